@@ -45,6 +45,7 @@ class RaycasterManager;
 class RenderEngine;
 class ScreenSpaceRenderable;
 class SyncEngine;
+class TaskScheduler;
 class TimeManager;
 class VersionChecker;
 class VirtualPropertyManager;
@@ -83,6 +84,7 @@ RaycasterManager& gRaycasterManager();
 RenderEngine& gRenderEngine();
 std::vector<std::unique_ptr<ScreenSpaceRenderable>>& gScreenspaceRenderables();
 SyncEngine& gSyncEngine();
+TaskScheduler& gTaskScheduler();
 TimeManager& gTimeManager();
 VersionChecker& gVersionChecker();
 VirtualPropertyManager& gVirtualPropertyManager();
@@ -103,6 +105,9 @@ scripting::ScriptScheduler& gScriptScheduler();
 
 } // namespace detail
 
+// The task scheduler is created first so that it is destroyed after all other globals
+// that might still have tasks running on it
+static TaskScheduler& taskScheduler = detail::gTaskScheduler();
 static ghoul::fontrendering::FontManager& fontManager = detail::gFontManager();
 static Dashboard& dashboard = detail::gDashboard();
 static DeferredcasterManager& deferredcasterManager = detail::gDeferredcasterManager();
@@ -28,8 +28,18 @@
 #include <openspace/interaction/externinteraction.h>
 #include <openspace/interaction/keyframenavigator.h>
 #include <openspace/scripting/lualibrary.h>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
 #include <vector>
 
+namespace openspace {
+    class MemoryMappedFile;
+    class TaskGroup;
+} // namespace openspace
+
 namespace openspace::interaction {
 
 class SessionRecording : public properties::PropertyOwner {
@@ -48,6 +58,46 @@ public:
     using CallbackHandle = int;
     using StateChangeCallback = std::function<void()>;
 
+    enum class RecordedType {
+        Camera = 0,
+        Time,
+        Script,
+        Invalid
+    };
+    /**
+     * Binary recordings are divided into blocks of consecutive keyframes. One of these
+     * entries is stored for each block in the index at the end of the file, which makes
+     * it possible to find and decode the keyframes around a specific time without
+     * parsing all of the preceding keyframes.
+     */
+    struct RecordingIndexEntry {
+        /// The offset of the first keyframe of the block from the start of the file
+        uint64_t offset;
+        /// The number of bytes that are used by all keyframes in the block
+        uint64_t size;
+        /// The number of keyframes in the block
+        uint64_t nEntries;
+        /// The timestamps of the first keyframe in the block
+        double timeOs;
+        double timeRec;
+        double timeSim;
+    };
+    /// The decoded contents of a single block of keyframes of a binary recording
+    struct KeyframeBlock {
+        struct Entry {
+            RecordedType type;
+            unsigned int idxIntoKeyframeTypeArray;
+            double timeOs;
+            double timeRec;
+            double timeSim;
+        };
+        std::vector<Entry> entries;
+        std::vector<interaction::KeyframeNavigator::CameraPose> keyframesCamera;
+        std::vector<datamessagestructures::TimeKeyframe> keyframesTime;
+        std::vector<std::string> keyframesScript;
+        bool hasErrors = false;
+    };
+
     SessionRecording();
 
     ~SessionRecording();
@@ -129,6 +179,20 @@ public:
      */
     void stopPlayback();
 
+    /**
+     * Moves the current playback to the provided time, measured in seconds since the
+     * start of the recording. The keyframes around the requested time are located using
+     * the index that is stored at the end of binary recording files, so the cost of a
+     * seek does not depend on the length of the recording. Script keyframes that were
+     * recorded before the requested time are not executed and the simulation time is
+     * not changed. Seeking is only supported for binary recordings that are played back
+     * relative to the recording start.
+     *
+     * \param recordedTime The time since the start of the recording to continue from
+     * \returns <code>true</code> if the playback was moved to the requested time
+     */
+    bool seekPlayback(double recordedTime);
+
     /**
      * Enables that rendered frames should be saved during playback
      * \param fps Number of frames per second.
@@ -208,13 +272,55 @@ public:
      */
     std::vector<std::string> playbackList() const;
 
+    /**
+     * Writes the keyframe \p index of a binary recording to \p stream, followed by the
+     * trailer that identifies it. The index has to be written directly after the last
+     * keyframe. The sizes of the blocks are computed from the offsets of the following
+     * blocks and the current position of the \p stream.
+     *
+     * \param stream The stream of the recording that the index is appended to
+     * \param index The blocks of keyframes that were written to the \p stream
+     */
+    static void writeRecordingIndex(std::ostream& stream,
+        std::vector<RecordingIndexEntry>& index);
+
+    /**
+     * Reads the keyframe index from the end of a binary recording. If the recording does
+     * not end with a valid index, because it was created by an earlier version, was not
+     * stopped properly, or was truncated, all keyframes are returned as a single block.
+     *
+     * \param data The contents of the recording file
+     * \param size The number of bytes in \p data
+     * \param headerSize The number of bytes of the file header before the first keyframe
+     * \returns The blocks of keyframes in the recording
+     */
+    static std::vector<RecordingIndexEntry> readRecordingIndex(const std::byte* data,
+        size_t size, size_t headerSize);
+
+    /**
+     * Decodes the binary keyframes in the \p size bytes at \p data. Decoding stops at
+     * the first keyframe that is incomplete or has an unknown type.
+     *
+     * \param data The first byte of the keyframes
+     * \param size The number of bytes that are decoded
+     * \param fileOffset The offset of \p data in the file, which is used for messages
+     * \returns The decoded keyframes
+     */
+    static KeyframeBlock decodeKeyframeBlock(const std::byte* data, size_t size,
+        size_t fileOffset);
+
+    /**
+     * Returns the position in the keyframe \p index of the last block that starts at or
+     * before \p recordedTime, or the first block if all blocks start after it.
+     *
+     * \param index The blocks of keyframes of a recording
+     * \param recordedTime The time since the start of the recording
+     * \returns The block from which the playback is continued to reach \p recordedTime
+     */
+    static size_t indexBlockForTime(const std::vector<RecordingIndexEntry>& index,
+        double recordedTime);
+
 private:
-    enum class RecordedType {
-        Camera = 0,
-        Time,
-        Script,
-        Invalid
-    };
     struct timelineEntry {
         RecordedType keyframeType;
         unsigned int idxIntoKeyframeTypeArray;
@@ -234,6 +340,22 @@ private:
     void playbackTimeChange();
     void playbackScript();
     bool playbackAddEntriesToTimeline();
+    void addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+        interaction::KeyframeNavigator::CameraPose keyframe);
+    void addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+        datamessagestructures::TimeKeyframe keyframe);
+    void addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+        std::string scriptToQueue);
+
+    void loadRecordingIndex(size_t headerSize);
+    bool loadKeyframesUntilCameraKeyframe();
+    void addKeyframeBlock(KeyframeBlock block);
+    void streamKeyframeBlocks();
+    void discardPlayedKeyframes();
+    bool hasLoadedAllKeyframes() const;
+    void addEntryToRecordingIndex(double timeOs, double timeRec, double timeSim);
+    void saveRecordingIndex();
+    void clearTimeline();
     void signalPlaybackFinishedForComponent(RecordedType type);
     void writeToFileBuffer(double src);
     void writeToFileBuffer(std::vector<char>& cvec);
@@ -313,6 +435,21 @@ private:
     unsigned int _idxTimeline_cameraFirstInTimeline = 0;
     double _cameraFirstInTimeline_timestamp = 0;
 
+    // Blocks of keyframes that are written to a binary recording before a new index
+    // entry is started
+    static const size_t KeyframesPerIndexBlock = 256;
+    std::vector<RecordingIndexEntry> _recordingIndex;
+
+    // Binary recordings are mapped into memory and the keyframe blocks are decoded on
+    // the task scheduler ahead of the current playback position
+    std::unique_ptr<MemoryMappedFile> _playbackData;
+    std::vector<RecordingIndexEntry> _playbackIndex;
+    std::unique_ptr<TaskGroup> _playbackReader;
+    size_t _nextPlaybackBlock = 0;
+    bool _isReadingBlock = false;
+    std::mutex _decodedBlockMutex;
+    std::optional<KeyframeBlock> _decodedBlock;
+
     int _nextCallbackHandle = 0;
 };
 
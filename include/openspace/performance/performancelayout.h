@@ -30,7 +30,7 @@
 namespace openspace::performance {
 
 struct PerformanceLayout {
-    constexpr static const int8_t Version = 0;
+    constexpr static const int8_t Version = 1;
     constexpr static const int LengthName = 256;
     constexpr static const int NumberValues = 256;
     constexpr static const int MaxValues = 1024;
@@ -47,13 +47,6 @@ struct PerformanceLayout {
     };
     SceneGraphPerformanceLayout sceneGraphEntries[MaxValues] = {};
     int16_t nScaleGraphEntries = 0;
-
-    struct FunctionPerformanceLayout {
-        char name[LengthName];
-        float time[NumberValues];
-    };
-    FunctionPerformanceLayout functionEntries[MaxValues] = {};
-    int16_t nFunctionEntries = 0;
 };
 
 } // namespace openspace::performance
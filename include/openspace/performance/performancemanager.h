@@ -25,7 +25,6 @@
 #ifndef __OPENSPACE_CORE___PERFORMANCEMANAGER___H__
 #define __OPENSPACE_CORE___PERFORMANCEMANAGER___H__
 
-#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -47,8 +46,6 @@ public:
 
     void resetPerformanceMeasurements();
 
-    void storeIndividualPerformanceMeasurement(const std::string& identifier,
-        long long microseconds);
     void storeScenePerformanceMeasurements(
         const std::vector<SceneGraphNode*>& sceneNodes);
 
@@ -79,8 +76,6 @@ private:
     std::string _prefix;
     std::string _ext = "log";
 
-    std::map<std::string, size_t> individualPerformanceLocations;
-
     std::unique_ptr<ghoul::SharedMemory> _performanceMemory;
 
     size_t _currentTick = 0;
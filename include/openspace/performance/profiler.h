@@ -0,0 +1,199 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___PROFILER___H__
+#define __OPENSPACE_CORE___PROFILER___H__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace openspace::scripting { struct LuaLibrary; }
+
+namespace openspace::performance {
+
+/**
+ * The profiler records named, nested zones from any thread into per-thread ring
+ * buffers. Each thread writes only into its own buffer, so recording a zone takes no
+ * locks and does not allocate. If the profiler is disabled, a zone costs a single
+ * relaxed atomic load. The zone names have to be string literals or otherwise outlive
+ * the profiler, as only the pointer is stored. In addition to the CPU zones, GPU zones
+ * measure the duration of the OpenGL commands that were issued inside them using
+ * timestamp queries, which are resolved asynchronously a few frames later. The
+ * recorded zones can be written to a file in the Chrome trace event format, which can
+ * be inspected with <code>chrome://tracing</code> or Perfetto.
+ */
+namespace profiler {
+
+/// The number of zones that each thread can hold before the oldest ones are overwritten
+constexpr const size_t RingBufferSize = 65536;
+
+namespace detail { extern std::atomic<bool> IsEnabled; }
+
+/**
+ * Returns whether the profiler is currently recording zones.
+ */
+inline bool isEnabled() {
+    return detail::IsEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Enables or disables the recording of zones. Zones that were recorded previously are
+ * kept when the profiler is disabled.
+ *
+ * \param enabled Whether zones should be recorded
+ */
+void setEnabled(bool enabled);
+
+/**
+ * Returns the number of nanoseconds that have passed since the start of the
+ * application using a monotonic clock.
+ */
+uint64_t now();
+
+/**
+ * Stores a completed zone in the ring buffer of the calling thread. This function is
+ * usually not called directly, but through the ProfilerZone class or the ProfileZone
+ * macro.
+ *
+ * \param name The name of the zone, which has to outlive the profiler
+ * \param begin The start time of the zone as returned by #now
+ * \param end The end time of the zone as returned by #now
+ */
+void recordZone(const char* name, uint64_t begin, uint64_t end);
+
+/**
+ * Sets the name under which the zones of the calling thread are shown in the trace.
+ *
+ * \param name The name of the calling thread
+ */
+void setThreadName(std::string name);
+
+/**
+ * Starts a GPU zone by inserting a timestamp query into the OpenGL command stream. GPU
+ * zones can be nested, but must only be used on the thread that owns the OpenGL
+ * context. This function is usually not called directly, but through the
+ * GpuProfilerZone class or the ProfileGpuZone macro.
+ *
+ * \param name The name of the zone, which has to outlive the profiler
+ */
+void beginGpuZone(const char* name);
+
+/**
+ * Ends the GPU zone that was started last by inserting a second timestamp query.
+ */
+void endGpuZone();
+
+/**
+ * Reads back the results of all GPU zones whose timestamp queries are available and
+ * stores them in the trace. Queries that are not yet available are kept for a later
+ * call. This function has to be called once per frame from the thread that owns the
+ * OpenGL context.
+ */
+void collectGpuZones();
+
+/**
+ * Removes all zones that have been recorded so far.
+ */
+void clear();
+
+/**
+ * Writes all zones that are currently stored in the ring buffers into the file at
+ * \p path using the Chrome trace event JSON format.
+ *
+ * \param path The path of the file that is written
+ * \returns <code>true</code> if the file was written successfully
+ */
+bool saveChromeTrace(const std::string& path);
+
+/**
+ * Returns the Lua library that contains the functions to control the profiler.
+ */
+scripting::LuaLibrary luaLibrary();
+
+} // namespace profiler
+
+/**
+ * Records a CPU zone that spans the lifetime of this object.
+ */
+class ProfilerZone {
+public:
+    explicit ProfilerZone(const char* name)
+        : _name(profiler::isEnabled() ? name : nullptr)
+        , _begin(_name ? profiler::now() : 0)
+    {}
+
+    ~ProfilerZone() {
+        if (_name) {
+            profiler::recordZone(_name, _begin, profiler::now());
+        }
+    }
+
+    ProfilerZone(const ProfilerZone&) = delete;
+    ProfilerZone& operator=(const ProfilerZone&) = delete;
+
+private:
+    const char* _name;
+    uint64_t _begin;
+};
+
+/**
+ * Records a GPU zone that spans the OpenGL commands issued during the lifetime of this
+ * object.
+ */
+class GpuProfilerZone {
+public:
+    explicit GpuProfilerZone(const char* name) : _isActive(profiler::isEnabled()) {
+        if (_isActive) {
+            profiler::beginGpuZone(name);
+        }
+    }
+
+    ~GpuProfilerZone() {
+        if (_isActive) {
+            profiler::endGpuZone();
+        }
+    }
+
+    GpuProfilerZone(const GpuProfilerZone&) = delete;
+    GpuProfilerZone& operator=(const GpuProfilerZone&) = delete;
+
+private:
+    bool _isActive;
+};
+
+#define __MERGE_ProfileZone(a,b)  a##b
+#define __LABEL_ProfileZone(a) __MERGE_ProfileZone(profilerZone_, a)
+
+/// Declare a new variable that records a profiler zone for the current block
+#define ProfileZone(name)                                                                \
+    const openspace::performance::ProfilerZone __LABEL_ProfileZone(__LINE__)((name))
+
+/// Declare a new variable that records a GPU profiler zone for the current block
+#define ProfileGpuZone(name)                                                             \
+    const openspace::performance::GpuProfilerZone __LABEL_ProfileZone(__LINE__)((name))
+
+} // namespace openspace::performance
+
+#endif // __OPENSPACE_CORE___PROFILER___H__
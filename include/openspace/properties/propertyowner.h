@@ -27,8 +27,12 @@
 
 #include <openspace/documentation/documentationgenerator.h>
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace openspace::properties {
@@ -75,7 +79,8 @@ public:
 
     /**
      * The destructor will remove all Propertys and PropertyOwners it owns along with
-     * itself.
+     * itself. If this PropertyOwner is still the sub-owner of another PropertyOwner, it
+     * is removed from that owner and from the URI index of its tree.
      */
     virtual ~PropertyOwner();
 
@@ -142,12 +147,15 @@ public:
      * first part of the name will be recursively extracted and used as a name for a
      * sub-owner and only the last part of the identifier is referring to a Property owned
      * by PropertyOwner named by the second-but-last name.
+     * The lookup is served from a hashed index of all URIs that is kept by the
+     * PropertyOwner at the top of the tree, so the cost does not grow with the number of
+     * sub-owners that have to be searched.
      *
      * \param uri The identifier of the Property that should be extracted
      * \return If the Property cannot be found, \c nullptr is returned, otherwise the
      *         pointer to the Property is returned
      */
-    Property* property(const std::string& uri) const;
+    Property* property(std::string_view uri) const;
 
     /**
      * This method checks if a Property with the provided \p uri exists in this
@@ -188,7 +196,7 @@ public:
      * \param identifier The identifier of the sub-owner that should be returned
      * \return The PropertyOwner with the given \p name, or \c nullptr
      */
-    PropertyOwner* propertySubOwner(const std::string& identifier) const;
+    PropertyOwner* propertySubOwner(std::string_view identifier) const;
 
     /**
      * Returns \c true if this PropertyOwner owns a sub-owner with the provided
@@ -257,7 +265,9 @@ public:
     void removeProperty(Property& prop);
 
     /**
-     * Removes the sub-owner from this PropertyOwner.
+     * Removes the sub-owner from this PropertyOwner. Notifies the sub-owner about this
+     * change by calling the PropertyOwner::setPropertyOwner method with a \c nullptr as
+     * parameter.
      *
      * \param owner The PropertyOwner that should be removed
      */
@@ -294,6 +304,16 @@ public:
     //Generate JSON for documentation
     std::string generateJson() const override;
 
+    /**
+     * Returns a counter that changes whenever a Property or a sub-owner is added to or
+     * removed from any PropertyOwner, or when a PropertyOwner changes its identifier.
+     * Caches that depend on the fully qualified identifiers of Property's can compare
+     * this value to find out whether they are still valid.
+     *
+     * \return The current value of the counter
+     */
+    static uint64_t structureGeneration();
+
 
 protected:
     /// The unique identifier of this PropertyOwner
@@ -313,6 +333,54 @@ protected:
     std::map<std::string, std::string> _groupNames;
     /// Collection of string tag(s) assigned to this property
     std::vector<std::string> _tags;
+
+private:
+    /// The incrementally computed FNV-1a hash of a URI relative to a root owner
+    struct UriHash {
+        UriHash append(std::string_view identifier) const;
+
+        uint64_t value = 14695981039346656037ULL;
+        bool isEmpty = true;
+    };
+
+    /**
+     * Returns the PropertyOwner at the top of the tree that contains this PropertyOwner
+     * together with the hash of the URI of this PropertyOwner relative to it.
+     */
+    std::pair<const PropertyOwner*, UriHash> uriIndexRoot() const;
+
+    /// Adds \p prop, which belongs to the owner with the URI hash \p prefix, to the index
+    void addToUriIndex(Property* prop, UriHash prefix) const;
+
+    /// Adds the Property's of \p owner and all of its sub-owners to the URI index
+    void addToUriIndex(const PropertyOwner& owner, UriHash prefix) const;
+
+    /// Removes \p prop from the URI index without accessing it
+    void removeFromUriIndex(const Property* prop) const;
+
+    /// Removes the Property's of \p owner and all of its sub-owners from the URI index
+    void removeFromUriIndex(const PropertyOwner& owner) const;
+
+    /// Returns whether \p uri, relative to this PropertyOwner, names the Property \p prop
+    bool isUriOf(const Property& prop, std::string_view uri) const;
+
+    /// Finds the Property for \p uri by walking the tree of sub-owners
+    Property* findProperty(std::string_view uri) const;
+
+    /**
+     * Maps the hashes of the URIs of all Property's in the tree below this owner,
+     * relative to this owner, to the Property's. Only the owner at the top of a tree uses
+     * this index, which is built on the first lookup and is kept up to date when
+     * Property's or sub-owners are added or removed. As hashes can collide, each match
+     * is verified against the URI. The indices of all owners are guarded by a single
+     * mutex, so that concurrent lookups are safe.
+     */
+    mutable std::unordered_multimap<uint64_t, Property*> _uriIndex;
+    /// The key of each Property in the #_uriIndex, so that Property's can be removed from
+    /// the index even if they were destroyed before their owner
+    mutable std::unordered_map<const Property*, uint64_t> _uriIndexKeys;
+    /// Whether the #_uriIndex has been built for this owner
+    mutable bool _hasUriIndex = false;
 };
 
 }  // namespace openspace::properties
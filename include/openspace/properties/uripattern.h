@@ -0,0 +1,104 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___URIPATTERN___H__
+#define __OPENSPACE_CORE___URIPATTERN___H__
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace openspace::properties {
+
+class Property;
+class PropertyOwner;
+
+/**
+ * A UriPattern is a compiled regular expression that is matched against the fully
+ * qualified identifiers of Property's. Most patterns that are used in scripts only
+ * consist of identifiers, <code>.</code>, and <code>.*</code>, for example
+ * <code>Scene.(.*).Renderable.Opacity</code>. These patterns are matched one character
+ * at a time by a small automaton, which makes it possible to test the URI of a
+ * PropertyOwner before any of its Property's and to skip all sub-owners that cannot lead
+ * to a match. All other patterns are handled by <code>std::regex</code>.
+ */
+class UriPattern {
+public:
+    /**
+     * Compiles the regular expression \p regex.
+     *
+     * \param regex The regular expression that fully qualified identifiers are matched
+     *        against
+     *
+     * \throw std::regex_error If \p regex is not a valid regular expression
+     */
+    explicit UriPattern(const std::string& regex);
+
+    /**
+     * Returns all Property's in the tree below \p owner, including \p owner itself, whose
+     * fully qualified identifier matches this pattern. The Property's are returned in
+     * the same order as PropertyOwner::propertiesRecursive would return them.
+     *
+     * \param owner The PropertyOwner at the top of the tree that is searched
+     * \return All Property's whose fully qualified identifier matches this pattern
+     */
+    std::vector<Property*> matchingProperties(const PropertyOwner& owner) const;
+
+    /// Returns \c true if this pattern is matched by the automaton and can prune owners
+    bool isHierarchical() const;
+
+private:
+    /// The set of active positions in the pattern, one bit for each position
+    using State = uint64_t;
+
+    State advance(State state, char c) const;
+    State advance(State state, std::string_view str) const;
+    State closure(State state) const;
+
+    void collect(const PropertyOwner& owner, State state, bool isEmpty,
+        std::vector<Property*>& result) const;
+
+    void collectRegex(const PropertyOwner& owner, std::string& prefix,
+        std::vector<Property*>& result) const;
+
+    /// The position masks for each character in the pattern
+    std::array<State, 256> _characterMasks = {};
+    /// The positions at which any single character is accepted
+    State _anyCharacterMask = 0;
+    /// The positions at which any sequence of characters is accepted
+    State _anySequenceMask = 0;
+    /// The state in which the full pattern has been matched
+    State _acceptMask = 0;
+
+    /// The fallback for patterns that cannot be matched by the automaton
+    std::unique_ptr<std::regex> _regex;
+};
+
+} // namespace openspace::properties
+
+#endif // __OPENSPACE_CORE___URIPATTERN___H__
@@ -44,6 +44,20 @@ const Renderable* renderable(const std::string& name);
 properties::Property* property(const std::string& uri);
 std::vector<properties::Property*> allProperties();
 
+/**
+ * Returns all Property's, including the ones owned by the VirtualPropertyManager, whose
+ * fully qualified identifier matches the regular expression \p regex. The compiled
+ * pattern and its result are cached, and the result is only recomputed after a Property
+ * or PropertyOwner has been added, removed, or renamed.
+ *
+ * \param regex The regular expression that the identifiers have to match
+ * \return All Property's whose fully qualified identifier matches \p regex, in the same
+ *         order as returned by allProperties
+ *
+ * \throw std::regex_error If \p regex is not a valid regular expression
+ */
+std::vector<properties::Property*> matchingProperties(const std::string& regex);
+
 } // namespace openspace
 
 #endif // __OPENSPACE_CORE___QUERY___H__
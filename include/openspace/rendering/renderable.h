@@ -85,6 +85,14 @@ public:
     void setRenderBin(RenderBin bin);
     bool matchesRenderBinMask(int binMask);
 
+    /**
+     * Returns the key by which this Renderable is ordered among the other renderables
+     * of the same render bin when the render queue is sorted. Renderables that use the
+     * same shader program and OpenGL state should return the same key. The default
+     * implementation returns a key that is based on the type of the Renderable.
+     */
+    virtual uint64_t renderSortKey() const;
+
     bool isVisible() const;
 
     void onEnabledChange(std::function<void(bool)> callback);
@@ -33,6 +33,7 @@
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/vector/vec3property.h>
 #include <openspace/properties/triggerproperty.h>
+#include <openspace/rendering/renderqueue.h>
 
 namespace ghoul {
     class Dictionary;
@@ -166,6 +167,18 @@ public:
 
     uint64_t frameNumber() const;
 
+    /**
+     * Returns the RenderQueue through which the scene graph nodes are submitted for
+     * rendering and which manages the per-frame texture upload budget.
+     */
+    RenderQueue& renderQueue();
+
+    /**
+     * Returns whether the draw packets in the order-independent render bins should be
+     * sorted by their sort key before they are rendered.
+     */
+    bool sortRenderQueue() const;
+
 private:
     void setRenderer(std::unique_ptr<Renderer> renderer);
     RendererImplementation rendererFromString(const std::string& renderingMethod) const;
@@ -210,6 +223,10 @@ private:
 #endif // OPENSPACE_WITH_INSTRUMENTATION
     properties::BoolProperty _disableMasterRendering;
 
+    properties::BoolProperty _sortRenderQueue;
+    properties::IntProperty _textureUploadBudget;
+    RenderQueue _renderQueue;
+
     properties::FloatProperty _globalBlackOutFactor;
     
     properties::BoolProperty _enableFXAA;
@@ -0,0 +1,137 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_CORE___RENDERQUEUE___H__
+#define __OPENSPACE_CORE___RENDERQUEUE___H__
+
+#include <ghoul/misc/boolean.h>
+#include <cstdint>
+#include <vector>
+
+namespace openspace {
+
+class SceneGraphNode;
+struct RenderData;
+struct RendererTasks;
+
+/**
+ * The RenderQueue collects the scene graph nodes that should be drawn into one render
+ * bin and submits them in an order that minimizes the number of program and state
+ * switches between consecutive renderables. Each submitted node becomes a draw packet
+ * whose sort key is provided by its Renderable (see Renderable::renderSortKey). In
+ * addition, the RenderQueue manages a per-frame budget for texture uploads that
+ * components streaming data to the GPU should consult before uploading, which spreads
+ * large upload spikes over multiple frames instead of stalling a single one. The number
+ * of draws, state changes, and uploaded bytes are collected per frame and are available
+ * through the #statistics function.
+ */
+class RenderQueue {
+public:
+    BooleanType(SortPackets);
+
+    struct Statistics {
+        /// The number of draw packets that were submitted in the current frame
+        int nDraws = 0;
+        /// The number of times the sort key changed between two consecutive packets
+        int nStateChanges = 0;
+        /// The number of bytes that were uploaded to the GPU in the current frame
+        uint64_t nUploadedBytes = 0;
+        /// The number of uploads that were postponed as the budget was exhausted
+        int nDeferredUploads = 0;
+    };
+
+    /**
+     * Resets the statistics and the upload budget. This function has to be called exactly
+     * once at the beginning of each frame, as calling it again in the same frame would
+     * permit uploading the budget again and discard the statistics collected so far.
+     */
+    void beginFrame();
+
+    /**
+     * Adds the provided \p node to the list of draw packets that are rendered in the
+     * next call to #flush.
+     *
+     * \param node The scene graph node whose renderable should be drawn
+     * \param sortKey The key by which the packets are ordered if they are sorted
+     */
+    void submit(SceneGraphNode* node, uint64_t sortKey);
+
+    /**
+     * Renders all draw packets that were submitted since the last call to this function
+     * and clears the list afterwards. If \p sort is <code>true</code>, the packets are
+     * stably sorted by their sort key first, otherwise they are rendered in the order in
+     * which they were submitted.
+     *
+     * \param data The RenderData that is passed to each scene graph node
+     * \param tasks The RendererTasks that each scene graph node can add to
+     * \param sort Whether the draw packets should be sorted before being rendered
+     */
+    void flush(const RenderData& data, RendererTasks& tasks, SortPackets sort);
+
+    /**
+     * Sets the number of bytes that can be uploaded to the GPU in a single frame.
+     *
+     * \param nBytes The maximum number of bytes that should be uploaded per frame
+     */
+    void setUploadBudget(uint64_t nBytes);
+
+    /**
+     * Returns whether an upload may be performed in the current frame. The first upload
+     * in each frame is always permitted, even if the budget is set to 0, so that progress
+     * is guaranteed. If this function returns <code>false</code>, the caller should retry
+     * in a later frame.
+     *
+     * \returns <code>true</code> if the upload budget for this frame is not exhausted
+     */
+    bool requestUpload();
+
+    /**
+     * Registers that \p nBytes were uploaded to the GPU in the current frame.
+     *
+     * \param nBytes The number of bytes that were uploaded
+     */
+    void registerUpload(uint64_t nBytes);
+
+    /**
+     * Returns the statistics that have been collected since the last call to
+     * #beginFrame.
+     *
+     * \returns The statistics of the current frame
+     */
+    const Statistics& statistics() const;
+
+private:
+    struct Packet {
+        SceneGraphNode* node;
+        uint64_t sortKey;
+    };
+    std::vector<Packet> _packets;
+
+    uint64_t _uploadBudget = 64 * 1024 * 1024;
+    Statistics _statistics;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___RENDERQUEUE___H__
@@ -52,6 +52,15 @@ public:
     virtual glm::dmat3 matrix(const UpdateData& time) const = 0;
     void update(const UpdateData& data);
 
+    /**
+     * Returns whether this rotation can be updated concurrently with other scene graph
+     * nodes, which requires that computing the matrix does not access any state that is
+     * shared with other objects without synchronization. The default implementation
+     * returns <code>false</code>, which causes the owning node to be updated on the
+     * main thread.
+     */
+    virtual bool isThreadSafe() const;
+
     static documentation::Documentation Documentation();
 
 protected:
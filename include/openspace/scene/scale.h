@@ -52,6 +52,15 @@ public:
     virtual double scaleValue(const UpdateData& data) const = 0;
     virtual void update(const UpdateData& data);
 
+    /**
+     * Returns whether this scale can be updated concurrently with other scene graph
+     * nodes, which requires that computing the scale value does not access any state
+     * that is shared with other objects without synchronization. The default
+     * implementation returns <code>false</code>, which causes the owning node to be
+     * updated on the main thread.
+     */
+    virtual bool isThreadSafe() const;
+
     static documentation::Documentation Documentation();
 
 protected:
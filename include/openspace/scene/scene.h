@@ -27,10 +27,13 @@
 
 #include <openspace/properties/propertyowner.h>
 
+#include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scene/scenelicense.h>
 #include <ghoul/misc/easing.h>
 #include <ghoul/misc/exception.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
@@ -251,9 +254,33 @@ private:
 
     void sortTopologically();
 
+    /**
+     * Builds the _updateGraph from the parent-child and dependency relations of the
+     * topologically sorted nodes.
+     */
+    void buildUpdateGraph();
+
+    /**
+     * Updates the transformations of all nodes. Unless disabled, nodes whose
+     * transformations are thread-safe are updated on the task scheduler as soon as their
+     * parent and dependencies are finished. The remaining nodes are updated on the
+     * calling thread while no other node is updated, after all nodes that precede them
+     * in the topological order and before all nodes that follow them.
+     */
+    void updateTransforms(const UpdateData& data);
+
     std::unique_ptr<Camera> _camera;
     std::vector<SceneGraphNode*> _topologicallySortedNodes;
     std::vector<SceneGraphNode*> _circularNodes;
+
+    // The edges between the nodes, indexed in the same way as _topologicallySortedNodes
+    struct {
+        std::vector<std::vector<size_t>> successors;
+        std::vector<int> nPredecessors;
+        // The number of predecessors that have not been updated in the current frame
+        std::unique_ptr<std::atomic<int>[]> nRemaining;
+    } _updateGraph;
+    properties::BoolProperty _parallelUpdate;
     std::unordered_map<std::string, SceneGraphNode*> _nodesByIdentifier;
     bool _dirtyNodeRegistry = false;
     SceneGraphNode _rootDummy;
@@ -99,6 +99,35 @@ public:
     void traversePreOrder(const std::function<void(SceneGraphNode*)>& fn);
     void traversePostOrder(const std::function<void(SceneGraphNode*)>& fn);
     void update(const UpdateData& data);
+
+    /**
+     * Updates the translation, rotation, and scale of this node and computes its world
+     * transformation. The parent of this node must have been updated before. This
+     * function can be called from a worker thread if isTransformThreadSafe returns
+     * <code>true</code>.
+     */
+    void updateTransform(const UpdateData& data);
+
+    /**
+     * Updates the renderable with the transformation that was computed in the last call
+     * to updateTransform. This function must be called from the thread that owns the
+     * OpenGL context.
+     */
+    void updateRenderable(const UpdateData& data);
+
+    /**
+     * Returns whether the translation, rotation, and scale of this node can be updated
+     * concurrently with other scene graph nodes.
+     */
+    bool isTransformThreadSafe() const;
+
+    /**
+     * Returns whether this node has a renderable that should be drawn for the provided
+     * \p data, that is whether it is initialized, active at the current time, visible,
+     * and part of the requested render bin.
+     */
+    bool shouldRender(const RenderData& data) const;
+
     void render(const RenderData& data, RendererTasks& tasks);
 
     void attachChild(std::unique_ptr<SceneGraphNode> child);
@@ -168,6 +197,9 @@ private:
 
     PerformanceRecord _performanceRecord = { 0, 0, 0, 0, 0 };
 
+    // Whether updateTransform has computed the transformation in the current frame
+    bool _hasUpdatedTransform = false;
+
     std::unique_ptr<Renderable> _renderable;
 
     properties::StringProperty _guiPath;
@@ -25,7 +25,9 @@
 #ifndef __OPENSPACE_CORE___SCENEINITIALIZER___H__
 #define __OPENSPACE_CORE___SCENEINITIALIZER___H__
 
-#include <openspace/util/threadpool.h>
+#include <openspace/util/taskscheduler.h>
+#include <deque>
+#include <mutex>
 #include <unordered_set>
 #include <vector>
 
@@ -51,6 +53,10 @@ private:
     std::vector<SceneGraphNode*> _initializedNodes;
 };
 
+/**
+ * Initializes the scene graph nodes on the TaskScheduler with at most the provided
+ * number of nodes being initialized at the same time.
+ */
 class MultiThreadedSceneInitializer : public SceneInitializer {
 public:
     MultiThreadedSceneInitializer(unsigned int nThreads);
@@ -60,10 +66,19 @@ public:
     bool isInitializing() const override;
 
 private:
+    /// Initializes queued nodes until the queue is empty
+    void initializeQueuedNodes();
+
     std::vector<SceneGraphNode*> _initializedNodes;
     std::unordered_set<SceneGraphNode*> _initializingNodes;
-    ThreadPool _threadPool;
+    std::deque<SceneGraphNode*> _queuedNodes;
+    unsigned int _nRunningInitializers = 0;
+    const unsigned int _nThreads;
     mutable std::mutex _mutex;
+
+    /// Declared last so that the running initializations finish before the other members
+    /// are gone
+    TaskGroup _tasks;
 };
 
 } // namespace openspace
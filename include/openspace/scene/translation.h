@@ -54,6 +54,15 @@ public:
 
     virtual glm::dvec3 position(const UpdateData& data) const = 0;
 
+    /**
+     * Returns whether this translation can be updated concurrently with other scene graph
+     * nodes, which requires that computing the position does not access any state that is
+     * shared with other objects without synchronization. The default implementation
+     * returns <code>false</code>, which causes the owning node to be updated on the
+     * main thread.
+     */
+    virtual bool isThreadSafe() const;
+
     // Registers a callback that gets called when a significant change has been made that
     // invalidates potentially stored points, for example in trails
     void onParameterChange(std::function<void()> callback);
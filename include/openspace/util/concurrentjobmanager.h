@@ -26,7 +26,7 @@
 #define __OPENSPACE_CORE___CONCURRENT_JOB_MANAGER___H__
 
 #include <openspace/util/concurrentqueue.h>
-#include <openspace/util/threadpool.h>
+#include <openspace/util/taskscheduler.h>
 
 #include <mutex>
 
@@ -36,15 +36,22 @@ template <typename T> struct Job;
 
 /*
  * Templated Concurrent Job Manager
- * This class is used execute specific jobs on one (1) parallell thread
+ * This class is used execute specific jobs on the worker threads of a TaskScheduler.
+ * Destroying the manager drops the jobs that have not started and waits for the running
+ * ones to finish.
  */
 template<typename P>
 class ConcurrentJobManager {
 public:
-    ConcurrentJobManager(ThreadPool pool);
+    ConcurrentJobManager(TaskScheduler& scheduler,
+        TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
 
     void enqueueJob(std::shared_ptr<Job<P>> job);
 
+    /**
+     * Drops all jobs that have not been started yet. Jobs that are currently running
+     * will still finish.
+     */
     void clearEnqueuedJobs();
 
     std::shared_ptr<Job<P>> popFinishedJob();
@@ -54,7 +61,14 @@ public:
 private:
     ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
     std::mutex _finishedJobsMutex;
-    ThreadPool threadPool;
+
+    const TaskScheduler::Priority _priority;
+    /// Cancelled and replaced whenever the enqueued jobs are cleared
+    CancellationToken _cancellationToken;
+    std::mutex _cancellationTokenMutex;
+
+    /// Declared last so that the running jobs finish before the other members are gone
+    TaskGroup _jobs;
 };
 
 } // namespace openspace
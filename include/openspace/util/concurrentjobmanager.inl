@@ -28,22 +28,31 @@
 namespace openspace {
 
 template<typename P>
-ConcurrentJobManager<P>::ConcurrentJobManager(ThreadPool pool)
-    : threadPool(pool)
+ConcurrentJobManager<P>::ConcurrentJobManager(TaskScheduler& scheduler,
+                                              TaskScheduler::Priority priority)
+    : _priority(priority)
+    , _jobs(scheduler)
 {}
 
 template<typename P>
 void ConcurrentJobManager<P>::enqueueJob(std::shared_ptr<Job<P>> job) {
-    threadPool.enqueue([this, job]() {
-        job->execute();
-        std::lock_guard<std::mutex> lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
-    });
+    std::lock_guard<std::mutex> lock(_cancellationTokenMutex);
+    _jobs.run(
+        [this, job]() {
+            job->execute();
+            std::lock_guard<std::mutex> lock(_finishedJobsMutex);
+            _finishedJobs.push(job);
+        },
+        _priority,
+        _cancellationToken
+    );
 }
 
 template<typename P>
 void ConcurrentJobManager<P>::clearEnqueuedJobs() {
-    threadPool.clearTasks();
+    std::lock_guard<std::mutex> lock(_cancellationTokenMutex);
+    _cancellationToken.cancel();
+    _cancellationToken = CancellationToken();
 }
 
 template<typename P>
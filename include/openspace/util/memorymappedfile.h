@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
+#define __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
+
+#include <cstddef>
+#include <string>
+
+namespace openspace {
+
+/**
+ * A read-only view of an entire file that is mapped into the address space of the
+ * process. The pages are loaded lazily by the operating system when they are first
+ * accessed and can be evicted again without going through the swap file, which makes
+ * this class suitable for streaming large binary datasets without first copying them
+ * into intermediate buffers. If the file could not be opened or mapped, the object is
+ * still constructed but <code>isValid()</code> returns <code>false</code>.
+ */
+class MemoryMappedFile {
+public:
+    explicit MemoryMappedFile(const std::string& path);
+    ~MemoryMappedFile();
+
+    MemoryMappedFile(const MemoryMappedFile&) = delete;
+    MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+    MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+    MemoryMappedFile& operator=(MemoryMappedFile&& other) noexcept;
+
+    /// Returns <code>true</code> if the file was successfully mapped
+    bool isValid() const;
+
+    /// Returns the path of the mapped file
+    const std::string& path() const;
+
+    /// Returns a pointer to the first byte of the file or <code>nullptr</code>
+    const std::byte* data() const;
+
+    /// Returns the size of the mapped file in bytes
+    size_t size() const;
+
+    /**
+     * Returns a typed pointer to the mapped memory at the byte \p offset. It is the
+     * responsibility of the caller to make sure that the offset is correctly aligned for
+     * type \c T and that enough data is available after the offset.
+     */
+    template <typename T>
+    const T* at(size_t offset) const {
+        return reinterpret_cast<const T*>(_data + offset);
+    }
+
+    /**
+     * Hints to the operating system that the bytes in [\p offset, \p offset + \p length)
+     * will be accessed soon and should be read ahead.
+     */
+    void prefetch(size_t offset, size_t length) const;
+
+    /**
+     * Touches every page of the mapping so that the whole file is resident in memory.
+     * This should be called from a worker thread before the data is accessed from a
+     * thread that must not stall on disk reads.
+     */
+    void populate() const;
+
+private:
+    void unmap();
+
+    std::string _path;
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+
+#ifdef WIN32
+    void* _fileHandle = nullptr;
+    void* _mappingHandle = nullptr;
+#endif // WIN32
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___MEMORYMAPPEDFILE___H__
@@ -30,6 +30,7 @@
 #include <ghoul/misc/exception.h>
 #include <array>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <set>
@@ -1005,6 +1006,11 @@ private:
     /// The last assigned kernel-id, used to determine the next free kernel id
     KernelHandle _lastAssignedKernel = KernelHandle(0);
 
+    /// CSPICE keeps global state and is not thread-safe, so every method that calls into
+    /// it or accesses the coverage information holds this lock. It is recursive as these
+    /// methods call each other
+    mutable std::recursive_mutex _spiceMutex;
+
     static SpiceManager* _instance;
 };
 
@@ -0,0 +1,207 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#ifndef __OPENSPACE_CORE___TASKSCHEDULER___H__
+#define __OPENSPACE_CORE___TASKSCHEDULER___H__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * A token that can be passed along with tasks to the TaskScheduler. Calling
+ * <code>cancel</code> on any copy of the token will prevent all tasks with that token
+ * that have not started yet from being executed. Tasks that are already running are not
+ * interrupted, but can poll <code>isCancelled</code> to end early.
+ */
+class CancellationToken {
+public:
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    friend class TaskGroup;
+    friend class TaskScheduler;
+
+    std::shared_ptr<std::atomic<bool>> _isCancelled;
+};
+
+/**
+ * The TaskScheduler executes tasks on a fixed set of worker threads. Every worker owns a
+ * separate deque of tasks for each priority and workers that run out of tasks steal from
+ * the other workers, so that tasks that are enqueued in bursts or from within other tasks
+ * do not contend on a single lock. Higher priority tasks are always started before lower
+ * priority tasks, regardless of which worker they are queued on. A worker executes its
+ * own most recent task first while other workers steal the oldest tasks.
+ *
+ * A single engine-wide instance is available as <code>global::taskScheduler</code> so
+ * that different systems share the available cores instead of each creating their own
+ * threads. The worker threads are started lazily when the first task is enqueued.
+ * Destroying the scheduler drops all tasks that have not started and waits for the
+ * running tasks to finish.
+ */
+class TaskScheduler {
+public:
+    enum class Priority {
+        Low = 0,
+        Normal,
+        High
+    };
+
+    explicit TaskScheduler(size_t nThreads);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * Enqueues the \p task to be executed on one of the worker threads. If this is called
+     * from a worker thread, the task is placed in that worker's deque.
+     */
+    void enqueue(std::function<void()> task, Priority priority = Priority::Normal);
+
+    /**
+     * Enqueues the \p task to be executed on one of the worker threads unless the
+     * \p token has been cancelled before the task is started.
+     */
+    void enqueue(std::function<void()> task, Priority priority,
+        const CancellationToken& token);
+
+    /// Returns the number of worker threads
+    size_t numThreads() const;
+
+    /// Returns the number of tasks that have been enqueued but not started yet
+    size_t numQueuedTasks() const;
+
+private:
+    friend class TaskGroup;
+
+    struct GroupState {
+        std::atomic<size_t> nUnfinished = 0;
+        std::atomic<bool> isCancelled = false;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    struct Task {
+        std::function<void()> function;
+        std::shared_ptr<std::atomic<bool>> isCancelled;
+        std::shared_ptr<GroupState> group;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::array<std::deque<Task>, 3> tasks;
+        // Lets other workers skip empty deques without taking the lock
+        std::array<std::atomic<size_t>, 3> nTasks = {};
+    };
+
+    void startWorkers();
+    void submit(Task task, Priority priority);
+    void removeTasks(const std::shared_ptr<GroupState>& group);
+    void finishTask(Task& task);
+    bool runQueuedTask(size_t preferredQueue);
+    void runTask(Task& task);
+    void workerLoop(size_t index);
+
+    /// Returns the index of the calling worker thread or numThreads() if the call is not
+    /// made from one of this scheduler's workers
+    size_t currentWorker() const;
+
+    const size_t _nThreads;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::once_flag _startWorkers;
+
+    std::atomic<size_t> _nQueuedTasks = 0;
+    std::atomic<size_t> _nSleepingWorkers = 0;
+    std::atomic<size_t> _nextQueue = 0;
+    std::atomic<bool> _stop = false;
+    std::mutex _sleepMutex;
+    std::condition_variable _wakeUp;
+};
+
+/**
+ * A TaskGroup keeps track of a set of tasks that are executed by a TaskScheduler so that
+ * it is possible to wait for all of them to finish or to cancel those that have not
+ * started yet. Destroying a TaskGroup cancels its pending tasks and waits for the running
+ * ones, which makes it safe for the tasks to access the object that owns the group.
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * Enqueues the \p task on the scheduler as part of this group. If the group has been
+     * cancelled, the task will not be executed.
+     */
+    void run(std::function<void()> task,
+        TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
+
+    /**
+     * Enqueues the \p task on the scheduler as part of this group. The task is skipped if
+     * either the group or the \p token is cancelled before it is started.
+     */
+    void run(std::function<void()> task, TaskScheduler::Priority priority,
+        const CancellationToken& token);
+
+    /**
+     * Blocks until all tasks in this group have finished or were skipped. If called from
+     * one of the scheduler's worker threads, that thread executes other queued tasks in
+     * the meantime instead of blocking a worker.
+     */
+    void wait();
+
+    /**
+     * Prevents all tasks in this group that have not started from being executed. This
+     * includes all tasks that are added to the group afterwards.
+     */
+    void cancel();
+
+    /// Returns the number of tasks in this group that have not finished or were skipped
+    size_t numUnfinishedTasks() const;
+
+private:
+    TaskScheduler& _scheduler;
+    std::shared_ptr<TaskScheduler::GroupState> _state;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_CORE___TASKSCHEDULER___H__
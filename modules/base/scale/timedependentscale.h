@@ -39,6 +39,7 @@ class TimeDependentScale : public Scale {
 public:
     TimeDependentScale(const ghoul::Dictionary& dictionary);
     double scaleValue(const UpdateData& data) const override;
+    bool isThreadSafe() const override;
 
     static documentation::Documentation Documentation();
 
@@ -37,6 +37,8 @@ public:
 
     static std::string DefaultTransferFunctionFile;
 
+    std::vector<documentation::Documentation> documentations() const override;
+
 private:
     void internalInitialize(const ghoul::Dictionary&) override;
 };
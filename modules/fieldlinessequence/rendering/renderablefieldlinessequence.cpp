@@ -32,6 +32,7 @@
 #include <openspace/interaction/orbitalnavigator.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scene.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/filesystem/filesystem.h>
@@ -39,7 +40,6 @@
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/textureunit.h>
 #include <fstream>
-#include <thread>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableFieldlinesSequence";
@@ -70,6 +70,8 @@ namespace {
     constexpr const char* KeyJsonScalingFactor = "ScaleToMeters";
     // [BOOLEAN] If value False => Load in initializing step and store in RAM
     constexpr const char* KeyOslfsLoadAtRuntime = "LoadAtRuntime";
+    // [INT] Number of states to load ahead of the active state if loading at runtime
+    constexpr const char* KeyOslfsPrefetchStates = "PrefetchStates";
 
     // ---------------------------- OPTIONAL MODFILE KEYS  ---------------------------- //
     // [STRING ARRAY] Values should be paths to .txt files
@@ -584,9 +586,20 @@ bool RenderableFieldlinesSequence::prepareForOsflsStreaming() {
         LERROR("The provided .osfls files seem to be corrupt!");
         return false;
     }
-    _states.push_back(newState);
     _nStates = _startTimes.size();
+
+    // The ring holds the previous and the active state and the prefetched states. The
+    // first state is already loaded and its index maps to the first slot
+    const size_t ringSize = std::min(static_cast<size_t>(_nPrefetchStates) + 2, _nStates);
+    _states.resize(ringSize);
+    _states[0] = std::move(newState);
+    _stateRing = std::vector<RingSlot>(ringSize);
+    _stateRing[0].stateIndex = 0;
+    _stateRing[0].isLoaded = true;
+    _hasFailedToLoad = std::vector<bool>(_nStates, false);
     _activeStateIndex = 0;
+
+    _loader = std::make_unique<TaskGroup>(global::taskScheduler);
     return true;
 }
 
@@ -619,6 +632,11 @@ void RenderableFieldlinesSequence::extractOsflsInfoFromDictionary() {
             _identifier, KeyOslfsLoadAtRuntime
         ));
     }
+
+    double nPrefetchStates;
+    if (_dictionary->getValue(KeyOslfsPrefetchStates, nPrefetchStates)) {
+        _nPrefetchStates = std::max(static_cast<int>(nPrefetchStates), 0);
+    }
 }
 
 void RenderableFieldlinesSequence::setupProperties() {
@@ -1014,32 +1032,29 @@ void RenderableFieldlinesSequence::extractMagnitudeVarsFromStrings(
 }
 
 void RenderableFieldlinesSequence::deinitializeGL() {
+    // Destroying the loader waits for the states that are currently being read
+    _loader = nullptr;
+    _loadedStates.clear();
+
     glDeleteVertexArrays(1, &_vertexArrayObject);
     _vertexArrayObject = 0;
 
     glDeleteBuffers(1, &_vertexPositionBuffer);
     _vertexPositionBuffer = 0;
+    _vertexPositionBufferSize = 0;
 
     glDeleteBuffers(1, &_vertexColorBuffer);
     _vertexColorBuffer = 0;
+    _vertexColorBufferSize = 0;
 
     glDeleteBuffers(1, &_vertexMaskingBuffer);
     _vertexMaskingBuffer = 0;
+    _vertexMaskingBufferSize = 0;
 
     if (_shaderProgram) {
         global::renderEngine.removeRenderProgram(_shaderProgram.get());
         _shaderProgram = nullptr;
     }
-
-    // Stall main thread until thread that's loading states is done!
-    bool printedWarning = false;
-    while (_isLoadingStateFromDisk) {
-        if (!printedWarning) {
-            LWARNING("Trying to destroy class when an active thread is still using it");
-            printedWarning = true;
-        }
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
-    }
 }
 
 bool RenderableFieldlinesSequence::isReady() const {
@@ -1169,23 +1184,36 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
         _needsUpdate              = false;
     }
 
-    if (_mustLoadNewStateFromDisk) {
-        if (!_isLoadingStateFromDisk && !_newStateIsReady) {
-            _isLoadingStateFromDisk    = true;
-            _mustLoadNewStateFromDisk  = false;
-            std::string filePath = _sourceFiles[_activeTriggerTimeIndex];
-            std::thread readBinaryThread([this, f = std::move(filePath)] {
-                readNewState(f);
-            });
-            readBinaryThread.detach();
-        }
-    }
+    // The loader only exists between initializeGL and deinitializeGL
+    if (_loadingStatesDynamically && _loader) {
+        moveLoadedStatesIntoRing();
+
+        if (_activeTriggerTimeIndex != -1) {
+            requestState(_activeTriggerTimeIndex);
+
+            // Avoid piling up prefetches when time moves faster than the states load
+            const size_t nPrefetch = static_cast<size_t>(_nPrefetchStates);
+            if (_loader->numUnfinishedTasks() <= nPrefetch) {
+                const int direction = global::timeManager.deltaTime() < 0.0 ? -1 : 1;
+                for (int i = 1; i <= _nPrefetchStates; ++i) {
+                    requestState(_activeTriggerTimeIndex + i * direction);
+                }
+            }
 
-    if (_needsUpdate || _newStateIsReady) {
-        if (_loadingStatesDynamically) {
-            _states[0] = std::move(*_newState);
+            const int slot = _activeTriggerTimeIndex % static_cast<int>(_states.size());
+            if (_mustLoadNewStateFromDisk && _hasFailedToLoad[_activeTriggerTimeIndex]) {
+                // Keep showing the previous state in place of the one that failed
+                _mustLoadNewStateFromDisk = false;
+            }
+            else if (_mustLoadNewStateFromDisk && _stateRing[slot].isLoaded) {
+                _activeStateIndex = slot;
+                _mustLoadNewStateFromDisk = false;
+                _needsUpdate = true;
+            }
         }
+    }
 
+    if (_needsUpdate) {
         updateVertexPositionBuffer();
 
         if (_states[_activeStateIndex].nExtraQuantities() > 0) {
@@ -1195,7 +1223,6 @@ void RenderableFieldlinesSequence::update(const UpdateData& data) {
 
         // Everything is set and ready for rendering!
         _needsUpdate = false;
-        _newStateIsReady = false;
     }
 
     if (_shouldUpdateColorBuffer) {
@@ -1226,13 +1253,92 @@ void RenderableFieldlinesSequence::updateActiveTriggerTimeIndex(double currentTi
     }
 }
 
-// Reading state from disk. Must be thread safe!
-void RenderableFieldlinesSequence::readNewState(const std::string& filePath) {
-    _newState = std::make_unique<FieldlinesState>();
-    if (_newState->loadStateFromOsfls(filePath)) {
-        _newStateIsReady = true;
+void RenderableFieldlinesSequence::moveLoadedStatesIntoRing() {
+    std::vector<LoadedState> loadedStates;
+    {
+        std::lock_guard<std::mutex> lock(_loadedStatesMutex);
+        std::swap(loadedStates, _loadedStates);
+    }
+
+    for (LoadedState& loaded : loadedStates) {
+        const int slot = loaded.stateIndex % static_cast<int>(_states.size());
+        RingSlot& ringSlot = _stateRing[slot];
+        if (ringSlot.stateIndex != loaded.stateIndex) {
+            // The slot was requested for another state while this one was loading
+            continue;
+        }
+        if (!loaded.isValid) {
+            // Free the slot for other states; the failed state is skipped from now on
+            _hasFailedToLoad[loaded.stateIndex] = true;
+            ringSlot.stateIndex = -1;
+            continue;
+        }
+        if (slot == _activeStateIndex &&
+            loaded.stateIndex != _activeTriggerTimeIndex)
+        {
+            // The slot is shown and only the state of the active trigger time may
+            // replace it. Mark the slot as empty so that the state is requested again
+            ringSlot.stateIndex = -1;
+            continue;
+        }
+
+        _states[slot] = std::move(loaded.state);
+        ringSlot.isLoaded = true;
     }
-    _isLoadingStateFromDisk = false;
+}
+
+// Starts reading the state with the provided index from disk on the task scheduler,
+// unless it is already loaded or being loaded
+void RenderableFieldlinesSequence::requestState(int stateIndex) {
+    if (stateIndex < 0 || stateIndex >= static_cast<int>(_nStates) ||
+        _hasFailedToLoad[stateIndex])
+    {
+        return;
+    }
+
+    const int slot = stateIndex % static_cast<int>(_states.size());
+    RingSlot& ringSlot = _stateRing[slot];
+    if (ringSlot.stateIndex == stateIndex) {
+        return;
+    }
+    const bool isActive = (stateIndex == _activeTriggerTimeIndex);
+    if (slot == _activeStateIndex && !isActive) {
+        // Don't replace the state that is shown by a prefetched state
+        return;
+    }
+
+    ringSlot.stateIndex = stateIndex;
+    ringSlot.isLoaded = false;
+
+    _loader->run(
+        [this, stateIndex, slot, path = _sourceFiles[stateIndex]]() {
+            // Skip states whose slot was requested for another state before they started
+            if (_stateRing[slot].stateIndex != stateIndex) {
+                return;
+            }
+
+            // A failure is reported as well, as the slot stays claimed until then
+            LoadedState loaded = { stateIndex, FieldlinesState() };
+            try {
+                loaded.isValid = loaded.state.loadStateFromOsfls(path);
+            }
+            catch (const std::exception& e) {
+                LERROR(e.what());
+                loaded.isValid = false;
+            }
+            catch (...) {
+                loaded.isValid = false;
+            }
+            if (!loaded.isValid) {
+                LWARNING(fmt::format("Failed to load state from: {}", path));
+                loaded.state = FieldlinesState();
+            }
+
+            std::lock_guard<std::mutex> lock(_loadedStatesMutex);
+            _loadedStates.push_back(std::move(loaded));
+        },
+        isActive ? TaskScheduler::Priority::High : TaskScheduler::Priority::Normal
+    );
 }
 
 // Unbind buffers and arrays
@@ -1241,17 +1347,25 @@ inline void unbindGL() {
     glBindVertexArray(0);
 }
 
+// Uploads the data to the bound array buffer. The old storage is orphaned first, so the
+// upload does not have to wait for earlier frames that still render from the buffer.
+// The storage only grows, which lets the driver reuse its allocations between states
+inline void uploadArrayBuffer(const void* data, GLsizeiptr size, GLsizeiptr& capacity) {
+    capacity = std::max(capacity, size);
+    glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+}
+
 void RenderableFieldlinesSequence::updateVertexPositionBuffer() {
     glBindVertexArray(_vertexArrayObject);
     glBindBuffer(GL_ARRAY_BUFFER, _vertexPositionBuffer);
 
     const std::vector<glm::vec3>& vertPos = _states[_activeStateIndex].vertexPositions();
 
-    glBufferData(
-        GL_ARRAY_BUFFER,
-        vertPos.size() * sizeof(glm::vec3),
+    uploadArrayBuffer(
         vertPos.data(),
-        GL_STATIC_DRAW
+        vertPos.size() * sizeof(glm::vec3),
+        _vertexPositionBufferSize
     );
 
     glEnableVertexAttribArray(VaPosition);
@@ -1271,11 +1385,10 @@ void RenderableFieldlinesSequence::updateVertexColorBuffer() {
     );
 
     if (isSuccessful) {
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            quantities.size() * sizeof(float),
+        uploadArrayBuffer(
             quantities.data(),
-            GL_STATIC_DRAW
+            quantities.size() * sizeof(float),
+            _vertexColorBufferSize
         );
 
         glEnableVertexAttribArray(VaColor);
@@ -1296,11 +1409,10 @@ void RenderableFieldlinesSequence::updateVertexMaskingBuffer() {
     );
 
     if (isSuccessful) {
-        glBufferData(
-            GL_ARRAY_BUFFER,
-            maskings.size() * sizeof(float),
+        uploadArrayBuffer(
             maskings.data(),
-            GL_STATIC_DRAW
+            maskings.size() * sizeof(float),
+            _vertexMaskingBufferSize
         );
 
         glEnableVertexAttribArray(VaMasking);
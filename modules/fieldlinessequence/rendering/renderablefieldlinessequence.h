@@ -36,11 +36,15 @@
 #include <openspace/properties/vector/vec4property.h>
 #include <openspace/rendering/transferfunction.h>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace { enum class SourceFileType; }
 
 namespace openspace {
 
+class TaskGroup;
+
 class RenderableFieldlinesSequence : public Renderable {
 public:
     RenderableFieldlinesSequence(const ghoul::Dictionary& dictionary);
@@ -61,25 +65,39 @@ private:
         ByQuantity
     };
 
+    // ------------------------------------ STRUCTS ------------------------------------//
+    // Used for 'runtime-states'. Bookkeeping for one slot of the ring of preloaded states
+    // in _states. The slot of a state is its index modulo the size of the ring
+    struct RingSlot {
+        // Index of the state that is stored or being loaded in this slot. -1 => empty.
+        // Read by the loading tasks to skip states that were replaced before they started
+        std::atomic_int stateIndex = -1;
+        // True if the slot in _states contains the state with stateIndex
+        bool isLoaded = false;
+    };
+
+    // Used for 'runtime-states'. A state that was read from disk by a loading task and
+    // that is waiting to be moved into its slot on the main thread
+    struct LoadedState {
+        int stateIndex;
+        FieldlinesState state;
+        // False if the state couldn't be read from disk
+        bool isValid = true;
+    };
+
     // ------------------------------------ STRINGS ------------------------------------//
     std::string _identifier;                               // Name of the Node!
 
     // ------------------------------------- FLAGS -------------------------------------//
-    // Used for 'runtime-states'. True when loading a new state from disk on another
-    // thread.
-    std::atomic_bool _isLoadingStateFromDisk = false;
     // False => states are stored in RAM (using 'in-RAM-states'), True => states are
     // loaded from disk during runtime (using 'runtime-states')
     bool _loadingStatesDynamically  = false;
-    // Used for 'runtime-states': True if new 'runtime-state' must be loaded from disk.
-    // False => the previous frame's state should still be shown
+    // Used for 'runtime-states': True if the state of the active trigger time has not
+    // been loaded from disk yet and the previous frame's state is still shown
     bool _mustLoadNewStateFromDisk  = false;
     // Used for 'in-RAM-states' : True if new 'in-RAM-state'  must be loaded.
     // False => the previous frame's state should still be shown
     bool _needsUpdate = false;
-    // Used for 'runtime-states'. True when finished loading a new state from disk on
-    // another thread.
-    std::atomic_bool _newStateIsReady = false;
     // True when new state is loaded or user change which quantity to color the lines by
     bool _shouldUpdateColorBuffer   = false;
     // True when new state is loaded or user change which quantity used for masking out
@@ -88,13 +106,16 @@ private:
 
     // --------------------------------- NUMERICALS ----------------------------------- //
     // Active index of _states. If(==-1)=>no state available for current time. Always the
-    // same as _activeTriggerTimeIndex if(_loadingStatesDynamically==true), else
-    // always = 0
+    // same as _activeTriggerTimeIndex if(_loadingStatesDynamically==false), else the
+    // slot in the ring of preloaded states that is shown
     int _activeStateIndex = -1;
     // Active index of _startTimes
     int _activeTriggerTimeIndex = -1;
     // Number of states in the sequence
     size_t _nStates = 0;
+    // Used for 'runtime-states'. Number of states that are loaded ahead of the active
+    // state in the direction time is moving
+    int _nPrefetchStates = 3;
     // In setup it is used to scale JSON coordinates. During runtime it is used to scale
     // domain limits.
     float _scalingFactor = 1.f;
@@ -110,12 +131,14 @@ private:
     GLuint _vertexMaskingBuffer = 0;
     // OpenGL Vertex Buffer Object containing the vertex positions
     GLuint _vertexPositionBuffer = 0;
+    // Allocated sizes in bytes of the vertex buffer objects' storage
+    GLsizeiptr _vertexColorBufferSize = 0;
+    GLsizeiptr _vertexMaskingBufferSize = 0;
+    GLsizeiptr _vertexPositionBufferSize = 0;
 
     // ----------------------------------- POINTERS ------------------------------------//
     // The Lua-Modfile-Dictionary used during initialization
     std::unique_ptr<ghoul::Dictionary> _dictionary;
-    // Used for 'runtime-states' when switching out current state to a new state
-    std::unique_ptr<FieldlinesState> _newState;
     std::unique_ptr<ghoul::opengl::ProgramObject> _shaderProgram;
     // Transfer function used to color lines when _pColorMethod is set to BY_QUANTITY
     std::unique_ptr<TransferFunction> _transferFunction;
@@ -132,8 +155,17 @@ private:
     std::vector<std::string> _sourceFiles;
     // Contains the _triggerTimes for all FieldlineStates in the sequence
     std::vector<double> _startTimes;
-    // Stores the FieldlineStates
+    // Stores the FieldlineStates. For 'runtime-states' this is the ring of preloaded
+    // states, which has room for the previous, the active and the prefetched states
     std::vector<FieldlinesState> _states;
+    // Used for 'runtime-states'. Which state each slot of the ring in _states contains
+    std::vector<RingSlot> _stateRing;
+    // Used for 'runtime-states'. True for the states that couldn't be read from disk,
+    // which are skipped instead of being requested again
+    std::vector<bool> _hasFailedToLoad;
+    // Used for 'runtime-states'. States that were loaded since the last update
+    std::mutex _loadedStatesMutex;
+    std::vector<LoadedState> _loadedStates;
 
     // ---------------------------------- Properties ---------------------------------- //
     // Group to hold the color properties
@@ -220,11 +252,16 @@ private:
     bool prepareForOsflsStreaming();
 
     // ------------------------- FUNCTIONS USED DURING RUNTIME ------------------------ //
-    void readNewState(const std::string& filePath);
+    void moveLoadedStatesIntoRing();
+    void requestState(int stateIndex);
     void updateActiveTriggerTimeIndex(double currentTime);
     void updateVertexPositionBuffer();
     void updateVertexColorBuffer();
     void updateVertexMaskingBuffer();
+
+    // Used for 'runtime-states'. Reads the states from disk on the task scheduler.
+    // Declared last so that it is destroyed, and its tasks have finished, first
+    std::unique_ptr<TaskGroup> _loader;
 };
 
 } // namespace openspace
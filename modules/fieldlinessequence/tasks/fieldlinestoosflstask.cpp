@@ -0,0 +1,226 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/fieldlinessequence/tasks/fieldlinestoosflstask.h>
+
+#include <modules/fieldlinessequence/util/fieldlinesstate.h>
+#include <openspace/documentation/verifier.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+
+namespace {
+    constexpr const char* _loggerCat = "FieldlinesToOsflsTask";
+
+    constexpr const char* KeyInputFolder = "InputFolder";
+    constexpr const char* KeyOutputFolder = "OutputFolder";
+    constexpr const char* KeySimulationModel = "SimulationModel";
+    constexpr const char* KeyScaleToMeters = "ScaleToMeters";
+    constexpr const char* KeyQuantizePositions = "QuantizePositions";
+    constexpr const char* KeyQuantizeExtras = "QuantizeExtraQuantities";
+
+    std::string lowercase(std::string s) {
+        std::transform(
+            s.begin(),
+            s.end(),
+            s.begin(),
+            [](char c) { return static_cast<char>(::tolower(c)); }
+        );
+        return s;
+    }
+} // namespace
+
+namespace openspace {
+
+FieldlinesToOsflsTask::FieldlinesToOsflsTask(const ghoul::Dictionary& dictionary) {
+    openspace::documentation::testSpecificationAndThrow(
+        documentation(),
+        dictionary,
+        "FieldlinesToOsflsTask"
+    );
+
+    _inputFolder = absPath(dictionary.value<std::string>(KeyInputFolder));
+    _outputFolder = absPath(dictionary.value<std::string>(KeyOutputFolder));
+    if (!_outputFolder.empty() && _outputFolder.back() != FileSys.PathSeparator) {
+        _outputFolder += FileSys.PathSeparator;
+    }
+
+    if (dictionary.hasKey(KeySimulationModel)) {
+        _model = fls::stringToModel(
+            lowercase(dictionary.value<std::string>(KeySimulationModel))
+        );
+    }
+    if (dictionary.hasKey(KeyScaleToMeters)) {
+        _scaleToMeters = static_cast<float>(dictionary.value<double>(KeyScaleToMeters));
+    }
+    if (dictionary.hasKey(KeyQuantizePositions)) {
+        _quantizePositions = dictionary.value<bool>(KeyQuantizePositions);
+    }
+    if (dictionary.hasKey(KeyQuantizeExtras)) {
+        _quantizeExtras = dictionary.value<bool>(KeyQuantizeExtras);
+    }
+}
+
+std::string FieldlinesToOsflsTask::description() {
+    return fmt::format(
+        "Convert the fieldlines states in {} to .osfls files in {}",
+        _inputFolder, _outputFolder
+    );
+}
+
+void FieldlinesToOsflsTask::perform(const Task::ProgressCallback& progressCallback) {
+    if (!FileSys.directoryExists(_inputFolder)) {
+        LERROR(fmt::format("{} is not a valid directory", _inputFolder));
+        return;
+    }
+    if (!FileSys.directoryExists(_outputFolder)) {
+        FileSys.createDirectory(
+            _outputFolder,
+            ghoul::filesystem::FileSystem::Recursive::Yes
+        );
+    }
+
+    std::vector<std::string> files = ghoul::filesystem::Directory(_inputFolder).readFiles(
+        ghoul::filesystem::Directory::Recursive::No,
+        ghoul::filesystem::Directory::Sort::Yes
+    );
+    files.erase(
+        std::remove_if(
+            files.begin(),
+            files.end(),
+            [](const std::string& path) {
+                const std::string ext = lowercase(
+                    ghoul::filesystem::File(path).fileExtension()
+                );
+                return ext != "osfls" && ext != "json";
+            }
+        ),
+        files.end()
+    );
+    if (files.empty()) {
+        LERROR(fmt::format("{} contains no .osfls or .json files", _inputFolder));
+        return;
+    }
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        const std::string& path = files[i];
+        const ghoul::filesystem::File file(path);
+
+        FieldlinesState state;
+        bool success = false;
+        if (lowercase(file.fileExtension()) == "osfls") {
+            success = state.loadStateFromOsfls(path);
+        }
+        else if (_model == fls::Model::Invalid) {
+            LERROR(fmt::format(
+                "Skipping {}: '{}' must be a valid model to convert JSON files",
+                path, KeySimulationModel
+            ));
+        }
+        else {
+            success = state.loadStateFromJson(path, _model, _scaleToMeters);
+        }
+
+        if (success) {
+            const std::string outputPath = _outputFolder + file.baseName() + ".osfls";
+            const bool didWrite = state.writeStateToOsfls(
+                outputPath,
+                _quantizePositions,
+                _quantizeExtras
+            );
+            if (!didWrite) {
+                LERROR(fmt::format("Failed to write {}", outputPath));
+            }
+        }
+        else {
+            LERROR(fmt::format("Failed to load {}", path));
+        }
+
+        progressCallback(static_cast<float>(i + 1) / static_cast<float>(files.size()));
+    }
+}
+
+documentation::Documentation FieldlinesToOsflsTask::documentation() {
+    using namespace documentation;
+    return {
+        "FieldlinesToOsflsTask",
+        "fieldlinessequence_fieldlines_to_osfls_task",
+        {
+            {
+                "Type",
+                new StringEqualVerifier("FieldlinesToOsflsTask"),
+                Optional::No,
+                "The type of this task"
+            },
+            {
+                KeyInputFolder,
+                new StringAnnotationVerifier("A path to a folder"),
+                Optional::No,
+                "The folder containing the .osfls and .json files that are converted"
+            },
+            {
+                KeyOutputFolder,
+                new StringAnnotationVerifier("A path to a folder"),
+                Optional::No,
+                "The folder that the converted .osfls files are written to. Each file "
+                "keeps the name of the file it was converted from"
+            },
+            {
+                KeySimulationModel,
+                new StringAnnotationVerifier("'batsrus', 'enlil' or 'pfss'"),
+                Optional::Yes,
+                "The model that the .json files were created from. Required if the "
+                "input folder contains .json files"
+            },
+            {
+                KeyScaleToMeters,
+                new DoubleVerifier,
+                Optional::Yes,
+                "The factor that converts the positions in the .json files into meters. "
+                "Defaults to 1"
+            },
+            {
+                KeyQuantizePositions,
+                new BoolVerifier,
+                Optional::Yes,
+                "If this is true, the vertex positions are stored as 16-bit values "
+                "within the bounding box of each state, halving their size. Defaults "
+                "to false"
+            },
+            {
+                KeyQuantizeExtras,
+                new BoolVerifier,
+                Optional::Yes,
+                "If this is true, the extra quantities are stored as 16-bit values "
+                "within the range of each quantity, halving their size. Defaults to "
+                "false"
+            }
+        }
+    };
+}
+
+} // namespace openspace
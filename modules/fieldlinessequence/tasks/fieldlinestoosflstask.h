@@ -22,53 +22,38 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#ifndef __OPENSPACE_CORE___THREAD_POOL___H__
-#define __OPENSPACE_CORE___THREAD_POOL___H__
+#ifndef __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESTOOSFLSTASK___H__
+#define __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESTOOSFLSTASK___H__
 
-#include <condition_variable>
-#include <functional>
-#include <mutex>
-#include <queue>
-#include <thread>
-#include <vector>
+#include <openspace/util/task.h>
 
-// Implementation based on http://progsch.net/wordpress/?p=81
+#include <modules/fieldlinessequence/util/commons.h>
+#include <string>
 
 namespace openspace {
 
-class ThreadPool;
-
-class Worker {
+/**
+ * Converts every .osfls and .json fieldlines state in a folder into .osfls files of the
+ * current version, optionally quantizing the positions and extra quantities.
+ */
+class FieldlinesToOsflsTask : public Task {
 public:
-    Worker(ThreadPool& p);
-    void operator()();
+    FieldlinesToOsflsTask(const ghoul::Dictionary& dictionary);
 
-private:
-    ThreadPool& pool;
-};
-
-class ThreadPool {
-public:
-    ThreadPool(size_t numThreads);
-    ThreadPool(const ThreadPool& toCopy);
-    ~ThreadPool();
+    std::string description() override;
+    void perform(const Task::ProgressCallback& progressCallback) override;
 
-    void enqueue(std::function<void()> f);
-    void clearTasks();
+    static documentation::Documentation documentation();
 
 private:
-    friend class Worker;
-
-    std::vector<std::thread> workers;
-
-    std::deque<std::function<void()>> tasks;
-
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-
-    bool stop;
+    std::string _inputFolder;
+    std::string _outputFolder;
+    fls::Model _model = fls::Model::Invalid;
+    float _scaleToMeters = 1.f;
+    bool _quantizePositions = false;
+    bool _quantizeExtras = false;
 };
 
 } // namespace openspace
 
-#endif // __OPENSPACE_CORE___THREAD_POOL___H__
+#endif // __OPENSPACE_MODULE_FIELDLINESSEQUENCE___FIELDLINESTOOSFLSTASK___H__
@@ -25,16 +25,72 @@
 #include <modules/fieldlinessequence/util/fieldlinesstate.h>
 
 #include <openspace/json.h>
+#include <openspace/util/memorymappedfile.h>
 #include <openspace/util/time.h>
 #include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 
 namespace {
     constexpr const char* _loggerCat = "FieldlinesState";
-    constexpr const int CurrentVersion = 0;
+    constexpr const int CurrentVersion = 1;
     using json = nlohmann::json;
+
+    // All sections of a version 1 file start at a multiple of this many bytes, which
+    // allows them to be used directly from a memory mapping
+    constexpr const uint64_t SectionAlignment = 64;
+    constexpr const float QuantizationSteps = std::numeric_limits<uint16_t>::max();
+
+    // Bits of OsflsHeader::flags
+    constexpr const uint32_t IsMorphable = 1 << 0;
+    constexpr const uint32_t QuantizedPositions = 1 << 1;
+    constexpr const uint32_t QuantizedExtras = 1 << 2;
+
+    // Header of version 1 files. The offsets are in bytes from the start of the file
+    struct OsflsHeader {
+        int32_t version;
+        uint32_t flags;
+        double triggerTime;
+        int32_t model;
+        uint32_t nExtras;
+        uint64_t nLines;
+        uint64_t nPoints;
+        uint64_t lineStartOffset;
+        uint64_t lineCountOffset;
+        uint64_t positionsOffset;
+        // The extra quantities follow each other, extrasStride bytes apart
+        uint64_t extrasOffset;
+        uint64_t extrasStride;
+        // For quantized extra quantities, the minimum and maximum value of each quantity
+        uint64_t extraRangesOffset;
+        uint64_t namesOffset;
+        uint64_t namesSize;
+        // For quantized positions, the minimum and extent of the bounding box
+        float positionMin[3];
+        float positionExtent[3];
+    };
+    static_assert(sizeof(OsflsHeader) == 128, "Unexpected padding in OsflsHeader");
+
+    uint64_t alignedOffset(uint64_t offset) {
+        return (offset + SectionAlignment - 1) / SectionAlignment * SectionAlignment;
+    }
+
+    uint16_t quantize(float value, float min, float extent) {
+        if (!(extent > 0.f) || !std::isfinite(value)) {
+            return 0;
+        }
+        const float normalized = std::clamp((value - min) / extent, 0.f, 1.f);
+        return static_cast<uint16_t>(std::lround(normalized * QuantizationSteps));
+    }
+
+    float dequantize(uint16_t value, float min, float extent) {
+        return min + value * (extent / QuantizationSteps);
+    }
 } // namespace
 
 namespace openspace {
@@ -73,13 +129,17 @@ bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
 
     switch (binFileVersion) {
         case 0:
-            // No need to put everything in this scope now, as only version 0 exists!
-            break;
+            return loadStateFromOsflsVersion0(ifs);
+        case 1:
+            ifs.close();
+            return loadStateFromOsflsVersion1(pathToOsflsFile);
         default:
             LERROR("VERSION OF BINARY FILE WAS NOT RECOGNIZED!");
             return false;
     }
+}
 
+bool FieldlinesState::loadStateFromOsflsVersion0(std::istream& ifs) {
     // Define tmp variables to store meta data in
     size_t nLines;
     size_t nPoints;
@@ -133,6 +193,109 @@ bool FieldlinesState::loadStateFromOsfls(const std::string& pathToOsflsFile) {
     return true;
 }
 
+bool FieldlinesState::loadStateFromOsflsVersion1(const std::string& pathToOsflsFile) {
+    const MemoryMappedFile file(pathToOsflsFile);
+    if (!file.isValid() || file.size() < sizeof(OsflsHeader)) {
+        LERROR(fmt::format("Couldn't map file: {}", pathToOsflsFile));
+        return false;
+    }
+    file.prefetch(0, file.size());
+
+    OsflsHeader header;
+    std::memcpy(&header, file.data(), sizeof(OsflsHeader));
+
+    const bool quantizedPositions = header.flags & QuantizedPositions;
+    const bool quantizedExtras = header.flags & QuantizedExtras;
+    const uint64_t positionSize = quantizedPositions ? sizeof(uint16_t) : sizeof(float);
+    const uint64_t extraSize = quantizedExtras ? sizeof(uint16_t) : sizeof(float);
+
+    // Make sure that all sections are within the file before touching them. The counts
+    // are checked first so that the section sizes below can't overflow
+    auto isInFile = [size = file.size()](uint64_t offset, uint64_t nBytes) {
+        return offset <= size && nBytes <= size - offset;
+    };
+    const uint64_t nLines = header.nLines;
+    const uint64_t nPoints = header.nPoints;
+    const uint64_t nExtras = header.nExtras;
+    const bool isValid = nLines <= file.size() && nPoints <= file.size() &&
+        isInFile(header.lineStartOffset, nLines * sizeof(GLint)) &&
+        isInFile(header.lineCountOffset, nLines * sizeof(GLsizei)) &&
+        isInFile(header.positionsOffset, 3 * nPoints * positionSize) &&
+        (nExtras == 0 || (header.extrasStride >= nPoints * extraSize &&
+            header.extrasStride <= file.size() &&
+            isInFile(
+                header.extrasOffset,
+                (nExtras - 1) * header.extrasStride + nPoints * extraSize
+            ))) &&
+        (!quantizedExtras ||
+            isInFile(header.extraRangesOffset, 2 * nExtras * sizeof(float))) &&
+        isInFile(header.namesOffset, header.namesSize);
+    if (!isValid) {
+        LERROR(fmt::format("The file {} is corrupt", pathToOsflsFile));
+        return false;
+    }
+
+    _triggerTime = header.triggerTime;
+    _model = static_cast<fls::Model>(header.model);
+    _isMorphable = header.flags & IsMorphable;
+
+    const GLint* lineStart = file.at<GLint>(header.lineStartOffset);
+    _lineStart.assign(lineStart, lineStart + nLines);
+    const GLsizei* lineCount = file.at<GLsizei>(header.lineCountOffset);
+    _lineCount.assign(lineCount, lineCount + nLines);
+
+    _vertexPositions.resize(nPoints);
+    if (quantizedPositions) {
+        const uint16_t* q = file.at<uint16_t>(header.positionsOffset);
+        for (size_t i = 0; i < nPoints; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                _vertexPositions[i][c] = dequantize(
+                    q[3 * i + c],
+                    header.positionMin[c],
+                    header.positionExtent[c]
+                );
+            }
+        }
+    }
+    else {
+        std::memcpy(
+            _vertexPositions.data(),
+            file.data() + header.positionsOffset,
+            3 * sizeof(float) * nPoints
+        );
+    }
+
+    _extraQuantities.resize(nExtras);
+    for (size_t i = 0; i < nExtras; ++i) {
+        std::vector<float>& values = _extraQuantities[i];
+        values.resize(nPoints);
+        const uint64_t offset = header.extrasOffset + i * header.extrasStride;
+        if (quantizedExtras) {
+            const float* range = file.at<float>(header.extraRangesOffset) + 2 * i;
+            const uint16_t* q = file.at<uint16_t>(offset);
+            for (size_t j = 0; j < nPoints; ++j) {
+                values[j] = dequantize(q[j], range[0], range[1] - range[0]);
+            }
+        }
+        else {
+            std::memcpy(values.data(), file.data() + offset, sizeof(float) * nPoints);
+        }
+    }
+
+    // The names are stored as consecutive null-terminated strings
+    _extraQuantityNames.clear();
+    const char* names = file.at<char>(header.namesOffset);
+    const char* namesEnd = names + header.namesSize;
+    while (names < namesEnd && _extraQuantityNames.size() < nExtras) {
+        const char* end = std::find(names, namesEnd, '\0');
+        _extraQuantityNames.emplace_back(names, end);
+        names = end + 1;
+    }
+    _extraQuantityNames.resize(nExtras);
+
+    return true;
+}
+
 bool FieldlinesState::loadStateFromJson(const std::string& pathToJsonFile,
                                         fls::Model Model, float coordToMeters)
 {
@@ -218,32 +381,13 @@ bool FieldlinesState::loadStateFromJson(const std::string& pathToJsonFile,
 }
 
 /**
- * \param absPath must be the path to the file (incl. filename but excl. extension!)
- * Directory must exist! File is created (or overwritten if already existing).
- * File is structured like this: (for version 0)
- *  0. int                    - version number of binary state file! (in case something
- *                              needs to be altered in the future, then increase
- *                              CurrentVersion)
- *  1. double                 - _triggerTime
- *  2. int                    - _model
- *  3. bool                   - _isMorphable
- *  4. size_t                 - Number of lines in the state  == _lineStart.size()
- *                                                            == _lineCount.size()
- *  5. size_t                 - Total number of vertex points == _vertexPositions.size()
- *                                                           == _extraQuantities[i].size()
- *  6. size_t                 - Number of extra quantites     == _extraQuantities.size()
- *                                                           == _extraQuantityNames.size()
- *  7. site_t                 - Number of total bytes that ALL _extraQuantityNames
- *                              consists of (Each such name is stored as a c_str which
- *                              means it ends with the null char '\0' )
- *  7. std::vector<GLint>     - _lineStart
- *  8. std::vector<GLsizei>   - _lineCount
- *  9. std::vector<glm::vec3> - _vertexPositions
- * 10. std::vector<float>     - _extraQuantities
- * 11. array of c_str         - Strings naming the extra quantities (elements of
- *                              _extraQuantityNames). Each string ends with null char '\0'
+ * \param absPath must be the path to the folder the file is saved in, including the
+ * trailing separator. Directory must exist! File is created (or overwritten if already
+ * existing) and is named after the trigger time.
  */
-void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
+void FieldlinesState::saveStateToOsfls(const std::string& absPath, bool quantizePositions,
+                                       bool quantizeExtras) const
+{
     // ------------------------------- Create the file ------------------------------- //
     std::string pathSafeTimeString = Time(_triggerTime).ISO8601();
     pathSafeTimeString.replace(13, 1, "-");
@@ -251,12 +395,36 @@ void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
     pathSafeTimeString.replace(19, 1, "-");
     const std::string& fileName = pathSafeTimeString + ".osfls";
 
-    std::ofstream ofs(absPath + fileName, std::ofstream::binary | std::ofstream::trunc);
+    writeStateToOsfls(absPath + fileName, quantizePositions, quantizeExtras);
+}
+
+/**
+ * File is structured like this: (for version 1)
+ *  0. OsflsHeader            - 128 bytes containing the version number (1), flags,
+ *                              _triggerTime, _model, the number of lines, points and
+ *                              extra quantities and the byte offset of every section.
+ *                              For quantized positions also the bounding box
+ * All following sections start at a multiple of SectionAlignment bytes:
+ *  1. GLint[nLines]          - _lineStart
+ *  2. GLsizei[nLines]        - _lineCount
+ *  3. float[3 * nPoints]     - _vertexPositions, or uint16_t if quantized
+ *  4. float[nPoints]         - one section for each of the _extraQuantities, or uint16_t
+ *                              if quantized
+ *  5. float[2 * nExtras]     - minimum and maximum of each extra quantity, only present
+ *                              if the extra quantities are quantized
+ *  6. array of c_str         - Strings naming the extra quantities (elements of
+ *                              _extraQuantityNames). Each string ends with null char '\0'
+ *
+ * Version 0 files, which stored the same data unaligned and without quantization after a
+ * smaller header, can still be read.
+ */
+bool FieldlinesState::writeStateToOsfls(const std::string& filePath,
+                                        bool quantizePositions, bool quantizeExtras) const
+{
+    std::ofstream ofs(filePath, std::ofstream::binary | std::ofstream::trunc);
     if (!ofs.is_open()) {
-        LERROR(fmt::format(
-            "Failed to save state to binary file: {}{}", absPath, fileName
-        ));
-        return;
+        LERROR(fmt::format("Failed to save state to binary file: {}", filePath));
+        return false;
     }
 
     // --------- Add each string of _extraQuantityNames into one long string --------- //
@@ -265,37 +433,137 @@ void FieldlinesState::saveStateToOsfls(const std::string& absPath) {
         allExtraQuantityNamesInOne += str + '\0'; // Add null char '\0' for easier reading
     }
 
-    const size_t nLines = _lineStart.size();
-    const size_t nPoints = _vertexPositions.size();
-    const size_t nExtras = _extraQuantities.size();
-    const size_t nStringBytes = allExtraQuantityNamesInOne.size();
+    const uint64_t nLines = _lineStart.size();
+    const uint64_t nPoints = _vertexPositions.size();
+    const uint64_t nExtras = _extraQuantities.size();
+    const uint64_t positionSize = quantizePositions ? sizeof(uint16_t) : sizeof(float);
+    const uint64_t extraSize = quantizeExtras ? sizeof(uint16_t) : sizeof(float);
+
+    //------------------------------ LAYOUT THE SECTIONS -------------------------------
+    OsflsHeader header = {};
+    header.version = CurrentVersion;
+    header.flags = (_isMorphable ? IsMorphable : 0) |
+                   (quantizePositions ? QuantizedPositions : 0) |
+                   (quantizeExtras ? QuantizedExtras : 0);
+    header.triggerTime = _triggerTime;
+    header.model = static_cast<int32_t>(_model);
+    header.nExtras = static_cast<uint32_t>(nExtras);
+    header.nLines = nLines;
+    header.nPoints = nPoints;
+    header.lineStartOffset = alignedOffset(sizeof(OsflsHeader));
+    header.lineCountOffset = alignedOffset(
+        header.lineStartOffset + nLines * sizeof(GLint)
+    );
+    header.positionsOffset = alignedOffset(
+        header.lineCountOffset + nLines * sizeof(GLsizei)
+    );
+    header.extrasOffset = alignedOffset(
+        header.positionsOffset + 3 * nPoints * positionSize
+    );
+    header.extrasStride = alignedOffset(nPoints * extraSize);
+    header.extraRangesOffset = header.extrasOffset + nExtras * header.extrasStride;
+    header.namesOffset = alignedOffset(
+        header.extraRangesOffset + (quantizeExtras ? 2 * nExtras * sizeof(float) : 0)
+    );
+    header.namesSize = allExtraQuantityNamesInOne.size();
+
+    //------------------------------- QUANTIZE THE DATA --------------------------------
+    std::vector<uint16_t> quantizedPositions;
+    if (quantizePositions && nPoints > 0) {
+        glm::vec3 min = _vertexPositions[0];
+        glm::vec3 max = _vertexPositions[0];
+        for (const glm::vec3& p : _vertexPositions) {
+            min = glm::min(min, p);
+            max = glm::max(max, p);
+        }
+        const glm::vec3 extent = max - min;
+
+        quantizedPositions.reserve(3 * nPoints);
+        for (const glm::vec3& p : _vertexPositions) {
+            for (int c = 0; c < 3; ++c) {
+                quantizedPositions.push_back(quantize(p[c], min[c], extent[c]));
+            }
+        }
+        for (int c = 0; c < 3; ++c) {
+            header.positionMin[c] = min[c];
+            header.positionExtent[c] = extent[c];
+        }
+    }
+
+    std::vector<float> extraRanges;
+    std::vector<std::vector<uint16_t>> quantizedExtras;
+    if (quantizeExtras) {
+        for (const std::vector<float>& values : _extraQuantities) {
+            float min = std::numeric_limits<float>::max();
+            float max = std::numeric_limits<float>::lowest();
+            for (float v : values) {
+                if (std::isfinite(v)) {
+                    min = std::min(min, v);
+                    max = std::max(max, v);
+                }
+            }
+            if (min > max) {
+                // No finite values at all
+                min = 0.f;
+                max = 0.f;
+            }
+            extraRanges.push_back(min);
+            extraRanges.push_back(max);
+
+            std::vector<uint16_t> q;
+            q.reserve(values.size());
+            for (float v : values) {
+                q.push_back(quantize(v, min, max - min));
+            }
+            quantizedExtras.push_back(std::move(q));
+        }
+    }
 
     //----------------------------- WRITE EVERYTHING TO FILE -----------------------------
-    // VERSION OF BINARY FIELDLINES STATE FILE - IN CASE STRUCTURE CHANGES IN THE FUTURE
-    ofs.write(reinterpret_cast<const char*>(&CurrentVersion), sizeof(int));
-
-    //-------------------- WRITE META DATA FOR STATE --------------------------------
-    ofs.write(reinterpret_cast<const char*>(&_triggerTime), sizeof(_triggerTime));
-    ofs.write(reinterpret_cast<const char*>(&_model), sizeof(int32_t));
-    ofs.write(reinterpret_cast<const char*>(&_isMorphable), sizeof(bool));
-
-    ofs.write(reinterpret_cast<const char*>(&nLines), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nPoints), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nExtras), sizeof(uint64_t));
-    ofs.write(reinterpret_cast<const char*>(&nStringBytes), sizeof(uint64_t));
-
-    //---------------------- WRITE ALL ARRAYS OF DATA --------------------------------
-    ofs.write(reinterpret_cast<char*>(_lineStart.data()), sizeof(int32_t) * nLines);
-    ofs.write(reinterpret_cast<char*>(_lineCount.data()), sizeof(uint32_t) * nLines);
-    ofs.write(
-        reinterpret_cast<char*>(_vertexPositions.data()),
-        3 * sizeof(float) * nPoints
-    );
-    // Write the data for each vector in _extraQuantities
-    for (std::vector<float>& vec : _extraQuantities) {
-        ofs.write(reinterpret_cast<char*>(vec.data()), sizeof(float) * nPoints);
+    // Pads the file with zeros up to the offset and writes the section
+    auto writeSection = [&ofs](uint64_t offset, const void* data, uint64_t nBytes) {
+        constexpr const char Zeros[SectionAlignment] = {};
+        const uint64_t position = static_cast<uint64_t>(ofs.tellp());
+        ofs.write(Zeros, offset - position);
+        ofs.write(reinterpret_cast<const char*>(data), nBytes);
+    };
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(OsflsHeader));
+    writeSection(header.lineStartOffset, _lineStart.data(), nLines * sizeof(GLint));
+    writeSection(header.lineCountOffset, _lineCount.data(), nLines * sizeof(GLsizei));
+    if (quantizePositions) {
+        writeSection(
+            header.positionsOffset,
+            quantizedPositions.data(),
+            3 * nPoints * sizeof(uint16_t)
+        );
     }
-    ofs.write(allExtraQuantityNamesInOne.c_str(), nStringBytes);
+    else {
+        writeSection(
+            header.positionsOffset,
+            _vertexPositions.data(),
+            3 * nPoints * sizeof(float)
+        );
+    }
+    for (uint64_t i = 0; i < nExtras; ++i) {
+        const uint64_t offset = header.extrasOffset + i * header.extrasStride;
+        if (quantizeExtras) {
+            writeSection(offset, quantizedExtras[i].data(), nPoints * sizeof(uint16_t));
+        }
+        else {
+            writeSection(offset, _extraQuantities[i].data(), nPoints * sizeof(float));
+        }
+    }
+    if (quantizeExtras) {
+        writeSection(
+            header.extraRangesOffset,
+            extraRanges.data(),
+            extraRanges.size() * sizeof(float)
+        );
+    }
+    writeSection(header.namesOffset, allExtraQuantityNamesInOne.data(), header.namesSize);
+
+    return ofs.good();
 }
 
 // TODO: This should probably be rewritten, but this is the way the files were structured
@@ -28,6 +28,7 @@
 #include <modules/fieldlinessequence/util/commons.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
@@ -39,7 +40,24 @@ public:
     void scalePositions(float scale);
 
     bool loadStateFromOsfls(const std::string& pathToOsflsFile);
-    void saveStateToOsfls(const std::string& pathToOsflsFile);
+
+    /**
+     * Saves the state into the folder \p absPath, using the trigger time as the file
+     * name. See writeStateToOsfls for the parameters.
+     */
+    void saveStateToOsfls(const std::string& absPath, bool quantizePositions = false,
+        bool quantizeExtras = false) const;
+
+    /**
+     * Writes the state to the .osfls file \p filePath in the current version of the
+     * format. Positions and extra quantities are stored as 32-bit floats unless
+     * \p quantizePositions or \p quantizeExtras is <code>true</code>, in which case they
+     * are quantized to 16 bits within their range of values.
+     *
+     * \returns <code>true</code> if the file was written successfully
+     */
+    bool writeStateToOsfls(const std::string& filePath, bool quantizePositions = false,
+        bool quantizeExtras = false) const;
 
     bool loadStateFromJson(const std::string& pathToJsonFile, fls::Model model,
         float coordToMeters);
@@ -66,6 +84,9 @@ public:
     void appendToExtra(size_t idx, float val);
 
 private:
+    bool loadStateFromOsflsVersion0(std::istream& file);
+    bool loadStateFromOsflsVersion1(const std::string& pathToOsflsFile);
+
     bool _isMorphable = false;
     double _triggerTime = -1.0;
     fls::Model _model;
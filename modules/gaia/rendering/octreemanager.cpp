@@ -25,36 +25,104 @@
 #include <modules/gaia/rendering/octreemanager.h>
 
 #include <modules/gaia/rendering/octreeculler.h>
+#include <openspace/engine/globals.h>
 #include <openspace/util/distanceconstants.h>
+#include <openspace/util/memorymappedfile.h>
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <thread>
 
 namespace {
     constexpr const char* _loggerCat = "OctreeManager";
+
+    // Node files written by writeToMultipleFiles start with this header. It is followed
+    // by the positions, colors and velocities of all stars in the node, each in its own
+    // section. Every section starts at an aligned offset so that the values can be used
+    // in place when the file is memory mapped.
+    constexpr const uint32_t NodeFileMagic = 0x444F4E47; // "GNOD"
+    constexpr const uint32_t NodeFileVersion = 2;
+    constexpr const uint64_t NodeFileAlignment = 16;
+
+    struct NodeFileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t nStars;
+        uint32_t valuesPerStar;
+        uint64_t positionOffset;
+        uint64_t colorOffset;
+        uint64_t velocityOffset;
+    };
+    static_assert(sizeof(NodeFileHeader) == 40, "Unexpected node file header size");
+
+    // Max number of prefetches that are queued or running on the task scheduler at once.
+    constexpr const int MaxPrefetchesInFlight = 8;
+    // Points along the extrapolated camera path, in number of frames ahead of the camera,
+    // for which the surrounding nodes will be prefetched.
+    constexpr const float PrefetchFramesAhead[] = { 10.f, 20.f, 40.f, 80.f };
+    // Fixed cost of opening and reading a node file, expressed in bytes.
+    constexpr const double NodeLoadOverheadBytes = 64.0 * 1024.0;
+
+    // Cost of reloading a node per byte of RAM it occupies. Small nodes are relatively
+    // more expensive to reload and are kept longer.
+    double reloadCostPerByte(size_t nBytes) {
+        return (NodeLoadOverheadBytes + nBytes) / std::max<double>(nBytes, 1.0);
+    }
+
+    uint64_t alignNodeFileOffset(uint64_t offset) {
+        return (offset + NodeFileAlignment - 1) / NodeFileAlignment * NodeFileAlignment;
+    }
+
+    void writeNodeFileSection(std::ofstream& outFileStream, uint64_t& currentOffset,
+                              uint64_t sectionOffset, const std::vector<float>& values)
+    {
+        constexpr const char Padding[NodeFileAlignment] = {};
+        outFileStream.write(Padding, sectionOffset - currentOffset);
+        outFileStream.write(
+            reinterpret_cast<const char*>(values.data()),
+            values.size() * sizeof(float)
+        );
+        currentOffset = sectionOffset + values.size() * sizeof(float);
+    }
 } // namespace
 
 namespace openspace {
 
 void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStarsPerNode) {
-    if (_root) {
+    if (!_branches[0].nodes.empty()) {
         LDEBUG("Clear existing Octree");
         clearAllData();
     }
 
+    // Wait for fetches from a previous Octree, queued fetches are dropped.
+    _ioTasks = nullptr;
+    _nPrefetchesInFlight = 0;
+    _isEvicting = false;
+    _prefetchQueue = std::priority_queue<PrefetchRequest>();
+    _predictedParentsOfCamera.clear();
+    _hasLastCameraPos = false;
+    {
+        std::lock_guard lock(_streamedNodesMutex);
+        _streamedNodes.clear();
+    }
+    _evictionAge = 0.0;
+
     LDEBUG("Initializing new Octree");
-    _root = std::make_shared<OctreeNode>();
-    _root->octreePositionIndex = 8;
+    _rootNode = OctreeNode();
+    _rootNode.isLeaf = false;
+    _rootPayload.octreePositionIndex = 8;
 
     // Initialize the culler. The NDC.z of the comparing corners are always -1 or 1.
     globebrowsing::AABB3 box;
     box.min = glm::vec3(-1.f, -1.f, 0.f);
     box.max = glm::vec3(1.f, 1.f, 1e2);
     _culler = std::make_unique<OctreeCuller>(box);
-    _removedKeysInPrevCall = std::set<int>();
-    _leastRecentlyFetchedNodes = std::queue<unsigned long long>();
+    _removedKeysInPrevCall.clear();
+    _loadedNodesChanged = true;
 
     // Reset default values when rebuilding the Octree during runtime.
     _numInnerNodes = 0;
@@ -74,28 +142,59 @@ void OctreeManager::initOctree(long long cpuRamBudget, int maxDist, int maxStars
 
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        _root->Children[i] = std::make_shared<OctreeNode>();
-        _root->Children[i]->posData = std::vector<float>();
-        _root->Children[i]->colData = std::vector<float>();
-        _root->Children[i]->velData = std::vector<float>();
-        _root->Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        _root->Children[i]->isLeaf = true;
-        _root->Children[i]->isLoaded = false;
-        _root->Children[i]->hasLoadedDescendant = false;
-        _root->Children[i]->bufferIndex = DEFAULT_INDEX;
-        _root->Children[i]->octreePositionIndex = 80 + i;
-        _root->Children[i]->numStars = 0;
-        _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-        _root->Children[i]->originX = (i % 2 == 0) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originY = (i % 4 < 2) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
-        _root->Children[i]->originZ = (i < 4) ?
-            _root->Children[i]->halfDimension :
-            -_root->Children[i]->halfDimension;
+        Branch& branch = _branches[i];
+        branch.nodes.clear();
+        branch.payloads.clear();
+
+        OctreeNode& node = branch.nodes.emplace_back();
+        node.bufferIndex = DEFAULT_INDEX;
+        node.halfDimension = MAX_DIST / 2.f;
+        node.originX = (i % 2 == 0) ? node.halfDimension : -node.halfDimension;
+        node.originY = (i % 4 < 2) ? node.halfDimension : -node.halfDimension;
+        node.originZ = (i < 4) ? node.halfDimension : -node.halfDimension;
+
+        NodePayload& payload = branch.payloads.emplace_back();
+        payload.octreePositionIndex = 80 + i;
+    }
+}
+
+OctreeManager::OctreeNode& OctreeManager::octreeNode(NodeIndex nodeIndex) {
+    if (nodeIndex == RootIndex) {
+        return _rootNode;
+    }
+    return _branches[nodeIndex >> BranchShift].nodes[nodeIndex & LocalIndexMask];
+}
+
+const OctreeManager::OctreeNode& OctreeManager::octreeNode(NodeIndex nodeIndex) const {
+    if (nodeIndex == RootIndex) {
+        return _rootNode;
     }
+    return _branches[nodeIndex >> BranchShift].nodes[nodeIndex & LocalIndexMask];
+}
+
+OctreeManager::NodePayload& OctreeManager::nodePayload(NodeIndex nodeIndex) {
+    if (nodeIndex == RootIndex) {
+        return _rootPayload;
+    }
+    return _branches[nodeIndex >> BranchShift].payloads[nodeIndex & LocalIndexMask];
+}
+
+const OctreeManager::NodePayload& OctreeManager::nodePayload(NodeIndex nodeIndex) const {
+    if (nodeIndex == RootIndex) {
+        return _rootPayload;
+    }
+    return _branches[nodeIndex >> BranchShift].payloads[nodeIndex & LocalIndexMask];
+}
+
+OctreeManager::NodeIndex OctreeManager::childIndex(NodeIndex nodeIndex,
+                                                   size_t child) const
+{
+    if (nodeIndex == RootIndex) {
+        return static_cast<NodeIndex>(child) << BranchShift;
+    }
+    const NodeIndex branchBits = nodeIndex & ~LocalIndexMask;
+    const NodeIndex firstChild = octreeNode(nodeIndex).firstChild;
+    return branchBits | (firstChild + static_cast<NodeIndex>(child));
 }
 
 void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
@@ -103,7 +202,7 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
 {
     // Clear stack if we've used it before.
     _biggestChunkIndexInUse = 0;
-    _freeSpotsInBuffer = std::stack<int>();
+    _freeSpotsInBuffer = std::stack<int, std::vector<int>>();
     _rebuildBuffer = true;
     _useVBO = useVBO;
     _datasetFitInMemory = datasetFitInMemory;
@@ -113,22 +212,34 @@ void OctreeManager::initBufferIndexStack(long long maxNodes, bool useVBO,
         _freeSpotsInBuffer.push(static_cast<int>(idx));
     }
     _maxStackSize = _freeSpotsInBuffer.size();
+
+    // Allocate the upload list bookkeeping up front so traversals don't have to.
+    _uploadCommands.clear();
+    _uploadCommandSlots.assign(_maxStackSize, -1);
     LINFO("StackSize: " + std::to_string(maxNodes));
 }
 
 void OctreeManager::insert(const std::vector<float>& starValues) {
+    insert(starValues.data());
+}
+
+void OctreeManager::insert(const float* starValues) {
     size_t index = getChildIndex(starValues[0], starValues[1], starValues[2]);
 
-    insertInNode(*_root->Children[index], starValues);
+    insertInNode(childIndex(RootIndex, index), starValues);
+}
+
+size_t OctreeManager::branchIndex(float posX, float posY, float posZ) const {
+    return getChildIndex(posX, posY, posZ);
 }
 
 void OctreeManager::sliceLodData(size_t branchIndex) {
     if (branchIndex != 8) {
-        sliceNodeLodCache(*_root->Children[branchIndex]);
+        sliceNodeLodCache(childIndex(RootIndex, branchIndex));
     }
     else {
-        for (int i = 0; i < 7; ++i) {
-            sliceNodeLodCache(*_root->Children[i]);
+        for (size_t i = 0; i < 8; ++i) {
+            sliceNodeLodCache(childIndex(RootIndex, i));
         }
     }
 }
@@ -136,20 +247,23 @@ void OctreeManager::sliceLodData(size_t branchIndex) {
 void OctreeManager::printStarsPerNode() const {
     auto accumulatedString = std::string();
 
-    for (int i = 0; i < 8; ++i) {
+    for (size_t i = 0; i < 8; ++i) {
         std::string prefix = "{" + std::to_string(i);
-        accumulatedString += printStarsPerNode(*_root->Children[i], prefix);
+        accumulatedString += printStarsPerNode(childIndex(RootIndex, i), prefix);
     }
     LINFO(fmt::format("Number of stars per node: \n{}", accumulatedString));
-    LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes)));
-    LINFO(fmt::format("Number of inner nodes: {}", std::to_string(_numInnerNodes)));
-    LINFO(fmt::format("Depth of tree: {}", std::to_string(_totalDepth)));
+    LINFO(fmt::format("Number of leaf nodes: {}", std::to_string(_numLeafNodes.load())));
+    LINFO(fmt::format("Number of inner nodes: {}", std::to_string(_numInnerNodes.load())));
+    LINFO(fmt::format("Depth of tree: {}", std::to_string(_totalDepth.load())));
 }
 
 void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
                                           size_t chunkSizeInBytes,
                                           const glm::ivec2& additionalNodes)
 {
+    if (!_ioTasks) {
+        _ioTasks = std::make_unique<TaskGroup>(global::taskScheduler);
+    }
 
     // If entire dataset fits in RAM then load the entire dataset asynchronously now.
     // Nodes will be rendered when they've been made available.
@@ -157,68 +271,114 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         // Only traverse Octree once!
         if (_parentNodeOfCamera == 8) {
             // Fetch first layer of children
-            fetchChildrenNodes(*_root, 0);
+            fetchChildrenNodes(RootIndex, 0);
 
-            for (int i = 0; i < 8; ++i) {
+            for (size_t i = 0; i < 8; ++i) {
                 // Check so branch doesn't have a single layer.
-                if (_root->Children[i]->isLeaf) {
+                const NodeIndex branchIndex = childIndex(RootIndex, i);
+                if (octreeNode(branchIndex).isLeaf) {
                     continue;
                 }
 
-                // Use multithreading to load files and detach thread from main execution
-                // so it can execute independently. Thread will be destroyed when
-                // finished!
-                std::thread([this, n = _root->Children[i]]() {
-                    fetchChildrenNodes(*n, -1);
-                }).detach();
+                // Load the files of every branch on the task scheduler.
+                _ioTasks->run([this, branchIndex]() {
+                    fetchChildrenNodes(branchIndex, -1);
+                });
             }
             _parentNodeOfCamera = 0;
         }
         return;
     }
 
-    // Get leaf node in which the camera resides.
+    // Get parent of the leaf node in which the camera resides.
     glm::vec3 fCameraPos = static_cast<glm::vec3>(
         cameraPos / (1000.0 * distanceconstants::Parsec)
     );
-    size_t idx = getChildIndex(fCameraPos.x, fCameraPos.y, fCameraPos.z);
-    std::shared_ptr<OctreeNode> node = _root->Children[idx];
-
-    while (!node->isLeaf) {
-        idx = getChildIndex(
-            fCameraPos.x,
-            fCameraPos.y,
-            fCameraPos.z,
-            node->originX,
-            node->originY,
-            node->originZ
-        );
-        node = node->Children[idx];
-    }
-    unsigned long long leafId = node->octreePositionIndex;
-    unsigned long long firstParentId = leafId / 10;
-
-    // Return early if camera resides in the same first parent as before!
-    // Otherwise camera has moved and may need to load more nodes!
-    if (_parentNodeOfCamera == firstParentId) {
-        return;
-    }
-    _parentNodeOfCamera = firstParentId;
+    const NodeIndex parentOfCamera = findParentOfLeaf(fCameraPos, false);
+    unsigned long long firstParentId = nodePayload(parentOfCamera).octreePositionIndex;
 
-    // Each parent level may be root, make sure to propagate it in that case!
-    unsigned long long secondParentId = (firstParentId == 8) ? 8 : leafId / 100;
-    unsigned long long thirdParentId = (secondParentId == 8) ? 8 : leafId / 1000;
-    unsigned long long fourthParentId = (thirdParentId == 8) ? 8 : leafId / 10000;
-    unsigned long long fifthParentId = (fourthParentId == 8) ? 8 : leafId / 100000;
+    // The movement since last frame is used to extrapolate the path of the camera.
+    const glm::vec3 cameraVelocity = _hasLastCameraPos ?
+        fCameraPos - _lastCameraPos :
+        glm::vec3(0.f);
+    _lastCameraPos = fCameraPos;
+    _hasLastCameraPos = true;
+    _prefetchCameraPos = fCameraPos;
 
     // Get the number of levels to fetch from user input.
     int additionalLevelsToFetch = additionalNodes.y;
 
     // Get more descendants when closer to root.
-    if (_parentNodeOfCamera < 80000) {
+    if (firstParentId < 80000) {
         additionalLevelsToFetch++;
     }
 
+    // Fetches that haven't started for the previous position are no longer relevant.
+    const bool hasCameraMovedToNewParent = (_parentNodeOfCamera != firstParentId);
+    if (hasCameraMovedToNewParent) {
+        clearPrefetchQueue();
+        _predictedParentsOfCamera.clear();
+    }
+
+    // Prefetch the nodes the camera is about to reach, if it keeps its velocity.
+    if (cameraVelocity != glm::vec3(0.f)) {
+        const float maxDist = static_cast<float>(MAX_DIST);
+        for (float framesAhead : PrefetchFramesAhead) {
+            const glm::vec3 predictedPos = fCameraPos + cameraVelocity * framesAhead;
+            if (std::abs(predictedPos.x) > maxDist ||
+                std::abs(predictedPos.y) > maxDist || std::abs(predictedPos.z) > maxDist)
+            {
+                break;
+            }
+
+            const NodeIndex predictedParent = findParentOfLeaf(predictedPos, true);
+            const unsigned long long predictedId =
+                nodePayload(predictedParent).octreePositionIndex;
+            const bool isPredicted = std::find(
+                _predictedParentsOfCamera.begin(),
+                _predictedParentsOfCamera.end(),
+                predictedId
+            ) != _predictedParentsOfCamera.end();
+            if (predictedId == firstParentId || predictedId == 8 || isPredicted) {
+                continue;
+            }
+            _predictedParentsOfCamera.push_back(predictedId);
+            schedulePrefetch(predictedParent, additionalLevelsToFetch, framesAhead);
+        }
+    }
+
+    // Check if we should remove any nodes from RAM. Wait for the previous removal to
+    // finish so that the budget is up to date.
+    long long tenthOfRamBudget = _maxCpuRamBudget / 10;
+    if (_cpuRamBudget < tenthOfRamBudget && !_isEvicting) {
+        long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
+        size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
+        std::vector<unsigned long long> nodesToRemove = selectNodesToEvict(
+            nNodesToRemove
+        );
+        // Use asynchronous removal.
+        if (!nodesToRemove.empty()) {
+            _isEvicting = true;
+            _ioTasks->run([this, nodesToRemove]() {
+                removeNodesFromRam(nodesToRemove);
+                _isEvicting = false;
+            });
+        }
+    }
+
+    // Only fetch the neighbors if camera has moved to a new first parent!
+    if (!hasCameraMovedToNewParent) {
+        dispatchPrefetches();
+        return;
+    }
+    _parentNodeOfCamera = firstParentId;
+
+    // Each parent level may be root, make sure to propagate it in that case!
+    unsigned long long secondParentId = (firstParentId == 8) ? 8 : firstParentId / 10;
+    unsigned long long thirdParentId = (secondParentId == 8) ? 8 : firstParentId / 100;
+    unsigned long long fourthParentId = (thirdParentId == 8) ? 8 : firstParentId / 1000;
+    unsigned long long fifthParentId = (fourthParentId == 8) ? 8 : firstParentId / 10000;
+
     // Get the 3^3 closest parents and load all their (eventual) children.
     for (int x = -1; x <= 1; x += 1) {
         for (int y = -2; y <= 2; y += 2) {
@@ -274,23 +434,7 @@ void OctreeManager::fetchSurroundingNodes(const glm::dvec3& cameraPos,
         }
     }
 
-    // Check if we should remove any nodes from RAM.
-    long long tenthOfRamBudget = _maxCpuRamBudget / 10;
-    if (_cpuRamBudget < tenthOfRamBudget) {
-        long long bytesToTenthOfRam = tenthOfRamBudget - _cpuRamBudget;
-        size_t nNodesToRemove = static_cast<size_t>(bytesToTenthOfRam / chunkSizeInBytes);
-        std::vector<unsigned long long> nodesToRemove;
-        while (nNodesToRemove > 0) {
-            // Dequeue nodes that were least recently fetched by findAndFetchNeighborNode.
-            nodesToRemove.push_back(_leastRecentlyFetchedNodes.front());
-            _leastRecentlyFetchedNodes.pop();
-            nNodesToRemove--;
-        }
-        // Use asynchronous removal.
-        if (!nodesToRemove.empty()) {
-            std::thread(&OctreeManager::removeNodesFromRam, this, nodesToRemove).detach();
-        }
-    }
+    dispatchPrefetches();
 }
 
 void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, int x,
@@ -301,7 +445,7 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
 
     // Fetch first layer children if we're already at root.
     if (parentId == 8) {
-        fetchChildrenNodes(*_root, 0);
+        fetchChildrenNodes(RootIndex, 0);
         return;
     }
 
@@ -377,37 +521,163 @@ void OctreeManager::findAndFetchNeighborNode(unsigned long long firstParentId, i
     }
 
     // Traverse to that parent node (as long as such a child exists!).
-    std::shared_ptr<OctreeNode> node = _root;
-    while (!indexStack.empty() && !node->Children[indexStack.top()]->isLeaf) {
-        node = node->Children[indexStack.top()];
-        node->hasLoadedDescendant = true;
+    NodeIndex node = RootIndex;
+    while (!indexStack.empty() &&
+           !octreeNode(childIndex(node, indexStack.top())).isLeaf)
+    {
+        node = childIndex(node, indexStack.top());
+        octreeNode(node).hasLoadedDescendant = true;
         indexStack.pop();
     }
 
-    // Fetch all children nodes from found parent. Use multithreading to load files
-    // asynchronously! Detach thread from main execution so it can execute independently.
-    // Thread will then be destroyed when it has finished!
-    std::thread([this, node, additionalLevelsToFetch]() {
-        fetchChildrenNodes(*node, additionalLevelsToFetch);
-    }).detach();
+    // Fetch all children nodes from found parent asynchronously on the task scheduler.
+    schedulePrefetch(node, additionalLevelsToFetch, 0.f);
+}
+
+OctreeManager::NodeIndex OctreeManager::findParentOfLeaf(const glm::vec3& position,
+                                                         bool markLoadedDescendants)
+{
+    NodeIndex parent = RootIndex;
+    NodeIndex node = childIndex(
+        RootIndex,
+        getChildIndex(position.x, position.y, position.z)
+    );
+    while (!octreeNode(node).isLeaf) {
+        OctreeNode& innerNode = octreeNode(node);
+        // Children of the parent will be loaded, so it must be traversed to render them.
+        if (markLoadedDescendants) {
+            innerNode.hasLoadedDescendant = true;
+        }
+        parent = node;
+        node = childIndex(
+            node,
+            getChildIndex(
+                position.x,
+                position.y,
+                position.z,
+                innerNode.originX,
+                innerNode.originY,
+                innerNode.originZ
+            )
+        );
+    }
+    return parent;
+}
+
+void OctreeManager::schedulePrefetch(NodeIndex nodeIndex, int additionalLevelsToFetch,
+                                     float framesAhead)
+{
+    if (nodePayload(nodeIndex).isPrefetchScheduled.exchange(true)) {
+        return;
+    }
+
+    // The angular size of the node approximates how much it will contribute on screen.
+    const OctreeNode& node = octreeNode(nodeIndex);
+    const glm::vec3 offset = glm::vec3(node.originX, node.originY, node.originZ) -
+                             _prefetchCameraPos;
+    const float distance = std::max(glm::length(offset), node.halfDimension);
+    const float contribution = (distance > 0.f) ? node.halfDimension / distance : 1.f;
+
+    _prefetchQueue.push({
+        contribution / (1.f + framesAhead),
+        nodeIndex,
+        additionalLevelsToFetch
+    });
+}
+
+void OctreeManager::dispatchPrefetches() {
+    while (!_prefetchQueue.empty() && _nPrefetchesInFlight < MaxPrefetchesInFlight) {
+        const PrefetchRequest request = _prefetchQueue.top();
+        _prefetchQueue.pop();
+
+        _nPrefetchesInFlight++;
+        // Prefetches are speculative and must not delay more important work.
+        _ioTasks->run(
+            [this, request]() {
+                fetchChildrenNodes(request.nodeIndex, request.additionalLevelsToFetch);
+                nodePayload(request.nodeIndex).isPrefetchScheduled = false;
+                _nPrefetchesInFlight--;
+            },
+            TaskScheduler::Priority::Low
+        );
+    }
+}
+
+void OctreeManager::clearPrefetchQueue() {
+    while (!_prefetchQueue.empty()) {
+        nodePayload(_prefetchQueue.top().nodeIndex).isPrefetchScheduled = false;
+        _prefetchQueue.pop();
+    }
+}
+
+void OctreeManager::touchStreamedNode(NodeIndex nodeIndex) {
+    const size_t nBytes = octreeNode(nodeIndex).numStars * _valuesPerStar * sizeof(float);
+    nodePayload(nodeIndex).evictionPriority = _evictionAge + reloadCostPerByte(nBytes);
+}
+
+std::vector<unsigned long long> OctreeManager::selectNodesToEvict(size_t nNodes) {
+    std::lock_guard lock(_streamedNodesMutex);
+    nNodes = std::min(nNodes, _streamedNodes.size());
+
+    // Move the nodes with the lowest priority to the front.
+    auto lowerPriority = [this](NodeIndex lhs, NodeIndex rhs) {
+        return nodePayload(lhs).evictionPriority < nodePayload(rhs).evictionPriority;
+    };
+    if (nNodes < _streamedNodes.size()) {
+        std::nth_element(
+            _streamedNodes.begin(),
+            _streamedNodes.begin() + nNodes,
+            _streamedNodes.end(),
+            lowerPriority
+        );
+    }
+
+    // Age the remaining nodes by raising the base priority of nodes that are touched
+    // from now on.
+    std::vector<unsigned long long> nodesToEvict;
+    nodesToEvict.reserve(nNodes);
+    double evictionAge = _evictionAge;
+    for (size_t i = 0; i < nNodes; ++i) {
+        const NodePayload& payload = nodePayload(_streamedNodes[i]);
+        nodesToEvict.push_back(payload.octreePositionIndex);
+        evictionAge = std::max<double>(evictionAge, payload.evictionPriority);
+    }
+    _evictionAge = evictionAge;
+    _streamedNodes.erase(_streamedNodes.begin(), _streamedNodes.begin() + nNodes);
+    return nodesToEvict;
 }
 
-std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4& mvp,
+const std::vector<OctreeManager::UploadCommand>& OctreeManager::traverseData(
+                                                              const glm::dmat4& mvp,
                                                               const glm::vec2& screenSize,
                                                               int& deltaStars,
                                                               gaia::RenderOption option,
                                                               float lodPixelThreshold)
 {
-    auto renderData = std::map<int, std::vector<float>>();
     bool innerRebuild = false;
     _minTotalPixelsLod = lodPixelThreshold;
 
+    // Reset the upload list from previous render call but keep its memory.
+    for (const UploadCommand& command : _uploadCommands) {
+        _uploadCommandSlots[command.bufferIndex] = -1;
+    }
+    _uploadCommands.clear();
+    _traversalStats = TraversalStats();
+
+    // The same key may have been removed more than once.
+    std::sort(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end());
+    _removedKeysInPrevCall.erase(
+        std::unique(_removedKeysInPrevCall.begin(), _removedKeysInPrevCall.end()),
+        _removedKeysInPrevCall.end()
+    );
+    const bool reclaimedKeys = !_removedKeysInPrevCall.empty();
+
     // Reclaim indices from previous render call.
     for (auto removedKey = _removedKeysInPrevCall.rbegin();
          removedKey != _removedKeysInPrevCall.rend(); ++removedKey) {
 
         // Uses a reverse loop to try to decrease the biggest chunk.
-        if (*removedKey == _biggestChunkIndexInUse - 1) {
+        if (*removedKey == static_cast<int>(_biggestChunkIndexInUse) - 1) {
             _biggestChunkIndexInUse = *removedKey;
             LDEBUG(fmt::format(
                 "Decreased size to: {} Free Spots in VBO: {}",
@@ -417,9 +687,7 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         _freeSpotsInBuffer.push(*removedKey);
     }
     // Clear cache of removed keys before next render call.
-    if (!_removedKeysInPrevCall.empty()) {
-        _removedKeysInPrevCall.clear();
-    }
+    _removedKeysInPrevCall.clear();
 
     // Rebuild VBO from scratch if we're not using most of it but have a high max index.
     if ((_biggestChunkIndexInUse > _maxStackSize * 4 / 5) &&
@@ -434,8 +702,24 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         innerRebuild = true;
     }
 
+    // Nodes only enter or leave the buffer if the view has changed, if nodes have been
+    // loaded or unloaded, or if a node couldn't be placed in the buffer last time.
+    const bool loadedNodesChanged = _loadedNodesChanged.exchange(false);
+    if (!_rebuildBuffer && !reclaimedKeys && !loadedNodesChanged && !_hasUnplacedNodes &&
+        mvp == _lastTraversalMvp && screenSize == _lastTraversalScreenSize &&
+        option == _lastTraversalOption && lodPixelThreshold == _lastLodPixelThreshold)
+    {
+        _traversalStats.skipped = true;
+        return _uploadCommands;
+    }
+    _lastTraversalMvp = mvp;
+    _lastTraversalScreenSize = screenSize;
+    _lastTraversalOption = option;
+    _lastLodPixelThreshold = lodPixelThreshold;
+    _hasUnplacedNodes = false;
+
     // Check if entire tree is too small to see, and if so remove it.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     float fMaxDist = static_cast<float>(MAX_DIST);
     for (int i = 0; i < 8; ++i) {
         float x = (i % 2 == 0) ? fMaxDist : -fMaxDist;
@@ -445,20 +729,18 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         corners[i] = glm::dvec4(pos, 1.0);
     }
     if (!_culler->isVisible(corners, mvp)) {
-        return renderData;
+        _traversalStats.nUploadCommands = _uploadCommands.size();
+        return _uploadCommands;
     }
     glm::vec2 nodeSize = _culler->getNodeSizeInPixels(corners, mvp, screenSize);
     float totalPixels = nodeSize.x * nodeSize.y;
     if (totalPixels < _minTotalPixelsLod * 2) {
         // Remove LOD from first layer of children.
-        for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *_root->Children[i],
-                deltaStars
-            );
-            renderData.insert(tmpData.begin(), tmpData.end());
+        for (size_t i = 0; i < 8; ++i) {
+            removeNodeFromCache(childIndex(RootIndex, i), deltaStars);
         }
-        return renderData;
+        _traversalStats.nUploadCommands = _uploadCommands.size();
+        return _uploadCommands;
     }
 
     for (size_t i = 0; i < 8; ++i) {
@@ -466,8 +748,8 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             continue;
         }
 
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *_root->Children[i],
+        checkNodeIntersection(
+            childIndex(RootIndex, i),
             mvp,
             screenSize,
             deltaStars,
@@ -477,27 +759,18 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
         // Avoid freezing when switching render mode for large datasets by only fetching
         // one branch at a time when rebuilding buffer.
         if (_rebuildBuffer) {
-            //renderData = std::move(tmpData);
             _traversedBranchesInRenderCall++;
-            //break;
         }
-
-        // Observe that if there exists identical keys in renderData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        renderData.insert(tmpData.begin(), tmpData.end());
     }
 
     if (_rebuildBuffer) {
         if (_useVBO) {
             // We need to overwrite bigger indices that had data before! No need for SSBO.
-            std::map<int, std::vector<float>> idxToRemove;
+            // This will only add indices that aren't already in the list
+            // (i.e. > biggestIdx).
             for (int idx : _removedKeysInPrevCall) {
-                idxToRemove[idx] = std::vector<float>();
+                addUploadCommand(idx, NodeData());
             }
-
-            // This will only insert indices that doesn't already exist in map
-            // (i.e. > biggestIdx).
-            renderData.insert(idxToRemove.begin(), idxToRemove.end());
         }
         if (innerRebuild) {
             deltaStars = 0;
@@ -518,14 +791,19 @@ std::map<int, std::vector<float>> OctreeManager::traverseData(const glm::dmat4&
             _traversedBranchesInRenderCall = 0;
         }
     }
-    return renderData;
+    _traversalStats.nUploadCommands = _uploadCommands.size();
+    return _uploadCommands;
+}
+
+const OctreeManager::TraversalStats& OctreeManager::traversalStats() const {
+    return _traversalStats;
 }
 
 std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
     std::vector<float> fullData;
 
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*_root->Children[i], option);
+        std::vector<float> tmpData = getNodeData(childIndex(RootIndex, i), option);
         fullData.insert(fullData.end(), tmpData.begin(), tmpData.end());
     }
     return fullData;
@@ -534,11 +812,11 @@ std::vector<float> OctreeManager::getAllData(gaia::RenderOption option) {
 void OctreeManager::clearAllData(int branchIndex) {
     // Don't clear everything if not needed.
     if (branchIndex != -1) {
-        clearNodeData(*_root->Children[branchIndex]);
+        clearNodeData(childIndex(RootIndex, branchIndex));
     }
     else {
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*_root->Children[i]);
+            clearNodeData(childIndex(RootIndex, i));
         }
     }
 }
@@ -553,13 +831,16 @@ void OctreeManager::writeToFile(std::ofstream& outFileStream, bool writeData) {
 
     // Use pre-traversal (Morton code / Z-order).
     for (size_t i = 0; i < 8; ++i) {
-        writeNodeToFile(outFileStream, *_root->Children[i], writeData);
+        writeNodeToFile(outFileStream, childIndex(RootIndex, i), writeData);
     }
 }
 
-void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
+void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, NodeIndex nodeIndex,
                                     bool writeData)
 {
+    const OctreeNode& node = octreeNode(nodeIndex);
+    const NodePayload& payload = nodePayload(nodeIndex);
+
     // Write node structure.
     bool isLeaf = node.isLeaf;
     int32_t numStars = static_cast<int32_t>(node.numStars);
@@ -568,22 +849,26 @@ void OctreeManager::writeNodeToFile(std::ofstream& outFileStream, const OctreeNo
 
     // Write node data if specified
     if (writeData) {
-        std::vector<float> nodeData = node.posData;
-        nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-        nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-        int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-        size_t nBytes = nDataSize * sizeof(nodeData[0]);
+        int32_t nDataSize = static_cast<int32_t>(
+            payload.posData.size() + payload.colData.size() + payload.velData.size()
+        );
 
         outFileStream.write(reinterpret_cast<const char*>(&nDataSize), sizeof(int32_t));
-        if (nDataSize > 0) {
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
+        // Write the attributes one after another, there is no need to merge them first.
+        for (const std::vector<float>* data : { &payload.posData, &payload.colData,
+                                                &payload.velData })
+        {
+            outFileStream.write(
+                reinterpret_cast<const char*>(data->data()),
+                data->size() * sizeof(float)
+            );
         }
     }
 
     // Write children to file (in Morton order) if we're in an inner node.
     if (!node.isLeaf) {
         for (size_t i = 0; i < 8; ++i) {
-            writeNodeToFile(outFileStream, *node.Children[i], writeData);
+            writeNodeToFile(outFileStream, childIndex(nodeIndex, i), writeData);
         }
     }
 }
@@ -613,16 +898,11 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
     // Octree Manager root halfDistance must be updated before any nodes are created!
     if (MAX_DIST != oldMaxdist) {
         for (size_t i = 0; i < 8; ++i) {
-            _root->Children[i]->halfDimension = MAX_DIST / 2.f;
-            _root->Children[i]->originX = (i % 2 == 0) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originY = (i % 4 < 2) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
-            _root->Children[i]->originZ = (i < 4) ?
-                _root->Children[i]->halfDimension :
-                -_root->Children[i]->halfDimension;
+            OctreeNode& node = octreeNode(childIndex(RootIndex, i));
+            node.halfDimension = MAX_DIST / 2.f;
+            node.originX = (i % 2 == 0) ? node.halfDimension : -node.halfDimension;
+            node.originY = (i % 4 < 2) ? node.halfDimension : -node.halfDimension;
+            node.originZ = (i < 4) ? node.halfDimension : -node.halfDimension;
         }
     }
 
@@ -632,12 +912,12 @@ int OctreeManager::readFromFile(std::ifstream& inFileStream, bool readData,
 
     // Use the same technique to construct octree from file.
     for (size_t i = 0; i < 8; ++i) {
-        nStarsRead += readNodeFromFile(inFileStream, *_root->Children[i], readData);
+        nStarsRead += readNodeFromFile(inFileStream, childIndex(RootIndex, i), readData);
     }
     return nStarsRead;
 }
 
-int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node,
+int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, NodeIndex nodeIndex,
                                     bool readData)
 {
     // Read node structure.
@@ -647,6 +927,7 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
     inFileStream.read(reinterpret_cast<char*>(&isLeaf), sizeof(bool));
     inFileStream.read(reinterpret_cast<char*>(&numStars), sizeof(int32_t));
 
+    OctreeNode& node = octreeNode(nodeIndex);
     node.isLeaf = isLeaf;
     node.numStars = numStars;
 
@@ -665,18 +946,23 @@ int OctreeManager::readNodeFromFile(std::ifstream& inFileStream, OctreeNode& nod
             auto posEnd = fetchedData.begin() + (starsInNode * POS_SIZE);
             auto colEnd = posEnd + (starsInNode * COL_SIZE);
             auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-            node.posData = std::vector<float>(fetchedData.begin(), posEnd);
-            node.colData = std::vector<float>(posEnd, colEnd);
-            node.velData = std::vector<float>(colEnd, velEnd);
+            NodePayload& payload = nodePayload(nodeIndex);
+            payload.posData = std::vector<float>(fetchedData.begin(), posEnd);
+            payload.colData = std::vector<float>(posEnd, colEnd);
+            payload.velData = std::vector<float>(colEnd, velEnd);
         }
     }
 
     // Create children if we're in an inner node and read from the corresponding nodes.
-    if (!node.isLeaf) {
+    if (!isLeaf) {
         numStars = 0;
-        createNodeChildren(node);
+        createNodeChildren(nodeIndex);
         for (size_t i = 0; i < 8; ++i) {
-            numStars += readNodeFromFile(inFileStream, *node.Children[i], readData);
+            numStars += readNodeFromFile(
+                inFileStream,
+                childIndex(nodeIndex, i),
+                readData
+            );
         }
     }
 
@@ -690,35 +976,57 @@ void OctreeManager::writeToMultipleFiles(const std::string& outFolderPath,
     // Write entire branch to disc, with one file per node.
     std::string outFilePrefix = outFolderPath + std::to_string(branchIndex);
     // More threads doesn't make it much faster, disk speed still the limiter.
-    writeNodeToMultipleFiles(outFilePrefix, *_root->Children[branchIndex], false);
+    writeNodeToMultipleFiles(outFilePrefix, childIndex(RootIndex, branchIndex), false);
 
     // Clear all data in branch.
     LINFO(fmt::format("Clear all data from branch {} in octree", branchIndex));
-    clearNodeData(*_root->Children[branchIndex]);
+    clearNodeData(childIndex(RootIndex, branchIndex));
 }
 
 void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
-                                             OctreeNode& node, bool threadWrites)
+                                             NodeIndex nodeIndex, bool threadWrites)
 {
-    // Prepare node data, save nothing else.
-    std::vector<float> nodeData = node.posData;
-    nodeData.insert(nodeData.end(), node.colData.begin(), node.colData.end());
-    nodeData.insert(nodeData.end(), node.velData.begin(), node.velData.end());
-    int32_t nDataSize = static_cast<int32_t>(nodeData.size());
-    size_t nBytes = nDataSize * sizeof(nodeData[0]);
+    const NodePayload& node = nodePayload(nodeIndex);
 
     // Only open output stream if we have any values to write.
-    if (nDataSize > 0) {
+    const size_t nStarsInNode = node.posData.size() / POS_SIZE;
+    if (nStarsInNode > 0) {
+        // Prepare header with aligned offsets to all attribute sections.
+        NodeFileHeader header;
+        header.magic = NodeFileMagic;
+        header.version = NodeFileVersion;
+        header.nStars = static_cast<uint32_t>(nStarsInNode);
+        header.valuesPerStar = static_cast<uint32_t>(POS_SIZE + COL_SIZE + VEL_SIZE);
+        header.positionOffset = alignNodeFileOffset(sizeof(NodeFileHeader));
+        header.colorOffset = alignNodeFileOffset(
+            header.positionOffset + node.posData.size() * sizeof(float)
+        );
+        header.velocityOffset = alignNodeFileOffset(
+            header.colorOffset + node.colData.size() * sizeof(float)
+        );
+
         // Use Morton code to name file (placement in Octree).
-        std::string outPath = outFilePrefix + BINARY_SUFFIX;
+        std::string outPath = outFilePrefix + NODE_SUFFIX;
         std::ofstream outFileStream(outPath, std::ofstream::binary);
         if (outFileStream.good()) {
-            // LINFO("Write " + std::to_string(nDataSize) + " values to " + outPath);
             outFileStream.write(
-                reinterpret_cast<const char*>(&nDataSize),
-                sizeof(int32_t)
+                reinterpret_cast<const char*>(&header),
+                sizeof(NodeFileHeader)
+            );
+            uint64_t offset = sizeof(NodeFileHeader);
+            writeNodeFileSection(
+                outFileStream,
+                offset,
+                header.positionOffset,
+                node.posData
+            );
+            writeNodeFileSection(outFileStream, offset, header.colorOffset, node.colData);
+            writeNodeFileSection(
+                outFileStream,
+                offset,
+                header.velocityOffset,
+                node.velData
             );
-            outFileStream.write(reinterpret_cast<const char*>(nodeData.data()), nBytes);
 
             outFileStream.close();
         }
@@ -728,21 +1036,22 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
     }
 
     // Recursively write children to file (in Morton order) if we're in an inner node.
-    if (!node.isLeaf) {
+    if (!octreeNode(nodeIndex).isLeaf) {
         std::vector<std::thread> writeThreads(8);
         for (size_t i = 0; i < 8; ++i) {
             std::string newOutFilePrefix = outFilePrefix + std::to_string(i);
+            const NodeIndex child = childIndex(nodeIndex, i);
             if (threadWrites) {
                 // Divide writing to new threads to speed up the process.
                 std::thread t(
-                    [this, newOutFilePrefix, n = node.Children[i]]() {
-                        writeNodeToMultipleFiles(newOutFilePrefix, *n, false);
+                    [this, newOutFilePrefix, child]() {
+                        writeNodeToMultipleFiles(newOutFilePrefix, child, false);
                     }
                 );
                 writeThreads[i] = std::move(t);
             }
             else {
-                writeNodeToMultipleFiles(newOutFilePrefix, *node.Children[i], false);
+                writeNodeToMultipleFiles(newOutFilePrefix, child, false);
             }
         }
         if (threadWrites) {
@@ -754,72 +1063,148 @@ void OctreeManager::writeNodeToMultipleFiles(const std::string& outFilePrefix,
     }
 }
 
-void OctreeManager::fetchChildrenNodes(OctreeNode& parentNode,
+void OctreeManager::fetchChildrenNodes(NodeIndex parentIndex,
                                        int additionalLevelsToFetch)
 {
     // Lock node to make sure nobody else are trying to load the same children.
-    std::lock_guard lock(parentNode.loadingLock);
+    std::lock_guard lock(nodePayload(parentIndex).loadingLock);
+
+    for (size_t i = 0; i < 8; ++i) {
+        const NodeIndex child = childIndex(parentIndex, i);
+        const OctreeNode& childNode = octreeNode(child);
 
-    for (int i = 0; i < 8; ++i) {
         // Fetch node data if we're streaming and it doesn't exist in RAM yet.
         // (As long as there is any RAM budget left and node actually has any data!)
-        if (!parentNode.Children[i]->isLoaded &&
-            (parentNode.Children[i]->numStars > 0) &&
-            _cpuRamBudget > static_cast<long long>(parentNode.Children[i]->numStars
+        if (!childNode.isLoaded && (childNode.numStars > 0) &&
+            _cpuRamBudget > static_cast<long long>(childNode.numStars
             * (POS_SIZE + COL_SIZE + VEL_SIZE) * 4))
         {
-            fetchNodeDataFromFile(*parentNode.Children[i]);
+            fetchNodeDataFromFile(child);
         }
 
         // Fetch all Children's Children if recursive is set to true!
-        if (additionalLevelsToFetch != 0 && !parentNode.Children[i]->isLeaf) {
-            fetchChildrenNodes(*parentNode.Children[i], --additionalLevelsToFetch);
+        if (additionalLevelsToFetch != 0 && !childNode.isLeaf) {
+            fetchChildrenNodes(child, --additionalLevelsToFetch);
         }
     }
 }
 
-void OctreeManager::fetchNodeDataFromFile(OctreeNode& node) {
+void OctreeManager::fetchNodeDataFromFile(NodeIndex nodeIndex) {
     // Remove root ID ("8") from index before loading file.
-    std::string posId = std::to_string(node.octreePositionIndex);
+    std::string posId = std::to_string(nodePayload(nodeIndex).octreePositionIndex);
     posId.erase(posId.begin());
-
-    std::string inFilePath = _streamFolderPath + posId + BINARY_SUFFIX;
-    std::ifstream inFileStream(inFilePath, std::ifstream::binary);
-    // LINFO("Fetch node data file: " + inFilePath);
-
-    if (inFileStream.good()) {
-        // Read node data.
-        int32_t nDataSize = 0;
-
-        // Octree knows if we have any data in this node = it exists.
-        // Otherwise don't call this function!
-        inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
-
-        std::vector<float> readData(nDataSize, 0.f);
-        int nBytes = nDataSize * sizeof(readData[0]);
-        if (nDataSize > 0) {
-            inFileStream.read(reinterpret_cast<char*>(&readData[0]), nBytes);
+    std::string inFilePrefix = _streamFolderPath + posId;
+
+    // Prefer memory mapped node files. Only fall back to the original binary format if
+    // the dataset was constructed before the node file format was introduced.
+    NodeData data;
+    if (!_useLegacyNodeFiles) {
+        data = mapNodeFile(nodeIndex, inFilePrefix + NODE_SUFFIX);
+    }
+    if (!data.owner) {
+        data = readLegacyNodeFile(inFilePrefix + BINARY_SUFFIX);
+        if (data.owner && !_useLegacyNodeFiles.exchange(true)) {
+            LINFO("Streaming node data files in the original binary format");
         }
+    }
 
-        int starsInNode = static_cast<int>(nDataSize / _valuesPerStar);
-        auto posEnd = readData.begin() + (starsInNode * POS_SIZE);
-        auto colEnd = posEnd + (starsInNode * COL_SIZE);
-        auto velEnd = colEnd + (starsInNode * VEL_SIZE);
-        node.posData = std::vector<float>(readData.begin(), posEnd);
-        node.colData = std::vector<float>(posEnd, colEnd);
-        node.velData = std::vector<float>(colEnd, velEnd);
-
+    if (data.owner) {
         // Keep track of nodes that are loaded and update CPU RAM budget.
-        node.isLoaded = true;
+        OctreeNode& node = octreeNode(nodeIndex);
+        {
+            NodePayload& payload = nodePayload(nodeIndex);
+            std::lock_guard lock(payload.loadingLock);
+            payload.streamedData = std::move(data);
+            node.isLoaded = true;
+        }
+        _loadedNodesChanged = true;
         if (!_datasetFitInMemory) {
-            std::lock_guard g(_leastRecentlyFetchedNodesMutex);
-            _leastRecentlyFetchedNodes.push(node.octreePositionIndex);
+            touchStreamedNode(nodeIndex);
+            std::lock_guard g(_streamedNodesMutex);
+            _streamedNodes.push_back(nodeIndex);
         }
-        _cpuRamBudget -= nBytes;
+        _cpuRamBudget -= static_cast<long long>(
+            node.numStars * _valuesPerStar * sizeof(float)
+        );
     }
     else {
-        LERROR("Error opening node data file: " + inFilePath);
+        LERROR("Error opening node data file: " + inFilePrefix);
+    }
+}
+
+OctreeManager::NodeData OctreeManager::mapNodeFile(NodeIndex nodeIndex,
+                                                   const std::string& filePath)
+{
+    auto file = std::make_shared<MemoryMappedFile>(filePath);
+    if (!file->isValid() || file->size() < sizeof(NodeFileHeader)) {
+        return NodeData();
+    }
+
+    const NodeFileHeader& header = *file->at<NodeFileHeader>(0);
+    if (header.magic != NodeFileMagic || header.version != NodeFileVersion) {
+        LERROR(fmt::format("Node data file '{}' has an unsupported format", filePath));
+        return NodeData();
+    }
+    // All sections have to be aligned and lie within the file
+    const uint64_t fileSize = file->size();
+    auto isValidSection = [&header, fileSize](uint64_t offset, size_t valuesPerStar) {
+        return offset % alignof(float) == 0 && offset <= fileSize &&
+               header.nStars <= (fileSize - offset) / (valuesPerStar * sizeof(float));
+    };
+    const bool isValid = header.nStars == octreeNode(nodeIndex).numStars &&
+                         isValidSection(header.positionOffset, POS_SIZE) &&
+                         isValidSection(header.colorOffset, COL_SIZE) &&
+                         isValidSection(header.velocityOffset, VEL_SIZE);
+    if (!isValid) {
+        LERROR(fmt::format("Node data file '{}' doesn't match index file", filePath));
+        return NodeData();
+    }
+
+    // Page in the data on this thread so the upload on the render thread doesn't stall
+    // on disk reads.
+    file->populate();
+
+    NodeData data;
+    data.positions = file->at<float>(header.positionOffset);
+    data.colors = file->at<float>(header.colorOffset);
+    data.velocities = file->at<float>(header.velocityOffset);
+    data.nStars = static_cast<size_t>(header.nStars);
+    data.owner = std::move(file);
+    return data;
+}
+
+OctreeManager::NodeData OctreeManager::readLegacyNodeFile(const std::string& filePath) {
+    std::ifstream inFileStream(filePath, std::ifstream::binary);
+    if (!inFileStream.good()) {
+        return NodeData();
     }
+
+    // Octree knows if we have any data in this node = it exists.
+    // Otherwise don't call this function!
+    int32_t nDataSize = 0;
+    inFileStream.read(reinterpret_cast<char*>(&nDataSize), sizeof(int32_t));
+
+    // The attribute blocks are stored after each other in the file and are read into one
+    // buffer that is shared with the views of the node data.
+    const size_t starsInNode = static_cast<size_t>(nDataSize) / _valuesPerStar;
+    auto buffer = std::make_shared<std::vector<float>>(
+        starsInNode * (POS_SIZE + COL_SIZE + VEL_SIZE)
+    );
+    inFileStream.read(
+        reinterpret_cast<char*>(buffer->data()),
+        buffer->size() * sizeof(float)
+    );
+    if (!inFileStream.good()) {
+        return NodeData();
+    }
+
+    NodeData data;
+    data.positions = buffer->data();
+    data.colors = data.positions + starsInNode * POS_SIZE;
+    data.velocities = data.colors + starsInNode * COL_SIZE;
+    data.nStars = starsInNode;
+    data.owner = std::move(buffer);
+    return data;
 }
 
 void OctreeManager::removeNodesFromRam(
@@ -836,63 +1221,50 @@ void OctreeManager::removeNodesFromRam(
         }
 
         // Traverse to node and remove it.
-        std::shared_ptr<OctreeNode> node = _root;
-        std::vector<std::shared_ptr<OctreeNode>> ancestors;
+        NodeIndex node = RootIndex;
+        std::vector<NodeIndex> ancestors;
         while (!indexStack.empty()) {
             ancestors.push_back(node);
-            node = node->Children[indexStack.top()];
+            node = childIndex(node, indexStack.top());
             indexStack.pop();
         }
-        removeNode(*node);
+        removeNode(node);
 
         propagateUnloadedNodes(ancestors);
     }
 }
 
-void OctreeManager::removeNode(OctreeNode& node) {
+void OctreeManager::removeNode(NodeIndex nodeIndex) {
+    NodePayload& node = nodePayload(nodeIndex);
+
     // Lock node to make sure nobody else is trying to access it while removing.
     std::lock_guard lock(node.loadingLock);
 
-    int nBytes = static_cast<int>(
-        node.numStars * _valuesPerStar * sizeof(node.posData[0])
+    const long long nBytes = static_cast<long long>(
+        octreeNode(nodeIndex).numStars * _valuesPerStar * sizeof(float)
     );
     // Keep track of which nodes that are loaded and update CPU RAM budget.
-    node.isLoaded = false;
+    octreeNode(nodeIndex).isLoaded = false;
+    _loadedNodesChanged = true;
     _cpuRamBudget += nBytes;
 
-    // Clear data
-    node.posData.clear();
-    node.posData.shrink_to_fit();
-    node.colData.clear();
-    node.colData.shrink_to_fit();
-    node.velData.clear();
-    node.velData.shrink_to_fit();
+    // Release the streamed data. Views that still reference it, for example in a pending
+    // upload, keep it alive until they have been uploaded.
+    node.streamedData = NodeData();
 }
 
-void OctreeManager::propagateUnloadedNodes(
-                                   std::vector<std::shared_ptr<OctreeNode>> ancestorNodes)
-{
-    std::shared_ptr<OctreeNode> parentNode = ancestorNodes.back();
-    while (parentNode->octreePositionIndex != 8) {
+void OctreeManager::propagateUnloadedNodes(std::vector<NodeIndex> ancestorNodes) {
+    NodeIndex parentNode = ancestorNodes.back();
+    while (parentNode != RootIndex) {
         // Check if any children of inner node is still loaded, or has loaded descendants.
-        if (parentNode->Children[0]->isLoaded || parentNode->Children[1]->isLoaded ||
-            parentNode->Children[2]->isLoaded || parentNode->Children[3]->isLoaded ||
-            parentNode->Children[4]->isLoaded || parentNode->Children[5]->isLoaded ||
-            parentNode->Children[6]->isLoaded || parentNode->Children[7]->isLoaded ||
-            parentNode->Children[0]->hasLoadedDescendant ||
-            parentNode->Children[1]->hasLoadedDescendant ||
-            parentNode->Children[2]->hasLoadedDescendant ||
-            parentNode->Children[3]->hasLoadedDescendant ||
-            parentNode->Children[4]->hasLoadedDescendant ||
-            parentNode->Children[5]->hasLoadedDescendant ||
-            parentNode->Children[6]->hasLoadedDescendant ||
-            parentNode->Children[7]->hasLoadedDescendant)
-        {
-            return;
+        for (size_t i = 0; i < 8; ++i) {
+            const OctreeNode& child = octreeNode(childIndex(parentNode, i));
+            if (child.isLoaded || child.hasLoadedDescendant) {
+                return;
+            }
         }
         // Else all children has been unloaded and we can update parent flag.
-        parentNode->hasLoadedDescendant = false;
-        // LINFO("Removed ancestor: " + std::to_string(parentNode->octreePositionIndex));
+        octreeNode(parentNode).hasLoadedDescendant = false;
 
         // Propagate change upwards.
         ancestorNodes.pop_back();
@@ -941,7 +1313,7 @@ bool OctreeManager::isRebuildOngoing() const {
 }
 
 size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float origX,
-                                    float origY, float origZ)
+                                    float origY, float origZ) const
 {
     size_t index = 0;
     if (posX < origX) {
@@ -956,48 +1328,57 @@ size_t OctreeManager::getChildIndex(float posX, float posY, float posZ, float or
     return index;
 }
 
-bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-                                 int depth)
+bool OctreeManager::insertInNode(NodeIndex nodeIndex, const float* starValues, int depth)
 {
-    if (node.isLeaf && node.numStars < MAX_STARS_PER_NODE) {
+    // Creating nodes in this branch reallocates its arena, so the node is looked up again
+    // after every call that may insert new nodes instead of holding on to a reference.
+    const bool isLeaf = octreeNode(nodeIndex).isLeaf;
+    if (isLeaf && octreeNode(nodeIndex).numStars < MAX_STARS_PER_NODE) {
         // Node is a leaf and it's not yet full -> insert star.
-        storeStarData(node, starValues);
+        storeStarData(nodeIndex, starValues);
 
-        if (depth > _totalDepth) {
-            _totalDepth = depth;
-        }
+        // Other branches may update the depth concurrently.
+        size_t totalDepth = _totalDepth;
+        while (static_cast<size_t>(depth) > totalDepth &&
+               !_totalDepth.compare_exchange_weak(totalDepth, depth))
+        {}
         return true;
     }
-    else if (node.isLeaf) {
+    else if (isLeaf) {
         // Too many stars in leaf node, subdivide into 8 new nodes.
         // Create children and clean up parent.
-        createNodeChildren(node);
+        createNodeChildren(nodeIndex);
+
+        // Payloads are never moved when the arena grows.
+        NodePayload& node = nodePayload(nodeIndex);
+        const OctreeNode& parent = octreeNode(nodeIndex);
+        const float originX = parent.originX;
+        const float originY = parent.originY;
+        const float originZ = parent.originZ;
 
         // Distribute stars from parent node into children.
+        float tmpValues[POS_SIZE + COL_SIZE + VEL_SIZE];
         for (size_t n = 0; n < MAX_STARS_PER_NODE; ++n) {
             // Position data.
             auto posBegin = node.posData.begin() + n * POS_SIZE;
-            auto posEnd = posBegin + POS_SIZE;
-            std::vector<float> tmpValues(posBegin, posEnd);
+            std::copy(posBegin, posBegin + POS_SIZE, tmpValues);
             // Color data.
             auto colBegin = node.colData.begin() + n * COL_SIZE;
-            auto colEnd = colBegin + COL_SIZE;
-            tmpValues.insert(tmpValues.end(), colBegin, colEnd);
+            std::copy(colBegin, colBegin + COL_SIZE, tmpValues + POS_SIZE);
             // Velocity data.
             auto velBegin = node.velData.begin() + n * VEL_SIZE;
-            auto velEnd = velBegin + VEL_SIZE;
-            tmpValues.insert(tmpValues.end(), velBegin, velEnd);
+            std::copy(velBegin, velBegin + VEL_SIZE, tmpValues + POS_SIZE + COL_SIZE);
 
             // Find out which child that will inherit the data and store it.
             size_t index = getChildIndex(
                 tmpValues[0],
                 tmpValues[1],
                 tmpValues[2],
-                node.originX,
-                node.originY,
-                node.originZ
+                originX,
+                originY,
+                originZ
             );
-            insertInNode(*node.Children[index], tmpValues, depth);
+            insertInNode(childIndex(nodeIndex, index), tmpValues, depth);
         }
 
         // Sort magnitudes in inner node.
@@ -1007,6 +1388,7 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
 
     // Node is an inner node, keep recursion going.
     // This will also take care of the new star when a subdivision has taken place.
+    const OctreeNode& node = octreeNode(nodeIndex);
     size_t index = getChildIndex(
         starValues[0],
         starValues[1],
@@ -1018,16 +1400,19 @@ bool OctreeManager::insertInNode(OctreeNode& node, const std::vector<float>& sta
 
     // Determine if new star should be kept in our LOD cache.
     // Keeps track of the brightest nodes in children.
-    if (starValues[POS_SIZE] < node.magOrder[MAX_STARS_PER_NODE - 1].first) {
-        storeStarData(node, starValues);
+    const NodePayload& payload = nodePayload(nodeIndex);
+    if (starValues[POS_SIZE] < payload.magOrder[MAX_STARS_PER_NODE - 1].first) {
+        storeStarData(nodeIndex, starValues);
     }
 
-    return insertInNode(*node.Children[index], starValues, ++depth);
+    return insertInNode(childIndex(nodeIndex, index), starValues, ++depth);
 }
 
-void OctreeManager::sliceNodeLodCache(OctreeNode& node) {
+void OctreeManager::sliceNodeLodCache(NodeIndex nodeIndex) {
     // Slice stored LOD data in inner nodes.
-    if (!node.isLeaf) {
+    if (!octreeNode(nodeIndex).isLeaf) {
+        NodePayload& node = nodePayload(nodeIndex);
+
         // Sort by magnitude. Inverse relation (i.e. a lower magnitude means a brighter
         // star!)
         std::sort(node.magOrder.begin(), node.magOrder.end());
@@ -1048,21 +1433,23 @@ void OctreeManager::sliceNodeLodCache(OctreeNode& node) {
         node.posData = std::move(tmpPos);
         node.colData = std::move(tmpCol);
         node.velData = std::move(tmpVel);
-        node.numStars = node.magOrder.size(); // = MAX_STARS_PER_NODE
+        octreeNode(nodeIndex).numStars = node.magOrder.size(); // = MAX_STARS_PER_NODE
 
-        for (int i = 0; i < 8; ++i) {
-            sliceNodeLodCache(*node.Children[i]);
+        for (size_t i = 0; i < 8; ++i) {
+            sliceNodeLodCache(childIndex(nodeIndex, i));
         }
     }
 }
 
-void OctreeManager::storeStarData(OctreeNode& node, const std::vector<float>& starValues)
-{
+void OctreeManager::storeStarData(NodeIndex nodeIndex, const float* starValues) {
+    NodePayload& node = nodePayload(nodeIndex);
+    size_t& numStars = octreeNode(nodeIndex).numStars;
+
     // Insert star data at the back of vectors and store a vector with pairs consisting of
     // star magnitude and insert index for later sorting and slicing of LOD cache.
     float mag = starValues[POS_SIZE];
-    node.magOrder.insert(node.magOrder.end(), std::make_pair(mag, node.numStars));
-    node.numStars++;
+    node.magOrder.insert(node.magOrder.end(), std::make_pair(mag, numStars));
+    numStars++;
 
     // If LOD is growing too large then sort it and resize to [chunk size] to avoid too
     // much RAM usage and increase threshold for adding new stars.
@@ -1071,16 +1458,18 @@ void OctreeManager::storeStarData(OctreeNode& node, const std::vector<float>& st
         node.magOrder.resize(MAX_STARS_PER_NODE);
     }
 
-    auto posEnd = starValues.begin() + POS_SIZE;
-    auto colEnd = posEnd + COL_SIZE;
-    node.posData.insert(node.posData.end(), starValues.begin(), posEnd);
+    const float* posEnd = starValues + POS_SIZE;
+    const float* colEnd = posEnd + COL_SIZE;
+    const float* velEnd = colEnd + VEL_SIZE;
+    node.posData.insert(node.posData.end(), starValues, posEnd);
     node.colData.insert(node.colData.end(), posEnd, colEnd);
-    node.velData.insert(node.velData.end(), colEnd, starValues.end());
+    node.velData.insert(node.velData.end(), colEnd, velEnd);
 }
 
-std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
+std::string OctreeManager::printStarsPerNode(NodeIndex nodeIndex,
                                              const std::string& prefix) const
 {
+    const OctreeNode& node = octreeNode(nodeIndex);
 
     // Print both inner and leaf nodes.
     auto str = prefix + "} : " + std::to_string(node.numStars);
@@ -1089,26 +1478,29 @@ std::string OctreeManager::printStarsPerNode(const OctreeNode& node,
         return str + " - [Leaf] \n";
     }
     else {
-        str += fmt::format("LOD: {} - [Parent]\n", node.posData.size() / POS_SIZE);
-        for (int i = 0; i < 8; ++i) {
+        str += fmt::format(
+            "LOD: {} - [Parent]\n",
+            nodePayload(nodeIndex).posData.size() / POS_SIZE
+        );
+        for (size_t i = 0; i < 8; ++i) {
             auto pref = prefix + "->" + std::to_string(i);
-            str += printStarsPerNode(*node.Children[i], pref);
+            str += printStarsPerNode(childIndex(nodeIndex, i), pref);
         }
         return str;
     }
 }
 
-std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNode& node,
-                                                                    const glm::dmat4& mvp,
-                                                              const glm::vec2& screenSize,
-                                                                          int& deltaStars,
-                                                                gaia::RenderOption option)
+void OctreeManager::checkNodeIntersection(NodeIndex nodeIndex, const glm::dmat4& mvp,
+                                          const glm::vec2& screenSize, int& deltaStars,
+                                          gaia::RenderOption option)
 {
-    std::map<int, std::vector<float>> fetchedData;
+    // No nodes are created while rendering, so the reference stays valid.
+    OctreeNode& node = octreeNode(nodeIndex);
+    _traversalStats.nVisitedNodes++;
     //int depth  = static_cast<int>(log2( MAX_DIST / node->halfDimension ));
 
     // Calculate the corners of the node.
-    std::vector<glm::dvec4> corners(8);
+    std::array<glm::dvec4, 8> corners;
     for (int i = 0; i < 8; ++i) {
         const float x = (i % 2 == 0) ?
             node.originX + node.halfDimension :
@@ -1127,8 +1519,8 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (!(_culler->isVisible(corners, mvp))) {
         // Check if this node or any of its children existed in cache previously.
         // If so, then remove them from cache and add those indices to stack.
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(nodeIndex, deltaStars);
+        return;
     }
 
     // Remove node if it has been unloaded while still in view.
@@ -1136,8 +1528,13 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
     if (node.bufferIndex != DEFAULT_INDEX && !node.isLoaded && _streamOctree &&
         !_datasetFitInMemory)
     {
-        fetchedData = removeNodeFromCache(node, deltaStars);
-        return fetchedData;
+        removeNodeFromCache(nodeIndex, deltaStars);
+        return;
+    }
+
+    // Visible nodes are the most recently used ones.
+    if (node.isLoaded && _streamOctree && !_datasetFitInMemory) {
+        touchStreamedNode(nodeIndex);
     }
 
     // Take care of inner nodes.
@@ -1156,27 +1553,24 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
             // we will overwrite the old data. Key merging is not a problem here.
             if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
                 // Return empty if we couldn't claim a buffer stream index.
-                if (!updateBufferIndex(node)) {
-                    return fetchedData;
+                NodeData data;
+                if (!updateBufferIndex(nodeIndex, data)) {
+                    return;
                 }
+                node.hasBufferedNodes = true;
 
                 // We're in an inner node, remove indices from potential children in cache
-                for (int i = 0; i < 8; ++i) {
-                    std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                        *node.Children[i],
-                        deltaStars
-                    );
-                    fetchedData.insert(tmpData.begin(), tmpData.end());
+                for (size_t i = 0; i < 8; ++i) {
+                    removeNodeFromCache(childIndex(nodeIndex, i), deltaStars);
                 }
 
                 // Insert data and adjust stars added in this frame.
-                fetchedData[node.bufferIndex] = constructInsertData(
-                    node,
-                    option,
-                    deltaStars
+                addUploadCommand(
+                    node.bufferIndex,
+                    constructInsertData(nodeIndex, std::move(data), option, deltaStars)
                 );
             }
-            return fetchedData;
+            return;
         }
     }
     // Return node data if node is a leaf.
@@ -1184,57 +1578,63 @@ std::map<int, std::vector<float>> OctreeManager::checkNodeIntersection(OctreeNod
         // If node already is in cache then skip it, otherwise store it.
         if ((node.bufferIndex == DEFAULT_INDEX) || _rebuildBuffer) {
             // Return empty if we couldn't claim a buffer stream index.
-            if (!updateBufferIndex(node)) {
-                return fetchedData;
+            NodeData data;
+            if (!updateBufferIndex(nodeIndex, data)) {
+                return;
             }
+            node.hasBufferedNodes = true;
 
             // Insert data and adjust stars added in this frame.
-            fetchedData[node.bufferIndex] = constructInsertData(
-                node,
-                option,
-                deltaStars
+            addUploadCommand(
+                node.bufferIndex,
+                constructInsertData(nodeIndex, std::move(data), option, deltaStars)
             );
         }
-        return fetchedData;
+        return;
     }
 
     // We're in a big, visible inner node -> remove it from cache if it existed.
     // But not its children -> set recursive check to false.
-    fetchedData = removeNodeFromCache(node, deltaStars, false);
+    removeNodeFromCache(nodeIndex, deltaStars, false);
 
     // Recursively check if children should be rendered.
+    bool hasBufferedChildren = false;
     for (size_t i = 0; i < 8; ++i) {
-        // Observe that if there exists identical keys in fetchedData then those values in
-        // tmpData will be ignored! Thus we store the removed keys until next render call!
-        std::map<int, std::vector<float>> tmpData = checkNodeIntersection(
-            *node.Children[i],
+        checkNodeIntersection(
+            childIndex(nodeIndex, i),
             mvp,
             screenSize,
             deltaStars,
             option
         );
-        fetchedData.insert(tmpData.begin(), tmpData.end());
+        hasBufferedChildren |= octreeNode(childIndex(nodeIndex, i)).hasBufferedNodes;
     }
-    return fetchedData;
+    node.hasBufferedNodes = hasBufferedChildren;
 }
 
-std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode& node,
-                                                                     int& deltaStars,
-                                                                     bool recursive)
+void OctreeManager::removeNodeFromCache(NodeIndex nodeIndex, int& deltaStars,
+                                        bool recursive)
 {
-    std::map<int, std::vector<float>> keysToRemove;
+    OctreeNode& node = octreeNode(nodeIndex);
+
+    // Nodes that stayed outside of the view since they were last removed don't have to
+    // be checked again.
+    if (!node.hasBufferedNodes) {
+        return;
+    }
+    _traversalStats.nRemovalChecks++;
 
     // If we're in rebuilding mode then there is no need to remove any nodes.
-    //if (_rebuildBuffer) return keysToRemove;
+    //if (_rebuildBuffer) return;
 
     // Check if this node was rendered == had a specified index.
     if (node.bufferIndex != DEFAULT_INDEX) {
 
         // Reclaim that index. We need to wait until next render call to use it again!
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        reclaimBufferIndex(node.bufferIndex);
 
         // Insert dummy node at offset index that should be removed from render.
-        keysToRemove[node.bufferIndex] = std::vector<float>();
+        addUploadCommand(node.bufferIndex, NodeData());
 
         // Reset index and adjust stars removed this frame.
         node.bufferIndex = DEFAULT_INDEX;
@@ -1243,36 +1643,103 @@ std::map<int, std::vector<float>> OctreeManager::removeNodeFromCache(OctreeNode&
 
     // Check children recursively if we're in an inner node.
     if (!(node.isLeaf) && recursive) {
-        for (int i = 0; i < 8; ++i) {
-            std::map<int, std::vector<float>> tmpData = removeNodeFromCache(
-                *node.Children[i],
-                deltaStars
-            );
-            keysToRemove.insert(tmpData.begin(), tmpData.end());
+        for (size_t i = 0; i < 8; ++i) {
+            removeNodeFromCache(childIndex(nodeIndex, i), deltaStars);
         }
     }
-    return keysToRemove;
+    if (node.isLeaf || recursive) {
+        node.hasBufferedNodes = false;
+    }
 }
 
-std::vector<float> OctreeManager::getNodeData(const OctreeNode& node,
+void OctreeManager::addUploadCommand(int bufferIndex, NodeData data) {
+    if (static_cast<size_t>(bufferIndex) >= _uploadCommandSlots.size()) {
+        _uploadCommandSlots.resize(static_cast<size_t>(bufferIndex) + 1, -1);
+        _traversalStats.nAllocations++;
+    }
+
+    int& slot = _uploadCommandSlots[bufferIndex];
+    if (slot != -1) {
+        // The chunk may have been cleared and claimed by another node in the same call
+        // while rebuilding the buffer. The data of the new owner takes precedence.
+        if (data.nStars > 0) {
+            _uploadCommands[slot].data = std::move(data);
+        }
+        return;
+    }
+
+    if (_uploadCommands.size() == _uploadCommands.capacity()) {
+        _traversalStats.nAllocations++;
+    }
+    slot = static_cast<int>(_uploadCommands.size());
+    _uploadCommands.push_back({ bufferIndex, std::move(data) });
+}
+
+void OctreeManager::reclaimBufferIndex(int bufferIndex) {
+    if (_removedKeysInPrevCall.size() == _removedKeysInPrevCall.capacity()) {
+        _traversalStats.nAllocations++;
+    }
+    _removedKeysInPrevCall.push_back(bufferIndex);
+}
+
+std::vector<float> OctreeManager::getNodeData(NodeIndex nodeIndex,
                                               gaia::RenderOption option)
 {
     // Return node data if node is a leaf.
-    if (node.isLeaf) {
+    if (octreeNode(nodeIndex).isLeaf) {
+        NodeData view;
+        {
+            std::lock_guard lock(nodePayload(nodeIndex).loadingLock);
+            view = nodeData(nodeIndex);
+        }
         int dStars = 0;
-        return constructInsertData(node, option, dStars);
+        NodeData data = constructInsertData(nodeIndex, std::move(view), option, dStars);
+
+        // Fill chunk by appending zeroes if we're using VBOs.
+        auto nodeData = std::vector<float>(
+            data.positions,
+            data.positions + data.nStars * POS_SIZE
+        );
+        if (_useVBO) {
+            nodeData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
+        }
+        if (data.colors) {
+            nodeData.insert(
+                nodeData.end(),
+                data.colors,
+                data.colors + data.nStars * COL_SIZE
+            );
+            if (_useVBO) {
+                nodeData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
+            }
+        }
+        if (data.velocities) {
+            nodeData.insert(
+                nodeData.end(),
+                data.velocities,
+                data.velocities + data.nStars * VEL_SIZE
+            );
+            if (_useVBO) {
+                nodeData.resize(
+                    (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
+                );
+            }
+        }
+        return nodeData;
     }
 
     // If we're not in a leaf, get data from all children recursively.
     auto nodeData = std::vector<float>();
     for (size_t i = 0; i < 8; ++i) {
-        std::vector<float> tmpData = getNodeData(*node.Children[i], option);
+        std::vector<float> tmpData = getNodeData(childIndex(nodeIndex, i), option);
         nodeData.insert(nodeData.end(), tmpData.begin(), tmpData.end());
     }
     return nodeData;
 }
 
-void OctreeManager::clearNodeData(OctreeNode& node) {
+void OctreeManager::clearNodeData(NodeIndex nodeIndex) {
+    NodePayload& node = nodePayload(nodeIndex);
+
     // Clear data and its allocated memory.
     node.posData.clear();
     node.posData.shrink_to_fit();
@@ -1280,70 +1747,87 @@ void OctreeManager::clearNodeData(OctreeNode& node) {
     node.colData.shrink_to_fit();
     node.velData.clear();
     node.velData.shrink_to_fit();
+    {
+        std::lock_guard lock(node.loadingLock);
+        node.streamedData = NodeData();
+    }
 
     // Clear magnitudes as well!
     //std::vector<std::pair<float, size_t>>().swap(node->magOrder);
     node.magOrder.clear();
 
-    if (!node.isLeaf) {
+    if (!octreeNode(nodeIndex).isLeaf) {
         // Remove data from all children recursively.
         for (size_t i = 0; i < 8; ++i) {
-            clearNodeData(*node.Children[i]);
+            clearNodeData(childIndex(nodeIndex, i));
         }
     }
 }
 
-void OctreeManager::createNodeChildren(OctreeNode& node) {
+void OctreeManager::createNodeChildren(NodeIndex nodeIndex) {
+    Branch& branch = _branches[nodeIndex >> BranchShift];
+    const size_t firstChild = branch.nodes.size();
+    if (firstChild + 8 > LocalIndexMask) {
+        throw ghoul::RuntimeError(fmt::format(
+            "Too many nodes in branch {} of octree", nodeIndex >> BranchShift
+        ));
+    }
+
+    // Copy the parent as growing the arena may move it.
+    const OctreeNode parent = octreeNode(nodeIndex);
+    const unsigned long long parentId = nodePayload(nodeIndex).octreePositionIndex;
+
     for (size_t i = 0; i < 8; ++i) {
         _numLeafNodes++;
-        node.Children[i] = std::make_shared<OctreeNode>();
-        node.Children[i]->isLeaf = true;
-        node.Children[i]->isLoaded = false;
-        node.Children[i]->hasLoadedDescendant = false;
-        node.Children[i]->bufferIndex = DEFAULT_INDEX;
-        node.Children[i]->octreePositionIndex = (node.octreePositionIndex * 10) + i;
-        node.Children[i]->numStars = 0;
-        node.Children[i]->posData = std::vector<float>();
-        node.Children[i]->colData = std::vector<float>();
-        node.Children[i]->velData = std::vector<float>();
-        node.Children[i]->magOrder = std::vector<std::pair<float, size_t>>();
-        node.Children[i]->halfDimension = node.halfDimension / 2.f;
+        OctreeNode& child = branch.nodes.emplace_back();
+        child.bufferIndex = DEFAULT_INDEX;
+        child.halfDimension = parent.halfDimension / 2.f;
 
         // Calculate new origin.
-        node.Children[i]->originX = node.originX;
-        node.Children[i]->originX += (i % 2 == 0) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originY = node.originY;
-        node.Children[i]->originY += (i % 4 < 2) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
-        node.Children[i]->originZ = node.originZ;
-        node.Children[i]->originZ += (i < 4) ?
-            node.Children[i]->halfDimension :
-            -node.Children[i]->halfDimension;
+        child.originX = parent.originX;
+        child.originX += (i % 2 == 0) ? child.halfDimension : -child.halfDimension;
+        child.originY = parent.originY;
+        child.originY += (i % 4 < 2) ? child.halfDimension : -child.halfDimension;
+        child.originZ = parent.originZ;
+        child.originZ += (i < 4) ? child.halfDimension : -child.halfDimension;
+
+        NodePayload& payload = branch.payloads.emplace_back();
+        payload.octreePositionIndex = (parentId * 10) + i;
     }
 
     // Clean up parent.
+    OctreeNode& node = octreeNode(nodeIndex);
+    node.firstChild = static_cast<NodeIndex>(firstChild);
     node.isLeaf = false;
     _numLeafNodes--;
     _numInnerNodes++;
 }
 
-bool OctreeManager::updateBufferIndex(OctreeNode& node) {
+bool OctreeManager::updateBufferIndex(NodeIndex nodeIndex, NodeData& data) {
+    OctreeNode& node = octreeNode(nodeIndex);
     if (node.bufferIndex != DEFAULT_INDEX) {
         // If we're rebuilding Buffer Index Cache then store indices to overwrite later.
-        _removedKeysInPrevCall.insert(node.bufferIndex);
+        reclaimBufferIndex(node.bufferIndex);
     }
 
     // Make sure node isn't loading/unloading as we're checking isLoaded flag.
-    std::lock_guard lock(node.loadingLock);
+    std::lock_guard lock(nodePayload(nodeIndex).loadingLock);
 
     // Return false if there are no more spots in our buffer, or if we're streaming and
     // node isn't loaded yet, or if node doesn't have any stars.
     if (_freeSpotsInBuffer.empty() || (_streamOctree && !node.isLoaded) ||
         node.numStars == 0)
     {
+        // Try again in the next traversal if the node didn't fit in the buffer.
+        _hasUnplacedNodes |= _freeSpotsInBuffer.empty() && node.numStars > 0;
+        return false;
+    }
+
+    // Nodes are unloaded on the task scheduler, so the view of the data has to be taken
+    // under the same lock as the check above. A chunk is only claimed for a node that
+    // has data to upload.
+    data = nodeData(nodeIndex);
+    if (data.nStars == 0) {
         return false;
     }
 
@@ -1361,39 +1845,43 @@ bool OctreeManager::updateBufferIndex(OctreeNode& node) {
     return true;
 }
 
-std::vector<float> OctreeManager::constructInsertData(const OctreeNode& node,
-                                                      gaia::RenderOption option,
-                                                      int& deltaStars)
+OctreeManager::NodeData OctreeManager::nodeData(NodeIndex nodeIndex) const {
+    const NodePayload& node = nodePayload(nodeIndex);
+    if (node.streamedData.owner) {
+        // The copy of the view keeps the streamed data alive after the node is unloaded
+        return node.streamedData;
+    }
+
+    NodeData data;
+    data.positions = node.posData.data();
+    data.colors = node.colData.data();
+    data.velocities = node.velData.data();
+    data.nStars = node.posData.size() / POS_SIZE;
+    return data;
+}
+
+OctreeManager::NodeData OctreeManager::constructInsertData(NodeIndex nodeIndex,
+                                                           NodeData data,
+                                                           gaia::RenderOption option,
+                                                           int& deltaStars)
 {
     // Return early if node doesn't contain any stars!
-    if (node.numStars == 0) {
-        return std::vector<float>();
+    const OctreeNode& node = octreeNode(nodeIndex);
+    if (node.numStars == 0 || data.nStars == 0) {
+        return NodeData();
     }
 
-    // Fill chunk by appending zeroes to data so we overwrite possible earlier values.
-    // And more importantly so our attribute pointers knows where to read!
-    auto insertData = std::vector<float>(node.posData.begin(), node.posData.end());
-    if (_useVBO) {
-        insertData.resize(POS_SIZE * MAX_STARS_PER_NODE, 0.f);
+    // Only reference the attributes that are used by the render option.
+    if (option == gaia::RenderOption::Static) {
+        data.colors = nullptr;
     }
-    if (option != gaia::RenderOption::Static) {
-        insertData.insert(insertData.end(), node.colData.begin(), node.colData.end());
-        if (_useVBO) {
-            insertData.resize((POS_SIZE + COL_SIZE) * MAX_STARS_PER_NODE, 0.f);
-        }
-        if (option == gaia::RenderOption::Motion) {
-            insertData.insert(insertData.end(), node.velData.begin(), node.velData.end());
-            if (_useVBO) {
-                insertData.resize(
-                    (POS_SIZE + COL_SIZE + VEL_SIZE) * MAX_STARS_PER_NODE, 0.f
-                );
-            }
-        }
+    if (option != gaia::RenderOption::Motion) {
+        data.velocities = nullptr;
     }
 
     // Update deltaStars.
     deltaStars += static_cast<int>(node.numStars);
-    return insertData;
+    return data;
 }
 
 }  // namespace openspace
@@ -26,9 +26,13 @@
 #define __OPENSPACE_MODULE_GAIA___OCTREEMANAGER___H__
 
 #include <modules/gaia/rendering/gaiaoptions.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/glm.h>
 #include <ghoul/opengl/ghoul_gl.h>
-#include <map>
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <queue>
 #include <stack>
@@ -40,23 +44,46 @@ class OctreeCuller;
 
 class OctreeManager {
 public:
-    struct OctreeNode {
-        std::shared_ptr<OctreeNode> Children[8];
-        std::vector<float> posData;
-        std::vector<float> colData;
-        std::vector<float> velData;
-        std::vector<std::pair<float, size_t>> magOrder;
-        float originX;
-        float originY;
-        float originZ;
-        float halfDimension;
-        size_t numStars;
-        bool isLeaf;
-        bool isLoaded;
-        bool hasLoadedDescendant;
-        std::mutex loadingLock;
+    /**
+     * Non-owning view of the star data in one node that should be inserted into the
+     * stream buffer. Values are grouped per attribute, i.e. all positions are followed by
+     * all colors and all velocities. Attributes that are not used by the current render
+     * option are <code>nullptr</code>, and a view without stars marks a chunk that should
+     * be cleared. If the data was streamed from a node file then \c owner keeps the
+     * memory mapping or the buffer it was read into alive, even if the node is unloaded
+     * before the data has been uploaded.
+     */
+    struct NodeData {
+        const float* positions = nullptr;
+        const float* colors = nullptr;
+        const float* velocities = nullptr;
+        size_t nStars = 0;
+        std::shared_ptr<const void> owner;
+    };
+
+    /**
+     * Update of the chunk with index \c bufferIndex in the stream buffer. A command with
+     * an empty view marks a chunk that should be cleared.
+     */
+    struct UploadCommand {
         int bufferIndex;
-        unsigned long long octreePositionIndex;
+        NodeData data;
+    };
+
+    /**
+     * Statistics for the latest call to <code>traverseData()</code>.
+     */
+    struct TraversalStats {
+        // Number of nodes that were tested against the view frustum.
+        size_t nVisitedNodes = 0;
+        // Number of nodes that were checked for chunks that should be cleared.
+        size_t nRemovalChecks = 0;
+        // Number of chunks that should be updated in the stream buffer.
+        size_t nUploadCommands = 0;
+        // Number of times the traversal had to allocate memory on the heap.
+        size_t nAllocations = 0;
+        // True if the traversal was skipped as nothing had changed since the last call.
+        bool skipped = false;
     };
 
     OctreeManager() = default;
@@ -85,6 +112,20 @@ public:
      */
     void insert(const std::vector<float>& starValues);
 
+    /**
+     * Inserts the star whose render values start at \param starValues. Stars that belong
+     * to different branches (see <code>branchIndex()</code>) may be inserted from
+     * different threads concurrently, as long as every branch is only built by one
+     * thread at a time.
+     */
+    void insert(const float* starValues);
+
+    /**
+     * \returns the index of the top level branch in which a star at the specified
+     * position will be inserted.
+     */
+    size_t branchIndex(float posX, float posY, float posZ) const;
+
     /**
      * Slices LOD data so only the MAX_STARS_PER_NODE brightest stars are stored in inner
      * nodes. If \p branchIndex is defined then only that branch will be sliced.
@@ -102,8 +143,11 @@ public:
     /**
      * Used while streaming nodes from files. Checks if any nodes need to be loaded or
      * unloaded. If entire dataset fits in RAM then the whole dataset will be loaded
-     * asynchronously. Otherwise only nodes close to the camera will be fetched.
-     * When RAM stars to fill up least-recently used nodes will start to unload.
+     * asynchronously. Otherwise nodes close to the camera, and nodes along the
+     * extrapolated path of the camera, will be prefetched in order of how soon and how
+     * large they are expected to be seen. Loads run on the shared task scheduler.
+     * When RAM stars to fill up the nodes with the lowest cost-aware LRU priority will
+     * start to unload.
      * Calls <code>findAndFetchNeighborNode()</code> and
      * <code>removeNodesFromRam()</code> internally.
      */
@@ -111,17 +155,26 @@ public:
         const glm::ivec2& additionalNodes);
 
     /**
-     * Builds render data structure by traversing the Octree and checking for intersection
-     * with view frustum. Every vector in map contains data for one node.
-     * The corresponding integer key is the index where chunk should be inserted into
-     * streaming buffer. Calls <code>checkNodeIntersection()</code> for every branch.
+     * Updates the set of nodes in the stream buffer by traversing the Octree and checking
+     * for intersection with view frustum. Only nodes that entered or left the buffer
+     * since the last call end up in the returned list, and the traversal is skipped
+     * entirely if neither the view nor the loaded nodes have changed. Otherwise only the
+     * visible nodes down to the LOD cut and the subtrees that still have chunks in the
+     * buffer are visited. The list is owned by the manager and reused between calls, so
+     * it is only valid until the next call.
+     * Calls <code>checkNodeIntersection()</code> for every branch.
      * \pdeltaStars keeps track of how many stars that were added/removed this render
      * call.
      */
-    std::map<int, std::vector<float>> traverseData(const glm::dmat4& mvp,
+    const std::vector<UploadCommand>& traverseData(const glm::dmat4& mvp,
         const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option,
         float lodPixelThreshold);
 
+    /**
+     * \returns statistics for the latest call to <code>traverseData()</code>.
+     */
+    const TraversalStats& traversalStats() const;
+
     /**
      * Builds full render data structure by traversing all leaves in the Octree.
      */
@@ -177,9 +230,87 @@ public:
     long long cpuRamBudget() const;
 
 private:
-    const size_t POS_SIZE = 3;
-    const size_t COL_SIZE = 2;
-    const size_t VEL_SIZE = 3;
+    /**
+     * Nodes are addressed by their index in the arena of their top level branch, with
+     * the index of the branch stored in the upper bits. The root is not stored in any
+     * arena and has its own index.
+     */
+    using NodeIndex = uint32_t;
+    static constexpr NodeIndex RootIndex = 0xFFFFFFFF;
+    static constexpr unsigned int BranchShift = 29;
+    static constexpr NodeIndex LocalIndexMask = (1u << BranchShift) - 1;
+
+    /**
+     * The fields of a node that are needed when traversing the Octree. The eight children
+     * of a node are stored next to each other in the arena, so the node only stores the
+     * index of its first child.
+     */
+    struct OctreeNode {
+        float originX = 0.f;
+        float originY = 0.f;
+        float originZ = 0.f;
+        float halfDimension = 0.f;
+        size_t numStars = 0;
+        NodeIndex firstChild = 0;
+        int bufferIndex = -1;
+        bool isLeaf = true;
+        bool isLoaded = false;
+        bool hasLoadedDescendant = false;
+        // Set if this node or any of its descendants might have a chunk in the stream
+        // buffer. Subtrees without any chunks are skipped when removing nodes.
+        bool hasBufferedNodes = false;
+    };
+
+    /**
+     * The star data and streaming state of a node, stored with the same index as the
+     * node but separate from the traversal fields.
+     */
+    struct NodePayload {
+        std::vector<float> posData;
+        std::vector<float> colData;
+        std::vector<float> velData;
+        std::vector<std::pair<float, size_t>> magOrder;
+        unsigned long long octreePositionIndex = 0;
+        // Set if the node data was streamed from a node file. The star data is then read
+        // from the memory mapping or the buffer that is owned by the view instead of from
+        // the vectors above, so that unloading the node never frees data that is still
+        // referenced by an upload. Guarded by loadingLock.
+        NodeData streamedData;
+        mutable std::mutex loadingLock;
+        // Priority for the cost-aware LRU eviction of streamed nodes.
+        std::atomic<double> evictionPriority = 0.0;
+        // Set while a fetch of the children of this node is queued or running.
+        std::atomic<bool> isPrefetchScheduled = false;
+    };
+
+    /**
+     * A queued fetch of the children of a node. Requests with a higher priority are
+     * fetched first.
+     */
+    struct PrefetchRequest {
+        float priority;
+        NodeIndex nodeIndex;
+        int additionalLevelsToFetch;
+
+        bool operator<(const PrefetchRequest& rhs) const {
+            return priority < rhs.priority;
+        }
+    };
+
+    /**
+     * Arena for all nodes in one top level branch, in the order they were created. The
+     * first node is the top node of the branch. Payloads are kept in a deque so that
+     * references to them stay valid while the branch is growing. Every branch has its
+     * own arena so that the branches can be constructed concurrently.
+     */
+    struct Branch {
+        std::vector<OctreeNode> nodes;
+        std::deque<NodePayload> payloads;
+    };
+
+    static constexpr size_t POS_SIZE = 3;
+    static constexpr size_t COL_SIZE = 2;
+    static constexpr size_t VEL_SIZE = 3;
 
     // MAX_DIST [kPc] - Determines the depth of Octree together with MAX_STARS_PER_NODE.
     // A smaller distance is better (i.e. a smaller total depth) and a smaller MAX_STARS
@@ -198,12 +329,30 @@ private:
 
     const int DEFAULT_INDEX = -1;
     const std::string BINARY_SUFFIX = ".bin";
+    const std::string NODE_SUFFIX = ".node";
 
     /**
      * \returns the correct index of child node. Maps [1,1,1] to 0 and [-1,-1,-1] to 7.
      */
     size_t getChildIndex(float posX, float posY, float posZ, float origX = 0.f,
-        float origY = 0.f, float origZ = 0.f);
+        float origY = 0.f, float origZ = 0.f) const;
+
+    /**
+     * \returns the node with index \param nodeIndex.
+     */
+    OctreeNode& octreeNode(NodeIndex nodeIndex);
+    const OctreeNode& octreeNode(NodeIndex nodeIndex) const;
+
+    /**
+     * \returns the payload of the node with index \param nodeIndex.
+     */
+    NodePayload& nodePayload(NodeIndex nodeIndex);
+    const NodePayload& nodePayload(NodeIndex nodeIndex) const;
+
+    /**
+     * \returns the index of child \param child of the inner node \param nodeIndex.
+     */
+    NodeIndex childIndex(NodeIndex nodeIndex, size_t child) const;
 
     /**
      * Private help function for <code>insert()</code>. Inserts star into node if leaf and
@@ -212,28 +361,26 @@ private:
      * If node is an inner node, then star is stores in LOD cache if it is among the
      * brightest stars in all children.
      */
-    bool insertInNode(OctreeNode& node, const std::vector<float>& starValues,
-        int depth = 1);
+    bool insertInNode(NodeIndex nodeIndex, const float* starValues, int depth = 1);
 
     /**
      * Slices LOD cache data in node to the MAX_STARS_PER_NODE brightest stars. This needs
      * to be called after the last star has been inserted into Octree but before it is
      * saved to file(s). Slices all descendants recursively.
      */
-    void sliceNodeLodCache(OctreeNode& node);
+    void sliceNodeLodCache(NodeIndex nodeIndex);
 
     /**
      * Private help function for <code>insertInNode()</code>. Stores star data in node and
      * keeps track of the brightest stars all children.
      */
-    void storeStarData(OctreeNode& node, const std::vector<float>& starValues);
+    void storeStarData(NodeIndex nodeIndex, const float* starValues);
 
     /**
      * Private help function for <code>printStarsPerNode()</code>. \returns an accumulated
      * string containing all descendant nodes.
      */
-    std::string printStarsPerNode(const OctreeNode& node,
-        const std::string& prefix) const;
+    std::string printStarsPerNode(NodeIndex nodeIndex, const std::string& prefix) const;
 
     /**
      * Private help function for <code>traverseData()</code>. Recursively checks which
@@ -242,56 +389,80 @@ private:
      * loaded (if streaming). \param deltaStars keeps track of how many stars that were
      * added/removed this render call.
      */
-    std::map<int, std::vector<float>> checkNodeIntersection(OctreeNode& node,
-        const glm::dmat4& mvp, const glm::vec2& screenSize, int& deltaStars,
-        gaia::RenderOption option);
+    void checkNodeIntersection(NodeIndex nodeIndex, const glm::dmat4& mvp,
+        const glm::vec2& screenSize, int& deltaStars, gaia::RenderOption option);
 
     /**
      * Checks if specified node existed in cache, and removes it if that's the case.
      * If node is an inner node then all children will be checked recursively as well as
      * long as \param recursive is not set to false. \param deltaStars keeps track of how
-     * many stars that were removed.
+     * many stars that were removed. Subtrees without any nodes in the cache are skipped.
      */
-    std::map<int, std::vector<float>> removeNodeFromCache(OctreeNode& node,
-        int& deltaStars, bool recursive = true);
+    void removeNodeFromCache(NodeIndex nodeIndex, int& deltaStars,
+        bool recursive = true);
+
+    /**
+     * Adds a command to update chunk \param bufferIndex with \param data to the upload
+     * list. If the chunk already has a command then a view with stars replaces it, as
+     * a chunk may be cleared and claimed by another node in the same call.
+     */
+    void addUploadCommand(int bufferIndex, NodeData data);
+
+    /**
+     * Stores \param bufferIndex so that it can be reused from the next call to
+     * <code>traverseData()</code>.
+     */
+    void reclaimBufferIndex(int bufferIndex);
 
     /**
      * Get data in node and its descendants regardless if they are visible or not.
      */
-    std::vector<float> getNodeData(const OctreeNode& node, gaia::RenderOption option);
+    std::vector<float> getNodeData(NodeIndex nodeIndex, gaia::RenderOption option);
 
     /**
      * Clear data from node and its descendants and shrink vectors to deallocate memory.
      */
-    void clearNodeData(OctreeNode& node);
+    void clearNodeData(NodeIndex nodeIndex);
 
     /**
-     * Contruct default children nodes for specified node.
+     * Contruct default children nodes for specified node. The children are appended to
+     * the arena of the branch, which invalidates references to nodes in that branch.
      */
-    void createNodeChildren(OctreeNode& node);
+    void createNodeChildren(NodeIndex nodeIndex);
 
     /**
      * Checks if node should be inserted into stream or not. \returns true if it should,
      * (i.e. it doesn't already exists, there is room for it in the buffer and node data
-     * is loaded if streaming). \returns false otherwise.
+     * is loaded if streaming). \returns false otherwise. If the node is inserted,
+     * \param data is set to the view of its star data. The view is taken while holding
+     * the same lock as the check, so the node can't be unloaded in between.
      */
-    bool updateBufferIndex(OctreeNode& node);
+    bool updateBufferIndex(NodeIndex nodeIndex, NodeData& data);
 
     /**
-     * Node should be inserted into stream. This function \returns the data to be
-     * inserted. If VBOs are used then the chunks will be appended by zeros, otherwise
-     * only the star data corresponding to RenderOption \param option will be inserted.
+     * \returns a view of the star data in \param node, regardless of whether the data is
+     * stored in the node vectors or was streamed from a node file. Streamed data is kept
+     * alive by the returned view. The <code>loadingLock</code> of the node has to be held
+     * while calling this function.
+     */
+    NodeData nodeData(NodeIndex nodeIndex) const;
+
+    /**
+     * Node should be inserted into stream. This function \returns the view \param data
+     * of the star data in the node, reduced to the star data corresponding to
+     * RenderOption \param option. No data is copied; if VBOs are used then it is up to
+     * the caller to fill the rest of the chunks with zeros.
      *
      * \param deltaStars keeps track of how many stars that were added.
      */
-    std::vector<float> constructInsertData(const OctreeNode& node,
+    NodeData constructInsertData(NodeIndex nodeIndex, NodeData data,
         gaia::RenderOption option, int& deltaStars);
 
     /**
      * Write a node to outFileStream. \param writeData defines if data should be included
      * or if only structure should be written.
      */
-    void writeNodeToFile(std::ofstream& outFileStream, const OctreeNode& node,
+    void writeNodeToFile(std::ofstream& outFileStream, NodeIndex nodeIndex,
         bool writeData);
 
     /**
@@ -299,21 +470,24 @@ private:
      * data or only structure should be read.
      * \returns accumulated sum of all read stars in node and its descendants.
      */
-    int readNodeFromFile(std::ifstream& inFileStream, OctreeNode& node, bool readData);
+    int readNodeFromFile(std::ifstream& inFileStream, NodeIndex nodeIndex,
+        bool readData);
 
     /**
-     * Write node data to a file. \param outFilePrefix specifies the accumulated path
-     * and name of the file. If \param threadWrites is set to true then one new thread
-     * will be created for each child to write its descendents.
+     * Write node data to a file in the memory mappable node file format.
+     * \param outFilePrefix specifies the accumulated path and name of the file. If
+     * \param threadWrites is set to true then one new thread will be created for each
+     * child to write its descendents.
      */
-    void writeNodeToMultipleFiles(const std::string& outFilePrefix, OctreeNode& node,
+    void writeNodeToMultipleFiles(const std::string& outFilePrefix, NodeIndex nodeIndex,
         bool threadWrites);
 
     /**
      * Finds the neighboring node on the same level (or a higher level if there is no
-     * corresponding level) in the specified direction. Also fetches data from found node
-     * if it's not already loaded. \param additionalLevelsToFetch determines if any
-     * descendants of the found node should be fetched as well (if they exists).
+     * corresponding level) in the specified direction. Also schedules a fetch of the
+     * data in the found node if it's not already loaded.
+     * \param additionalLevelsToFetch determines if any descendants of the found node
+     * should be fetched as well (if they exists).
      */
     void findAndFetchNeighborNode(unsigned long long firstParentId, int x, int y, int z,
         int additionalLevelsToFetch);
@@ -326,14 +500,67 @@ private:
      * If it is set to a negative value then all descendants will be fetched recursively.
      * Calls <code>fetchNodeDataFromFile()</code> for every child that passes the tests.
      */
-    void fetchChildrenNodes(OctreeNode& parentNode, int additionalLevelsToFetch);
+    void fetchChildrenNodes(NodeIndex parentIndex, int additionalLevelsToFetch);
 
     /**
-     * Fetches data for specified node from file.
+     * Fetches data for specified node from file. Node files in the memory mappable
+     * format are mapped and used in place, otherwise the data is read from a node file
+     * in the original binary format.
      * OBS! Only call if node file exists (i.e. node has any data, node->numStars > 0)
      * and is not already loaded.
      */
-    void fetchNodeDataFromFile(OctreeNode& node);
+    void fetchNodeDataFromFile(NodeIndex nodeIndex);
+
+    /**
+     * Maps the node file at \param filePath. \returns a view of the star data in the
+     * mapping, or an empty view if the file doesn't exist or isn't a valid node file.
+     */
+    NodeData mapNodeFile(NodeIndex nodeIndex, const std::string& filePath);
+
+    /**
+     * Reads the node file in the original binary format at \param filePath into a new
+     * buffer. \returns a view of the star data that owns the buffer, or an empty view if
+     * the file couldn't be read.
+     */
+    NodeData readLegacyNodeFile(const std::string& filePath);
+
+    /**
+     * \returns the parent of the leaf that contains \param position, given in the same
+     * units as the node origins. If \param markLoadedDescendants is true then all inner
+     * nodes on the way are flagged to have loaded descendants.
+     */
+    NodeIndex findParentOfLeaf(const glm::vec3& position, bool markLoadedDescendants);
+
+    /**
+     * Queues a fetch of the children of \param nodeIndex, and
+     * \param additionalLevelsToFetch levels of their descendants, unless the node is
+     * already queued. \param framesAhead is the number of frames until the camera is
+     * expected to reach the node.
+     */
+    void schedulePrefetch(NodeIndex nodeIndex, int additionalLevelsToFetch,
+        float framesAhead);
+
+    /**
+     * Starts the queued fetches with the highest priority on the task scheduler, as long
+     * as there are less than the maximum number of fetches in flight.
+     */
+    void dispatchPrefetches();
+
+    /**
+     * Removes all fetches that haven't been started yet from the queue.
+     */
+    void clearPrefetchQueue();
+
+    /**
+     * Updates the eviction priority of a loaded node that is in use.
+     */
+    void touchStreamedNode(NodeIndex nodeIndex);
+
+    /**
+     * Selects \param nNodes loaded nodes with the lowest eviction priority and removes
+     * them from the list of loaded nodes. \returns the position indices of the nodes.
+     */
+    std::vector<unsigned long long> selectNodesToEvict(size_t nNodes);
 
     /**
     * Loops though all nodes in \param nodesToRemove and clears them from RAM.
@@ -346,25 +573,43 @@ private:
      * Removes data in specified node from main memory and updates RAM budget and flags
      * accordingly.
      */
-    void removeNode(OctreeNode& node);
+    void removeNode(NodeIndex nodeIndex);
 
     /**
      * Loops through \param ancestorNodes backwards and checks if parent node has any
      * loaded descendants left. If not, then flag <code>hasLoadedDescendant</code> will be
      * set to false for that parent node and next parent in line will be checked.
      */
-    void propagateUnloadedNodes(std::vector<std::shared_ptr<OctreeNode>> ancestorNodes);
+    void propagateUnloadedNodes(std::vector<NodeIndex> ancestorNodes);
 
-    std::shared_ptr<OctreeNode> _root;
+    OctreeNode _rootNode;
+    NodePayload _rootPayload;
+    std::array<Branch, 8> _branches;
     std::unique_ptr<OctreeCuller> _culler;
-    std::stack<int> _freeSpotsInBuffer;
-    std::set<int> _removedKeysInPrevCall;
-    std::queue<unsigned long long> _leastRecentlyFetchedNodes;
-    std::mutex _leastRecentlyFetchedNodesMutex;
-
-    size_t _totalDepth = 0;
-    size_t _numLeafNodes = 0;
-    size_t _numInnerNodes = 0;
+    std::stack<int, std::vector<int>> _freeSpotsInBuffer;
+    std::vector<int> _removedKeysInPrevCall;
+    std::vector<UploadCommand> _uploadCommands;
+    // Position of the command for every chunk in the upload list, or -1 if there is none.
+    std::vector<int> _uploadCommandSlots;
+    TraversalStats _traversalStats;
+    // Loaded nodes that may be evicted while streaming.
+    std::vector<NodeIndex> _streamedNodes;
+    std::mutex _streamedNodesMutex;
+    // Aging value of the cost-aware LRU, raised to the priority of every evicted node.
+    std::atomic<double> _evictionAge = 0.0;
+
+    std::priority_queue<PrefetchRequest> _prefetchQueue;
+    std::vector<unsigned long long> _predictedParentsOfCamera;
+    std::atomic<int> _nPrefetchesInFlight = 0;
+    std::atomic<bool> _isEvicting = false;
+    glm::vec3 _prefetchCameraPos = glm::vec3(0.f);
+    glm::vec3 _lastCameraPos = glm::vec3(0.f);
+    bool _hasLastCameraPos = false;
+
+    // Atomic as branches may be constructed concurrently.
+    std::atomic<size_t> _totalDepth = 0;
+    std::atomic<size_t> _numLeafNodes = 0;
+    std::atomic<size_t> _numInnerNodes = 0;
     size_t _biggestChunkIndexInUse = 0;
     size_t _valuesPerStar = 0;
     float _minTotalPixelsLod = 0.f;
@@ -374,12 +619,27 @@ private:
     bool _useVBO = false;
     bool _streamOctree = false;
     bool _datasetFitInMemory = false;
-    long long _cpuRamBudget = 0;
+    // Atomic as nodes are fetched and removed on the task scheduler.
+    std::atomic<bool> _useLegacyNodeFiles = false;
+    std::atomic<long long> _cpuRamBudget = 0;
     long long _maxCpuRamBudget = 0;
     unsigned long long _parentNodeOfCamera = 8;
     std::string _streamFolderPath;
     size_t _traversedBranchesInRenderCall = 0;
 
+    // State of the last traversal, used to skip traversals when nothing has changed.
+    glm::dmat4 _lastTraversalMvp = glm::dmat4(0.0);
+    glm::vec2 _lastTraversalScreenSize = glm::vec2(0.f);
+    gaia::RenderOption _lastTraversalOption = gaia::RenderOption::Static;
+    float _lastLodPixelThreshold = -1.f;
+    bool _hasUnplacedNodes = true;
+    std::atomic<bool> _loadedNodesChanged = true;
+
+    // Fetches and evictions that run on the task scheduler. Created when streaming
+    // starts. Declared last so that running fetches finish before any other member is
+    // destroyed.
+    std::unique_ptr<TaskGroup> _ioTasks;
+
 }; // class OctreeManager
 
 }  // namespace openspace
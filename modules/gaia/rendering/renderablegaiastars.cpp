@@ -33,6 +33,7 @@
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/rendering/renderengine.h>
+#include <openspace/rendering/renderqueue.h>
 #include <openspace/util/distanceconversion.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/fmt.h>
@@ -211,6 +212,14 @@ namespace {
         "The number of rendered stars in the current frame."
     };
 
+    constexpr openspace::properties::Property::PropertyInfo NumTraversalAllocationsInfo =
+    {
+        "NumTraversalAllocations",
+        "Traversal Allocations",
+        "The number of heap allocations made while traversing the octree in the current "
+        "frame. Stays at zero once the buffers have grown to their working size."
+    };
+
     constexpr openspace::properties::Property::PropertyInfo CpuRamBudgetInfo = {
         "CpuRamBudget",
         "CPU RAM Budget",
@@ -534,6 +543,7 @@ RenderableGaiaStars::RenderableGaiaStars(const ghoul::Dictionary& dictionary)
     , _lastRow(LastRowInfo, 0, 0, 2539913)
     , _columnNamesList(ColumnNamesInfo)
     , _nRenderedStars(NumRenderedStarsInfo, 0, 0, 2000000000) // 2 Billion stars
+    , _nTraversalAllocations(NumTraversalAllocationsInfo, 0, 0, 2000000000)
     , _cpuRamBudgetProperty(CpuRamBudgetInfo, 0.f, 0.f, 1.f)
     , _gpuStreamBudgetProperty(GpuStreamBudgetInfo, 0.f, 0.f, 1.f)
     , _reportGlErrors(ReportGlErrorsInfo, false)
@@ -851,6 +861,8 @@ RenderableGaiaStars::RenderableGaiaStars(const ghoul::Dictionary& dictionary)
     // Add a read-only property for the number of rendered stars per frame.
     _nRenderedStars.setReadOnly(true);
     addProperty(_nRenderedStars);
+    _nTraversalAllocations.setReadOnly(true);
+    addProperty(_nTraversalAllocations);
 
     // Add CPU RAM Budget Property and GPU Stream Budget Property to menu.
     _cpuRamBudgetProperty.setReadOnly(true);
@@ -1173,10 +1185,12 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         _cpuRamBudgetProperty = static_cast<float>(_octreeManager.cpuRamBudget());
     }
 
-    // Traverse Octree and build a map with new nodes to render, uses mvp matrix to decide
+    // Traverse Octree and get the chunks that changed since last frame, uses mvp matrix
+    // to decide
     const int renderOption = _renderOption;
     int deltaStars = 0;
-    std::map<int, std::vector<float>> updateData = _octreeManager.traverseData(
+    using UploadCommand = OctreeManager::UploadCommand;
+    const std::vector<UploadCommand>& updateData = _octreeManager.traverseData(
         modelViewProjMat,
         screenSize,
         deltaStars,
@@ -1187,10 +1201,21 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
     // Update number of rendered stars.
     _nStarsToRender += deltaStars;
     _nRenderedStars = _nStarsToRender;
+    _nTraversalAllocations = static_cast<int>(
+        _octreeManager.traversalStats().nAllocations
+    );
 
     // Update GPU Stream Budget property.
     _gpuStreamBudgetProperty = static_cast<float>(_octreeManager.numFreeSpotsInBuffer());
 
+    // The changed chunks are always uploaded as the buffers are orphaned every frame, but
+    // they count against the upload budget of the other streaming components
+    uint64_t nUploadedBytes = 0;
+    for (const auto& [offset, subData] : updateData) {
+        nUploadedBytes += subData.nStars * _nRenderValuesPerStar * sizeof(GLfloat);
+    }
+    global::renderEngine.renderQueue().registerUpload(nUploadedBytes);
+
     int nChunksToRender = static_cast<int>(_octreeManager.biggestChunkIndexInUse());
     int maxStarsPerNode = static_cast<int>(_octreeManager.maxStarsPerNode());
     int valuesPerStar = static_cast<int>(_nRenderValuesPerStar);
@@ -1210,8 +1235,7 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
 
         // Update vector with accumulated indices.
         for (const auto& [offset, subData] : updateData) {
-            int newValue = static_cast<int>(subData.size() / _nRenderValuesPerStar) +
-                           _accumulatedIndices[offset];
+            int newValue = static_cast<int>(subData.nStars) + _accumulatedIndices[offset];
             int changeInValue = newValue - _accumulatedIndices[offset + 1];
             _accumulatedIndices[offset + 1] = newValue;
             // Propagate change.
@@ -1246,18 +1270,27 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             GL_STREAM_DRAW
         );
 
-        // Update SSBO with one insert per chunk/node.
-        // The key in map holds the offset index.
+        // Update SSBO with one insert per attribute in every chunk/node, directly from
+        // the octree data. The command holds the offset index.
         for (const auto &[offset, subData] : updateData) {
             // We don't need to fill chunk with zeros for SSBOs!
             // Just check if we have any values to update.
-            if (!subData.empty()) {
-                glBufferSubData(
-                    GL_SHADER_STORAGE_BUFFER,
-                    offset * _chunkSize * sizeof(GLfloat),
-                    subData.size() * sizeof(GLfloat),
-                    subData.data()
-                );
+            if (subData.nStars == 0) {
+                continue;
+            }
+            GLintptr chunkOffset = offset * _chunkSize * sizeof(GLfloat);
+            const std::pair<const float*, size_t> attributes[] = {
+                { subData.positions, PositionSize },
+                { subData.colors, ColorSize },
+                { subData.velocities, VelocitySize }
+            };
+            for (const auto& [values, valuesPerStar] : attributes) {
+                if (!values) {
+                    continue;
+                }
+                GLsizeiptr nBytes = subData.nStars * valuesPerStar * sizeof(GLfloat);
+                glBufferSubData(GL_SHADER_STORAGE_BUFFER, chunkOffset, nBytes, values);
+                chunkOffset += nBytes;
             }
         }
 
@@ -1287,18 +1320,13 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
         );
 
         // Update buffer with one insert per chunk/node.
-        //The key in map holds the offset index.
+        //The command holds the offset index.
         for (const auto& [offset, subData] : updateData) {
-            // Fill chunk by appending zeroes so we overwrite possible earlier values.
-            // Only required when removing nodes because chunks are filled up in octree
-            // fetch on add.
-            std::vector<float> vectorData(subData.begin(), subData.end());
-            vectorData.resize(posChunkSize, 0.f);
-            glBufferSubData(
-                GL_ARRAY_BUFFER,
-                offset * posChunkSize * sizeof(GLfloat),
-                posChunkSize * sizeof(GLfloat),
-                vectorData.data()
+            uploadVboChunk(
+                offset * posChunkSize,
+                subData.positions,
+                subData.nStars * PositionSize,
+                posChunkSize
             );
         }
 
@@ -1320,16 +1348,13 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
             );
 
             // Update buffer with one insert per chunk/node.
-            //The key in map holds the offset index.
+            //The command holds the offset index.
             for (const auto& [offset, subData] : updateData) {
-                // Fill chunk by appending zeroes so we overwrite possible earlier values.
-                std::vector<float> vectorData(subData.begin(), subData.end());
-                vectorData.resize(posChunkSize + colChunkSize, 0.f);
-                glBufferSubData(
-                    GL_ARRAY_BUFFER,
-                    offset * colChunkSize * sizeof(GLfloat),
-                    colChunkSize * sizeof(GLfloat),
-                    vectorData.data() + posChunkSize
+                uploadVboChunk(
+                    offset * colChunkSize,
+                    subData.colors,
+                    subData.nStars * ColorSize,
+                    colChunkSize
                 );
             }
 
@@ -1352,16 +1377,13 @@ void RenderableGaiaStars::render(const RenderData& data, RendererTasks&) {
                 );
 
                 // Update buffer with one insert per chunk/node.
-                //The key in map holds the offset index.
+                //The command holds the offset index.
                 for (const auto& [offset, subData] : updateData) {
-                    // Fill chunk by appending zeroes.
-                    std::vector<float> vectorData(subData.begin(), subData.end());
-                    vectorData.resize(_chunkSize, 0.f);
-                    glBufferSubData(
-                        GL_ARRAY_BUFFER,
-                        offset * velChunkSize * sizeof(GLfloat),
-                        velChunkSize * sizeof(GLfloat),
-                        vectorData.data() + posChunkSize + colChunkSize
+                    uploadVboChunk(
+                        offset * velChunkSize,
+                        subData.velocities,
+                        subData.nStars * VelocitySize,
+                        velChunkSize
                     );
                 }
             }
@@ -1560,6 +1582,28 @@ void RenderableGaiaStars::checkGlErrors(const std::string& identifier) const {
     }
 }
 
+void RenderableGaiaStars::uploadVboChunk(size_t offset, const float* values,
+                                         size_t nValues, size_t chunkSize) const
+{
+    if (nValues > 0) {
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            offset * sizeof(GLfloat),
+            nValues * sizeof(GLfloat),
+            values
+        );
+    }
+    // Fill chunk with zeroes so we overwrite possible earlier values.
+    if (nValues < chunkSize) {
+        glBufferSubData(
+            GL_ARRAY_BUFFER,
+            (offset + nValues) * sizeof(GLfloat),
+            (chunkSize - nValues) * sizeof(GLfloat),
+            _chunkPadding.data()
+        );
+    }
+}
+
 void RenderableGaiaStars::update(const UpdateData&) {
     const int shaderOption = _shaderOption;
     const int renderOption = _renderOption;
@@ -1909,6 +1953,7 @@ void RenderableGaiaStars::update(const UpdateData&) {
 
         // Calculate memory budgets.
         _chunkSize = _octreeManager.maxStarsPerNode() * _nRenderValuesPerStar;
+        _chunkPadding = std::vector<float>(_chunkSize, 0.f);
         long long totalChunkSizeInBytes = _octreeManager.totalNodes() *
                                           _chunkSize * sizeof(GLfloat);
         _maxStreamingBudgetInBytes = std::min(
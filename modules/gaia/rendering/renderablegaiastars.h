@@ -115,6 +115,14 @@ private:
      */
     void checkGlErrors(const std::string& identifier) const;
 
+    /**
+     * Uploads \p nValues values into the currently bound array buffer, starting at the
+     * float index \p offset, and fills the rest of the chunk of size \p chunkSize with
+     * zeroes so that possible earlier values are overwritten.
+     */
+    void uploadVboChunk(size_t offset, const float* values, size_t nValues,
+        size_t chunkSize) const;
+
     properties::StringProperty _filePath;
     std::unique_ptr<ghoul::filesystem::File> _dataFile;
     bool _dataIsDirty = true;
@@ -158,6 +166,7 @@ private:
     properties::OptionProperty _renderOption;
     properties::OptionProperty _shaderOption;
     properties::IntProperty _nRenderedStars;
+    properties::IntProperty _nTraversalAllocations;
     // LongLongProperty doesn't show up in menu, use FloatProperty instead.
     properties::FloatProperty _cpuRamBudgetProperty;
     properties::FloatProperty _gpuStreamBudgetProperty;
@@ -198,6 +207,7 @@ private:
     long long _gpuMemoryBudgetInBytes = 0;
     long long _maxStreamingBudgetInBytes = 0;
     size_t _chunkSize = 0;
+    std::vector<float> _chunkPadding;
 
     GLuint _vao = 0;
     GLuint _vaoEmpty = 0;
@@ -26,12 +26,21 @@
 
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/fmt.h>
+#include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/directory.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/dictionary.h>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <numeric>
 #include <thread>
 
 namespace {
@@ -40,6 +49,8 @@ namespace {
     constexpr const char* KeyMaxDist = "MaxDist";
     constexpr const char* KeyMaxStarsPerNode = "MaxStarsPerNode";
     constexpr const char* KeySingleFileInput = "SingleFileInput";
+    constexpr const char* KeyParallelBuild = "ParallelBuild";
+    constexpr const char* KeyNumThreads = "NumThreads";
 
     constexpr const char* KeyFilterPosX = "FilterPosX";
     constexpr const char* KeyFilterPosY = "FilterPosY";
@@ -67,6 +78,29 @@ namespace {
     constexpr const char* KeyFilterRvError = "FilterRvError";
 
     constexpr const char* _loggerCat = "ConstructOctreeTask";
+
+    // ReadFitsTask writes the stars of every top level branch to a file with this
+    // prefix, followed by the index of the branch
+    constexpr const char* BranchFilePrefix = "octant_";
+
+    // Calls job(i) for every i in [0, nJobs) using at most nTasks tasks on the shared
+    // task scheduler. Every task claims the next unprocessed job as soon as it is done
+    // with its previous one, so tasks that finish a small branch early continue with the
+    // remaining branches.
+    void runInParallel(size_t nJobs, size_t nTasks,
+                       const std::function<void(size_t)>& job)
+    {
+        std::atomic<size_t> nextJob = 0;
+        openspace::TaskGroup tasks(openspace::global::taskScheduler);
+        for (size_t i = 0; i < std::min(nJobs, nTasks); ++i) {
+            tasks.run([&]() {
+                for (size_t j = nextJob++; j < nJobs; j = nextJob++) {
+                    job(j);
+                }
+            });
+        }
+        tasks.wait();
+    }
 } // namespace
 
 namespace openspace {
@@ -93,6 +127,14 @@ ConstructOctreeTask::ConstructOctreeTask(const ghoul::Dictionary& dictionary) {
         _singleFileInput = dictionary.value<bool>(KeySingleFileInput);
     }
 
+    if (dictionary.hasKey(KeyParallelBuild)) {
+        _parallelBuild = dictionary.value<bool>(KeyParallelBuild);
+    }
+
+    if (dictionary.hasKey(KeyNumThreads)) {
+        _nThreads = static_cast<int>(dictionary.value<double>(KeyNumThreads));
+    }
+
     _octreeManager = std::make_shared<OctreeManager>();
     _indexOctreeManager = std::make_shared<OctreeManager>();
 
@@ -206,6 +248,9 @@ void ConstructOctreeTask::perform(const Task::ProgressCallback& onProgress) {
     if (_singleFileInput) {
         constructOctreeFromSingleFile(onProgress);
     }
+    else if (_parallelBuild) {
+        constructOctreeFromFolderInParallel(onProgress);
+    }
     else {
         constructOctreeFromFolder(onProgress);
     }
@@ -285,21 +330,24 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
         progressCallback(0.3f);
         LINFO("Constructing Octree.");
 
-        // Insert star into octree. We assume the data already is in correct order.
-        for (size_t i = 0; i < fullData.size(); i += nValuesPerStar) {
-            auto first = fullData.begin() + i;
-            auto last = fullData.begin() + i + nValuesPerStar;
-            std::vector<float> filterValues(first, last);
-            std::vector<float> renderValues(first, first + RENDER_VALUES);
+        if (_parallelBuild) {
+            nFilteredStars = constructBranchesInParallel(fullData, nValuesPerStar);
+        }
+        else {
+            // Insert star into octree. We assume the data already is in correct order.
+            for (size_t i = 0; i < fullData.size(); i += nValuesPerStar) {
+                const float* starValues = fullData.data() + i;
 
-            // Filter data by parameters.
-            if (checkAllFilters(filterValues)) {
-                nFilteredStars++;
-                continue;
-            }
+                // Filter data by parameters.
+                if (checkAllFilters(starValues)) {
+                    nFilteredStars++;
+                    continue;
+                }
 
-            // If all filters passed then insert render values into Octree.
-            _octreeManager->insert(renderValues);
+                // If all filters passed then insert render values into Octree. The
+                // render values are the first RENDER_VALUES values of every star.
+                _octreeManager->insert(starValues);
+            }
         }
         inFileStream.close();
     }
@@ -311,8 +359,10 @@ void ConstructOctreeTask::constructOctreeFromSingleFile(
     }
     LINFO(fmt::format("{} of {} read stars were filtered", nFilteredStars, nTotalStars));
 
-    // Slice LOD data before writing to files.
-    _octreeManager->sliceLodData();
+    // Slice LOD data before writing to files. Already done per branch if parallel.
+    if (!_parallelBuild) {
+        _octreeManager->sliceLodData();
+    }
 
     LINFO("Writing octree to: " + _outFileOrFolderPath);
     std::ofstream outFileStream(_outFileOrFolderPath, std::ofstream::binary);
@@ -353,22 +403,27 @@ void ConstructOctreeTask::constructOctreeFromFolder(
     //int starsOutside2000 = 0;
     //int starsOutside5000 = 0;
 
-    ghoul::filesystem::Directory currentDir(_inFileOrFolderPath);
-    std::vector<std::string> allInputFiles = currentDir.readFiles();
+    std::array<std::string, 8> branchFiles;
+    if (!findBranchFiles(branchFiles)) {
+        return;
+    }
     std::vector<float> filterValues;
     auto writeThreads = std::vector<std::thread>(8);
 
     _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
 
-    float processOneFile = 1.f / allInputFiles.size();
+    float processOneFile = 1.f / 8;
 
     LINFO(fmt::format(
         "MAX DIST: {} - MAX STARS PER NODE: {}",
         _indexOctreeManager->maxDist(), _indexOctreeManager->maxStarsPerNode()
     ));
 
-    for (size_t idx = 0; idx < allInputFiles.size(); ++idx) {
-        std::string inFilePath = allInputFiles[idx];
+    for (size_t idx = 0; idx < 8; ++idx) {
+        const std::string& inFilePath = branchFiles[idx];
+        if (inFilePath.empty()) {
+            continue;
+        }
         int nStarsInfile = 0;
 
         LINFO("Reading data file: " + inFilePath);
@@ -384,7 +439,7 @@ void ConstructOctreeTask::constructOctreeFromFolder(
             ))
             {
                 // Filter data by parameters.
-                if (checkAllFilters(filterValues)) {
+                if (checkAllFilters(filterValues.data())) {
                     nFilteredStars++;
                     continue;
                 }
@@ -398,16 +453,11 @@ void ConstructOctreeTask::constructOctreeFromFolder(
                 //}
 
                 // If all filters passed then insert render values into Octree.
-                std::vector<float> renderValues(
-                    filterValues.begin(),
-                    filterValues.begin() + RENDER_VALUES
-                );
-
-                _indexOctreeManager->insert(renderValues);
+                _indexOctreeManager->insert(filterValues.data());
                 nStarsInfile++;
 
-                //float maxVal = fmax(fmax(fabs(renderValues[0]), fabs(renderValues[1])),
-                //    fabs(renderValues[2]));
+                //float maxVal = fmax(fmax(fabs(filterValues[0]), fabs(filterValues[1])),
+                //    fabs(filterValues[2]));
                 //if (maxVal > maxRadius) maxRadius = maxVal;
                 //// Calculate how many stars are outside of different thresholds.
                 //if (maxVal > 10) starsOutside10++;
@@ -499,11 +549,233 @@ void ConstructOctreeTask::constructOctreeFromFolder(
 
     // Make sure all threads are done.
     for (int i = 0; i < 8; ++i) {
-        writeThreads[i].join();
+        if (writeThreads[i].joinable()) {
+            writeThreads[i].join();
+        }
+    }
+}
+
+size_t ConstructOctreeTask::constructBranchesInParallel(const std::vector<float>& fullData,
+                                                       int32_t nValuesPerStar)
+{
+    const size_t nStars = fullData.size() / nValuesPerStar;
+    const size_t nThreads = numberOfThreads();
+    LINFO(fmt::format("Constructing all branches in parallel on {} threads", nThreads));
+
+    // Filter and partition the stars by branch in consecutive ranges. Concatenating the
+    // ranges keeps the original order of the stars within every branch, which makes the
+    // constructed branches identical to the ones constructed serially.
+    const size_t nRanges = nThreads;
+    const size_t rangeSize = (nStars + nRanges - 1) / nRanges;
+    std::vector<std::array<std::vector<size_t>, 8>> rangeBranches(nRanges);
+    std::vector<size_t> rangeFilteredStars(nRanges, 0);
+    runInParallel(nRanges, nThreads, [&](size_t range) {
+        const size_t first = range * rangeSize;
+        const size_t last = std::min(first + rangeSize, nStars);
+        for (size_t star = first; star < last; ++star) {
+            const float* starValues = fullData.data() + star * nValuesPerStar;
+            if (checkAllFilters(starValues)) {
+                rangeFilteredStars[range]++;
+                continue;
+            }
+            const size_t branch = _octreeManager->branchIndex(
+                starValues[0],
+                starValues[1],
+                starValues[2]
+            );
+            rangeBranches[range][branch].push_back(star);
+        }
+    });
+
+    // Start with the biggest branches so they don't end up last on a single thread.
+    std::array<size_t, 8> branchSizes = {};
+    for (const std::array<std::vector<size_t>, 8>& branches : rangeBranches) {
+        for (size_t branch = 0; branch < 8; ++branch) {
+            branchSizes[branch] += branches[branch].size();
+        }
+    }
+    std::array<size_t, 8> branchOrder;
+    std::iota(branchOrder.begin(), branchOrder.end(), 0);
+    std::stable_sort(
+        branchOrder.begin(),
+        branchOrder.end(),
+        [&branchSizes](size_t lhs, size_t rhs) {
+            return branchSizes[lhs] > branchSizes[rhs];
+        }
+    );
+
+    // Every branch is only touched by one thread, so no further locking is needed.
+    runInParallel(8, nThreads, [&](size_t job) {
+        const size_t branch = branchOrder[job];
+        for (const std::array<std::vector<size_t>, 8>& branches : rangeBranches) {
+            for (size_t star : branches[branch]) {
+                _octreeManager->insert(fullData.data() + star * nValuesPerStar);
+            }
+        }
+        _octreeManager->sliceLodData(branch);
+    });
+
+    return std::accumulate(rangeFilteredStars.begin(), rangeFilteredStars.end(),
+        size_t(0));
+}
+
+void ConstructOctreeTask::constructOctreeFromFolderInParallel(
+                                           const Task::ProgressCallback& progressCallback)
+{
+    std::array<std::string, 8> branchFiles;
+    if (!findBranchFiles(branchFiles)) {
+        return;
+    }
+    std::vector<size_t> branches;
+    for (size_t branch = 0; branch < 8; ++branch) {
+        if (!branchFiles[branch].empty()) {
+            branches.push_back(branch);
+        }
+    }
+
+    _indexOctreeManager->initOctree(0, _maxDist, _maxStarsPerNode);
+
+    LINFO(fmt::format(
+        "MAX DIST: {} - MAX STARS PER NODE: {}",
+        _indexOctreeManager->maxDist(), _indexOctreeManager->maxStarsPerNode()
+    ));
+    const size_t nThreads = numberOfThreads();
+    LINFO(fmt::format("Constructing all branches in parallel on {} threads", nThreads));
+
+    std::atomic<size_t> nStars = 0;
+    std::atomic<size_t> nFilteredStars = 0;
+    std::atomic<size_t> nStarsOutsideBranch = 0;
+    size_t nProcessedFiles = 0;
+    std::mutex progressMutex;
+
+    runInParallel(branches.size(), nThreads, [&](size_t job) {
+        const size_t idx = branches[job];
+        const std::string& inFilePath = branchFiles[idx];
+        size_t nStarsInFile = 0;
+
+        LINFO("Reading data file: " + inFilePath);
+
+        std::ifstream inFileStream(inFilePath, std::ifstream::binary);
+        if (inFileStream.good()) {
+            int32_t nValuesPerStar = 0;
+            inFileStream.read(reinterpret_cast<char*>(&nValuesPerStar), sizeof(int32_t));
+            std::vector<float> filterValues(nValuesPerStar, 0.f);
+
+            while (inFileStream.read(
+                reinterpret_cast<char*>(filterValues.data()),
+                nValuesPerStar * sizeof(filterValues[0])
+            ))
+            {
+                // Filter data by parameters.
+                if (checkAllFilters(filterValues.data())) {
+                    nFilteredStars++;
+                    continue;
+                }
+
+                // Other threads are constructing the other branches.
+                const size_t branch = _indexOctreeManager->branchIndex(
+                    filterValues[0],
+                    filterValues[1],
+                    filterValues[2]
+                );
+                if (branch != idx) {
+                    nStarsOutsideBranch++;
+                    continue;
+                }
+
+                _indexOctreeManager->insert(filterValues.data());
+                nStarsInFile++;
+            }
+            inFileStream.close();
+        }
+        else {
+            LERROR(fmt::format(
+                "Error opening file '{}' for loading preprocessed file!", inFilePath
+            ));
+        }
+
+        // Slice LOD data and write branch to files. Data will be cleared after it has
+        // been written so the thread can continue with the next branch.
+        _indexOctreeManager->sliceLodData(idx);
+        LINFO(fmt::format("Writing {} stars to octree files!", nStarsInFile));
+        _indexOctreeManager->writeToMultipleFiles(_outFileOrFolderPath, idx);
+        nStars += nStarsInFile;
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        nProcessedFiles++;
+        progressCallback(static_cast<float>(nProcessedFiles) / branches.size());
+    });
+
+    LINFO(fmt::format(
+        "A total of {} stars were read from files and distributed into {} total nodes",
+        nStars.load(), _indexOctreeManager->totalNodes()
+    ));
+    LINFO(fmt::format(
+        "Number leaf nodes: {}\n Number inner nodes: {}\n Total depth of tree: {}",
+        _indexOctreeManager->numLeafNodes(),
+        _indexOctreeManager->numInnerNodes(),
+        _indexOctreeManager->totalDepth()
+    ));
+    LINFO(std::to_string(nFilteredStars.load()) + " stars were filtered");
+    if (nStarsOutsideBranch > 0) {
+        LWARNING(fmt::format(
+            "{} stars were skipped as they were stored in the file of another branch",
+            nStarsOutsideBranch.load()
+        ));
+    }
+
+    // Write index file of Octree structure.
+    std::string indexFileOutPath = _outFileOrFolderPath + "index.bin";
+    std::ofstream outFileStream(indexFileOutPath, std::ofstream::binary);
+    if (outFileStream.good()) {
+        LINFO("Writing index file!");
+        _indexOctreeManager->writeToFile(outFileStream, false);
+
+        outFileStream.close();
+    }
+    else {
+        LERROR(fmt::format(
+            "Error opening file: {} as index output file.", indexFileOutPath
+        ));
     }
 }
 
-bool ConstructOctreeTask::checkAllFilters(const std::vector<float>& filterValues) {
+size_t ConstructOctreeTask::numberOfThreads() const {
+    const size_t nSchedulerThreads = global::taskScheduler.numThreads();
+    if (_nThreads > 0) {
+        return std::min(static_cast<size_t>(_nThreads), nSchedulerThreads);
+    }
+    return nSchedulerThreads;
+}
+
+bool ConstructOctreeTask::findBranchFiles(std::array<std::string, 8>& branchFiles) const {
+    ghoul::filesystem::Directory currentDir(_inFileOrFolderPath);
+    for (const std::string& path : currentDir.readFiles()) {
+        // The order of the files in the directory listing is unspecified, so the branch
+        // is taken from the name of the file
+        const std::string name = ghoul::filesystem::File(path).baseName();
+        const size_t prefixLength = std::strlen(BranchFilePrefix);
+        const bool isBranchFile = name.size() == prefixLength + 1 &&
+            name.compare(0, prefixLength, BranchFilePrefix) == 0 &&
+            name[prefixLength] >= '0' && name[prefixLength] < '8';
+        if (!isBranchFile) {
+            LWARNING(fmt::format("Ignoring file '{}' that is not a branch file", path));
+            continue;
+        }
+
+        const size_t branch = static_cast<size_t>(name[prefixLength] - '0');
+        if (!branchFiles[branch].empty()) {
+            LERROR(fmt::format(
+                "Found '{}' and '{}' for branch {}", branchFiles[branch], path, branch
+            ));
+            return false;
+        }
+        branchFiles[branch] = path;
+    }
+    return true;
+}
+
+bool ConstructOctreeTask::checkAllFilters(const float* filterValues) const {
     // Return true if star is caught in any filter.
     return (_filterPosX && filterStar(_posX, filterValues[0])) ||
         (_filterPosY && filterStar(_posY, filterValues[1])) ||
@@ -532,7 +804,7 @@ bool ConstructOctreeTask::checkAllFilters(const std::vector<float>& filterValues
 }
 
 bool ConstructOctreeTask::filterStar(const glm::vec2& range, float filterValue,
-                                     float normValue)
+                                     float normValue) const
 {
     // Return true if star should be filtered away, i.e. if min = max = filterValue or
     // if filterValue < min (when min != 0.0) or filterValue > max (when max != 0.0).
@@ -590,6 +862,24 @@ documentation::Documentation ConstructOctreeTask::Documentation() {
                 "binary file with the full Octree. If false then task will read all "
                 "files in specified folder and output multiple files for the Octree."
             },
+            {
+                KeyParallelBuild,
+                new BoolVerifier,
+                Optional::Yes,
+                "If true then the eight branches of the Octree are constructed "
+                "concurrently. The constructed Octree is identical to the one constructed "
+                "serially. If SingleFileInput is false then every file in the input "
+                "folder must contain the stars of one branch, as written by "
+                "ReadFitsTask, and one branch per thread is kept in memory."
+            },
+            {
+                KeyNumThreads,
+                new IntVerifier,
+                Optional::Yes,
+                "The maximum number of tasks on the shared task scheduler that construct "
+                "the octree if ParallelBuild is true. Defaults to the number of threads "
+                "of the task scheduler."
+            },
             {
                 KeyFilterPosX,
                 new Vector2Verifier<double>,
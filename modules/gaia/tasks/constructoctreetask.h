@@ -29,6 +29,7 @@
 
 #include <modules/gaia/rendering/octreeculler.h>
 #include <modules/gaia/rendering/octreemanager.h>
+#include <array>
 
 namespace openspace {
 
@@ -58,17 +59,50 @@ private:
      * folder, prepared by ReadFitsTask, and inserts star render data into an octree
      * (if star data passed all defined filters).
      * Stores octree structure in a binary index file and stores all render data
-     * separate files, one file per node in the octree.
+     * separate files, one memory mappable node file per node in the octree.
      */
     void constructOctreeFromFolder(const Task::ProgressCallback& progressCallback);
 
+    /**
+     * Parallel version of <code>constructOctreeFromSingleFile()</code>. Partitions all
+     * stars in \param fullData by top level branch, keeping the order of the stars
+     * within every branch, and then constructs and slices the eight branches
+     * concurrently. The resulting Octree is identical to the one constructed serially.
+     * \returns the number of filtered stars.
+     */
+    size_t constructBranchesInParallel(const std::vector<float>& fullData,
+        int32_t nValuesPerStar);
+
+    /**
+     * Parallel version of <code>constructOctreeFromFolder()</code>. Every input file is
+     * expected to contain one branch, as written by ReadFitsTask, and the branches are
+     * read, constructed and written concurrently. At most <code>numberOfThreads()</code>
+     * branches are kept in memory at the same time.
+     */
+    void constructOctreeFromFolderInParallel(
+        const Task::ProgressCallback& progressCallback);
+
+    /**
+     * \returns the number of tasks that run concurrently on the task scheduler in a
+     * parallel construction.
+     */
+    size_t numberOfThreads() const;
+
+    /**
+     * Finds the files in the input folder that contain the stars of each branch, which
+     * are named <code>octant_[branch].bin</code> by ReadFitsTask. Branches without a file
+     * are left empty in \param branchFiles.
+     * \returns false if there is more than one file for any branch.
+     */
+    bool findBranchFiles(std::array<std::string, 8>& branchFiles) const;
+
     /**
      * Checks all defined filter ranges and \returns true if any of the corresponding
      * <code>filterValues</code> are outside of the defined range.
      * \returns false if value should be inserted into Octree.
      * \param filterValues are all read filter values in binary file.
      */
-    bool checkAllFilters(const std::vector<float>& filterValues);
+    bool checkAllFilters(const float* filterValues) const;
 
     /**
      * \returns true if star should be filtered away and false if all filters passed.
@@ -76,13 +110,16 @@ private:
      * star. Star is filtered either if min = max = filterValue or if filterValue < min
      * (when min != 0.0) or filterValue > max (when max != 0.0).
      */
-    bool filterStar(const glm::vec2& range, float filterValue, float normValue = 0.f);
+    bool filterStar(const glm::vec2& range, float filterValue,
+        float normValue = 0.f) const;
 
     std::string _inFileOrFolderPath;
     std::string _outFileOrFolderPath;
     int _maxDist = 0;
     int _maxStarsPerNode = 0;
     bool _singleFileInput = false;
+    bool _parallelBuild = false;
+    int _nThreads = 0;
 
     std::shared_ptr<OctreeManager> _octreeManager;
     std::shared_ptr<OctreeManager> _indexOctreeManager;
@@ -26,12 +26,222 @@
 
 #include <openspace/util/distanceconversion.h>
 #include <ghoul/misc/dictionary.h>
+#include <ghoul/misc/exception.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/fmt.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
 
 namespace {
     constexpr const char* _loggerCat = "ReadFileJob";
-}
+
+    // Order of the default columns in the table.
+    enum DefaultColumn {
+        Ra = 0,
+        RaError,
+        Dec,
+        DecError,
+        Parallax,
+        ParallaxError,
+        PmRa,
+        PmRaError,
+        PmDec,
+        PmDecError,
+        MeanMagG,
+        MeanMagBp,
+        MeanMagRp,
+        BpRp,
+        BpG,
+        GRp,
+        RadialVelocity,
+        RadialVelocityError
+    };
+
+    // Values per star that are copied straight from a column. NaNs are replaced by the
+    // default value.
+    struct CopiedValue {
+        size_t valueIndex;
+        DefaultColumn column;
+        float defaultValue;
+    };
+
+    // OBS: ORDERING IS IMPORTANT! This is where slicing happens.
+    // Default order for rendering:
+    // Position [X, Y, Z]
+    // Mean G-band Magnitude
+    // -- Mean Bp-band Magnitude
+    // -- Mean Rp-band Magnitude
+    // Bp-Rp Color
+    // -- Bp-G Color
+    // -- G-Rp Color
+    // Velocity [X, Y, Z]
+    // Followed by additional parameters to filter by.
+    constexpr const size_t PositionIndex = 0;
+    constexpr const size_t VelocityIndex = 5;
+    constexpr const CopiedValue CopiedValues[] = {
+        // Magnitude render value. (Set default to high mag = low brightness)
+        { 3, MeanMagG, 20.f },
+        // Color render value. (Default value is bluish stars)
+        { 4, BpRp, 0.f },
+        { 8, MeanMagBp, 20.f },
+        { 9, MeanMagRp, 20.f },
+        { 10, BpG, 0.f },
+        { 11, GRp, 0.f },
+        { 12, Ra, 0.f },
+        { 13, RaError, 0.f },
+        { 14, Dec, 0.f },
+        { 15, DecError, 0.f },
+        { 16, Parallax, 0.f },
+        { 17, ParallaxError, 0.f },
+        { 18, PmRa, 0.f },
+        { 19, PmRaError, 0.f },
+        { 20, PmDec, 0.f },
+        { 21, PmDecError, 0.f },
+        { 22, RadialVelocity, 0.f },
+        { 23, RadialVelocityError, 0.f }
+    };
+    constexpr const size_t NumDefaultValues = 24;
+
+    // Marks stars without a measured position.
+    constexpr const uint8_t InvalidOctant = 8;
+
+    float valueOrDefault(float value, float defaultValue) {
+        return std::isnan(value) ? defaultValue : value;
+    }
+
+    // Matrix to convert ICRS Equatorial Ra and Dec to Galactic coordinates. Stored by
+    // columns like a glm::mat3, but as plain floats so that the multiplications inline
+    // into the vectorized conversion loop.
+    constexpr const float APrimG[3][3] = {
+        { -0.0548755604162154f, 0.4941094278755837f, -0.8676661490190047f },
+        { -0.8734370902348850f, -0.4448296299600112f, -0.1980763734312015f },
+        { -0.4838350155487132f, 0.7469822444972189f, 0.4559837761750669f }
+    };
+
+    // Returns the component \p row of APrimG * (x, y, z)
+    float galactic(int row, float x, float y, float z) {
+        return APrimG[0][row] * x + APrimG[1][row] * y + APrimG[2][row] * z;
+    }
+
+    // The number of stars that are converted at once. All intermediate arrays of a block
+    // fit into the L1 cache
+    constexpr const size_t ConversionBlockSize = 256;
+
+    /**
+     * Converts the positions and velocities of \p nStars stars from ICRS Ra, Dec,
+     * parallax and proper motion columns into galactic cartesian coordinates. Every
+     * output is a separate array with one value per star. \p octants gets the octant of
+     * every star, or <code>InvalidOctant</code> if it doesn't have a position.
+     *
+     * The stars are converted in blocks. Per block, the trigonometric functions and the
+     * square roots, which can't be vectorized without -ffast-math, are evaluated in
+     * separate passes. The remaining passes have no branches or calls and only write to
+     * the block arrays, which can't alias the columns, so that the compiler vectorizes
+     * them without run-time alias checks.
+     */
+    void convertPositionsAndVelocities(const std::vector<const float*>& columns,
+                                       size_t nStars, float* posX, float* posY,
+                                       float* posZ, float* velX, float* velY, float* velZ,
+                                       uint8_t* octants)
+    {
+        using Block = std::array<float, ConversionBlockSize>;
+        Block cosRa, sinRa, cosDec, sinDec, radius;
+        Block x, y, z, tanVelX, tanVelY, tanVelZ, radVelX, radVelY, radVelZ;
+        std::array<uint8_t, ConversionBlockSize> octant;
+
+        for (size_t first = 0; first < nStars; first += ConversionBlockSize) {
+            const size_t n = std::min(ConversionBlockSize, nStars - first);
+            const float* ra = columns[Ra] + first;
+            const float* dec = columns[Dec] + first;
+            const float* parallax = columns[Parallax] + first;
+            const float* pmra = columns[PmRa] + first;
+            const float* pmdec = columns[PmDec] + first;
+            const float* radialVel = columns[RadialVelocity] + first;
+
+            for (size_t i = 0; i < n; ++i) {
+                cosRa[i] = std::cos(glm::radians(ra[i]));
+                sinRa[i] = std::sin(glm::radians(ra[i]));
+                cosDec[i] = std::cos(glm::radians(dec[i]));
+                sinDec[i] = std::sin(glm::radians(dec[i]));
+            }
+
+            // Set to a default distance if parallax doesn't exist.
+            // Parallax is in milliArcseconds -> distance in kiloParsecs
+            // https://gea.esac.esa.int/archive/documentation/GDR2/Gaia_archive/
+            // chap_datamodel/sec_dm_main_tables/ssec_dm_gaia_source.html
+            // The division is done for every star, as a division in only one branch of
+            // the selection could trap and prevents the vectorization
+            for (size_t i = 0; i < n; ++i) {
+                const float r = 1.f / parallax[i];
+                radius[i] = std::isnan(parallax[i]) ? 9.f : r;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                const float rx = cosRa[i] * cosDec[i];
+                const float ry = sinRa[i] * cosDec[i];
+                const float rz = sinDec[i];
+                const float galX = galactic(0, rx, ry, rz);
+                const float galY = galactic(1, rx, ry, rz);
+                const float galZ = galactic(2, rx, ry, rz);
+                x[i] = radius[i] * galX;
+                y[i] = radius[i] * galY;
+                z[i] = radius[i] * galZ;
+
+                // Convert Proper Motion from ICRS [Ra,Dec] to Galactic Tanget Vector
+                // [l,b].
+                const float pmRa = valueOrDefault(pmra[i], 0.f);
+                const float pmDec = valueOrDefault(pmdec[i], 0.f);
+                const float pmX = -sinRa[i] * pmRa - cosRa[i] * sinDec[i] * pmDec;
+                const float pmY = cosRa[i] * pmRa - sinRa[i] * sinDec[i] * pmDec;
+                const float pmZ = cosDec[i] * pmDec;
+
+                // Convert to Tangential vector [m/s] from Proper Motion vector [mas/yr]
+                const float toTangential = 1000.f * 4.74f * radius[i];
+                tanVelX[i] = toTangential * galactic(0, pmX, pmY, pmZ);
+                tanVelY[i] = toTangential * galactic(1, pmX, pmY, pmZ);
+                tanVelZ[i] = toTangential * galactic(2, pmX, pmY, pmZ);
+
+                // radial_vel is given in [km/s] -> convert to [m/s]. Stars without a
+                // radial velocity get NaNs here, which are not used below
+                const float radVel = 1000.f * radialVel[i];
+                radVelX[i] = radVel * galX;
+                radVelY[i] = radVel * galY;
+                radVelZ[i] = radVel * galZ;
+
+                const bool hasPosition = !std::isnan(ra[i]) & !std::isnan(dec[i]);
+                const int o = (x[i] < 0.f ? 1 : 0) + (y[i] < 0.f ? 2 : 0) +
+                              (z[i] < 0.f ? 4 : 0);
+                octant[i] = static_cast<uint8_t>(hasPosition ? o : InvalidOctant);
+            }
+
+            // Calculate True Space Velocity [m/s] if we have the radial velocity,
+            // otherwise use the vector [m/s] we got from proper motion.
+            // Use Pythagoras theorem for the final Space Velocity [m/s].
+            for (size_t i = 0; i < n; ++i) {
+                if (!std::isnan(radialVel[i])) {
+                    tanVelX[i] = std::sqrt(
+                        radVelX[i] * radVelX[i] + tanVelX[i] * tanVelX[i]
+                    );
+                    tanVelY[i] = std::sqrt(
+                        radVelY[i] * radVelY[i] + tanVelY[i] * tanVelY[i]
+                    );
+                    tanVelZ[i] = std::sqrt(
+                        radVelZ[i] * radVelZ[i] + tanVelZ[i] * tanVelZ[i]
+                    );
+                }
+            }
+
+            std::copy(x.begin(), x.begin() + n, posX + first);
+            std::copy(y.begin(), y.begin() + n, posY + first);
+            std::copy(z.begin(), z.begin() + n, posZ + first);
+            std::copy(tanVelX.begin(), tanVelX.begin() + n, velX + first);
+            std::copy(tanVelY.begin(), tanVelY.begin() + n, velY + first);
+            std::copy(tanVelZ.begin(), tanVelZ.begin() + n, velZ + first);
+            std::copy(octant.begin(), octant.begin() + n, octants + first);
+        }
+    }
+} // namespace
 
 namespace openspace::gaia {
 
@@ -63,202 +273,98 @@ void ReadFileJob::execute() {
         ));
     }
 
-    int nStars = table->readRows - _firstRow + 1;
-
-    int nNullArr = 0;
     size_t nColumnsRead = _allColumns.size();
     if (nColumnsRead != _nDefaultCols) {
         LINFO("Additional columns will be read! Consider add column in code for "
             "significant speedup!");
     }
+    const size_t nValuesPerStar = static_cast<size_t>(_nValuesPerStar);
+    if (nValuesPerStar < NumDefaultValues + nColumnsRead - _nDefaultCols) {
+        throw ghoul::RuntimeError(fmt::format(
+            "{} values per star is too few to store {} columns",
+            nValuesPerStar, nColumnsRead
+        ));
+    }
 
-    // Copy columns to local variables.
+    // Look up all columns once. The number of stars is the number of rows that were
+    // actually read.
     std::unordered_map<std::string, std::vector<float>>& tableContent = table->contents;
-
-    // Default columns parameters.
-    //std::vector<float> l_longitude = std::move(tableContent[_allColumns[0]]);
-    //std::vector<float> b_latitude = std::move(tableContent[_allColumns[1]]);
-    std::vector<float> ra = std::move(tableContent[_allColumns[0]]);
-    std::vector<float> ra_err = std::move(tableContent[_allColumns[1]]);
-    std::vector<float> dec = std::move(tableContent[_allColumns[2]]);
-    std::vector<float> dec_err = std::move(tableContent[_allColumns[3]]);
-    std::vector<float> parallax = std::move(tableContent[_allColumns[4]]);
-    std::vector<float> parallax_err = std::move(tableContent[_allColumns[5]]);
-    std::vector<float> pmra = std::move(tableContent[_allColumns[6]]);
-    std::vector<float> pmra_err = std::move(tableContent[_allColumns[7]]);
-    std::vector<float> pmdec = std::move(tableContent[_allColumns[8]]);
-    std::vector<float> pmdec_err = std::move(tableContent[_allColumns[9]]);
-    std::vector<float> meanMagG = std::move(tableContent[_allColumns[10]]);
-    std::vector<float> meanMagBp = std::move(tableContent[_allColumns[11]]);
-    std::vector<float> meanMagRp = std::move(tableContent[_allColumns[12]]);
-    std::vector<float> bp_rp = std::move(tableContent[_allColumns[13]]);
-    std::vector<float> bp_g = std::move(tableContent[_allColumns[14]]);
-    std::vector<float> g_rp = std::move(tableContent[_allColumns[15]]);
-    std::vector<float> radial_vel = std::move(tableContent[_allColumns[16]]);
-    std::vector<float> radial_vel_err = std::move(tableContent[_allColumns[17]]);
-
-
-    // Construct data array. OBS: ORDERING IS IMPORTANT! This is where slicing happens.
-    for (int i = 0; i < nStars; ++i) {
-        std::vector<float> values(_nValuesPerStar);
-        size_t idx = 0;
-
-        // Default order for rendering:
-        // Position [X, Y, Z]
-        // Mean G-band Magnitude
-        // -- Mean Bp-band Magnitude
-        // -- Mean Rp-band Magnitude
-        // Bp-Rp Color
-        // -- Bp-G Color
-        // -- G-Rp Color
-        // Velocity [X, Y, Z]
-
-        // Return early if star doesn't have a measured position.
-        if (std::isnan(ra[i]) || std::isnan(dec[i])) {
-            nNullArr++;
-            continue;
-        }
-
-        // Store positions. Set to a default distance if parallax doesn't exist.
-        float radiusInKiloParsec = 9.0;
-        if (!std::isnan(parallax[i])) {
-            // Parallax is in milliArcseconds -> distance in kiloParsecs
-            // https://gea.esac.esa.int/archive/documentation/GDR2/Gaia_archive/
-            // chap_datamodel/sec_dm_main_tables/ssec_dm_gaia_source.html
-            //LINFO("Parallax: " + std::to_string(parallax[i]));
-            radiusInKiloParsec = 1.f / parallax[i];
-        }
-        /*// Convert to Galactic Coordinates from Galactic Lon & Lat.
-        // https://gea.esac.esa.int/archive/documentation/GDR2/Data_processing/
-        // chap_cu3ast/sec_cu3ast_intro/ssec_cu3ast_intro_tansforms.html#SSS1
-        values[idx++] = radiusInKiloParsec * cos(glm::radians(b_latitude[i])) *
-            cos(glm::radians(l_longitude[i])); // Pos X
-        values[idx++] = radiusInKiloParsec * cos(glm::radians(b_latitude[i])) *
-            sin(glm::radians(l_longitude[i])); // Pos Y
-        values[idx++] = radiusInKiloParsec * sin(glm::radians(b_latitude[i])); // Pos Z
-        */
-
-        // Convert ICRS Equatorial Ra and Dec to Galactic latitude and longitude.
-        glm::mat3 aPrimG = glm::mat3(
-            // Col 0
-            glm::vec3(-0.0548755604162154, 0.4941094278755837, -0.8676661490190047),
-            // Col 1
-            glm::vec3(-0.8734370902348850, -0.4448296299600112, -0.1980763734312015),
-            // Col 2
-            glm::vec3(-0.4838350155487132, 0.7469822444972189, 0.4559837761750669)
-        );
-        glm::vec3 rICRS = glm::vec3(
-            cos(glm::radians(ra[i])) * cos(glm::radians(dec[i])),
-            sin(glm::radians(ra[i])) * cos(glm::radians(dec[i])),
-            sin(glm::radians(dec[i]))
-        );
-        glm::vec3 rGal = aPrimG * rICRS;
-        values[idx++] = radiusInKiloParsec * rGal.x; // Pos X
-        values[idx++] = radiusInKiloParsec * rGal.y; // Pos Y
-        values[idx++] = radiusInKiloParsec * rGal.z; // Pos Z
-
-        /*if (abs(rGal.x - values[0]) > 1e-5 || abs(rGal.y - values[1]) > 1e-5 ||
-        abs(rGal.z - values[2]) > 1e-5) {
-        LINFO("rGal: " + std::to_string(rGal) +
-        " - LB: [" + std::to_string(values[0]) + ", " + std::to_string(values[1]) +
-        ", " + std::to_string(values[2]) + "]");
-        }*/
-
-        // Store magnitude render value. (Set default to high mag = low brightness)
-        values[idx++] = std::isnan(meanMagG[i]) ? 20.f : meanMagG[i]; // Mean G-band Mag
-
-        // Store color render value. (Default value is bluish stars)
-        values[idx++] = std::isnan(bp_rp[i]) ? 0.f : bp_rp[i]; // Bp-Rp Color
-
-
-        // Store velocity.
-        if (std::isnan(pmra[i])) {
-            pmra[i] = 0.f;
-        }
-        if (std::isnan(pmdec[i])) {
-            pmdec[i] = 0.f;
+    const size_t nStars = tableContent[_allColumns[0]].size();
+    std::vector<const float*> columns(nColumnsRead);
+    for (size_t col = 0; col < nColumnsRead; ++col) {
+        const std::vector<float>& column = tableContent[_allColumns[col]];
+        if (column.size() < nStars) {
+            throw ghoul::RuntimeError(fmt::format(
+                "Column '{}' in Fits file '{}' is too short",
+                _allColumns[col], _inFilePath
+            ));
         }
+        columns[col] = column.data();
+    }
 
-        // Convert Proper Motion from ICRS [Ra,Dec] to Galactic Tanget Vector [l,b].
-        glm::vec3 uICRS = glm::vec3(
-            -sin(glm::radians(ra[i])) * pmra[i] -
-                cos(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec[i],
-            cos(glm::radians(ra[i])) * pmra[i] -
-                sin(glm::radians(ra[i])) * sin(glm::radians(dec[i])) * pmdec[i],
-            cos(glm::radians(dec[i]))  * pmdec[i]
-        );
-        glm::vec3 pmVecGal = aPrimG * uICRS;
-
-        // Convert to Tangential vector [m/s] from Proper Motion vector [mas/yr]
-        float tanVelX = 1000.f * 4.74f * radiusInKiloParsec * pmVecGal.x;
-        float tanVelY = 1000.f * 4.74f * radiusInKiloParsec * pmVecGal.y;
-        float tanVelZ = 1000.f * 4.74f * radiusInKiloParsec * pmVecGal.z;
-
-        // Calculate True Space Velocity [m/s] if we have the radial velocity
-        if (!std::isnan(radial_vel[i])) {
-            // Calculate Radial Velocity in the direction of the star.
-            // radial_vel is given in [km/s] -> convert to [m/s].
-            float radVelX = 1000.f * radial_vel[i] * rGal.x;
-            float radVelY = 1000.f * radial_vel[i] * rGal.y;
-            float radVelZ = 1000.f * radial_vel[i] * rGal.z;
+    // Convert positions and velocities for all stars at once.
+    std::vector<float> converted(6 * nStars);
+    float* posX = converted.data();
+    float* posY = posX + nStars;
+    float* posZ = posY + nStars;
+    float* velX = posZ + nStars;
+    float* velY = velX + nStars;
+    float* velZ = velY + nStars;
+    std::vector<uint8_t> octants(nStars);
+    convertPositionsAndVelocities(
+        columns,
+        nStars,
+        posX,
+        posY,
+        posZ,
+        velX,
+        velY,
+        velZ,
+        octants.data()
+    );
 
-            // Use Pythagoras theorem for the final Space Velocity [m/s].
-            values[idx++] = sqrt(pow(radVelX, 2) + pow(tanVelX, 2)); // Vel X [U]
-            values[idx++] = sqrt(pow(radVelY, 2) + pow(tanVelY, 2)); // Vel Y [V]
-            values[idx++] = sqrt(pow(radVelZ, 2) + pow(tanVelZ, 2)); // Vel Z [W]
-        }
-        // Otherwise use the vector [m/s] we got from proper motion.
-        else {
-            radial_vel[i] = 0.f;
-            values[idx++] = tanVelX; // Vel X [U]
-            values[idx++] = tanVelY; // Vel Y [V]
-            values[idx++] = tanVelZ; // Vel Z [W]
+    // Grow every octant once and write the stars straight into it.
+    std::array<size_t, 8> starsInOctant = {};
+    for (uint8_t octant : octants) {
+        if (octant != InvalidOctant) {
+            starsInOctant[octant]++;
         }
+    }
+    std::array<size_t, 8> writeOffset;
+    for (size_t i = 0; i < 8; ++i) {
+        writeOffset[i] = _octants[i].size();
+        _octants[i].resize(writeOffset[i] + starsInOctant[i] * nValuesPerStar, 0.f);
+    }
 
-        // Store additional parameters to filter by.
-        values[idx++] = std::isnan(meanMagBp[i]) ? 20.f : meanMagBp[i];
-        values[idx++] = std::isnan(meanMagRp[i]) ? 20.f : meanMagRp[i];
-        values[idx++] = std::isnan(bp_g[i]) ? 0.f : bp_g[i];
-        values[idx++] = std::isnan(g_rp[i]) ? 0.f : g_rp[i];
-        values[idx++] = ra[i];
-        values[idx++] = std::isnan(ra_err[i]) ? 0.f : ra_err[i];
-        values[idx++] = dec[i];
-        values[idx++] = std::isnan(dec_err[i]) ? 0.f : dec_err[i];
-        values[idx++] = std::isnan(parallax[i]) ? 0.f : parallax[i];
-        values[idx++] = std::isnan(parallax_err[i]) ? 0.f : parallax_err[i];
-        values[idx++] = pmra[i];
-        values[idx++] = std::isnan(pmra_err[i]) ? 0.f : pmra_err[i];
-        values[idx++] = pmdec[i];
-        values[idx++] = std::isnan(pmdec_err[i]) ? 0.f : pmdec_err[i];
-        values[idx++] = radial_vel[i];
-        values[idx++] = std::isnan(radial_vel_err[i]) ? 0.f : radial_vel_err[i];
-
-        // Read extra columns, if any. This will slow down the sorting tremendously!
-        for (size_t col = _nDefaultCols; col < nColumnsRead; ++col) {
-            std::vector<float> vecData = std::move(tableContent[_allColumns[col]]);
-            values[idx++] = std::isnan(vecData[col]) ? 0.f : vecData[col];
+    for (size_t i = 0; i < nStars; ++i) {
+        // Skip stars that don't have a measured position.
+        if (octants[i] == InvalidOctant) {
+            continue;
         }
 
-        size_t index = 0;
-        if (values[0] < 0.0) {
-            index += 1;
-        }
-        if (values[1] < 0.0) {
-            index += 2;
-        }
-        if (values[2] < 0.0) {
-            index += 4;
+        float* values = _octants[octants[i]].data() + writeOffset[octants[i]];
+        writeOffset[octants[i]] += nValuesPerStar;
+
+        values[PositionIndex] = posX[i];
+        values[PositionIndex + 1] = posY[i];
+        values[PositionIndex + 2] = posZ[i];
+        values[VelocityIndex] = velX[i];
+        values[VelocityIndex + 1] = velY[i];
+        values[VelocityIndex + 2] = velZ[i];
+        for (const CopiedValue& v : CopiedValues) {
+            values[v.valueIndex] = valueOrDefault(columns[v.column][i], v.defaultValue);
         }
 
-        _octants[index].insert(_octants[index].end(), values.begin(), values.end());
+        // Read extra columns, if any.
+        size_t idx = NumDefaultValues;
+        for (size_t col = _nDefaultCols; col < nColumnsRead; ++col) {
+            values[idx++] = valueOrDefault(columns[col][i], 0.f);
+        }
     }
-
-    /*LINFO(std::to_string(nNullArr) + " out of " +
-        std::to_string(nStars) + " read stars were nullArrays.");*/
 }
 
 std::vector<std::vector<float>> ReadFileJob::product() {
-    return _octants;
+    return std::move(_octants);
 }
 
 } // namespace openspace::gaiamission
@@ -33,8 +33,8 @@ namespace openspace::gaia {
 
 struct ReadFileJob : public Job<std::vector<std::vector<float>>> {
     /**
-     * Constructs a Job that will read a single FITS file in a concurrent thread and
-     * divide the star data into 8 octants depending on position.
+     * Constructs a Job that will read a single FITS file, or a block of rows in it, in a
+     * concurrent thread and divide the star data into 8 octants depending on position.
      * \param allColumns define which columns that will be read, it should correspond
      * to the pre-defined order in the job. If additional columns are defined they will
      * be read but slow down the process.
@@ -34,6 +34,7 @@
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/fmt.h>
 
+#include <algorithm>
 #include <fstream>
 #include <set>
 
@@ -45,6 +46,7 @@ namespace {
     constexpr const char* KeyFirstRow = "FirstRow";
     constexpr const char* KeyLastRow = "LastRow";
     constexpr const char* KeyFilterColumnNames = "FilterColumnNames";
+    constexpr const char* KeyRowBlockSize = "RowBlockSize";
 
     constexpr const char* _loggerCat = "ReadFitsTask";
 } // namespace
@@ -97,6 +99,13 @@ ReadFitsTask::ReadFitsTask(const ghoul::Dictionary& dictionary) {
             _filterColumnNames.push_back(d.value<std::string>(std::to_string(key)));
         }
     }
+
+    if (dictionary.hasKey(KeyRowBlockSize)) {
+        _rowBlockSize = std::max(
+            static_cast<int>(dictionary.value<double>(KeyRowBlockSize)),
+            0
+        );
+    }
 }
 
 std::string ReadFitsTask::description() {
@@ -173,10 +182,10 @@ void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
 
     _firstRow = std::max(_firstRow, 1);
 
-    // Create Threadpool and JobManager.
-    LINFO("Threads in pool: " + std::to_string(_threadsToUse));
-    ThreadPool threadPool(_threadsToUse);
-    ConcurrentJobManager<std::vector<std::vector<float>>> jobManager(threadPool);
+    // Create TaskScheduler and JobManager.
+    LINFO("Threads in scheduler: " + std::to_string(_threadsToUse));
+    TaskScheduler scheduler(_threadsToUse);
+    ConcurrentJobManager<std::vector<std::vector<float>>> jobManager(scheduler);
 
     // Get all files in specified folder.
     ghoul::filesystem::Directory currentDir(_inFileOrFolderPath);
@@ -225,33 +234,72 @@ void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
     }
     LINFO(allNames);
 
-    // Declare how many values to save for each star.
-    int32_t nValuesPerStar = 24;
+    // Declare how many values to save for each star. Additional filter columns are
+    // stored after the 24 default values.
+    int32_t nValuesPerStar = static_cast<int32_t>(24 + _filterColumnNames.size());
     size_t nDefaultColumns = defaultColumnNames.size();
     auto fitsFileReader = std::make_shared<FitsFileReader>(false);
 
     // Divide all files into ReadFilejobs and then delegate them onto several threads!
+    // If a row block size is given every file is split into several jobs so that no
+    // more than one block per thread has to be kept in memory at a time.
+    size_t nJobs = 0;
     while (!allInputFiles.empty()) {
         std::string fileToRead = allInputFiles.back();
         allInputFiles.erase(allInputFiles.end() - 1);
 
-        // Add reading of file to jobmanager, which will distribute it to our threadpool.
-        auto readFileJob = std::make_shared<gaia::ReadFileJob>(
-            fileToRead,
-            _allColumnNames,
-            _firstRow,
-            _lastRow,
-            nDefaultColumns,
-            nValuesPerStar,
-            fitsFileReader
-        );
-        jobManager.enqueueJob(readFileJob);
+        int lastRow = _lastRow;
+        int blockSize = 0;
+        if (_rowBlockSize > 0) {
+            // Reading a single row of one column is enough to get the size of the table.
+            std::shared_ptr<TableData<float>> table = fitsFileReader->readTable<float>(
+                fileToRead,
+                { defaultColumnNames[0] },
+                1,
+                1
+            );
+            if (!table) {
+                LERROR(fmt::format("Failed to open Fits file '{}'", fileToRead));
+                continue;
+            }
+            if (lastRow < _firstRow || lastRow > table->readRows) {
+                lastRow = table->readRows;
+            }
+            if (_firstRow > lastRow) {
+                continue;
+            }
+            blockSize = _rowBlockSize;
+        }
+
+        int firstRow = _firstRow;
+        do {
+            int lastRowInJob = lastRow;
+            if (blockSize > 0) {
+                lastRowInJob = std::min(firstRow + blockSize - 1, lastRow);
+            }
+
+            // Add reading of rows to jobmanager, which will distribute it to our
+            // threadpool.
+            auto readFileJob = std::make_shared<gaia::ReadFileJob>(
+                fileToRead,
+                _allColumnNames,
+                firstRow,
+                lastRowInJob,
+                nDefaultColumns,
+                nValuesPerStar,
+                fitsFileReader
+            );
+            jobManager.enqueueJob(readFileJob);
+            nJobs++;
+
+            firstRow = lastRowInJob + 1;
+        } while (blockSize > 0 && firstRow <= lastRow);
     }
 
-    LINFO("All files added to queue!");
+    LINFO(fmt::format("All files added to queue as {} jobs!", nJobs));
 
     // Check for finished jobs.
-    while (finishedJobs < nInputFiles) {
+    while (finishedJobs < nJobs) {
         if (jobManager.numFinishedJobs() > 0) {
             std::vector<std::vector<float>> newOctant =
                 jobManager.popFinishedJob()->product();
@@ -266,7 +314,7 @@ void ReadFitsTask::readAllFitsFilesFromFolder(const Task::ProgressCallback&) {
                     newOctant[i].end()
                 );
                 if ((octants[i].size() > MAX_SIZE_BEFORE_WRITE) ||
-                    (finishedJobs == nInputFiles))
+                    (finishedJobs == nJobs))
                 {
                     // Write to file!
                     totalStars += writeOctantToFile(
@@ -384,6 +432,14 @@ documentation::Documentation ReadFitsTask::Documentation() {
                 "to be read from the specified FITS file(s). These columns can be used "
                 "for filtering while constructing Octree later.",
             },
+            {
+                KeyRowBlockSize,
+                new IntVerifier,
+                Optional::Yes,
+                "If defined and larger than 0, every FITS file is read in blocks of this "
+                "many rows instead of all at once. This bounds the memory that is used "
+                "while reading files that are too large to fit in memory.",
+            },
 
         }
     };
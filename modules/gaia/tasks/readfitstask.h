@@ -26,7 +26,6 @@
 #define __OPENSPACE_MODULE_GAIA___READFITSTASK___H__
 
 #include <openspace/util/task.h>
-#include <openspace/util/threadpool.h>
 #include <openspace/util/concurrentjobmanager.h>
 #include <modules/fitsfilereader/include/fitsfilereader.h>
 
@@ -73,6 +72,7 @@ private:
     size_t _threadsToUse = 1;
     int _firstRow = 0;
     int _lastRow = 0;
+    int _rowBlockSize = 0;
     std::vector<std::string> _allColumnNames;
     std::vector<std::string> _filterColumnNames;
 };
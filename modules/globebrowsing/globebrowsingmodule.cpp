@@ -46,6 +46,7 @@
 #include <ghoul/misc/templatefactory.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/systemcapabilities/generalcapabilitiescomponent.h>
+#include <algorithm>
 #include <vector>
 
 #include <gdal.h>
@@ -477,6 +478,16 @@ scripting::LuaLibrary GlobeBrowsingModule::luaLibrary() const {
             "supported by the WMS server identified by the provided name. The 'URL'"
             "component of the returned table can be used in the 'FilePath' argument "
             "for a call to the 'addLayer' function to add the value to a globe."
+        },
+        {
+            "tileQueueLatencies",
+            &globebrowsing::luascriptfunctions::tileQueueLatencies,
+            {},
+            "",
+            "Returns an array of tables with the time that tile requests have waited "
+            "before being loaded, one for each tile level that has been loaded. Each "
+            "table contains the 'Level', the number of loaded tiles 'NumTiles', and "
+            "the 'AverageLatency' and 'MaximumLatency' in milliseconds."
         }
     };
     res.scripts = {
@@ -820,6 +831,26 @@ uint64_t GlobeBrowsingModule::wmsCacheSize() const {
     return size * 1024 * 1024;
 }
 
+void GlobeBrowsingModule::addTileQueueLatencies(
+                                 const std::vector<globebrowsing::JobQueueLatency>& l)
+{
+    if (l.size() > _tileQueueLatencies.size()) {
+        _tileQueueLatencies.resize(l.size());
+    }
+    for (size_t i = 0; i < l.size(); ++i) {
+        globebrowsing::JobQueueLatency& total = _tileQueueLatencies[i];
+        total.nJobs += l[i].nJobs;
+        total.totalLatency += l[i].totalLatency;
+        total.maximumLatency = std::max(total.maximumLatency, l[i].maximumLatency);
+    }
+}
+
+const std::vector<globebrowsing::JobQueueLatency>&
+GlobeBrowsingModule::tileQueueLatencies() const
+{
+    return _tileQueueLatencies;
+}
+
 #ifdef OPENSPACE_MODULE_GLOBEBROWSING_INSTRUMENTATION
 void GlobeBrowsingModule::addFrameInfo(globebrowsing::RenderableGlobe* globe,
                                        uint32_t nTilesRenderedLocal,
@@ -25,6 +25,7 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___GLOBEBROWSING_MODULE___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___GLOBEBROWSING_MODULE___H__
 
+#include <modules/globebrowsing/src/prioritizingconcurrentjobmanager.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/scalar/uintproperty.h>
@@ -95,6 +96,18 @@ public:
     std::string wmsCacheLocation() const;
     uint64_t wmsCacheSize() const; // bytes
 
+    /**
+     * Adds the queue latencies of tile requests, indexed by the level of the requested
+     * tiles, to the totals of all tile providers.
+     */
+    void addTileQueueLatencies(const std::vector<globebrowsing::JobQueueLatency>& l);
+
+    /**
+     * \returns the total time that tile requests have been waiting in the queues of all
+     * tile providers before being loaded, indexed by the level of the requested tiles.
+     */
+    const std::vector<globebrowsing::JobQueueLatency>& tileQueueLatencies() const;
+
 #ifdef OPENSPACE_MODULE_GLOBEBROWSING_INSTRUMENTATION
     void addFrameInfo(globebrowsing::RenderableGlobe* globe, uint32_t nTilesRenderedLocal,
         uint32_t nTilesRenderedGlobal, uint32_t nTilesUploaded);
@@ -142,6 +155,8 @@ private:
 
     std::multimap<std::string, UrlInfo> _urlList;
 
+    std::vector<globebrowsing::JobQueueLatency> _tileQueueLatencies;
+
 #ifdef OPENSPACE_MODULE_GLOBEBROWSING_INSTRUMENTATION
     struct FrameInfo {
         uint64_t iFrame = 0;
@@ -412,4 +412,40 @@ int capabilities(lua_State* L) {
     return 1;
 }
 
+int tileQueueLatencies(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 0, "lua::tileQueueLatencies");
+
+    const std::vector<JobQueueLatency>& latencies =
+        global::moduleEngine.module<GlobeBrowsingModule>()->tileQueueLatencies();
+
+    lua_newtable(L);
+    int key = 1;
+    for (size_t level = 0; level < latencies.size(); ++level) {
+        const JobQueueLatency& l = latencies[level];
+        if (l.nJobs == 0) {
+            continue;
+        }
+
+        lua_newtable(L);
+
+        ghoul::lua::push(L, "Level", static_cast<int>(level));
+        lua_settable(L, -3);
+
+        ghoul::lua::push(L, "NumTiles", static_cast<double>(l.nJobs));
+        lua_settable(L, -3);
+
+        ghoul::lua::push(L, "AverageLatency", 1000.0 * l.totalLatency / l.nJobs);
+        lua_settable(L, -3);
+
+        ghoul::lua::push(L, "MaximumLatency", 1000.0 * l.maximumLatency);
+        lua_settable(L, -3);
+
+        lua_rawseti(L, -2, key);
+        key++;
+    }
+
+    ghoul_assert(lua_gettop(L) == 1, "Incorrect number of items left on stack");
+    return 1;
+}
+
 } // namespace openspace::globebrowsing::luascriptfunctions
@@ -43,7 +43,7 @@ AsyncTileDataProvider::AsyncTileDataProvider(std::string name,
                                     std::unique_ptr<RawTileDataReader> rawTileDataReader)
     : _name(std::move(name))
     , _rawTileDataReader(std::move(rawTileDataReader))
-    , _concurrentJobManager(LRUThreadPool<TileIndex::TileHashKey>(1, 10))
+    , _concurrentJobManager(global::taskScheduler, 1, 10)
 {
     _globeBrowsingModule = global::moduleEngine.module<GlobeBrowsingModule>();
     performReset(ResetRawTileDataReader::No);
@@ -55,16 +55,30 @@ const RawTileDataReader& AsyncTileDataProvider::rawTileDataReader() const {
     return *_rawTileDataReader;
 }
 
-bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex) {
-    if (_resetMode == ResetMode::ShouldNotReset && satisfiesEnqueueCriteria(tileIndex)) {
+bool AsyncTileDataProvider::enqueueTileIO(const TileIndex& tileIndex, float priority) {
+    if (_resetMode == ResetMode::ShouldNotReset &&
+        satisfiesEnqueueCriteria(tileIndex, priority))
+    {
         auto job = std::make_unique<TileLoadJob>(*_rawTileDataReader, tileIndex);
-        _concurrentJobManager.enqueueJob(std::move(job), tileIndex.hashKey());
+        _concurrentJobManager.enqueueJob(
+            std::move(job),
+            tileIndex.hashKey(),
+            priority,
+            tileIndex.level
+        );
         _enqueuedTileRequests.insert(tileIndex.hashKey());
         return true;
     }
     return false;
 }
 
+void AsyncTileDataProvider::cancelTileIO(const TileIndex& tileIndex) {
+    const TileIndex::TileHashKey key = tileIndex.hashKey();
+    if (_concurrentJobManager.cancelJob(key)) {
+        _enqueuedTileRequests.erase(key);
+    }
+}
+
 void AsyncTileDataProvider::clearTiles() {
     std::optional<RawTile> finishedJob = popFinishedRawTile();
     while (finishedJob) {
@@ -72,6 +86,10 @@ void AsyncTileDataProvider::clearTiles() {
     }
 }
 
+bool AsyncTileDataProvider::hasFinishedRawTile() const {
+    return _concurrentJobManager.numFinishedJobs() > 0;
+}
+
 std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
     if (_concurrentJobManager.numFinishedJobs() > 0) {
         // Now the tile load job looses ownerwhip of the data pointer
@@ -93,9 +111,15 @@ std::optional<RawTile> AsyncTileDataProvider::popFinishedRawTile() {
     }
 }
 
-bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex) {
-    // Only satisfies if it is not already enqueued. Also bumps the request to the top.
-    const bool alreadyEnqueued = _concurrentJobManager.touch(tileIndex.hashKey());
+bool AsyncTileDataProvider::satisfiesEnqueueCriteria(const TileIndex& tileIndex,
+                                                     float priority)
+{
+    // Only satisfies if it is not already enqueued. Also updates the priority of the
+    // request to the one of the latest requester
+    const bool alreadyEnqueued = _concurrentJobManager.updatePriority(
+        tileIndex.hashKey(),
+        priority
+    );
     // Early out so we don't need to check the already enqueued requests
     if (alreadyEnqueued) {
         return false;
@@ -129,6 +153,9 @@ void AsyncTileDataProvider::endEnqueuedJobs() {
 
 void AsyncTileDataProvider::update() {
     endUnfinishedJobs();
+    _globeBrowsingModule->addTileQueueLatencies(
+        _concurrentJobManager.fetchQueueLatencies()
+    );
 
     // May reset
     switch (_resetMode) {
@@ -55,9 +55,24 @@ public:
     ~AsyncTileDataProvider();
 
     /**
-     * Creates a job which asynchronously loads a raw tile. This job is enqueued.
+     * Creates a job which asynchronously loads a raw tile. This job is enqueued. If the
+     * tile is already enqueued, its priority is updated instead.
+     * \param tileIndex is the index of the tile that should be loaded
+     * \param priority is the priority of the request; higher values are loaded first
      */
-    bool enqueueTileIO(const TileIndex& tileIndex);
+    bool enqueueTileIO(const TileIndex& tileIndex, float priority);
+
+    /**
+     * Removes the request for the tile with index <code>tileIndex</code> from the queue.
+     * A tile that is currently being loaded can not be cancelled.
+     */
+    void cancelTileIO(const TileIndex& tileIndex);
+
+    /**
+     * Returns whether there is a finished job that can be retrieved through
+     * #popFinishedRawTile.
+     */
+    bool hasFinishedRawTile() const;
 
     /**
      * Get one finished job.
@@ -85,8 +100,9 @@ protected:
 
     /**
      * \returns true if tile of index <code>tileIndex</code> is not already enqueued.
+     * If the tile is enqueued, its priority is set to <code>priority</code>.
      */
-    bool satisfiesEnqueueCriteria(const TileIndex& tileIndex);
+    bool satisfiesEnqueueCriteria(const TileIndex& tileIndex, float priority);
 
     /**
      * An unfinished job is a load tile job that has been popped from the thread pool due
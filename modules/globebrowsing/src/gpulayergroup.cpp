@@ -32,7 +32,8 @@
 namespace openspace::globebrowsing {
 
 void GPULayerGroup::setValue(ghoul::opengl::ProgramObject& program,
-                             const LayerGroup& layerGroup, const TileIndex& tileIndex)
+                             const LayerGroup& layerGroup, const TileIndex& tileIndex,
+                             float priority)
 {
     ghoul_assert(
         layerGroup.activeLayers().size() == _gpuActiveLayers.size(),
@@ -72,6 +73,7 @@ void GPULayerGroup::setValue(ghoul::opengl::ProgramObject& program,
             case layergroupid::TypeID::ByLevelTileLayer: {
                 const ChunkTilePile& ctp = al.chunkTilePile(
                     tileIndex,
+                    priority,
                     layerGroup.pileSize()
                 );
                 for (size_t j = 0; j < _gpuActiveLayers[i].gpuChunkTiles.size(); ++j) {
@@ -52,10 +52,11 @@ public:
     /**
      * Sets the value of <code>LayerGroup</code> to its corresponding
      * GPU struct. OBS! Users must ensure bind has been
-     * called before setting using this method.
+     * called before setting using this method. Missing tiles are requested with the
+     * provided <code>priority</code>.
      */
     void setValue(ghoul::opengl::ProgramObject& programObject,
-        const LayerGroup& layerGroup, const TileIndex& tileIndex);
+        const LayerGroup& layerGroup, const TileIndex& tileIndex, float priority);
 
     /**
      * Binds this object with GLSL variables with identifiers starting
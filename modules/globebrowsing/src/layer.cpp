@@ -389,9 +389,11 @@ void Layer::deinitialize() {
     }
 }
 
-ChunkTilePile Layer::chunkTilePile(const TileIndex& tileIndex, int pileSize) const {
+ChunkTilePile Layer::chunkTilePile(const TileIndex& tileIndex, float priority,
+                                   int pileSize) const
+{
     if (_tileProvider) {
-        return tileprovider::chunkTilePile(*_tileProvider, tileIndex, pileSize);
+        return tileprovider::chunkTilePile(*_tileProvider, tileIndex, priority, pileSize);
     }
     else {
         ChunkTilePile chunkTilePile;
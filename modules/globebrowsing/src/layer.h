@@ -51,7 +51,8 @@ public:
     void initialize();
     void deinitialize();
 
-    ChunkTilePile chunkTilePile(const TileIndex& tileIndex, int pileSize) const;
+    ChunkTilePile chunkTilePile(const TileIndex& tileIndex, float priority,
+        int pileSize) const;
     Tile::Status tileStatus(const TileIndex& index) const;
 
     layergroupid::TypeID type() const;
@@ -25,8 +25,10 @@
 #ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 #define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITIZING_CONCURRENT_JOB_MANAGER___H__
 
-#include <modules/globebrowsing/src/lruthreadpool.h>
+#include <modules/globebrowsing/src/priorityqueue.h>
 #include <openspace/util/concurrentqueue.h>
+#include <openspace/util/taskscheduler.h>
+#include <chrono>
 #include <mutex>
 
 namespace openspace { template <typename T> struct Job; }
@@ -34,39 +36,76 @@ namespace openspace { template <typename T> struct Job; }
 namespace openspace::globebrowsing {
 
 /**
- * Concurrent job manager which prioritizes which jobs to work on depending on which ones
- * were enqueued latest. The class is templated both on the job type and the key type
- * which is used to identify jobs. In case a job need to be explicitly ended. It can be
- * identified using its key.
+ * Accumulated time that jobs of one level have been waiting in the queue of a
+ * PrioritizingConcurrentJobManager before they were started. All times are in seconds.
+ */
+struct JobQueueLatency {
+    uint64_t nJobs = 0;
+    double totalLatency = 0.0;
+    double maximumLatency = 0.0;
+};
+
+/**
+ * Concurrent job manager which prioritizes which jobs to work on depending on a priority
+ * that is provided when the job is enqueued. Jobs with the same priority are worked on in
+ * the reverse order in which they were enqueued. The class is templated both on the job
+ * type and the key type which is used to identify jobs. In case a job need to be
+ * explicitly ended. It can be identified using its key.
+ *
+ * Only a limited number of jobs are kept in the queue; when it is full, the job with the
+ * lowest priority is dropped. The jobs are executed on the TaskScheduler with at most a
+ * fixed number of them running at the same time.
  */
 template<typename P, typename KeyType>
 class PrioritizingConcurrentJobManager {
 public:
-    PrioritizingConcurrentJobManager(LRUThreadPool<KeyType> pool);
+    /**
+     * \param scheduler is the TaskScheduler on which the jobs are executed
+     * \param nConcurrentJobs is the maximum number of jobs that are executed at once
+     * \param queueSize is the maximum number of jobs that are waiting to be executed
+     */
+    PrioritizingConcurrentJobManager(TaskScheduler& scheduler, size_t nConcurrentJobs,
+        size_t queueSize);
+    ~PrioritizingConcurrentJobManager();
 
     /**
-     * Enqueues a job which is identified using a given key
+     * Enqueues a job which is identified using a given key. If the queue is full and all
+     * of the enqueued jobs have a higher priority, the job is not enqueued and its key is
+     * instead returned by the next call to keysToUnfinishedJobs.
+     * \param job is the job to be executed
+     * \param key is the identifier of the job
+     * \param priority is the priority of the job; higher values are executed first
+     * \param level is the level at which the time the job waits in the queue is recorded
      */
-    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key);
+    void enqueueJob(std::shared_ptr<Job<P>> job, KeyType key, float priority, int level);
 
     /**
      * The keys returned by this function have been popped from the queue and corresponds
-     * to jobs that will not be executed and therefore marked as unfinished. Calling this
-     * function will also clear the list of unfinished jobs so if the jobs need to be
-     * explicitly ended, the user need to make sure to do so after calling this function.
+     * to jobs that will not be executed, or whose execution failed, and therefore marked
+     * as unfinished. Calling this function will also clear the list of unfinished jobs so
+     * if the jobs need to be explicitly ended, the user need to make sure to do so after
+     * calling this function.
      */
     std::vector<KeyType> keysToUnfinishedJobs();
 
     std::vector<KeyType> keysToEnqueuedJobs();
 
     /**
-     * Bumps the job identified with <code>key</code> to the beginning of the queue.
-     * In case the job was not already enqueued the function simply returns false and
-     * no state is changed.
-     * \param key is the identifier of the job to bump.
+     * Changes the priority of the job identified with <code>key</code>. In case the job
+     * was not already enqueued the function simply returns false and no state is changed.
+     * \param key is the identifier of the job to reprioritize.
+     * \param priority is the new priority of the job
+     * \returns true if the job was found, else returns false.
+     */
+    bool updatePriority(KeyType key, float priority);
+
+    /**
+     * Removes the job identified with <code>key</code> from the queue. Can not end a job
+     * that a worker is currently handling.
+     * \param key is the identifier of the job to remove.
      * \returns true if the job was found, else returns false.
      */
-    bool touch(KeyType key);
+    bool cancelJob(KeyType key);
 
     /**
      * Clear all enqueued jobs. Can not end jobs that workers are currently handling.
@@ -82,11 +121,42 @@ public:
 
     size_t numFinishedJobs() const;
 
+    /**
+     * \returns the queue latencies, indexed by the level that was passed to enqueueJob,
+     * of the jobs that have been started since the last call to this function.
+     */
+    std::vector<JobQueueLatency> fetchQueueLatencies();
+
 private:
+    struct DefaultHasher {
+        unsigned long long operator()(const KeyType& key) const {
+            return static_cast<unsigned long long>(key);
+        }
+    };
+
+    struct QueuedJob {
+        std::shared_ptr<Job<P>> job;
+        std::chrono::steady_clock::time_point enqueueTime;
+        int level;
+    };
+
+    /// Executes the highest priority jobs until there are no more jobs queued
+    void executeQueuedJobs();
+
     ConcurrentQueue<std::shared_ptr<Job<P>>> _finishedJobs;
     std::mutex _finishedJobsMutex;
-    /// An LRU thread pool is used since the jobs can be bumped and hence prioritized.
-    LRUThreadPool<KeyType> _threadPool;
+
+    /// An indexed priority queue is used since the jobs can be reprioritized
+    PriorityQueue<KeyType, QueuedJob, DefaultHasher> _queuedJobs;
+    const size_t _queueSize;
+    std::vector<KeyType> _unqueuedJobs;
+    std::vector<JobQueueLatency> _queueLatencies;
+    size_t _nRunningExecutors = 0;
+    const size_t _nConcurrentJobs;
+    std::mutex _queueMutex;
+
+    /// Declared last so that the running jobs finish before the other members are gone
+    TaskGroup _executors;
 };
 
 } // namespace openspace::globebrowsing
@@ -22,47 +22,155 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <ghoul/logging/logmanager.h>
 #include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
 
 namespace openspace::globebrowsing {
 
 template <typename P, typename KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::PrioritizingConcurrentJobManager(
-                                                              LRUThreadPool<KeyType> pool)
-    : _threadPool(std::move(pool))
+                                                                 TaskScheduler& scheduler,
+                                                                   size_t nConcurrentJobs,
+                                                                         size_t queueSize)
+    : _queueSize(queueSize)
+    , _nConcurrentJobs(nConcurrentJobs)
+    , _executors(scheduler)
 {}
 
+template <typename P, typename KeyType>
+PrioritizingConcurrentJobManager<P, KeyType>::~PrioritizingConcurrentJobManager() {
+    // Make sure the running executors stop after their current job
+    clearEnqueuedJobs();
+}
+
 template <typename P, typename KeyType>
 void PrioritizingConcurrentJobManager<P, KeyType>::enqueueJob(std::shared_ptr<Job<P>> job,
-                                                              KeyType key)
+                                                              KeyType key, float priority,
+                                                              int level)
 {
-    _threadPool.enqueue([this, job]() {
-        job->execute();
-        std::lock_guard lock(_finishedJobsMutex);
-        _finishedJobs.push(job);
-    }, key);
+    {
+        std::lock_guard lock(_queueMutex);
+        const bool isFull = !_queuedJobs.contains(key) &&
+                            _queuedJobs.size() >= _queueSize;
+        if (isFull) {
+            if (_queueSize == 0 || priority <= _queuedJobs.lowestPriority()) {
+                // The new job would be the first one to be dropped
+                _unqueuedJobs.push_back(key);
+                return;
+            }
+            _unqueuedJobs.push_back(_queuedJobs.popLowest().key);
+        }
+
+        QueuedJob queuedJob = { std::move(job), std::chrono::steady_clock::now(), level };
+        _queuedJobs.push(key, std::move(queuedJob), priority);
+
+        if (_nRunningExecutors >= _nConcurrentJobs) {
+            // One of the running executors will pick up the job
+            return;
+        }
+        _nRunningExecutors++;
+    }
+
+    _executors.run([this]() { executeQueuedJobs(); });
+}
+
+template <typename P, typename KeyType>
+void PrioritizingConcurrentJobManager<P, KeyType>::executeQueuedJobs() {
+    while (true) {
+        std::shared_ptr<Job<P>> job;
+        KeyType key;
+        {
+            std::lock_guard lock(_queueMutex);
+            if (_queuedJobs.isEmpty()) {
+                _nRunningExecutors--;
+                return;
+            }
+            auto element = _queuedJobs.pop();
+            key = element.key;
+            QueuedJob queuedJob = std::move(element.value);
+            job = std::move(queuedJob.job);
+
+            const std::chrono::duration<double> latency =
+                std::chrono::steady_clock::now() - queuedJob.enqueueTime;
+            const size_t level = static_cast<size_t>(std::max(queuedJob.level, 0));
+            if (level >= _queueLatencies.size()) {
+                _queueLatencies.resize(level + 1);
+            }
+            JobQueueLatency& l = _queueLatencies[level];
+            l.nJobs++;
+            l.totalLatency += latency.count();
+            l.maximumLatency = std::max(l.maximumLatency, latency.count());
+        }
+
+        // A failing job must not end this executor, as it would still count as running
+        // and no new executor would be started in its place. The job is instead reported
+        // as unfinished so that it can be requested again
+        bool success = false;
+        try {
+            job->execute();
+            success = true;
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+        }
+        catch (const std::exception& e) {
+            LERRORC("PrioritizingConcurrentJobManager", e.what());
+        }
+        catch (...) {
+            LERRORC("PrioritizingConcurrentJobManager", "Unknown error in job");
+        }
+
+        if (success) {
+            std::lock_guard lock(_finishedJobsMutex);
+            _finishedJobs.push(job);
+        }
+        else {
+            std::lock_guard lock(_queueMutex);
+            _unqueuedJobs.push_back(key);
+        }
+    }
 }
 
 template <typename P, typename KeyType>
 std::vector<KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::keysToUnfinishedJobs() {
-    return _threadPool.getUnqueuedTasksKeys();
+    std::lock_guard lock(_queueMutex);
+    std::vector<KeyType> keys = std::move(_unqueuedJobs);
+    _unqueuedJobs.clear();
+    return keys;
 }
 
 template <typename P, typename KeyType>
 std::vector<KeyType>
 PrioritizingConcurrentJobManager<P, KeyType>::keysToEnqueuedJobs() {
-    return _threadPool.getQueuedTasksKeys();
+    std::vector<KeyType> keys;
+    std::lock_guard lock(_queueMutex);
+    while (!_queuedJobs.isEmpty()) {
+        keys.push_back(_queuedJobs.pop().key);
+    }
+    return keys;
 }
 
 template <typename P, typename KeyType>
-bool PrioritizingConcurrentJobManager<P, KeyType>::touch(KeyType key) {
-    return _threadPool.touch(key);
+bool PrioritizingConcurrentJobManager<P, KeyType>::updatePriority(KeyType key,
+                                                                  float priority)
+{
+    std::lock_guard lock(_queueMutex);
+    return _queuedJobs.setPriority(key, priority);
+}
+
+template <typename P, typename KeyType>
+bool PrioritizingConcurrentJobManager<P, KeyType>::cancelJob(KeyType key) {
+    std::lock_guard lock(_queueMutex);
+    return _queuedJobs.erase(key);
 }
 
 template <typename P, typename KeyType>
 void PrioritizingConcurrentJobManager<P, KeyType>::clearEnqueuedJobs() {
-    _threadPool.clearEnqueuedTasks();
+    std::lock_guard lock(_queueMutex);
+    _queuedJobs.clear();
 }
 
 template <typename P, typename KeyType>
@@ -79,4 +187,13 @@ size_t PrioritizingConcurrentJobManager<P, KeyType>::numFinishedJobs() const {
     return _finishedJobs.size();
 }
 
+template <typename P, typename KeyType>
+std::vector<JobQueueLatency>
+PrioritizingConcurrentJobManager<P, KeyType>::fetchQueueLatencies() {
+    std::lock_guard lock(_queueMutex);
+    std::vector<JobQueueLatency> latencies = std::move(_queueLatencies);
+    _queueLatencies.clear();
+    return latencies;
+}
+
 } // namespace openspace::globebrowsing
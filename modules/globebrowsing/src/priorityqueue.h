@@ -0,0 +1,110 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_QUEUE___H__
+#define __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_QUEUE___H__
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace openspace::globebrowsing {
+
+/**
+ * Templated class implementing an indexed max-priority queue. In addition to the usual
+ * push and pop operations, items can be looked up by their key to change their priority
+ * or to remove them from the queue. If two items have the same priority, the one that
+ * was pushed or reprioritized last is popped first. <code>KeyType</code> needs to be an
+ * enumerable type.
+ */
+template <typename KeyType, typename ValueType, typename HasherType>
+class PriorityQueue {
+public:
+    struct Item {
+        KeyType key;
+        ValueType value;
+        float priority;
+        uint64_t order;
+    };
+
+    /**
+     * Adds the <code>value</code> to the queue. If an item with the same
+     * <code>key</code> already exists, its value and priority are replaced.
+     */
+    void push(KeyType key, ValueType value, float priority);
+
+    /**
+     * Changes the priority of the item identified by <code>key</code>.
+     * \returns true if the item exists in the queue.
+     */
+    bool setPriority(const KeyType& key, float priority);
+
+    /**
+     * Removes the item identified by <code>key</code> from the queue.
+     * \returns true if the item existed in the queue.
+     */
+    bool erase(const KeyType& key);
+
+    /**
+     * Pops the item with the highest priority.
+     */
+    Item pop();
+
+    /**
+     * Pops the item with the lowest priority. This operation is linear in the number of
+     * items in the queue.
+     */
+    Item popLowest();
+
+    /**
+     * \returns the lowest priority of all items in the queue. This operation is linear
+     * in the number of items in the queue.
+     */
+    float lowestPriority() const;
+
+    bool contains(const KeyType& key) const;
+    bool isEmpty() const;
+    size_t size() const;
+    void clear();
+
+private:
+    bool isBefore(const Item& lhs, const Item& rhs) const;
+    size_t lowestIndex() const;
+    Item removeAt(size_t index);
+    void swapItems(size_t lhs, size_t rhs);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+
+    /// The items are stored as a binary heap
+    std::vector<Item> _items;
+    /// Maps a key to the index of its item in the heap
+    std::unordered_map<KeyType, size_t, HasherType> _indices;
+    uint64_t _nextOrder = 0;
+};
+
+} // namespace openspace::globebrowsing
+
+#include <modules/globebrowsing/src/priorityqueue.inl>
+
+#endif // __OPENSPACE_MODULE_GLOBEBROWSING___PRIORITY_QUEUE___H__
@@ -0,0 +1,204 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <ghoul/misc/assert.h>
+#include <utility>
+
+namespace openspace::globebrowsing {
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void PriorityQueue<KeyType, ValueType, HasherType>::push(KeyType key, ValueType value,
+                                                         float priority)
+{
+    const auto it = _indices.find(key);
+    if (it != _indices.end()) {
+        _items[it->second].value = std::move(value);
+        setPriority(key, priority);
+        return;
+    }
+
+    _indices[key] = _items.size();
+    _items.push_back({ std::move(key), std::move(value), priority, _nextOrder++ });
+    siftUp(_items.size() - 1);
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool PriorityQueue<KeyType, ValueType, HasherType>::setPriority(const KeyType& key,
+                                                                float priority)
+{
+    const auto it = _indices.find(key);
+    if (it == _indices.end()) {
+        return false;
+    }
+
+    const size_t index = it->second;
+    const bool increased = priority >= _items[index].priority;
+    _items[index].priority = priority;
+    _items[index].order = _nextOrder++;
+    if (increased) {
+        siftUp(index);
+    }
+    else {
+        siftDown(index);
+    }
+    return true;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool PriorityQueue<KeyType, ValueType, HasherType>::erase(const KeyType& key) {
+    const auto it = _indices.find(key);
+    if (it == _indices.end()) {
+        return false;
+    }
+    removeAt(it->second);
+    return true;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+typename PriorityQueue<KeyType, ValueType, HasherType>::Item
+PriorityQueue<KeyType, ValueType, HasherType>::pop()
+{
+    ghoul_assert(!_items.empty(), "There is no item to pop");
+    return removeAt(0);
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+typename PriorityQueue<KeyType, ValueType, HasherType>::Item
+PriorityQueue<KeyType, ValueType, HasherType>::popLowest()
+{
+    ghoul_assert(!_items.empty(), "There is no item to pop");
+    return removeAt(lowestIndex());
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+float PriorityQueue<KeyType, ValueType, HasherType>::lowestPriority() const {
+    ghoul_assert(!_items.empty(), "The queue is empty");
+    return _items[lowestIndex()].priority;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool PriorityQueue<KeyType, ValueType, HasherType>::contains(const KeyType& key) const {
+    return _indices.find(key) != _indices.end();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool PriorityQueue<KeyType, ValueType, HasherType>::isEmpty() const {
+    return _items.empty();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t PriorityQueue<KeyType, ValueType, HasherType>::size() const {
+    return _items.size();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void PriorityQueue<KeyType, ValueType, HasherType>::clear() {
+    _items.clear();
+    _indices.clear();
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+bool PriorityQueue<KeyType, ValueType, HasherType>::isBefore(const Item& lhs,
+                                                             const Item& rhs) const
+{
+    if (lhs.priority != rhs.priority) {
+        return lhs.priority > rhs.priority;
+    }
+    return lhs.order > rhs.order;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+size_t PriorityQueue<KeyType, ValueType, HasherType>::lowestIndex() const {
+    // The lowest priority item is always a leaf of the heap, which are stored in the
+    // second half of the vector
+    size_t lowest = _items.size() / 2;
+    for (size_t i = lowest + 1; i < _items.size(); ++i) {
+        if (isBefore(_items[lowest], _items[i])) {
+            lowest = i;
+        }
+    }
+    return lowest;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+typename PriorityQueue<KeyType, ValueType, HasherType>::Item
+PriorityQueue<KeyType, ValueType, HasherType>::removeAt(size_t index)
+{
+    const size_t last = _items.size() - 1;
+    if (index != last) {
+        swapItems(index, last);
+    }
+
+    Item item = std::move(_items.back());
+    _items.pop_back();
+    _indices.erase(item.key);
+
+    if (index < _items.size()) {
+        // The item that was moved into the hole can need to go either way
+        siftUp(index);
+        siftDown(index);
+    }
+    return item;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void PriorityQueue<KeyType, ValueType, HasherType>::swapItems(size_t lhs, size_t rhs) {
+    std::swap(_items[lhs], _items[rhs]);
+    _indices[_items[lhs].key] = lhs;
+    _indices[_items[rhs].key] = rhs;
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void PriorityQueue<KeyType, ValueType, HasherType>::siftUp(size_t index) {
+    while (index > 0) {
+        const size_t parent = (index - 1) / 2;
+        if (!isBefore(_items[index], _items[parent])) {
+            return;
+        }
+        swapItems(index, parent);
+        index = parent;
+    }
+}
+
+template <typename KeyType, typename ValueType, typename HasherType>
+void PriorityQueue<KeyType, ValueType, HasherType>::siftDown(size_t index) {
+    while (true) {
+        const size_t left = 2 * index + 1;
+        const size_t right = left + 1;
+        size_t first = index;
+        if (left < _items.size() && isBefore(_items[left], _items[first])) {
+            first = left;
+        }
+        if (right < _items.size() && isBefore(_items[right], _items[first])) {
+            first = right;
+        }
+        if (first == index) {
+            return;
+        }
+        swapItems(index, first);
+        index = first;
+    }
+}
+
+} // namespace openspace::globebrowsing
@@ -35,7 +35,7 @@
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
 #include <openspace/performance/performancemanager.h>
-#include <openspace/performance/performancemeasurement.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
@@ -245,13 +245,14 @@ const Chunk& findChunkNode(const Chunk& node, const Geodetic2& location) {
 }
 
 std::vector<std::pair<ChunkTile, const LayerRenderSettings*>>
-tilesAndSettingsUnsorted(const LayerGroup& layerGroup, const TileIndex& tileIndex)
+tilesAndSettingsUnsorted(const LayerGroup& layerGroup, const TileIndex& tileIndex,
+                         float priority)
 {
     std::vector<std::pair<ChunkTile, const LayerRenderSettings*>> tilesAndSettings;
     for (Layer* layer : layerGroup.activeLayers()) {
         if (layer->tileProvider()) {
             tilesAndSettings.emplace_back(
-                tileprovider::chunkTile(*layer->tileProvider(), tileIndex),
+                tileprovider::chunkTile(*layer->tileProvider(), tileIndex, priority),
                 &layer->renderSettings()
             );
         }
@@ -272,7 +273,8 @@ BoundingHeights boundingHeightsForChunk(const Chunk& chunk, const LayerManager&
     const LayerGroup& heightmaps = lm.layerGroup(layergroupid::GroupID::HeightLayers);
     std::vector<ChunkTileSettingsPair> chunkTileSettingPairs = tilesAndSettingsUnsorted(
         heightmaps,
-        chunk.tileIndex
+        chunk.tileIndex,
+        chunk.tilePriority
     );
 
     bool lastHadMissingData = true;
@@ -327,7 +329,8 @@ bool colorAvailableForChunk(const Chunk& chunk, const LayerManager& lm) {
     const LayerGroup& colormaps = lm.layerGroup(layergroupid::GroupID::ColorLayers);
     std::vector<ChunkTileSettingsPair> chunkTileSettingPairs = tilesAndSettingsUnsorted(
         colormaps,
-        chunk.tileIndex
+        chunk.tileIndex,
+        chunk.tilePriority
     );
 
     for (const ChunkTileSettingsPair& chunkTileSettingsPair : chunkTileSettingPairs) {
@@ -341,6 +344,16 @@ bool colorAvailableForChunk(const Chunk& chunk, const LayerManager& lm) {
     return true;
 }
 
+void cancelTileRequests(const Chunk& chunk, const LayerManager& lm) {
+    for (const LayerGroup* layerGroup : lm.layerGroups()) {
+        for (Layer* layer : layerGroup->activeLayers()) {
+            if (layer->tileProvider()) {
+                tileprovider::cancelTileRequest(*layer->tileProvider(), chunk.tileIndex);
+            }
+        }
+    }
+}
+
 std::array<glm::dvec4, 8> boundingCornersForChunk(const Chunk& chunk,
                                                   const Ellipsoid& ellipsoid,
                                                   const BoundingHeights& heights)
@@ -1152,14 +1165,19 @@ void RenderableGlobe::renderChunks(const RenderData& data, RendererTasks&) {
 }
 
 void RenderableGlobe::renderChunkGlobally(const Chunk& chunk, const RenderData& data) {
-    //PerfMeasure("globally");
+    //ProfileZone("globally");
     const TileIndex& tileIndex = chunk.tileIndex;
     ghoul::opengl::ProgramObject& program = *_globalRenderer.program;
 
     const std::array<LayerGroup*, LayerManager::NumLayerGroups>& layerGroups =
         _layerManager.layerGroups();
     for (size_t i = 0; i < layerGroups.size(); ++i) {
-        _globalRenderer.gpuLayerGroups[i].setValue(program, *layerGroups[i], tileIndex);
+        _globalRenderer.gpuLayerGroups[i].setValue(
+            program,
+            *layerGroups[i],
+            tileIndex,
+            chunk.tilePriority
+        );
     }
 
     // The length of the skirts is proportional to its size
@@ -1209,14 +1227,19 @@ void RenderableGlobe::renderChunkGlobally(const Chunk& chunk, const RenderData&
 }
 
 void RenderableGlobe::renderChunkLocally(const Chunk& chunk, const RenderData& data) {
-    //PerfMeasure("locally");
+    //ProfileZone("locally");
     const TileIndex& tileIndex = chunk.tileIndex;
     ghoul::opengl::ProgramObject& program = *_localRenderer.program;
 
     const std::array<LayerGroup*, LayerManager::NumLayerGroups>& layerGroups =
         _layerManager.layerGroups();
     for (size_t i = 0; i < layerGroups.size(); ++i) {
-        _localRenderer.gpuLayerGroups[i].setValue(program, *layerGroups[i], tileIndex);
+        _localRenderer.gpuLayerGroups[i].setValue(
+            program,
+            *layerGroups[i],
+            tileIndex,
+            chunk.tilePriority
+        );
     }
 
     // The length of the skirts is proportional to its size
@@ -2002,6 +2025,13 @@ int RenderableGlobe::desiredLevelByDistance(const Chunk& chunk,
 int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
                                                  const RenderData& data,
                                                  const BoundingHeights& heights) const
+{
+    const double scaledArea = scaledProjectedArea(chunk, data, heights);
+    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
+}
+
+double RenderableGlobe::scaledProjectedArea(const Chunk& chunk, const RenderData& data,
+                                            const BoundingHeights& heights) const
 {
     // Calculations are done in the reference frame of the globe
     // (model space). Hence, the camera position needs to be transformed
@@ -2077,9 +2107,7 @@ int RenderableGlobe::desiredLevelByProjectedArea(const Chunk& chunk,
     const double areaABC = 0.5 * glm::length(glm::cross(AC, AB));
     const double projectedChunkAreaApprox = 8 * areaABC;
 
-    const double scaledArea = _generalProperties.currentLodScaleFactor *
-                              projectedChunkAreaApprox;
-    return chunk.tileIndex.level + static_cast<int>(round(scaledArea - 1));
+    return _generalProperties.currentLodScaleFactor * projectedChunkAreaApprox;
 }
 
 int RenderableGlobe::desiredLevelByAvailableTileData(const Chunk& chunk) const {
@@ -2208,6 +2236,8 @@ void RenderableGlobe::splitChunkNode(Chunk& cn, int depth) {
             cn.children[i] = new (memory[i]) Chunk(
                 cn.tileIndex.child(static_cast<Quad>(i))
             );
+            // Until the child is updated, it covers a quarter of its parent's area
+            cn.children[i]->tilePriority = cn.tilePriority / 4.f;
             const BoundingHeights& heights = boundingHeightsForChunk(
                 *(cn.children[i]),
                 _layerManager
@@ -2241,6 +2271,8 @@ void RenderableGlobe::mergeChunkNode(Chunk& cn) {
     for (Chunk* child : cn.children) {
         if (child) {
             mergeChunkNode(*child);
+            // The tiles of a merged chunk are no longer needed
+            cancelTileRequests(*child, _layerManager);
             freeChunkNode(child);
         }
     }
@@ -2310,6 +2342,11 @@ void RenderableGlobe::updateChunk(Chunk& chunk, const RenderData& data) const {
         chunk.isVisible = true;
     }
 
+    // Culled chunks are not rendered, so the loading of their tiles can wait
+    chunk.tilePriority = chunk.isVisible ?
+        static_cast<float>(scaledProjectedArea(chunk, data, heights)) :
+        0.f;
+
     const int dl = desiredLevel(chunk, data, heights);
 
     if (dl < chunk.tileIndex.level) {
@@ -34,6 +34,7 @@
 #include <modules/globebrowsing/src/layermanager.h>
 #include <modules/globebrowsing/src/skirtedgrid.h>
 #include <modules/globebrowsing/src/tileindex.h>
+#include <modules/globebrowsing/src/tileprovider.h>
 #include <openspace/properties/scalar/floatproperty.h>
 #include <openspace/properties/scalar/intproperty.h>
 #include <openspace/properties/scalar/boolproperty.h>
@@ -77,6 +78,10 @@ struct Chunk {
     bool colorTileOK = false;
     bool heightTileOK = false;
 
+    /// The priority with which missing tiles are requested on behalf of this chunk. It is
+    /// the projected area of the chunk relative to the area at which it should be split
+    float tilePriority = tileprovider::DefaultTilePriority;
+
     std::array<glm::dvec4, 8> corners;
     std::array<Chunk*, 4> children = { { nullptr, nullptr, nullptr, nullptr } };
 };
@@ -217,6 +222,15 @@ private:
         const BoundingHeights& heights) const;
     int desiredLevelByProjectedArea(const Chunk& chunk, const RenderData& data,
         const BoundingHeights& heights) const;
+
+    /**
+     * Approximates the area that the chunk covers when projected onto a unit sphere
+     * around the camera, scaled with the current level of detail scale factor. A value
+     * of 1 means that the chunk is shown at the level of detail that it is meant for,
+     * larger values mean that the chunk is shown with too few pixels.
+     */
+    double scaledProjectedArea(const Chunk& chunk, const RenderData& data,
+        const BoundingHeights& heights) const;
     int desiredLevelByAvailableTileData(const Chunk& chunk) const;
 
 
@@ -32,6 +32,7 @@
 #include <modules/globebrowsing/src/rawtiledatareader.h>
 #include <openspace/engine/globals.h>
 #include <openspace/engine/moduleengine.h>
+#include <openspace/rendering/renderengine.h>
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/filesystem/file.h>
@@ -164,11 +165,25 @@ void initAsyncTileDataReader(DefaultTileProvider& t, TileTextureInitData initDat
 
 bool initTexturesFromLoadedData(DefaultTileProvider& t) {
     if (t.asyncTextureDataProvider) {
+        if (!t.asyncTextureDataProvider->hasFinishedRawTile()) {
+            return false;
+        }
+
+        // If the upload budget of this frame is exhausted, the finished tiles remain in
+        // the queue of the data provider and are uploaded in one of the next frames
+        RenderQueue& queue = global::renderEngine.renderQueue();
+        if (!queue.requestUpload()) {
+            return false;
+        }
+
         std::optional<RawTile> tile = t.asyncTextureDataProvider->popFinishedRawTile();
         if (tile) {
             const cache::ProviderTileKey key = { tile->tileIndex, t.uniqueIdentifier };
             ghoul_assert(!t.tileCache->exist(key), "Tile must not be existing in cache");
+            const bool hasData = tile->error == RawTile::ReadError::None;
+            const size_t nBytes = hasData ? tile->textureInitData->totalNumBytes : 0;
             t.tileCache->createTileAndPut(key, std::move(tile.value()));
+            queue.registerUpload(nBytes);
             return true;
         }
     }
@@ -859,7 +874,7 @@ bool deinitialize(TileProvider& tp) {
 
 
 
-Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
+Tile tile(TileProvider& tp, const TileIndex& tileIndex, float priority) {
     switch (tp.type) {
         case Type::DefaultTileProvider: {
             DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
@@ -871,7 +886,7 @@ Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
                 const Tile tile = t.tileCache->get(key);
 
                 if (!tile.texture) {
-                    t.asyncTextureDataProvider->enqueueTileIO(tileIndex);
+                    t.asyncTextureDataProvider->enqueueTileIO(tileIndex, priority);
                 }
 
                 return tile;
@@ -942,13 +957,13 @@ Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
             TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
             const auto it = t.tileProviderMap.find(tileIndex.hashKey());
             const bool hasProvider = it != t.tileProviderMap.end();
-            return hasProvider ? tile(*it->second, tileIndex) : Tile();
+            return hasProvider ? tile(*it->second, tileIndex, priority) : Tile();
         }
         case Type::ByLevelTileProvider: {
             TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
             TileProvider* provider = levelProvider(t, tileIndex.level);
             if (provider) {
-                return tile(*provider, tileIndex);
+                return tile(*provider, tileIndex, priority);
             }
             else {
                 return Tile();
@@ -958,7 +973,7 @@ Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
             TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
             if (t.successfulInitialization) {
                 ensureUpdated(t);
-                return tile(*t.currentTileProvider, tileIndex);
+                return tile(*t.currentTileProvider, tileIndex, priority);
             }
             else {
                 return Tile();
@@ -972,6 +987,50 @@ Tile tile(TileProvider& tp, const TileIndex& tileIndex) {
 
 
 
+void cancelTileRequest(TileProvider& tp, const TileIndex& tileIndex) {
+    switch (tp.type) {
+        case Type::DefaultTileProvider: {
+            DefaultTileProvider& t = static_cast<DefaultTileProvider&>(tp);
+            if (t.asyncTextureDataProvider) {
+                t.asyncTextureDataProvider->cancelTileIO(tileIndex);
+            }
+            break;
+        }
+        case Type::SingleImageTileProvider:
+        case Type::SizeReferenceTileProvider:
+        case Type::TileIndexTileProvider:
+            break;
+        case Type::ByIndexTileProvider: {
+            TileProviderByIndex& t = static_cast<TileProviderByIndex&>(tp);
+            const auto it = t.tileProviderMap.find(tileIndex.hashKey());
+            if (it != t.tileProviderMap.end()) {
+                cancelTileRequest(*it->second, tileIndex);
+            }
+            break;
+        }
+        case Type::ByLevelTileProvider: {
+            TileProviderByLevel& t = static_cast<TileProviderByLevel&>(tp);
+            TileProvider* provider = levelProvider(t, tileIndex.level);
+            if (provider) {
+                cancelTileRequest(*provider, tileIndex);
+            }
+            break;
+        }
+        case Type::TemporalTileProvider: {
+            TemporalTileProvider& t = static_cast<TemporalTileProvider&>(tp);
+            if (t.successfulInitialization && t.currentTileProvider) {
+                cancelTileRequest(*t.currentTileProvider, tileIndex);
+            }
+            break;
+        }
+        default:
+            throw ghoul::MissingCaseException();
+    }
+}
+
+
+
+
 Tile::Status tileStatus(TileProvider& tp, const TileIndex& index) {
     switch (tp.type) {
         case Type::DefaultTileProvider: {
@@ -1306,10 +1365,12 @@ float noDataValueAsFloat(TileProvider& tp) {
 
 
 
-ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents, int maxParents) {
+ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, float priority, int parents,
+                    int maxParents)
+{
     ghoul_assert(tp.isInitialized, "TileProvider was not initialized.");
 
-    auto ascendToParent = [](TileIndex& tileIndex, TileUvTransform& uv) {
+    auto ascendToParent = [&priority](TileIndex& tileIndex, TileUvTransform& uv) {
         uv.uvOffset *= 0.5;
         uv.uvScale *= 0.5;
 
@@ -1318,6 +1379,9 @@ ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents, int maxP
         tileIndex.x /= 2;
         tileIndex.y /= 2;
         tileIndex.level--;
+
+        // The parent covers four times the area at the same resolution
+        priority *= 4.f;
     };
 
     TileUvTransform uvTransform = { glm::vec2(0.f, 0.f), glm::vec2(1.f, 1.f) };
@@ -1342,7 +1406,7 @@ ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents, int maxP
     // Step 3. Traverse 0 or more parents up the chunkTree until we find a chunk that
     //         has a loaded tile ready to use.
     while (tileIndex.level > 1) {
-        Tile t = tile(tp, tileIndex);
+        Tile t = tile(tp, tileIndex, priority);
         if (t.status != Tile::Status::OK) {
             if (--maxParents < 0) {
                 return ChunkTile{ Tile(), uvTransform, TileDepthTransform() };
@@ -1362,13 +1426,15 @@ ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents, int maxP
 
 
 
-ChunkTilePile chunkTilePile(TileProvider& tp, TileIndex tileIndex, int pileSize) {
+ChunkTilePile chunkTilePile(TileProvider& tp, TileIndex tileIndex, float priority,
+                            int pileSize)
+{
     ghoul_assert(tp.isInitialized, "TileProvider was not initialized.");
     ghoul_assert(pileSize >= 0, "pileSize must be positive");
 
     ChunkTilePile chunkTilePile(pileSize);
     for (int i = 0; i < pileSize; ++i) {
-        chunkTilePile[i] = chunkTile(tp, tileIndex, i);
+        chunkTilePile[i] = chunkTile(tp, tileIndex, priority, i);
         if (chunkTilePile[i].tile.status == Tile::Status::Unavailable) {
             if (i > 0) {
                 // First iteration
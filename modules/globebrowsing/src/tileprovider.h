@@ -197,12 +197,37 @@ std::unique_ptr<TileProvider> createFromDictionary(layergroupid::TypeID layerTyp
 bool initialize(TileProvider& tp);
 bool deinitialize(TileProvider& tp);
 
-Tile tile(TileProvider& tp, const TileIndex& tileIndex);
+/**
+ * The priority of a tile request is the projected area of the requested tile in units of
+ * the area at which a tile is shown at its full resolution, which makes it a measure of
+ * the screen-space error that is caused by the tile missing. Requests that are not made
+ * on behalf of a rendered chunk use this priority.
+ */
+constexpr const float DefaultTilePriority = 1.f;
+
+/**
+ * Returns the tile with the index <code>tileIndex</code>. If the tile is not loaded
+ * yet, it is requested with the provided <code>priority</code>.
+ */
+Tile tile(TileProvider& tp, const TileIndex& tileIndex,
+    float priority = DefaultTilePriority);
 
-ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex, int parents = 0,
-    int maxParents = 1337);
+/**
+ * Removes the pending request for the tile with index <code>tileIndex</code>, for
+ * example because the chunk that requested it was merged into its parent.
+ */
+void cancelTileRequest(TileProvider& tp, const TileIndex& tileIndex);
+
+/**
+ * The <code>priority</code> is the one of the tile at <code>tileIndex</code>. If one of
+ * the parent tiles is requested instead, the priority is scaled by the ratio of the
+ * areas of the two tiles.
+ */
+ChunkTile chunkTile(TileProvider& tp, TileIndex tileIndex,
+    float priority = DefaultTilePriority, int parents = 0, int maxParents = 1337);
 
-ChunkTilePile chunkTilePile(TileProvider& tp, TileIndex tileIndex, int pileSize);
+ChunkTilePile chunkTilePile(TileProvider& tp, TileIndex tileIndex, float priority,
+    int pileSize);
 
 /**
  * Returns the status of a <code>Tile</code>. The <code>Tile::Status</code>
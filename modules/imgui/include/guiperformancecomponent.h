@@ -48,7 +48,6 @@ protected:
     properties::IntProperty _sortingSelection;
 
     properties::BoolProperty _sceneGraphIsEnabled;
-    properties::BoolProperty _functionsIsEnabled;
     properties::BoolProperty _outputLogs;
 };
 
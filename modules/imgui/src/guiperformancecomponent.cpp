@@ -57,13 +57,6 @@ namespace {
         "graph values is visible."
     };
 
-    constexpr openspace::properties::Property::PropertyInfo FunctionsEnabledInfo = {
-        "ShowFunctions",
-        "Show Function Measurements",
-        "If this value is enabled, the window showing the measurements for the "
-        "individual functions is visible."
-    };
-
     constexpr openspace::properties::Property::PropertyInfo OutputLogsInfo = {
         "OutputLogs",
         "Output Logs",
@@ -78,13 +71,11 @@ GuiPerformanceComponent::GuiPerformanceComponent()
     : GuiComponent("PerformanceComponent", "Performance Component")
     , _sortingSelection(SortingSelectionInfo, -1, -1, 6)
     , _sceneGraphIsEnabled(SceneGraphEnabledInfo, false)
-    , _functionsIsEnabled(FunctionsEnabledInfo, false)
     , _outputLogs(OutputLogsInfo, false)
 {
     addProperty(_sortingSelection);
 
     addProperty(_sceneGraphIsEnabled);
-    addProperty(_functionsIsEnabled);
     addProperty(_outputLogs);
 }
 
@@ -109,9 +100,6 @@ void GuiPerformanceComponent::render() {
     v = _sceneGraphIsEnabled;
     ImGui::Checkbox("SceneGraph", &v);
     _sceneGraphIsEnabled = v;
-    v = _functionsIsEnabled;
-    ImGui::Checkbox("Functions", &v);
-    _functionsIsEnabled = v;
     v = _outputLogs;
     ImGui::Checkbox("Output Logs", &v);
     global::performanceManager.setLogging(v);
@@ -406,51 +394,6 @@ void GuiPerformanceComponent::render() {
         ImGui::End();
     }
 
-    if (_functionsIsEnabled) {
-        bool fe = _functionsIsEnabled;
-        ImGui::Begin("Functions", &fe);
-        _functionsIsEnabled = fe;
-
-        for (int i = 0; i < layout->nFunctionEntries; ++i) {
-            using namespace performance;
-
-            const PerformanceLayout::FunctionPerformanceLayout& entry =
-                layout->functionEntries[i];
-
-            float avg = 0.f;
-            int count = 0;
-            for (int j = 0; j < PerformanceLayout::NumberValues; ++j) {
-                avg += layout->functionEntries[i].time[j];
-                if (layout->functionEntries[i].time[j] != 0.f) {
-                    ++count;
-                }
-            }
-            if (count > 0) {
-                avg /= count;
-            }
-
-            auto minmax = std::minmax_element(
-                std::begin(layout->functionEntries[i].time),
-                std::end(layout->functionEntries[i].time)
-            );
-
-            const std::string& renderTime = std::to_string(
-                entry.time[PerformanceLayout::NumberValues - 1]
-            ) + "us";
-            ImGui::PlotLines(
-                fmt::format("{}\nAverage: {}us", entry.name, avg).c_str(),
-                &entry.time[0],
-                PerformanceLayout::NumberValues,
-                0,
-                renderTime.c_str(),
-                *(minmax.first),
-                *(minmax.second),
-                ImVec2(0, 40)
-            );
-        }
-        ImGui::End();
-    }
-
     ImGui::End();
 }
 
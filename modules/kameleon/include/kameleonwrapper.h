@@ -28,6 +28,8 @@
 #include <ghoul/glm.h>
 #include <glm/gtx/std_based_type.hpp>
 #include <array>
+#include <functional>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -117,6 +119,26 @@ public:
     std::array<std::string, 3> gridVariables() const;
 
 
+    /**
+     * Integrates a fieldline from the \p seedPoint with the Bogacki-Shampine 3(2) method
+     * and an adaptive step size. The integration does not depend on a model, which makes
+     * it possible to verify it against analytic fields.
+     *
+     * \param field Returns the field vector at the passed position. If the second
+     *        argument is not <code>nullptr</code>, the size of the grid cell containing
+     *        the position is stored in it
+     * \param isInside Returns whether the passed position is within the traced domain
+     * \param seedPoint The position at which the integration starts
+     * \param stepSize The initial step size as a fraction of the local grid cell size
+     * \param direction The direction along the field in which the line is traced
+     * \returns The positions along the fieldline. The last position is the first one
+     *          outside the domain or the position at which the step limit was reached
+     */
+    static std::vector<glm::vec3> integrateFieldline(
+        const std::function<glm::vec3(const glm::vec3&, glm::vec3*)>& field,
+        const std::function<bool(const glm::vec3&)>& isInside,
+        const glm::vec3& seedPoint, float stepSize, TraceDirection direction);
+
     Model model() const;
     GridType gridType() const;
     std::string parent() const;
@@ -127,8 +149,22 @@ public:
 private:
     using TraceLine = std::vector<glm::vec3>;
 
-    TraceLine traceCartesianFieldline(const std::string& xVar, const std::string& yVar,
-        const std::string& zVar, const glm::vec3& seedPoint, float stepSize,
+    /**
+     * Traces the fieldlines of the vector field \p xVar, \p yVar, \p zVar from all
+     * \p seedPoints in parallel. If no \p color is provided, each line is colored by
+     * the classification of its end points.
+     */
+    Fieldlines traceFieldlines(const std::string& xVar, const std::string& yVar,
+        const std::string& zVar, const std::vector<glm::vec3>& seedPoints, float stepSize,
+        const std::optional<glm::vec4>& color) const;
+
+    /**
+     * Traces a single fieldline from the \p seedPoint with an adaptive step size, using
+     * the provided \p interpolator and the IDs of already loaded variables. The
+     * \p stepSize is the initial step size as a fraction of the local grid cell size.
+     */
+    TraceLine traceCartesianFieldline(ccmc::Interpolator& interpolator, long int xID,
+        long int yID, long int zID, const glm::vec3& seedPoint, float stepSize,
         TraceDirection direction, FieldlineEnd& end) const;
 
     TraceLine traceLorentzTrajectory(const glm::vec3& seedPoint, float stepsize,
@@ -139,6 +175,20 @@ private:
     Model modelType() const;
     glm::vec4 classifyFieldline(FieldlineEnd fEnd, FieldlineEnd bEnd) const;
 
+    /**
+     * Calls \p function for all items in <code>[0, nItems)</code>, distributed over the
+     * threads of the task scheduler and the calling thread. Every thread passes its own
+     * interpolator, as they are not thread-safe. The function returns when all items
+     * have been processed.
+     *
+     * \param nItems The number of items to process
+     * \param function The function that processes the item with the passed index
+     * \param showProgress If <code>true</code>, the progress is printed on the console
+     */
+    void runParallel(size_t nItems,
+        const std::function<void(ccmc::Interpolator&, size_t)>& function,
+        bool showProgress) const;
+
     ccmc::Kameleon* _kameleon = nullptr;
     ccmc::Model* _model = nullptr;
     Model _type = Model::Unknown;
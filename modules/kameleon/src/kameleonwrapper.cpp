@@ -24,6 +24,9 @@
 
 #include <modules/kameleon/include/kameleonwrapper.h>
 
+#include <openspace/engine/globals.h>
+#include <openspace/util/progressbar.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
@@ -31,6 +34,12 @@
 #include <ghoul/glm.h>
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/misc.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <optional>
 
 #ifdef WIN32
 #pragma warning (push)
@@ -178,6 +187,53 @@ void KameleonWrapper::close() {
     _gridType = GridType::Unknown;
 }
 
+void KameleonWrapper::runParallel(size_t nItems,
+                       const std::function<void(ccmc::Interpolator&, size_t)>& function,
+                                  bool showProgress) const
+{
+    std::atomic<size_t> nextItem = 0;
+    std::atomic<size_t> nFinishedItems = 0;
+
+    // The interpolators cache the cell of the previous sample and are not thread-safe,
+    // so every thread needs its own. Items are handed out one at a time, since their
+    // cost varies a lot between the inside and the outside of the model's domain
+    auto worker = [this, nItems, &function, &nextItem, &nFinishedItems]() {
+        std::unique_ptr<ccmc::Interpolator> interpolator(
+            _model->createNewInterpolator()
+        );
+        for (size_t i = nextItem++; i < nItems; i = nextItem++) {
+            function(*interpolator, i);
+            nFinishedItems++;
+        }
+    };
+
+    // The calling thread works as well, so one task fewer than there are threads is
+    // enough. This also guarantees progress if this is called from a worker thread
+    TaskGroup tasks(global::taskScheduler);
+    const size_t nThreads = std::min(global::taskScheduler.numThreads(), nItems);
+    for (size_t i = 1; i < nThreads; ++i) {
+        tasks.run(worker);
+    }
+
+    std::unique_ptr<ccmc::Interpolator> interpolator(_model->createNewInterpolator());
+    std::unique_ptr<ProgressBar> progressBar;
+    if (showProgress) {
+        progressBar = std::make_unique<ProgressBar>(static_cast<int>(nItems));
+    }
+    for (size_t i = nextItem++; i < nItems; i = nextItem++) {
+        function(*interpolator, i);
+        nFinishedItems++;
+        if (progressBar) {
+            progressBar->print(static_cast<int>(nFinishedItems));
+        }
+    }
+
+    tasks.wait();
+    if (progressBar) {
+        progressBar->print(static_cast<int>(nItems));
+    }
+}
+
 // This method returns new'd memory,  turn into std::vector<float> instead?
 float* KameleonWrapper::uniformSampledValues(const std::string& var,
                                              const glm::size3_t& outDimensions) const
@@ -188,8 +244,8 @@ float* KameleonWrapper::uniformSampledValues(const std::string& var,
 
     const size_t size = outDimensions.x * outDimensions.y * outDimensions.z;
     float* data = new float[size];
-    std::vector<double> doubleData(size);
-
+    // Samples outside the domain are left at zero
+    std::vector<double> doubleData(size, 0.0);
 
     const double varMin =
         _model->getVariableAttribute(var, "actual_min").getAttributeFloat();
@@ -198,103 +254,116 @@ float* KameleonWrapper::uniformSampledValues(const std::string& var,
         _model->getVariableAttribute(var, "actual_max").getAttributeFloat();
     LDEBUG(fmt::format("{} Max: {}", var, varMax));
 
-    // HISTOGRAM
-    constexpr const int NBins = 200;
-    std::vector<int> histogram(NBins, 0);
-    // Explicitly mentioning the capture list provides either an error on MSVC (if NBins)
-    // is not specified or a warning on Clang if it is specified. Sigh...
-    auto mapToHistogram = [=](double val) {
-        double zeroToOne = (val - varMin) / (varMax - varMin);
-        zeroToOne *= static_cast<double>(NBins);
-        const int izerotoone = static_cast<int>(zeroToOne);
-
-        return glm::clamp(izerotoone, 0, NBins - 1);
-    };
+    const long int varID = _model->getVariableID(var);
+
+    // Every sample coordinate only depends on one of the grid indices, so the model
+    // coordinates are computed once per index and looked up while sampling. The inside
+    // flags mark the coordinates that are within the model's domain
+    std::vector<float> xCoords(outDimensions.x);
+    std::vector<float> yCoords(outDimensions.y);
+    std::vector<float> zCoords(outDimensions.z);
+    std::vector<char> xInside(outDimensions.x, 1);
+    std::vector<char> yInside(outDimensions.y, 1);
+    std::vector<char> zInside(outDimensions.z, 1);
+
+    if (_gridType == GridType::Spherical) {
+        bool hasGap = false;
+        for (size_t x = 0; x < outDimensions.x; ++x) {
+            // Put r in the [0..sqrt(3)] range
+            const double rNorm = glm::root_three<double>() * x / outDimensions.x - 1;
+            // Go to physical coordinates before sampling
+            const double rPh = _min.x + rNorm * (_max.x - _min.x);
+            xInside[x] = rPh >= _min.x && rPh <= _max.x;
+            // ENLIL CDF specific hacks!
+            // Convert from meters to AU for interpolator
+            xCoords[x] = static_cast<float>(rPh / ccmc::constants::AU_in_meters);
+        }
+        for (size_t y = 0; y < outDimensions.y; ++y) {
+            // Put theta in the [0..PI] range
+            const double thetaPh = glm::pi<double>() * y / outDimensions.y - 1;
+            yInside[y] = thetaPh >= _min.y && thetaPh <= _max.y;
+            // Convert from colatitude [0, pi] rad to latitude [-90, 90] deg
+            yCoords[y] = static_cast<float>(-thetaPh * 180.f / glm::pi<double>() + 90.f);
+        }
+        for (size_t z = 0; z < outDimensions.z; ++z) {
+            // Put phi in the [0..2PI] range
+            const double phiNorm = glm::two_pi<double>() * z / outDimensions.z - 1;
+            // phi range needs to be mapped to the slightly different model range to
+            // avoid gaps in the data Subtract a small term to avoid rounding errors when
+            // comparing to phiMax.
+            const double phiPh = _min.z + phiNorm / glm::two_pi<double>() *
+                                 (_max.z - _min.z - 0.000001);
+            zInside[z] = phiPh >= _min.z && phiPh <= _max.z;
+            hasGap |= phiPh > _max.z;
+            // Convert from [0, 2pi] rad to [0, 360] degrees
+            zCoords[z] = static_cast<float>(phiPh * 180.f / glm::pi<double>());
+        }
 
-    // ProgressBar pb(static_cast<int>(outDimensions.x));
-    for (size_t x = 0; x < outDimensions.x; ++x) {
+        if (hasGap) {
+            LWARNING("Warning: There might be a gap in the data");
+        }
+    }
+    else {
+        // Assume cartesian for fallback purpose
+        const double stepX = (_max.x - _min.x) / (static_cast<double>(outDimensions.x));
+        const double stepY = (_max.y - _min.y) / (static_cast<double>(outDimensions.y));
+        const double stepZ = (_max.z - _min.z) / (static_cast<double>(outDimensions.z));
+        for (size_t x = 0; x < outDimensions.x; ++x) {
+            xCoords[x] = static_cast<float>(_min.x + stepX * x);
+        }
         for (size_t y = 0; y < outDimensions.y; ++y) {
-            for (size_t z = 0; z < outDimensions.z; ++z) {
-                const size_t index = x + y * outDimensions.x +
-                                     z * outDimensions.x * outDimensions.y;
-
-                if (_gridType == GridType::Spherical) {
-                    // Put r in the [0..sqrt(3)] range
-                    const double rNorm = glm::root_three<double>() * x /
-                                         outDimensions.x - 1;
-
-                    // Put theta in the [0..PI] range
-                    const double thetaNorm = glm::pi<double>() * y / outDimensions.y - 1;
-
-                    // Put phi in the [0..2PI] range
-                    const double phiNorm = glm::two_pi<double>() * z /
-                                           outDimensions.z - 1;
-
-                    // Go to physical coordinates before sampling
-                    const double rPh = _min.x + rNorm * (_max.x - _min.x);
-                    const double thetaPh = thetaNorm;
-                    // phi range needs to be mapped to the slightly different model
-                    // range to avoid gaps in the data Subtract a small term to
-                    // avoid rounding errors when comparing to phiMax.
-                    const double phiPh = _min.z + phiNorm /
-                                    glm::two_pi<double>() * (_max.z - _min.z - 0.000001);
-
-                    double value = 0.0;
-                    // See if sample point is inside domain
-                    if (rPh < _min.x || rPh > _max.x || thetaPh < _min.y ||
-                        thetaPh > _max.y || phiPh < _min.z || phiPh > _max.z)
-                    {
-                        if (phiPh > _max.z) {
-                            LWARNING("Warning: There might be a gap in the data");
-                        }
-                        // Leave values at zero if outside domain
-                    } else { // if inside
-                        // ENLIL CDF specific hacks!
-                        // Convert from meters to AU for interpolator
-                        const double localRPh = rPh / ccmc::constants::AU_in_meters;
-                        // Convert from colatitude [0, pi] rad to latitude [-90, 90] deg
-                        const double localThetaPh = -thetaPh * 180.f /
-                                                    glm::pi<double>() + 90.f;
-                        // Convert from [0, 2pi] rad to [0, 360] degrees
-                        const double localPhiPh = phiPh * 180.f / glm::pi<double>();
-                        // Sample
-                        value = _interpolator->interpolate(
-                            var,
-                            static_cast<float>(localRPh),
-                            static_cast<float>(localThetaPh),
-                            static_cast<float>(localPhiPh)
+            yCoords[y] = static_cast<float>(_min.y + stepY * y);
+        }
+        for (size_t z = 0; z < outDimensions.z; ++z) {
+            zCoords[z] = static_cast<float>(_min.z + stepZ * z);
+        }
+    }
+
+    const bool isSpherical = (_gridType == GridType::Spherical);
+    runParallel(
+        outDimensions.y * outDimensions.z,
+        [&](ccmc::Interpolator& interpolator, size_t row) {
+            const size_t y = row % outDimensions.y;
+            const size_t z = row / outDimensions.y;
+            double* values = doubleData.data() + row * outDimensions.x;
+
+            if (isSpherical) {
+                if (!yInside[y] || !zInside[z]) {
+                    // Leave values at zero if outside domain
+                    return;
+                }
+                for (size_t x = 0; x < outDimensions.x; ++x) {
+                    if (xInside[x]) {
+                        values[x] = interpolator.interpolate(
+                            varID,
+                            xCoords[x],
+                            yCoords[y],
+                            zCoords[z]
                         );
                     }
-
-                    doubleData[index] = value;
-                    histogram[mapToHistogram(value)]++;
-
-                } else {
-                    // Assume cartesian for fallback purpose
-                    const double stepX = (_max.x - _min.x) /
-                                         (static_cast<double>(outDimensions.x));
-                    const double stepY = (_max.y - _min.y) /
-                                         (static_cast<double>(outDimensions.y));
-                    const double stepZ = (_max.z - _min.z) /
-                                         (static_cast<double>(outDimensions.z));
-
-                    const double xPos = _min.x + stepX * x;
-                    const double yPos = _min.y + stepY * y;
-                    const double zPos = _min.z + stepZ * z;
-
-                    // get interpolated data value for (xPos, yPos, zPos)
-                    // swap yPos and zPos because model has Z as up
-                    double value = _interpolator->interpolate(
-                        var,
-                        static_cast<float>(xPos),
-                        static_cast<float>(zPos),
-                        static_cast<float>(yPos)
+                }
+            }
+            else {
+                // swap yPos and zPos because model has Z as up
+                for (size_t x = 0; x < outDimensions.x; ++x) {
+                    values[x] = interpolator.interpolate(
+                        varID,
+                        xCoords[x],
+                        zCoords[z],
+                        yCoords[y]
                     );
-                    doubleData[index] = value;
-                    histogram[mapToHistogram(value)]++;
                 }
             }
-        }
+        },
+        true
+    );
+
+    // HISTOGRAM
+    constexpr const int NBins = 200;
+    std::vector<int> histogram(NBins, 0);
+    for (size_t i = 0; i < size; ++i) {
+        const double zeroToOne = (doubleData[i] - varMin) / (varMax - varMin) * NBins;
+        histogram[glm::clamp(static_cast<int>(zeroToOne), 0, NBins - 1)]++;
     }
 
     int sum = 0;
@@ -312,16 +381,9 @@ float* KameleonWrapper::uniformSampledValues(const std::string& var,
     const double dist = ((varMax - varMin) / NBins) * stop;
 
     const double varMaxNew = varMin + dist;
-    for(size_t i = 0; i < size; ++i) {
+    for (size_t i = 0; i < size; ++i) {
         const double normalizedVal = (doubleData[i] - varMin) / (varMaxNew - varMin);
-
         data[i] = static_cast<float>(glm::clamp(normalizedVal, 0.0, 1.0));
-        if (data[i] < 0.f) {
-            LERROR(fmt::format("Datapoint {} less than 0", i));
-        }
-        if (data[i] > 1.f) {
-            LERROR(fmt::format("Datapoint {} more than 1", i));
-        }
     }
 
     return data;
@@ -340,9 +402,10 @@ float* KameleonWrapper::uniformSliceValues(const std::string& var,
 
     const size_t size = outDimensions.x * outDimensions.y * outDimensions.z;
     float* data = new float[size];
-    std::vector<double> doubleData(size);
+    std::fill(data, data + size, 0.f);
 
     _model->loadVariable(var);
+    const long int varID = _model->getVariableID(var);
 
     const double varMin =
         _model->getVariableAttribute(var, "actual_min").getAttributeFloat();
@@ -364,91 +427,102 @@ float* KameleonWrapper::uniformSliceValues(const std::string& var,
     LDEBUG(fmt::format("{} min: {}", var, varMin));
     LDEBUG(fmt::format("{} max: {}", var, varMax));
 
-    //double maxValue = 0.0;
-    //double minValue = std::numeric_limits<double>::max();
+    const float missingValue = _model->getMissingValue();
 
-    float missingValue = _model->getMissingValue();
+    // As for the uniformly sampled values, the model coordinates of each grid index are
+    // computed up front. The interpolator is called with the coordinates in the order
+    // (x, z, y) for cartesian grids and (r, phi, theta) for spherical grids
+    std::vector<float> xCoords(outDimensions.x);
+    std::vector<float> yCoords(outDimensions.y);
+    std::vector<float> zCoords(outDimensions.z);
+    std::vector<char> xInside(outDimensions.x, 1);
+    std::vector<char> yInside(outDimensions.y, 1);
+    std::vector<char> zInside(outDimensions.z, 1);
 
+    const bool isSpherical = (_gridType == GridType::Spherical);
+    bool hasGap = false;
     for (size_t x = 0; x < outDimensions.x; ++x) {
-        for (size_t y = 0; y < outDimensions.y; ++y) {
-            for(size_t z = 0; z < outDimensions.z; ++z){
-
-                const float xi = (hasXSlice) ? slice : x;
-                const float yi = (hasYSlice) ? slice : y;
-                const float zi = (hasZSlice) ? slice : z;
-
-                double value = 0;
-                const size_t index = x + y * outDimensions.x +
-                                     z * outDimensions.x * outDimensions.y;
-                if (_gridType == GridType::Spherical) {
-                        // int z = zSlice;
-                        // Put r in the [0..sqrt(3)] range
-                        const double rNorm = glm::root_three<double>() * xi / xDim;
-
-                        // Put theta in the [0..PI] range
-                        const double thetaNorm = glm::pi<double>() * yi / yDim;
-
-                        // Put phi in the [0..2PI] range
-                        const double phiNorm = glm::two_pi<double>() * zi / zDim;
-
-                        // Go to physical coordinates before sampling
-                        const double rPh = _min.x + rNorm * (_max.x - _min.x);
-                        const double thetaPh = thetaNorm;
-                        // phi range needs to be mapped to the slightly different model
-                        // range to avoid gaps in the data Subtract a small term to
-                        // avoid rounding errors when comparing to phiMax.
-                        const double phiPh = _min.z + phiNorm / glm::two_pi<double>() *
-                                             (_max.z - _min.z - 0.000001);
-
-                        // See if sample point is inside domain
-                        if (rPh < _min.x || rPh > _max.x || thetaPh < _min.y ||
-                            thetaPh > _max.y || phiPh < _min.z || phiPh > _max.z)
-                        {
-                            if (phiPh > _max.z) {
-                                LWARNING("Warning: There might be a gap in the data");
-                            }
-                            // Leave values at zero if outside domain
-                        } else { // if inside
-                            // ENLIL CDF specific hacks!
-                            // Convert from meters to AU for interpolator
-                            const double localRPh = rPh / ccmc::constants::AU_in_meters;
-                            // Convert from colatitude [0, pi] rad to [-90, 90] deg
-                            const double localThetaPh = -thetaPh * 180.f /
-                                                        glm::pi<double>() + 90.f;
-                            // Convert from [0, 2pi] rad to [0, 360] degrees
-                            const double localPhiPh = phiPh * 180.f / glm::pi<double>();
-                            // Sample
-                            value = _interpolator->interpolate(
-                                var,
-                                static_cast<float>(localRPh),
-                                static_cast<float>(localPhiPh),
-                                static_cast<float>(localThetaPh)
-                            );
-                        }
-
-                } else {
-                    const double xPos = _min.x + stepX * xi;
-                    const double yPos = _min.y + stepY * yi;
-                    const double zPos = _min.z + stepZ * zi;
-
-                    // std::cout << zPos << ", " << zpos << std::endl;
-                    // Should y and z be flipped?
-                    value = _interpolator->interpolate(
-                        var,
-                        static_cast<float>(xPos),
-                        static_cast<float>(zPos),
-                        static_cast<float>(yPos));
+        const float xi = hasXSlice ? slice : x;
+        if (isSpherical) {
+            // Put r in the [0..sqrt(3)] range
+            const double rNorm = glm::root_three<double>() * xi / xDim;
+            // Go to physical coordinates before sampling
+            const double rPh = _min.x + rNorm * (_max.x - _min.x);
+            xInside[x] = rPh >= _min.x && rPh <= _max.x;
+            // ENLIL CDF specific hacks!
+            // Convert from meters to AU for interpolator
+            xCoords[x] = static_cast<float>(rPh / ccmc::constants::AU_in_meters);
+        }
+        else {
+            xCoords[x] = static_cast<float>(_min.x + stepX * xi);
+        }
+    }
+    for (size_t y = 0; y < outDimensions.y; ++y) {
+        const float yi = hasYSlice ? slice : y;
+        if (isSpherical) {
+            // Put theta in the [0..PI] range
+            const double thetaPh = glm::pi<double>() * yi / yDim;
+            yInside[y] = thetaPh >= _min.y && thetaPh <= _max.y;
+            // Convert from colatitude [0, pi] rad to [-90, 90] deg
+            yCoords[y] = static_cast<float>(-thetaPh * 180.f / glm::pi<double>() + 90.f);
+        }
+        else {
+            yCoords[y] = static_cast<float>(_min.y + stepY * yi);
+        }
+    }
+    for (size_t z = 0; z < outDimensions.z; ++z) {
+        const float zi = hasZSlice ? slice : z;
+        if (isSpherical) {
+            // Put phi in the [0..2PI] range
+            const double phiNorm = glm::two_pi<double>() * zi / zDim;
+            // phi range needs to be mapped to the slightly different model range to
+            // avoid gaps in the data Subtract a small term to avoid rounding errors when
+            // comparing to phiMax.
+            const double phiPh = _min.z + phiNorm / glm::two_pi<double>() *
+                                 (_max.z - _min.z - 0.000001);
+            zInside[z] = phiPh >= _min.z && phiPh <= _max.z;
+            hasGap |= phiPh > _max.z;
+            // Convert from [0, 2pi] rad to [0, 360] degrees
+            zCoords[z] = static_cast<float>(phiPh * 180.f / glm::pi<double>());
+        }
+        else {
+            zCoords[z] = static_cast<float>(_min.z + stepZ * zi);
+        }
+    }
+
+    if (hasGap) {
+        LWARNING("Warning: There might be a gap in the data");
+    }
+
+    runParallel(
+        outDimensions.y * outDimensions.z,
+        [&](ccmc::Interpolator& interpolator, size_t row) {
+            const size_t y = row % outDimensions.y;
+            const size_t z = row / outDimensions.y;
+            if (!yInside[y] || !zInside[z]) {
+                // Leave values at zero if outside domain
+                return;
+            }
+
+            float* values = data + row * outDimensions.x;
+            for (size_t x = 0; x < outDimensions.x; ++x) {
+                if (!xInside[x]) {
+                    continue;
                 }
+                const float value = interpolator.interpolate(
+                    varID,
+                    xCoords[x],
+                    zCoords[z],
+                    yCoords[y]
+                );
 
                 if (value != missingValue) {
-                    doubleData[index] = value;
-                    data[index] = static_cast<float>(value);
-                } else {
-                    doubleData[index] = 0;
+                    values[x] = value;
                 }
             }
-        }
-    }
+        },
+        false
+    );
 
     return data;
 }
@@ -470,6 +544,12 @@ float* KameleonWrapper::uniformSampledVectorValues(const std::string& xVar,
     constexpr const int NumChannels = 4;
     const size_t size = NumChannels * outDimensions.x * outDimensions.y * outDimensions.z;
     float* data = new float[size];
+    std::fill(data, data + size, 0.f);
+
+    if (_gridType != GridType::Cartesian) {
+        LERROR("Only cartesian grid supported for uniformSampledVectorValues (for now)");
+        return data;
+    }
 
     float varXMin = _model->getVariableAttribute(xVar, "actual_min").getAttributeFloat();
     float varXMax = _model->getVariableAttribute(xVar, "actual_max").getAttributeFloat();
@@ -478,51 +558,41 @@ float* KameleonWrapper::uniformSampledVectorValues(const std::string& xVar,
     float varZMin = _model->getVariableAttribute(zVar, "actual_min").getAttributeFloat();
     float varZMax = _model->getVariableAttribute(zVar, "actual_max").getAttributeFloat();
 
+    const long int xID = _model->getVariableID(xVar);
+    const long int yID = _model->getVariableID(yVar);
+    const long int zID = _model->getVariableID(zVar);
+
     const float stepX = (_max.x - _min.x) / (static_cast<float>(outDimensions.x));
     const float stepY = (_max.y - _min.y) / (static_cast<float>(outDimensions.y));
     const float stepZ = (_max.z - _min.z) / (static_cast<float>(outDimensions.z));
 
-    //LDEBUG(xVar << "Min: " << varXMin);
-    //LDEBUG(xVar << "Max: " << varXMax);
-    //LDEBUG(yVar << "Min: " << varYMin);
-    //LDEBUG(yVar << "Max: " << varYMax);
-    //LDEBUG(zVar << "Min: " << varZMin);
-    //LDEBUG(zVar << "Max: " << varZMax);
-
-    //ProgressBar pb(static_cast<int>(outDimensions.x));
-    for (size_t x = 0; x < outDimensions.x; ++x) {
-        //pb.print(x);
-        for (size_t y = 0; y < outDimensions.y; ++y) {
-            for (size_t z = 0; z < outDimensions.z; ++z) {
-                const size_t index = x * NumChannels + y * NumChannels * outDimensions.x +
-                                     z * NumChannels * outDimensions.x * outDimensions.y;
-
-                if (_gridType == GridType::Cartesian) {
-                    const float xPos = _min.x + stepX * x;
-                    const float yPos = _min.y + stepY * y;
-                    const float zPos = _min.z + stepZ * z;
-
-                    // get interpolated data value for (xPos, yPos, zPos)
-                    const float xVal = _interpolator->interpolate(xVar, xPos, yPos, zPos);
-                    const float yVal = _interpolator->interpolate(yVar, xPos, yPos, zPos);
-                    const float zVal = _interpolator->interpolate(zVar, xPos, yPos, zPos);
-
-                    // scale to [0,1]
-                    data[index]     = (xVal - varXMin) / (varXMax - varXMin); // R
-                    data[index + 1] = (yVal - varYMin) / (varYMax - varYMin); // G
-                    data[index + 2] = (zVal - varZMin) / (varZMax - varZMin); // B
-                    // GL_RGB refuses to work. Workaround doing a GL_RGBA  hardcoded alpha
-                    data[index + 3] = 1.f;
-                } else {
-                    LERROR(
-                        "Only cartesian grid supported for "
-                        "uniformSampledVectorValues (for now)"
-                    );
-                    return data;
-                }
+    runParallel(
+        outDimensions.y * outDimensions.z,
+        [&](ccmc::Interpolator& interpolator, size_t row) {
+            const float yPos = _min.y + stepY * (row % outDimensions.y);
+            const float zPos = _min.z + stepZ * (row / outDimensions.y);
+            float* values = data + NumChannels * row * outDimensions.x;
+
+            for (size_t x = 0; x < outDimensions.x; ++x) {
+                const float xPos = _min.x + stepX * x;
+
+                // All three components are sampled at the same position one after
+                // another, so that the interpolator only has to locate the cell once
+                const float xVal = interpolator.interpolate(xID, xPos, yPos, zPos);
+                const float yVal = interpolator.interpolate(yID, xPos, yPos, zPos);
+                const float zVal = interpolator.interpolate(zID, xPos, yPos, zPos);
+
+                // scale to [0,1]
+                float* voxel = values + NumChannels * x;
+                voxel[0] = (xVal - varXMin) / (varXMax - varXMin); // R
+                voxel[1] = (yVal - varYMin) / (varYMax - varYMin); // G
+                voxel[2] = (zVal - varZMin) / (varZMax - varZMin); // B
+                // GL_RGB refuses to work. Workaround doing a GL_RGBA  hardcoded alpha
+                voxel[3] = 1.f;
             }
-        }
-    }
+        },
+        true
+    );
 
     return data;
 }
@@ -533,57 +603,7 @@ KameleonWrapper::Fieldlines KameleonWrapper::classifiedFieldLines(const std::str
                                                  const std::vector<glm::vec3>& seedPoints,
                                                                      float stepSize) const
 {
-    ghoul_assert(_model && _interpolator, "Model and interpolator must exist");
-    LINFO(fmt::format(
-        "Creating {} fieldlines from variables {} {} {}",
-        seedPoints.size(), xVar, yVar, zVar
-    ));
-
-    std::vector<std::vector<LinePoint> > fieldLines;
-
-    if (_type == Model::BATSRUS) {
-        fieldLines.reserve(seedPoints.size());
-        for (const glm::vec3& seedPoint : seedPoints) {
-            FieldlineEnd forwardEnd;
-            std::vector<glm::vec3> fLine = traceCartesianFieldline(
-                xVar,
-                yVar,
-                zVar,
-                seedPoint,
-                stepSize,
-                TraceDirection::FORWARD,
-                forwardEnd
-            );
-            FieldlineEnd backEnd;
-            std::vector<glm::vec3> bLine = traceCartesianFieldline(
-                xVar,
-                yVar,
-                zVar,
-                seedPoint,
-                stepSize,
-                TraceDirection::BACK,
-                backEnd
-            );
-
-            bLine.erase(bLine.begin());
-            bLine.insert(bLine.begin(), fLine.rbegin(), fLine.rend());
-
-            // classify
-            glm::vec4 color = classifyFieldline(forwardEnd, backEnd);
-
-            // write colors and convert positions to meter
-            std::vector<LinePoint> line;
-            for (glm::vec3& position : bLine) {
-                line.push_back({ RE_TO_METER * std::move(position), color });
-            }
-
-            fieldLines.push_back(line);
-        }
-    } else {
-        LERROR("Fieldlines are only supported for BATSRUS model");
-    }
-
-    return fieldLines;
+    return traceFieldlines(xVar, yVar, zVar, seedPoints, stepSize, std::nullopt);
 }
 
 KameleonWrapper::Fieldlines KameleonWrapper::fieldLines(const std::string& xVar,
@@ -593,55 +613,7 @@ KameleonWrapper::Fieldlines KameleonWrapper::fieldLines(const std::string& xVar,
                                                                            float stepSize,
                                                              const glm::vec4& color) const
 {
-    ghoul_assert(_model && _interpolator, "Model and interpolator must exist");
-
-    LINFO(fmt::format(
-        "Creating {} fieldlines from variables {} {} {}",
-        seedPoints.size(), xVar, yVar, zVar
-    ));
-
-    Fieldlines fieldLines;
-
-    if (_type == Model::BATSRUS) {
-        fieldLines.reserve(seedPoints.size());
-        for (const glm::vec3& seedPoint : seedPoints) {
-            FieldlineEnd forwardEnd;
-            std::vector<glm::vec3> fLine = traceCartesianFieldline(
-                xVar,
-                yVar,
-                zVar,
-                seedPoint,
-                stepSize,
-                TraceDirection::FORWARD,
-                forwardEnd
-            );
-            FieldlineEnd backEnd;
-            std::vector<glm::vec3> bLine = traceCartesianFieldline(
-                xVar,
-                yVar,
-                zVar,
-                seedPoint,
-                stepSize,
-                TraceDirection::BACK,
-                backEnd
-            );
-
-            bLine.erase(bLine.begin());
-            bLine.insert(bLine.begin(), fLine.rbegin(), fLine.rend());
-
-            // write colors and convert positions to meter
-            std::vector<LinePoint> line;
-            for (glm::vec3& position : bLine) {
-                line.push_back({ RE_TO_METER * std::move(position), color });
-            }
-
-            fieldLines.push_back(line);
-        }
-    } else {
-        LERROR("Fieldlines are only supported for BATSRUS model");
-    }
-
-    return fieldLines;
+    return traceFieldlines(xVar, yVar, zVar, seedPoints, stepSize, color);
 }
 
 KameleonWrapper::Fieldlines KameleonWrapper::lorentzTrajectories(
@@ -768,87 +740,121 @@ KameleonWrapper::GridType KameleonWrapper::gridType() const {
     return _gridType;
 }
 
-KameleonWrapper::TraceLine KameleonWrapper::traceCartesianFieldline(
-                                                                  const std::string& xVar,
-                                                                  const std::string& yVar,
-                                                                  const std::string& zVar,
-                                                               const glm::vec3& seedPoint,
-                                                                           float stepSize,
-                                                                 TraceDirection direction,
-                                                                  FieldlineEnd& end) const
+KameleonWrapper::Fieldlines KameleonWrapper::traceFieldlines(const std::string& xVar,
+                                                             const std::string& yVar,
+                                                             const std::string& zVar,
+                                                 const std::vector<glm::vec3>& seedPoints,
+                                                                     float stepSize,
+                                             const std::optional<glm::vec4>& color) const
 {
-    constexpr const int MaxSteps = 5000;
+    ghoul_assert(_model && _interpolator, "Model and interpolator must exist");
 
-    _model->loadVariable(xVar);
-    const long int xID = _model->getVariableID(xVar);
+    LINFO(fmt::format(
+        "Creating {} fieldlines from variables {} {} {}",
+        seedPoints.size(), xVar, yVar, zVar
+    ));
 
-    _model->loadVariable(yVar);
-    const long int yID = _model->getVariableID(yVar);
+    if (_type != Model::BATSRUS) {
+        LERROR("Fieldlines are only supported for BATSRUS model");
+        return Fieldlines();
+    }
 
+    // Loading the variables is not thread-safe, so it has to happen before the tracing
+    _model->loadVariable(xVar);
+    _model->loadVariable(yVar);
     _model->loadVariable(zVar);
+    const long int xID = _model->getVariableID(xVar);
+    const long int yID = _model->getVariableID(yVar);
     const long int zID = _model->getVariableID(zVar);
 
-    glm::vec3 pos = seedPoint;
-    int numSteps = 0;
-    TraceLine line;
+    Fieldlines fieldLines(seedPoints.size());
+    runParallel(
+        seedPoints.size(),
+        [&](ccmc::Interpolator& interpolator, size_t i) {
+            FieldlineEnd forwardEnd;
+            TraceLine fLine = traceCartesianFieldline(
+                interpolator,
+                xID,
+                yID,
+                zID,
+                seedPoints[i],
+                stepSize,
+                TraceDirection::FORWARD,
+                forwardEnd
+            );
+            FieldlineEnd backEnd;
+            TraceLine bLine = traceCartesianFieldline(
+                interpolator,
+                xID,
+                yID,
+                zID,
+                seedPoints[i],
+                stepSize,
+                TraceDirection::BACK,
+                backEnd
+            );
 
-    // While we are inside the models boundaries and not inside earth
-    while ((pos.x < _max.x && pos.x > _min.x && pos.y < _max.y && pos.y > _min.y &&
-            pos.z < _max.z && pos.z > _min.z) &&
-            !(pos.x*pos.x + pos.y*pos.y + pos.z*pos.z < 1.0))
-    {
+            bLine.erase(bLine.begin());
+            bLine.insert(bLine.begin(), fLine.rbegin(), fLine.rend());
 
-        // Save position. Model has +Z as up
-        line.push_back(glm::vec3(pos.x, pos.z, pos.y));
-
-        // Calculate new position with Runge-Kutta 4th order
-        float stepX;
-        float stepY;
-        float stepZ;
-        glm::vec3 k1 = glm::normalize(glm::vec3(
-            _interpolator->interpolate(xID, pos.x, pos.y, pos.z, stepX, stepY, stepZ),
-            _interpolator->interpolate(yID, pos.x, pos.y, pos.z),
-            _interpolator->interpolate(zID, pos.x, pos.y, pos.z)
-        ));
-        k1 = (direction == TraceDirection::FORWARD) ? k1 : -1.f * k1;
-
-        glm::vec3 step = glm::vec3(stepX, stepY, stepZ) * stepSize;
-
-        glm::vec3 k1Pos = pos + step / 2.f * k1;
-        glm::vec3 k2 = glm::normalize(glm::vec3(
-            _interpolator->interpolate(xID, k1Pos.x, k1Pos.y, k1Pos.z),
-            _interpolator->interpolate(yID, k1Pos.x, k1Pos.y, k1Pos.z),
-            _interpolator->interpolate(zID, k1Pos.x, k1Pos.y, k1Pos.z)
-        ));
-        k2 = (direction == TraceDirection::FORWARD) ? k2 : -1.f * k2;
-
-        glm::vec3 k2Pos = pos + step / 2.f * k2;
-        glm::vec3 k3 = glm::normalize(glm::vec3(
-            _interpolator->interpolate(xID, k2Pos.x, k2Pos.y, k2Pos.z),
-            _interpolator->interpolate(yID, k2Pos.x, k2Pos.y, k2Pos.z),
-            _interpolator->interpolate(zID, k2Pos.x, k2Pos.y, k2Pos.z)
-        ));
-        k3 = (direction == TraceDirection::FORWARD) ? k3 : -1.f * k3;
-
-        glm::vec3 k3Pos = pos + step / 2.f * k3;
-        glm::vec3 k4 = glm::normalize(glm::vec3(
-            _interpolator->interpolate(xID, k3Pos.x, k3Pos.y, k3Pos.z),
-            _interpolator->interpolate(yID, k3Pos.x, k3Pos.y, k3Pos.z),
-            _interpolator->interpolate(zID, k3Pos.x, k3Pos.y, k3Pos.z)
-        ));
-        k4 = (direction == TraceDirection::FORWARD) ? k4 : -1.f * k4;
-
-        pos = pos + (step / 6.f) * (k1 + 2.f * k2 + 2.f * k3 + k4);
+            // classify, unless a color was provided
+            const glm::vec4 lineColor = color.has_value() ?
+                *color :
+                classifyFieldline(forwardEnd, backEnd);
 
-        ++numSteps;
-        if (numSteps > MaxSteps) {
-            LDEBUG(fmt::format("Max number of steps taken ({})", MaxSteps));
-            break;
+            // write colors and convert positions to meter
+            std::vector<LinePoint>& line = fieldLines[i];
+            line.reserve(bLine.size());
+            for (const glm::vec3& position : bLine) {
+                line.push_back({ RE_TO_METER * position, lineColor });
+            }
+        },
+        false
+    );
+
+    return fieldLines;
+}
+
+KameleonWrapper::TraceLine KameleonWrapper::traceCartesianFieldline(
+                                                         ccmc::Interpolator& interpolator,
+                                                                           long int xID,
+                                                                           long int yID,
+                                                                           long int zID,
+                                                               const glm::vec3& seedPoint,
+                                                                           float stepSize,
+                                                                 TraceDirection direction,
+                                                                  FieldlineEnd& end) const
+{
+    auto field = [&](const glm::vec3& p, glm::vec3* cellSize) {
+        glm::vec3 v;
+        if (cellSize) {
+            v.x = interpolator.interpolate(
+                xID, p.x, p.y, p.z, cellSize->x, cellSize->y, cellSize->z
+            );
         }
+        else {
+            v.x = interpolator.interpolate(xID, p.x, p.y, p.z);
+        }
+        v.y = interpolator.interpolate(yID, p.x, p.y, p.z);
+        v.z = interpolator.interpolate(zID, p.x, p.y, p.z);
+        return v;
+    };
+
+    auto isInside = [this](const glm::vec3& p) {
+        // While we are inside the models boundaries and not inside earth
+        return (p.x < _max.x && p.x > _min.x && p.y < _max.y && p.y > _min.y &&
+                p.z < _max.z && p.z > _min.z) &&
+               !(p.x * p.x + p.y * p.y + p.z * p.z < 1.0);
+    };
+
+    TraceLine line = integrateFieldline(field, isInside, seedPoint, stepSize, direction);
+
+    // Model has +Z as up. The last position is kept in model coordinates
+    for (size_t i = 0; i + 1 < line.size(); ++i) {
+        line[i] = glm::vec3(line[i].x, line[i].z, line[i].y);
     }
-    // Save last position. Model has +Z as up
-    line.push_back(pos);
 
+    const glm::vec3& pos = line.back();
     if (pos.z > 0.f && (pos.x * pos.x + pos.y * pos.y + pos.z * pos.z < 1.f)) {
         end = FieldlineEnd::NORTH;
     }
@@ -862,6 +868,85 @@ KameleonWrapper::TraceLine KameleonWrapper::traceCartesianFieldline(
     return line;
 }
 
+std::vector<glm::vec3> KameleonWrapper::integrateFieldline(
+                      const std::function<glm::vec3(const glm::vec3&, glm::vec3*)>& field,
+                                   const std::function<bool(const glm::vec3&)>& isInside,
+                                                               const glm::vec3& seedPoint,
+                                                                           float stepSize,
+                                                                 TraceDirection direction)
+{
+    constexpr const int MaxSteps = 5000;
+    // The step size is adapted to keep the estimated error of every step below this
+    // tolerance, which is measured in grid cells. In smooth regions the steps can grow up
+    // to MaxStepScale times the requested step size, in strongly curved regions they can
+    // shrink down to 1 / MaxStepScale of it
+    constexpr const float Tolerance = 1e-3f;
+    constexpr const float MaxStepScale = 8.f;
+
+    const float sign = (direction == TraceDirection::FORWARD) ? 1.f : -1.f;
+    const float minStepSize = stepSize / MaxStepScale;
+    const float maxStepSize = stepSize * MaxStepScale;
+
+    // Returns the normalized field direction at p. If requested, the size of the grid
+    // cell that contains p is returned as well, which is used to scale the step
+    auto fieldDirection = [&](const glm::vec3& p, glm::vec3* cellSize = nullptr) {
+        return sign * glm::normalize(field(p, cellSize));
+    };
+
+    glm::vec3 pos = seedPoint;
+    glm::vec3 cellSize;
+    glm::vec3 dir = fieldDirection(pos, &cellSize);
+    float h = stepSize;
+    int numSteps = 0;
+    std::vector<glm::vec3> line;
+
+    while (isInside(pos)) {
+        line.push_back(pos);
+
+        // Calculate new position with the Bogacki-Shampine 3(2) method. The difference
+        // to its embedded second order solution estimates the error of the step. The
+        // direction at the end of an accepted step is the first stage of the next step,
+        // so every step needs three field evaluations, compared to four for the RK4
+        // method that was used with a fixed step size before
+        while (true) {
+            const glm::vec3& k1 = dir;
+            const glm::vec3 k2 = fieldDirection(pos + (h / 2.f) * cellSize * k1);
+            const glm::vec3 k3 = fieldDirection(pos + (3.f * h / 4.f) * cellSize * k2);
+            const glm::vec3 next = pos + h * cellSize *
+                                   (2.f / 9.f * k1 + 1.f / 3.f * k2 + 4.f / 9.f * k3);
+
+            glm::vec3 nextCellSize;
+            const glm::vec3 k4 = fieldDirection(next, &nextCellSize);
+
+            // The error is measured in units of the cell size
+            const float error = h * glm::length(
+                -5.f / 72.f * k1 + 1.f / 12.f * k2 + 1.f / 9.f * k3 - 1.f / 8.f * k4
+            );
+            const float scale = error > 0.f ?
+                glm::clamp(0.9f * std::cbrt(Tolerance / error), 0.2f, 5.f) :
+                5.f;
+
+            if (error <= Tolerance || h <= minStepSize || std::isnan(error)) {
+                pos = next;
+                dir = k4;
+                cellSize = nextCellSize;
+                h = glm::clamp(h * scale, minStepSize, maxStepSize);
+                break;
+            }
+            h = std::max(h * scale, minStepSize);
+        }
+
+        ++numSteps;
+        if (numSteps > MaxSteps) {
+            LDEBUG(fmt::format("Max number of steps taken ({})", MaxSteps));
+            break;
+        }
+    }
+    line.push_back(pos);
+
+    return line;
+}
+
 KameleonWrapper::TraceLine KameleonWrapper::traceLorentzTrajectory(
                                                                const glm::vec3& seedPoint,
                                                                            float stepsize,
@@ -25,13 +25,37 @@
 #include <modules/multiresvolume/rendering/atlasmanager.h>
 
 #include <modules/multiresvolume/rendering/tsp.h>
+#include <openspace/engine/globals.h>
+#include <openspace/rendering/renderengine.h>
+#include <openspace/rendering/renderqueue.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/texture.h>
+#include <algorithm>
 #include <cstring>
 
+namespace {
+    // The maximum number of bricks that are copied into the PBO by one task
+    constexpr const size_t BricksPerCopyTask = 64;
+} // namespace
+
 namespace openspace {
 
-AtlasManager::AtlasManager(TSP* tsp) : _tsp(tsp) {}
+AtlasManager::AtlasManager(TSP* tsp)
+    : _tsp(tsp)
+{
+    for (UploadSlot& slot : _slots) {
+        slot.copies = std::make_unique<TaskGroup>(global::taskScheduler);
+    }
+}
+
+AtlasManager::~AtlasManager() {
+    // The copies write into the mapped PBOs and read from the brick data
+    for (UploadSlot& slot : _slots) {
+        slot.copies->wait();
+    }
+}
 
 bool AtlasManager::initialize() {
     TSP::Header header = _tsp->header();
@@ -49,10 +73,18 @@ bool AtlasManager::initialize() {
     _atlasMap = std::vector<unsigned int>(_nOtLeaves, NotUsedIndex);
     _nBricksInAtlas = _nBricksInMap;
 
-    _freeAtlasCoords = std::vector<unsigned int>(_nBricksInAtlas, 0);
-
-    for (unsigned int i = 0; i < _nBricksInAtlas; i++) {
-        _freeAtlasCoords[i] = i;
+    _residency.initialize(_tsp->numTotalNodes(), _nBricksInAtlas);
+
+    // If the file can't be mapped, the bricks are read through the TSP file stream
+    _brickData = std::make_unique<MemoryMappedFile>(_tsp->filename());
+    const size_t requiredSize = TSP::dataPosition() +
+        static_cast<size_t>(_tsp->numTotalNodes()) * _brickSize;
+    if (!_brickData->isValid() || _brickData->size() < requiredSize) {
+        LWARNINGC(
+            "AtlasManager",
+            "Could not map the brick data, reading the bricks on the render thread"
+        );
+        _brickData = nullptr;
     }
 
     _textureAtlas = new ghoul::opengl::Texture(
@@ -63,14 +95,17 @@ bool AtlasManager::initialize() {
     );
     _textureAtlas->uploadTexture();
 
-    glGenBuffers(2, _pboHandle);
+    for (UploadSlot& slot : _slots) {
+        glGenBuffers(1, &slot.pbo);
+    }
 
+    // No bricks are in the atlas until the first streamed bricks are uploaded
     glGenBuffers(1, &_atlasMapBuffer);
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, _atlasMapBuffer);
     glBufferData(
         GL_SHADER_STORAGE_BUFFER,
         sizeof(GLint) * _nBricksInMap,
-        nullptr,
+        _atlasMap.data(),
         GL_DYNAMIC_READ
     );
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
@@ -86,81 +121,81 @@ unsigned int AtlasManager::atlasMapBuffer() const {
     return _atlasMapBuffer;
 }
 
-void AtlasManager::updateAtlas(BufferIndex bufferIndex, std::vector<int>& brickIndices) {
-    size_t nBrickIndices = brickIndices.size();
-
-    _requiredBricks.clear();
-    for (size_t i = 0; i < nBrickIndices; i++) {
-        _requiredBricks.insert(brickIndices[i]);
-    }
-
-    for (unsigned int it : _prevRequiredBricks) {
-        if (!_requiredBricks.count(it)) {
-            removeFromAtlas(it);
-        }
-    }
-
-    // Stats
-    _nUsedBricks = static_cast<unsigned int>(_requiredBricks.size());
-    _nStreamedBricks = 0;
-    _nDiskReads = 0;
+void AtlasManager::updateAtlas(std::vector<int>& brickIndices) {
+    // The bricks that were streamed since the previous call had the whole frame to be
+    // copied, so this only waits if the copies take longer than rendering a frame
+    uploadSlot(_slots[1 - _nextSlot]);
 
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[bufferIndex]);
+    // The last upload from this slot's PBO was issued in the previous frame. Orphaning
+    // its storage lets the driver provide new memory instead of waiting for the upload
+    UploadSlot& slot = _slots[_nextSlot];
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
     glBufferData(GL_PIXEL_UNPACK_BUFFER, _volumeSize, nullptr, GL_STREAM_DRAW);
-    float* mappedBuffer = reinterpret_cast<float*>(
+    slot.mappedBuffer = reinterpret_cast<float*>(
         glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY)
     );
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
-    if (!mappedBuffer) {
+    if (!slot.mappedBuffer) {
         LERRORC("AtlasManager", "Failed to map PBO");
         return;
     }
 
-    for (auto itStart = _requiredBricks.begin(); itStart != _requiredBricks.end();) {
-        int firstBrick = *itStart;
-        int lastBrick = firstBrick;
-
-        auto itEnd = itStart;
-        for (itEnd++;
-            itEnd != _requiredBricks.end() &&
-            *itEnd == static_cast<unsigned int>(lastBrick) + 1;
-            itEnd++)
-        {
-            lastBrick = *itEnd;
-        }
+    // Evicts the bricks that are no longer required and returns the missing ones
+    const std::vector<unsigned int>& missingBricks = _residency.update(brickIndices);
 
-        addToAtlas(firstBrick, lastBrick, mappedBuffer);
+    // Stats
+    _nUsedBricks = _residency.numRequiredBricks();
+    _nDiskReads = 0;
 
-        itStart = itEnd;
+    slot.bricks.clear();
+    if (_brickData) {
+        // Claim the atlas slots here as the residency table is not thread-safe, and copy
+        // the bricks from the mapping on the task scheduler
+        for (unsigned int brickIndex : missingBricks) {
+            if (_residency.isResident(brickIndex)) {
+                continue;
+            }
+            const unsigned int atlasData = _residency.insert(
+                brickIndex,
+                brickLevel(brickIndex)
+            );
+            slot.bricks.emplace_back(brickIndex, atlasData & 0x0FFFFFFF);
+        }
+        copyMappedBricks(slot);
     }
+    else {
+        // Bricks with consecutive indices are read from disk in a single read
+        for (size_t first = 0; first < missingBricks.size();) {
+            size_t last = first;
+            while (last + 1 < missingBricks.size() &&
+                   missingBricks[last + 1] == missingBricks[last] + 1)
+            {
+                last++;
+            }
 
-    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-
-    for (size_t i = 0; i < nBrickIndices; i++) {
-        _atlasMap[i] = _brickMap[brickIndices[i]];
+            addToAtlas(missingBricks[first], missingBricks[last], slot);
+            first = last + 1;
+        }
     }
+    _nStreamedBricks = static_cast<unsigned int>(slot.bricks.size());
 
-    std::swap(_prevRequiredBricks, _requiredBricks);
-
-    pboToAtlas(bufferIndex);
+    // Evicted atlas slots keep their bricks in the texture until the new ones are
+    // uploaded, so the current atlas map stays valid until it is replaced by this one
+    slot.atlasMap = _atlasMap;
+    for (size_t i = 0; i < brickIndices.size(); i++) {
+        slot.atlasMap[i] = _residency.atlasData(brickIndices[i]);
+    }
 
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _atlasMapBuffer);
-    GLint* to = reinterpret_cast<GLint*>(
-        glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_WRITE_ONLY)
-    );
-    memcpy(to, _atlasMap.data(), sizeof(GLint)*_atlasMap.size());
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    _nextSlot = 1 - _nextSlot;
 }
 
-void AtlasManager::addToAtlas(int firstBrickIndex, int lastBrickIndex,
-                              float* mappedBuffer)
+void AtlasManager::addToAtlas(int firstBrickIndex, int lastBrickIndex, UploadSlot& slot)
 {
-    while (_brickMap.count(firstBrickIndex) && firstBrickIndex <= lastBrickIndex) {
+    while (_residency.isResident(firstBrickIndex) && firstBrickIndex <= lastBrickIndex) {
         firstBrickIndex++;
     }
-    while (_brickMap.count(lastBrickIndex) && lastBrickIndex >= firstBrickIndex) {
+    while (_residency.isResident(lastBrickIndex) && lastBrickIndex >= firstBrickIndex) {
         lastBrickIndex--;
     }
     if (lastBrickIndex < firstBrickIndex) {
@@ -178,79 +213,113 @@ void AtlasManager::addToAtlas(int firstBrickIndex, int lastBrickIndex,
     _nDiskReads++;
 
     for (int brickIndex = firstBrickIndex; brickIndex <= lastBrickIndex; brickIndex++) {
-        if (!_brickMap.count(brickIndex)) {
-            unsigned int atlasCoords = _freeAtlasCoords.back();
-            _freeAtlasCoords.pop_back();
-            int level = _nOtLevels - static_cast<int>(
-                floor(log((7.0 * (float(brickIndex % _nOtNodes)) + 1.0))/log(8)) - 1
+        if (!_residency.isResident(brickIndex)) {
+            const unsigned int atlasData = _residency.insert(
+                brickIndex,
+                brickLevel(brickIndex)
             );
-            ghoul_assert(atlasCoords <= 0x0FFFFFFF, "@MISSING");
-            unsigned int atlasData = (level << 28) + atlasCoords;
-            _brickMap.emplace(brickIndex, atlasData);
-            _nStreamedBricks++;
-            fillVolume(
+            std::memcpy(
+                slot.mappedBuffer + slot.bricks.size() * _nBrickVals,
                 &sequenceBuffer[_nBrickVals*(brickIndex - firstBrickIndex)],
-                mappedBuffer,
-                atlasCoords
+                _brickSize
             );
+            slot.bricks.emplace_back(brickIndex, atlasData & 0x0FFFFFFF);
         }
     }
 
     delete[] sequenceBuffer;
 }
 
-void AtlasManager::removeFromAtlas(int brickIndex) {
-    unsigned int atlasData = _brickMap[brickIndex];
-    unsigned int atlasCoords = atlasData & 0x0FFFFFFF;
-    _brickMap.erase(brickIndex);
-    _freeAtlasCoords.push_back(atlasCoords);
+void AtlasManager::copyMappedBricks(UploadSlot& slot) {
+    for (size_t first = 0; first < slot.bricks.size(); first += BricksPerCopyTask) {
+        const size_t last = std::min(first + BricksPerCopyTask, slot.bricks.size());
+
+        // Start reading the bricks of the task from disk while it is queued
+        const unsigned int firstBrick = slot.bricks[first].first;
+        const unsigned int lastBrick = slot.bricks[last - 1].first;
+        _brickData->prefetch(
+            TSP::dataPosition() + static_cast<size_t>(firstBrick) * _brickSize,
+            static_cast<size_t>(lastBrick - firstBrick + 1) * _brickSize
+        );
+        _nDiskReads++;
+
+        // The slot's bricks are not changed before the copies have been waited for
+        slot.copies->run(
+            [this, &slot, first, last]() {
+                for (size_t i = first; i < last; ++i) {
+                    const unsigned int brickIndex = slot.bricks[i].first;
+                    const float* brick = _brickData->at<float>(
+                        TSP::dataPosition() + static_cast<size_t>(brickIndex) * _brickSize
+                    );
+                    std::memcpy(slot.mappedBuffer + i * _nBrickVals, brick, _brickSize);
+                }
+            },
+            TaskScheduler::Priority::High
+        );
+    }
 }
 
-void AtlasManager::fillVolume(float* in, float* out, unsigned int linearAtlasCoords) {
-    int x = linearAtlasCoords % _nBricksPerDim;
-    int y = (linearAtlasCoords / _nBricksPerDim) % _nBricksPerDim;
-    int z = linearAtlasCoords / _nBricksPerDim / _nBricksPerDim;
-
-    unsigned int xMin = x*_paddedBrickDim;
-    unsigned int yMin = y*_paddedBrickDim;
-    unsigned int zMin = z*_paddedBrickDim;
-    unsigned int xMax = xMin + _paddedBrickDim;
-    unsigned int yMax = yMin + _paddedBrickDim;
-    unsigned int zMax = zMin + _paddedBrickDim;
-
-    unsigned int from = 0;
-    for (unsigned int zValCoord = zMin; zValCoord<zMax; ++zValCoord) {
-        for (unsigned int yValCoord = yMin; yValCoord<yMax; ++yValCoord) {
-            for (unsigned int xValCoord = xMin; xValCoord<xMax; ++xValCoord) {
-                unsigned int idx = xValCoord + yValCoord * _atlasDim +
-                                   zValCoord * _atlasDim * _atlasDim;
-
-                out[idx] = in[from];
-                from++;
-            }
-        }
+void AtlasManager::uploadSlot(UploadSlot& slot) {
+    if (!slot.mappedBuffer) {
+        return;
     }
-}
 
-void AtlasManager::pboToAtlas(BufferIndex bufferIndex) {
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[bufferIndex]);
-    glm::size3_t dim = _textureAtlas->dimensions();
+    slot.copies->wait();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    slot.mappedBuffer = nullptr;
+
+    // Every brick is copied from its place in the PBO to its slot in the atlas
+    const GLsizei dim = static_cast<GLsizei>(_paddedBrickDim);
     glBindTexture(GL_TEXTURE_3D, *_textureAtlas);
-    glTexSubImage3D(
-        GL_TEXTURE_3D,
-        0,
-        0,
-        0,
-        0,
-        static_cast<GLsizei>(dim[0]),
-        static_cast<GLsizei>(dim[1]),
-        static_cast<GLsizei>(dim[2]),
-        GL_RED,
-        GL_FLOAT,
-        nullptr
-    );
+    for (size_t i = 0; i < slot.bricks.size(); ++i) {
+        const unsigned int atlasSlot = slot.bricks[i].second;
+        const GLint x = atlasSlot % _nBricksPerDim;
+        const GLint y = (atlasSlot / _nBricksPerDim) % _nBricksPerDim;
+        const GLint z = atlasSlot / _nBricksPerDim / _nBricksPerDim;
+        glTexSubImage3D(
+            GL_TEXTURE_3D,
+            0,
+            x * dim,
+            y * dim,
+            z * dim,
+            dim,
+            dim,
+            dim,
+            GL_RED,
+            GL_FLOAT,
+            reinterpret_cast<const void*>(i * static_cast<size_t>(_brickSize))
+        );
+    }
     glBindTexture(GL_TEXTURE_3D, 0);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // The missing bricks are required for this frame and can't be postponed, but they
+    // count against the upload budget of the other streaming components
+    global::renderEngine.renderQueue().registerUpload(
+        static_cast<uint64_t>(slot.bricks.size()) * _brickSize
+    );
+
+    _atlasMap = std::move(slot.atlasMap);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _atlasMapBuffer);
+    GLint* to = reinterpret_cast<GLint*>(
+        glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_WRITE_ONLY)
+    );
+    memcpy(to, _atlasMap.data(), sizeof(GLint)*_atlasMap.size());
+    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void AtlasManager::removeFromAtlas(int brickIndex) {
+    if (_residency.isResident(brickIndex)) {
+        _residency.evict(brickIndex);
+    }
+}
+
+unsigned int AtlasManager::brickLevel(unsigned int brickIndex) const {
+    return _nOtLevels - static_cast<unsigned int>(
+        floor(log((7.0 * (float(brickIndex % _nOtNodes)) + 1.0)) / log(8)) - 1
+    );
 }
 
 ghoul::opengl::Texture& AtlasManager::textureAtlas() {
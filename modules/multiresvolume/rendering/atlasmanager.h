@@ -25,37 +25,43 @@
 #ifndef __OPENSPACE_MODULE_MULTIRESVOLUME___ATLASMANAGER___H__
 #define __OPENSPACE_MODULE_MULTIRESVOLUME___ATLASMANAGER___H__
 
+#include <modules/multiresvolume/rendering/brickresidency.h>
+
 #include <ghoul/glm.h>
 #include <glm/gtx/std_based_type.hpp>
-#include <map>
-#include <set>
+#include <array>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ghoul::opengl { class Texture; }
 
 namespace openspace {
 
+class MemoryMappedFile;
+class TaskGroup;
 class TSP;
 
 class AtlasManager {
 public:
-    enum BufferIndex {
-        EVEN = 0,
-        ODD = 1
-    };
-
     AtlasManager(TSP* tsp);
-    ~AtlasManager() = default;
-
-    void updateAtlas(BufferIndex bufferIndex, std::vector<int>& brickIndices);
-    void addToAtlas(int firstBrickIndex, int lastBrickIndex, float* mappedBuffer);
+    ~AtlasManager();
+
+    /**
+     * Makes the bricks that were requested in the previous call resident in the texture
+     * atlas and starts streaming the bricks in \p brickIndices that are missing. The
+     * missing bricks are copied into a mapped PBO on the task scheduler while the frame
+     * is rendered and are uploaded in the next call, together with the atlas map that
+     * refers to them. Until then, the atlas map and the atlas texture both stay at the
+     * state of the previous call.
+     */
+    void updateAtlas(std::vector<int>& brickIndices);
     void removeFromAtlas(int brickIndex);
     bool initialize();
     const std::vector<unsigned int>& atlasMap() const;
     unsigned int atlasMapBuffer() const;
 
-    void pboToAtlas(BufferIndex bufferIndex);
     ghoul::opengl::Texture& textureAtlas();
 
     unsigned int numDiskReads() const;
@@ -67,18 +73,33 @@ public:
 private:
     const unsigned int NotUsedIndex = std::numeric_limits<unsigned int>::max();
 
+    // One of the two PBOs that the streamed bricks are written into. The bricks are
+    // stored one after another and the buffer stays mapped from the call to updateAtlas
+    // that fills it until the next call, which uploads the bricks into the atlas
+    struct UploadSlot {
+        unsigned int pbo = 0;
+        float* mappedBuffer = nullptr;
+        // The bricks in the buffer and the atlas slots they are uploaded to
+        std::vector<std::pair<unsigned int, unsigned int>> bricks;
+        // The atlas map that becomes current once the bricks are uploaded
+        std::vector<unsigned int> atlasMap;
+        // Copies of bricks into the buffer that run on the task scheduler
+        std::unique_ptr<TaskGroup> copies;
+    };
+
     TSP* _tsp;
-    unsigned int _pboHandle[2];
     unsigned int _atlasMapBuffer;
 
+    // The atlas map of the bricks that are currently in the atlas texture
     std::vector<unsigned int> _atlasMap;
-    std::map<unsigned int, unsigned int> _brickMap;
-    std::vector<unsigned int> _freeAtlasCoords;
-    std::set<unsigned int> _requiredBricks;
-    std::set<unsigned int> _prevRequiredBricks;
+    BrickResidency _residency;
 
     ghoul::opengl::Texture* _textureAtlas;
 
+    // The brick data of the TSP file is read through a memory mapping so that the bricks
+    // can be copied into the PBO on the task scheduler without intermediate buffers
+    std::unique_ptr<MemoryMappedFile> _brickData;
+
     // Stats
     unsigned int _nUsedBricks;
     unsigned int _nStreamedBricks;
@@ -96,7 +117,23 @@ private:
     unsigned int _nBricksInMap;
     unsigned int _atlasDim;
 
-    void fillVolume(float* in, float* out, unsigned int linearAtlasCoords);
+    unsigned int brickLevel(unsigned int brickIndex) const;
+
+    // Reads the missing bricks in the range through the TSP file stream into the slot
+    void addToAtlas(int firstBrickIndex, int lastBrickIndex, UploadSlot& slot);
+
+    // Copies the bricks of the slot from the mapping into its PBO in parallel
+    void copyMappedBricks(UploadSlot& slot);
+
+    // Waits for the copies into the slot, uploads its bricks into the atlas texture and
+    // makes its atlas map current
+    void uploadSlot(UploadSlot& slot);
+
+    // The slot that is filled by the next call to updateAtlas; the other one holds the
+    // bricks of the previous call. Declared last so that running copies finish before
+    // any other member is destroyed
+    size_t _nextSlot = 0;
+    std::array<UploadSlot, 2> _slots;
 };
 
 } // namespace openspace
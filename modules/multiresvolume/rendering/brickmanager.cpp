@@ -24,6 +24,9 @@
 
 #include <modules/multiresvolume/rendering/brickmanager.h>
 
+#include <openspace/engine/globals.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/logging/logmanager.h>
@@ -32,15 +35,25 @@
 
 namespace {
     constexpr const char* _loggerCat = "BrickManager";
+
+    // The maximum number of consecutive bricks that are copied into a PBO by one task
+    constexpr const unsigned int BricksPerUploadTask = 64;
 } // namespace
 
 namespace openspace {
 
 BrickManager::BrickManager(TSP* tsp)
     : _tsp(tsp)
-{}
+{
+    _pboUploads[EVEN] = std::make_unique<TaskGroup>(global::taskScheduler);
+    _pboUploads[ODD] = std::make_unique<TaskGroup>(global::taskScheduler);
+}
 
-BrickManager::~BrickManager() {}
+BrickManager::~BrickManager() {
+    // Waits for the running uploads and unmaps the PBOs that are still mapped
+    finishPBOUploads(EVEN);
+    finishPBOUploads(ODD);
+}
 
 bool BrickManager::readHeader() {
     if (!_tsp->file().is_open()) {
@@ -104,6 +117,14 @@ bool BrickManager::readHeader() {
         return false;
     }
 
+    _brickData = std::make_unique<MemoryMappedFile>(_tsp->filename());
+    if (!_brickData->isValid() ||
+        _brickData->size() != static_cast<size_t>(fileSize))
+    {
+        LERROR(fmt::format("Could not map the brick data of {}", _tsp->filename()));
+        return false;
+    }
+
     _hasReadHeader = true;
 
     // Hold two brick lists
@@ -224,7 +245,7 @@ bool BrickManager::buildBrickList(BUFFER_INDEX bufferIndex,
     return true;
 }
 
-bool BrickManager::fillVolume(float* in, float* out, unsigned int x, unsigned int y,
+bool BrickManager::fillVolume(const float* in, float* out, unsigned int x, unsigned int y,
                               unsigned int z)
 {
 
@@ -281,131 +302,121 @@ void BrickManager::coordinatesFromLinear(int idx, int& x, int& y, int& z) {
 }
 
 bool BrickManager::diskToPBO(BUFFER_INDEX pboIndex) {
+    // A previous upload into the same PBO has to be complete before it can be reused
+    if (!finishPBOUploads(pboIndex)) {
+        return false;
+    }
+
     // Map PBO
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[pboIndex]);
     glBufferData(GL_PIXEL_UNPACK_BUFFER, _volumeSize, nullptr, GL_STREAM_DRAW);
     float* mappedBuffer = reinterpret_cast<float*>(
         glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY)
     );
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
     if (!mappedBuffer) {
         LERROR("Failed to map PBO");
         return false;
     }
+    _mappedPBO[pboIndex] = mappedBuffer;
+
+    const float* brickData = reinterpret_cast<const float*>(
+        _brickData->data() + TSP::dataPosition()
+    );
 
     // Loop over brick request list
+    const unsigned int nBricks = static_cast<unsigned int>(
+        _brickLists[pboIndex].size() / 3
+    );
     unsigned int brickIndex = 0;
-    while (brickIndex < _brickLists[pboIndex].size() / 3) {
-        // Find first active brick index in list
-        while (brickIndex < _brickLists[pboIndex].size() / 3 &&
-               _brickLists[pboIndex][3 * brickIndex] == -1)
-        {
+    while (brickIndex < nBricks) {
+        if (_brickLists[pboIndex][3 * brickIndex] == -1) {
             // If not used, remove from PBO cache list
             _bricksInPBO[pboIndex][brickIndex] = -1;
             brickIndex++;
+            continue;
         }
-
-        // If we are at the end of the list, exit
-        if (brickIndex == _brickLists[pboIndex].size() / 3) {
-            break;
+        if (_bricksInPBO[pboIndex][brickIndex] != -1) {
+            // Already in the PBO
+            brickIndex++;
+            continue;
         }
 
-        // Find a sequence of consecutive bricks in list
-        unsigned int sequence = 0;
-        // Count number of bricks already in PBO
-        unsigned int inPBO = 0;
-        unsigned int brickIndexProbe = brickIndex;
-        while (brickIndexProbe < _brickLists[pboIndex].size() / 3 &&
-            _brickLists[pboIndex][3 * brickIndexProbe] != -1)
+        // Find a sequence of consecutive bricks that need to be uploaded, so that every
+        // task reads a contiguous region of the file. The atlas coordinates are copied
+        // as the brick list might be rebuilt while the task is running
+        const unsigned int firstBrick = brickIndex;
+        std::vector<unsigned int> coordinates;
+        while (brickIndex < nBricks && coordinates.size() < BricksPerUploadTask &&
+               _brickLists[pboIndex][3 * brickIndex] != -1 &&
+               _bricksInPBO[pboIndex][brickIndex] == -1)
         {
-            sequence++;
-            if (_bricksInPBO[pboIndex][brickIndexProbe] != -1) {
-                inPBO++;
-            }
-            brickIndexProbe++;
+            const unsigned int coords = linearCoordinates(
+                _brickLists[pboIndex][3 * brickIndex + 0],
+                _brickLists[pboIndex][3 * brickIndex + 1],
+                _brickLists[pboIndex][3 * brickIndex + 2]
+            );
+            coordinates.push_back(coords);
+            // Update the atlas list since the brick will be uploaded
+            _bricksInPBO[pboIndex][brickIndex] = coords;
+            brickIndex++;
         }
-        //INFO("Reading " << sequence << " bricks");
-
-        // Read the sequence into a buffer
-        float* seqBuffer = new float[sequence * _numBrickVals];
-        size_t bufSize = sequence * _numBrickVals * sizeof(float);
-        /*
-        std::ios::pos_type offset = dataPos_ +
-        static_cast<std::ios::pos_type>(brickIndex) *
-        static_cast<std::ios::pos_type>(_brickSize);
-        */
-
-        long long offset = TSP::dataPosition() +
-                           static_cast<long>(brickIndex) * static_cast<long>(_brickSize);
-
-        // Skip reading if all bricks in sequence is already in PBO
-        if (inPBO != sequence) {
-            //timer_.start();
-
-            /*
-            std::streamoff off = static_cast<std::streamoff>(offset);
-            in_.seekg(off);
-            if (in_.tellg() == -1) {
-            ERROR("Failed to get input stream position");
-            INFO("offset: " << offset);
-            INFO("streamoff max: " << std::numeric_limits<std::streamoff>::max());
-            INFO("size_t max: " << std::numeric_limits<size_t>::max());
-            return false;
-            }
-            INFO("in.tellg(): " << in_.tellg());
-            in_.read(reinterpret_cast<char*>(seqBuffer), _brickSize*sequence);
-            */
-
-            _tsp->file().seekg(offset);
-            _tsp->file().read(reinterpret_cast<char*>(seqBuffer), bufSize);
-
-
-            //timer_.stop();
-            //double time = timer_.elapsed().wall / 1.0e9;
-            //double mb = (_brickSize*sequence) / 1048576.0;
-            //INFO("Disk read "<<mb<<" MB in "<<time<<" s, "<< mb/time<<" MB/s");
-
-            // For each brick in the buffer, put it the correct buffer spot
-            for (unsigned int i = 0; i < sequence; ++i) {
-                // Only upload if needed
-                // Pointless if implementation only skips reading when ALL bricks in
-                // sequence are in PBO, but could be useful if other solutions that
-                // considers part of the buffer are implemented
-                if (_bricksInPBO[pboIndex][brickIndex + i] == -1) {
-                    unsigned int x = static_cast<unsigned int>(
-                        _brickLists[pboIndex][3 * (brickIndex + i) + 0]
-                    );
-                    unsigned int y = static_cast<unsigned int>(
-                        _brickLists[pboIndex][3 * (brickIndex + i) + 1]
-                    );
-                    unsigned int z = static_cast<unsigned int>(
-                        _brickLists[pboIndex][3 * (brickIndex + i) + 2]
-                    );
 
+        // Ask the operating system to start reading the bricks before the task starts
+        _brickData->prefetch(
+            TSP::dataPosition() + static_cast<size_t>(firstBrick) * _brickSize,
+            coordinates.size() * _brickSize
+        );
+
+        const float* in = brickData + static_cast<size_t>(firstBrick) * _numBrickVals;
+        _pboUploads[pboIndex]->run(
+            [this, in, mappedBuffer, coordinates = std::move(coordinates)]() {
+                for (size_t i = 0; i < coordinates.size(); ++i) {
+                    int x, y, z;
+                    coordinatesFromLinear(static_cast<int>(coordinates[i]), x, y, z);
                     // Put each brick in the correct buffer place.
                     // This needs to be done because the values are in brick order, and
                     // the volume needs to be filled with one big float array.
-                    fillVolume(&seqBuffer[_numBrickVals*i], mappedBuffer, x, y, z);
-                    // Update the atlas list since the brick will be uploaded
-                    //INFO(brickIndex+i);
-                    _bricksInPBO[pboIndex][brickIndex + i] = linearCoordinates(x, y, z);
+                    fillVolume(
+                        in + i * _numBrickVals,
+                        mappedBuffer,
+                        static_cast<unsigned int>(x),
+                        static_cast<unsigned int>(y),
+                        static_cast<unsigned int>(z)
+                    );
                 }
             }
-        } // if in pbo
+        );
+    }
 
-        // Update the brick index
-        brickIndex += sequence;
+    return true;
+}
 
-        delete[] seqBuffer;
+bool BrickManager::finishPBOUploads(BUFFER_INDEX pboIndex) {
+    if (!_mappedPBO[pboIndex]) {
+        return true;
     }
 
-    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    _pboUploads[pboIndex]->wait();
+    _mappedPBO[pboIndex] = nullptr;
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[pboIndex]);
+    const GLboolean success = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
+    if (success == GL_FALSE) {
+        LERROR("PBO contents were corrupted while it was mapped");
+        return false;
+    }
     return true;
 }
 
 bool BrickManager::pboToAtlas(BUFFER_INDEX _pboIndex) {
+    if (!finishPBOUploads(_pboIndex)) {
+        return false;
+    }
+
     glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pboHandle[_pboIndex]);
     glm::size3_t dim = _textureAtlas->dimensions();
     glBindTexture(GL_TEXTURE_3D, *_textureAtlas);
@@ -27,12 +27,16 @@
 
 #include <modules/multiresvolume/rendering/tsp.h>
 
+#include <memory>
 #include <vector>
 
 namespace ghoul::opengl { class Texture; }
 
 namespace openspace {
 
+class MemoryMappedFile;
+class TaskGroup;
+
 class BrickManager {
 public:
     enum BUFFER_INDEX { EVEN = 0, ODD = 1 };
@@ -46,9 +50,21 @@ public:
 
     bool buildBrickList(BUFFER_INDEX bufferIndex, std::vector<int>& brickRequest);
 
-    bool fillVolume(float* in, float* out, unsigned int x, unsigned int y,
+    bool fillVolume(const float* in, float* out, unsigned int x, unsigned int y,
         unsigned int z);
+
+    /**
+     * Maps the PBO with the provided index and starts copying the bricks of the
+     * corresponding brick list from the TSP file into it. The copies are executed on
+     * the task scheduler, so this function returns before the PBO is filled. The PBO
+     * stays mapped until the next call to pboToAtlas with the same index.
+     */
     bool diskToPBO(BUFFER_INDEX pboIndex);
+
+    /**
+     * Waits for the bricks that were started by diskToPBO to be copied into the PBO
+     * with the provided index, unmaps it, and copies its contents into the atlas.
+     */
     bool pboToAtlas(BUFFER_INDEX pboIndex);
 
     ghoul::opengl::Texture* textureAtlas();
@@ -59,6 +75,7 @@ private:
     void incrementCoordinates();
     unsigned int linearCoordinates(int x, int y, int z);
     void coordinatesFromLinear(int idx, int& x, int& y, int& z);
+    bool finishPBOUploads(BUFFER_INDEX pboIndex);
 
     TSP* _tsp = nullptr;
     TSP::Header _header;
@@ -92,10 +109,20 @@ private:
 
     // PBOs
     unsigned int _pboHandle[2];
+    // PBOs stay mapped while the bricks are copied into them on the task scheduler
+    float* _mappedPBO[2] = { nullptr, nullptr };
+
+    // The brick data region of the TSP file is read through a memory mapping so that
+    // the bricks can be copied into the PBOs without intermediate buffers
+    std::unique_ptr<MemoryMappedFile> _brickData;
 
     // Caching, one for each PBO
     std::vector<std::vector<int>> _bricksInPBO;
     std::vector<std::vector<bool>> _usedCoords;
+
+    // Declared last so that running uploads are finished before the brick data and the
+    // caches they access are destroyed
+    std::unique_ptr<TaskGroup> _pboUploads[2];
 };
 
 } // namespace openspace
@@ -0,0 +1,132 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/multiresvolume/rendering/brickresidency.h>
+
+#include <ghoul/misc/assert.h>
+#include <algorithm>
+
+namespace {
+    constexpr const unsigned int AtlasSlotMask = 0x0FFFFFFF;
+    constexpr const int LevelShift = 28;
+} // namespace
+
+namespace openspace {
+
+void BrickResidency::initialize(unsigned int nBricks, unsigned int nAtlasSlots) {
+    _atlasData.assign(nBricks, NotResident);
+    _requiredGeneration.assign(nBricks, 0);
+    _generation = 0;
+
+    // Slots are handed out from the back, so the first slots are used first
+    _freeAtlasSlots.resize(nAtlasSlots);
+    for (unsigned int i = 0; i < nAtlasSlots; ++i) {
+        _freeAtlasSlots[i] = nAtlasSlots - 1 - i;
+    }
+
+    _requiredBricks.clear();
+    _prevRequiredBricks.clear();
+    _missingBricks.clear();
+}
+
+const std::vector<unsigned int>& BrickResidency::update(
+                                                    const std::vector<int>& brickIndices)
+{
+    _generation++;
+    if (_generation == 0) {
+        // The generation counter wrapped around, so old stamps could be mistaken for
+        // the current generation
+        std::fill(_requiredGeneration.begin(), _requiredGeneration.end(), 0);
+        _generation = 1;
+    }
+
+    _requiredBricks.clear();
+    _missingBricks.clear();
+    const unsigned int nBricks = static_cast<unsigned int>(_atlasData.size());
+    for (int index : brickIndices) {
+        const unsigned int brick = static_cast<unsigned int>(index);
+        if (index < 0 || brick >= nBricks || _requiredGeneration[brick] == _generation) {
+            continue;
+        }
+        _requiredGeneration[brick] = _generation;
+        _requiredBricks.push_back(brick);
+        if (_atlasData[brick] == NotResident) {
+            _missingBricks.push_back(brick);
+        }
+    }
+
+    // Only the bricks that were required in the previous frame can have become unused
+    for (unsigned int brick : _prevRequiredBricks) {
+        if (_requiredGeneration[brick] != _generation && isResident(brick)) {
+            evict(brick);
+        }
+    }
+    std::swap(_prevRequiredBricks, _requiredBricks);
+
+    // Consecutive bricks are stored next to each other on disk
+    std::sort(_missingBricks.begin(), _missingBricks.end());
+    return _missingBricks;
+}
+
+unsigned int BrickResidency::insert(unsigned int brickIndex, unsigned int level) {
+    ghoul_assert(brickIndex < _atlasData.size(), "Brick index out of range");
+    ghoul_assert(!isResident(brickIndex), "Brick is already resident");
+    ghoul_assert(!_freeAtlasSlots.empty(), "No free atlas slots");
+
+    const unsigned int atlasSlot = _freeAtlasSlots.back();
+    _freeAtlasSlots.pop_back();
+    ghoul_assert(atlasSlot <= AtlasSlotMask, "Atlas slot out of range");
+
+    const unsigned int data = (level << LevelShift) + atlasSlot;
+    _atlasData[brickIndex] = data;
+    return data;
+}
+
+void BrickResidency::evict(unsigned int brickIndex) {
+    ghoul_assert(isResident(brickIndex), "Brick is not resident");
+
+    _freeAtlasSlots.push_back(_atlasData[brickIndex] & AtlasSlotMask);
+    _atlasData[brickIndex] = NotResident;
+}
+
+bool BrickResidency::isResident(unsigned int brickIndex) const {
+    return brickIndex < _atlasData.size() && _atlasData[brickIndex] != NotResident;
+}
+
+unsigned int BrickResidency::atlasData(unsigned int brickIndex) const {
+    return brickIndex < _atlasData.size() ? _atlasData[brickIndex] : NotResident;
+}
+
+unsigned int BrickResidency::numRequiredBricks() const {
+    // The required bricks have been swapped into the previous list by update
+    return static_cast<unsigned int>(_prevRequiredBricks.size());
+}
+
+unsigned int BrickResidency::numResidentBricks() const {
+    return static_cast<unsigned int>(
+        _atlasData.size() - std::count(_atlasData.begin(), _atlasData.end(), NotResident)
+    );
+}
+
+} // namespace openspace
@@ -0,0 +1,101 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_MULTIRESVOLUME___BRICKRESIDENCY___H__
+#define __OPENSPACE_MODULE_MULTIRESVOLUME___BRICKRESIDENCY___H__
+
+#include <limits>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * Keeps track of which bricks of a TSP are resident in the texture atlas and which atlas
+ * slot each of them occupies. All state is stored in dense arrays that are indexed by
+ * the brick index, so inserting and evicting a brick does not allocate. Instead of
+ * building a set of the required bricks every frame, each required brick is stamped
+ * with the current generation. A brick that is not stamped with the current generation
+ * is no longer required, so the bricks of the previous frame can be diffed against the
+ * current frame without clearing or sorting anything.
+ */
+class BrickResidency {
+public:
+    static constexpr const unsigned int NotResident =
+        std::numeric_limits<unsigned int>::max();
+
+    /**
+     * Resets the residency table for \p nBricks bricks that share \p nAtlasSlots slots
+     * in the atlas. All bricks are initially not resident.
+     */
+    void initialize(unsigned int nBricks, unsigned int nAtlasSlots);
+
+    /**
+     * Starts a new frame in which the bricks in \p brickIndices are required. The list
+     * may contain the same brick multiple times. Bricks that were required in the
+     * previous frame but are not required anymore are evicted, which frees their atlas
+     * slots.
+     *
+     * \param brickIndices The bricks that are required in this frame
+     * \returns The required bricks that are not resident, in increasing order
+     */
+    const std::vector<unsigned int>& update(const std::vector<int>& brickIndices);
+
+    /**
+     * Assigns a free atlas slot to the brick \p brickIndex. The returned value is the
+     * entry of the brick in the atlas map, which stores the octree \p level in the upper
+     * four bits and the atlas slot in the remaining bits.
+     */
+    unsigned int insert(unsigned int brickIndex, unsigned int level);
+
+    /// Removes the brick \p brickIndex from the atlas and frees its slot
+    void evict(unsigned int brickIndex);
+
+    /// Returns <code>true</code> if the brick \p brickIndex is in the atlas
+    bool isResident(unsigned int brickIndex) const;
+
+    /// Returns the atlas map entry of the brick \p brickIndex or NotResident
+    unsigned int atlasData(unsigned int brickIndex) const;
+
+    /// Returns the number of distinct bricks that were passed to the last update call
+    unsigned int numRequiredBricks() const;
+
+    /// Returns the number of bricks that are currently in the atlas
+    unsigned int numResidentBricks() const;
+
+private:
+    // The atlas map entry for every brick, or NotResident
+    std::vector<unsigned int> _atlasData;
+    // The generation in which each brick was last required
+    std::vector<unsigned int> _requiredGeneration;
+    unsigned int _generation = 0;
+
+    std::vector<unsigned int> _freeAtlasSlots;
+    std::vector<unsigned int> _requiredBricks;
+    std::vector<unsigned int> _prevRequiredBricks;
+    std::vector<unsigned int> _missingBricks;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_MULTIRESVOLUME___BRICKRESIDENCY___H__
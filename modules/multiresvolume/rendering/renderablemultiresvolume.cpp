@@ -700,7 +700,7 @@ void RenderableMultiresVolume::update(const UpdateData& data) {
             uploadStart = selectionEnd;
         }
 
-        _atlasManager->updateAtlas(AtlasManager::EVEN, _brickIndices);
+        _atlasManager->updateAtlas(_brickIndices);
 
         if (_gatheringStats) {
             std::chrono::system_clock::time_point uploadEnd =
@@ -24,17 +24,66 @@
 
 #include <modules/multiresvolume/rendering/tsp.h>
 
+#include <openspace/engine/globals.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/taskscheduler.h>
 #include <ghoul/fmt.h>
 #include <ghoul/glm.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/filesystem/cachemanager.h>
 #include <ghoul/logging/logmanager.h>
+#include <cstdio>
+#include <cstring>
 #include <numeric>
 #include <queue>
+#include <sys/stat.h>
 
 namespace {
     constexpr const char* _loggerCat = "TSP";
+
+    // The number of bricks whose errors are calculated before the progress is stored
+    constexpr const unsigned int BricksPerErrorPass = 4096;
+    // The number of bricks whose errors are calculated by a single task
+    constexpr const unsigned int BricksPerErrorTask = 16;
+
+    // The file with the error progress starts with this header, followed by the spatial
+    // and the temporal error arrays
+    struct ErrorProgressHeader {
+        // Identify the data file that the errors were calculated for
+        uint64_t fileSize;
+        int64_t modificationTime;
+        openspace::TSP::Header header;
+        unsigned int nNodes;
+
+        // The number of bricks for which the errors have been calculated
+        unsigned int nSpatialBricks;
+        unsigned int nTemporalBricks;
+    };
+
+    ErrorProgressHeader errorProgressHeader(const std::string& filename,
+                                            const openspace::TSP::Header& header,
+                                            unsigned int nNodes)
+    {
+        ErrorProgressHeader result = {};
+        struct stat info;
+        if (stat(filename.c_str(), &info) == 0) {
+            result.fileSize = static_cast<uint64_t>(info.st_size);
+            result.modificationTime = static_cast<int64_t>(info.st_mtime);
+        }
+        result.header = header;
+        result.nNodes = nNodes;
+        return result;
+    }
+
+    // Returns whether the stored progress was calculated for the same data file, which
+    // might have been regenerated under the same name in the meantime
+    bool isSameDataFile(const ErrorProgressHeader& lhs, const ErrorProgressHeader& rhs) {
+        return lhs.fileSize == rhs.fileSize &&
+               lhs.modificationTime == rhs.modificationTime &&
+               std::memcmp(&lhs.header, &rhs.header, sizeof(lhs.header)) == 0 &&
+               lhs.nNodes == rhs.nNodes;
+    }
 } // namespace
 
 namespace openspace {
@@ -221,6 +270,10 @@ long long TSP::dataPosition() {
     return sizeof(Header);
 }
 
+const std::string& TSP::filename() const {
+    return _filename;
+}
+
 std::ifstream& TSP::file() {
     return _file;
 }
@@ -268,106 +321,72 @@ GLuint TSP::ssbo() const {
 bool TSP::calculateSpatialError() {
     unsigned int numBrickVals = _paddedBrickDim*_paddedBrickDim*_paddedBrickDim;
 
-    if (!_file.is_open()) {
+    // The bricks are read through a memory mapping, so only the bricks that are
+    // currently being processed need to be resident in memory
+    MemoryMappedFile brickData(_filename);
+    const size_t brickSize = static_cast<size_t>(numBrickVals) * sizeof(float);
+    const size_t requiredSize = dataPosition() + _numTotalNodes * brickSize;
+    if (!brickData.isValid() || brickData.size() < requiredSize) {
         return false;
     }
+    auto brickValues = [&brickData, brickSize](unsigned int brick) {
+        return brickData.at<float>(dataPosition() + brick * brickSize);
+    };
 
-    std::vector<float> buffer(numBrickVals);
-    std::vector<float> averages(_numTotalNodes);
     std::vector<float> stdDevs(_numTotalNodes);
 
-    // First pass: Calculate average color for each brick
-    LDEBUG("Calculating spatial error, first pass");
-    for (unsigned int brick = 0; brick<_numTotalNodes; ++brick) {
-        // Offset in file
-        std::streampos offset = dataPosition() +
-                                static_cast<long long>(brick*numBrickVals*sizeof(float));
-        _file.seekg(offset);
-
-        _file.read(
-            reinterpret_cast<char*>(&buffer[0]),
-            static_cast<size_t>(numBrickVals) * sizeof(float)
-        );
-
-        double average = std::accumulate(
-            buffer.begin(),
-            buffer.end(),
-            0.0,
-            [](double a, float b) { return a + static_cast<double>(b); }
-        );
-        averages[brick] = static_cast<float>(average / static_cast<double>(numBrickVals));
-    }
-
-    // Spatial SNR stats
-    float minError = 1e20f;
-    float maxError = 0.f;
-    std::vector<float> medianArray(_numTotalNodes);
-
-    // Second pass: For each brick, compare the covered leaf voxels with
-    // the brick average
-    LDEBUG("Calculating spatial error, second pass");
-    for (unsigned int brick = 0; brick < _numTotalNodes; ++brick) {
-        // Fetch mean intensity
-        float brickAvg = averages[brick];
-
-        // Sum  for std dev computation
-        float stdDev = 0.f;
-
-        // Get a list of leaf bricks that the current brick covers
-        std::list<unsigned int> leafBricksCovered = coveredLeafBricks(brick);
-
-        // If the brick is already a leaf, assign a negative error.
-        // Ad hoc "hack" to distinguish leafs from other nodes that happens
-        // to get a zero error due to rounding errors or other reasons.
-        if (leafBricksCovered.size() == 1) {
-            stdDev = -0.1f;
-        }
-        else {
+    // For each brick, compare the covered leaf voxels with the brick average
+    LDEBUG("Calculating spatial error");
+    const bool success = calculateErrors(
+        SPATIAL_ERR,
+        stdDevs,
+        [this, &brickValues, numBrickVals](unsigned int brick) -> float {
+            // Calculate the average color of the brick
+            const float* values = brickValues(brick);
+            double average = std::accumulate(
+                values,
+                values + numBrickVals,
+                0.0,
+                [](double a, float b) { return a + static_cast<double>(b); }
+            );
+            float brickAvg = static_cast<float>(
+                average / static_cast<double>(numBrickVals)
+            );
+
+            // Get a list of leaf bricks that the current brick covers
+            std::list<unsigned int> leafBricksCovered = coveredLeafBricks(brick);
+
+            // If the brick is already a leaf, assign a negative error.
+            // Ad hoc "hack" to distinguish leafs from other nodes that happens
+            // to get a zero error due to rounding errors or other reasons.
+            if (leafBricksCovered.size() == 1) {
+                return -0.1f;
+            }
 
             // Calculate "standard deviation" corresponding to leaves
-            for (auto lb = leafBricksCovered.begin(); lb != leafBricksCovered.end(); ++lb)
-            {
-                // Read brick
-                std::streampos offset = dataPosition() +
-                                 static_cast<long long>((*lb)*numBrickVals*sizeof(float));
-                _file.seekg(offset);
-
-                _file.read(reinterpret_cast<char*>(&buffer[0]),
-                    static_cast<size_t>(numBrickVals)*sizeof(float));
-
-                // Add to sum
-                for (auto v = buffer.begin(); v != buffer.end(); ++v) {
-                    stdDev += pow(*v - brickAvg, 2.f);
+            float stdDev = 0.f;
+            for (unsigned int leafBrick : leafBricksCovered) {
+                const float* leafValues = brickValues(leafBrick);
+                for (unsigned int i = 0; i < numBrickVals; ++i) {
+                    stdDev += pow(leafValues[i] - brickAvg, 2.f);
                 }
             }
 
             stdDev /= static_cast<float>(leafBricksCovered.size()*numBrickVals);
-            stdDev = sqrt(stdDev);
-        } // if not leaf
-
-        if (stdDev < minError) {
-            minError = stdDev;
-        }
-        else if (stdDev > maxError) {
-            maxError = stdDev;
+            return sqrt(stdDev);
         }
-
-        stdDevs[brick] = stdDev;
-        medianArray[brick] = stdDev;
+    );
+    if (!success) {
+        return false;
     }
 
-    std::sort(medianArray.begin(), medianArray.end());
-    //float medError = medianArray[medianArray.size()/2];
-
     // "Normalize" errors
     float minNorm = 1e20f;
     float maxNorm = 0.f;
     for (unsigned int i = 0; i<_numTotalNodes; ++i) {
-        //float normalized = (stdDevs[i]-minError)/(maxError-minError);
         if (stdDevs[i] > 0.f) {
             stdDevs[i] = pow(stdDevs[i], 0.5f);
         }
-        //_data[i*NUM_DATA + SPATIAL_ERR] = *reinterpret_cast<int*>(&stdDevs[i]);
         _data[i*NUM_DATA + SPATIAL_ERR] = glm::floatBitsToInt(stdDevs[i]);
         if (stdDevs[i] < minNorm) {
             minNorm = stdDevs[i];
@@ -392,84 +411,70 @@ bool TSP::calculateSpatialError() {
 }
 
 bool TSP::calculateTemporalError() {
-    if (!_file.is_open()) {
+    unsigned int numBrickVals = _paddedBrickDim * _paddedBrickDim * _paddedBrickDim;
+
+    MemoryMappedFile brickData(_filename);
+    const size_t brickSize = static_cast<size_t>(numBrickVals) * sizeof(float);
+    const size_t requiredSize = dataPosition() + _numTotalNodes * brickSize;
+    if (!brickData.isValid() || brickData.size() < requiredSize) {
         return false;
     }
+    auto brickValues = [&brickData, brickSize](unsigned int brick) {
+        return brickData.at<float>(dataPosition() + brick * brickSize);
+    };
 
     LDEBUG("Calculating temporal error");
 
-    // Statistics
-    //float minErr = 1e20f;
-    //float maxErr = 0.f;
-    std::vector<float> meanArray(_numTotalNodes);
-
     // Save errors
     std::vector<float> errors(_numTotalNodes);
 
-    // Calculate temporal error for one brick at a time
-    for (unsigned int brick = 0; brick<_numTotalNodes; ++brick) {
-        unsigned int numBrickVals = _paddedBrickDim * _paddedBrickDim * _paddedBrickDim;
-
-        // Save the individual voxel's average over timesteps. Because the
-        // BSTs are built by averaging leaf nodes, we only need to sample
-        // the brick at the correct coordinate.
-        std::vector<float> voxelAverages(numBrickVals);
-        std::vector<float> voxelStdDevs(numBrickVals);
-
-        // Read the whole brick to fill the averages
-        std::streampos offset = dataPosition() +
-                                static_cast<long long>(brick*numBrickVals*sizeof(float));
-        _file.seekg(offset);
+    const bool success = calculateErrors(
+        TEMPORAL_ERR,
+        errors,
+        [this, &brickValues, numBrickVals](unsigned int brick) -> float {
+            // The individual voxel's average over timesteps. Because the BSTs are built
+            // by averaging leaf nodes, we only need to sample the brick at the correct
+            // coordinate.
+            const float* voxelAverages = brickValues(brick);
+
+            // Build a list of the BST leaf bricks (within the same octree level) that
+            // this brick covers
+            std::list<unsigned int> coveredBricks = coveredBSTLeafBricks(brick);
+
+            // If the brick is at the lowest BST level, automatically set the error
+            // to -0.1 (enables using -1 as a marker for "no error accepted");
+            // Somewhat ad hoc to get around the fact that the error could be
+            // 0.0 higher up in the tree
+            if (coveredBricks.size() == 1) {
+                return -0.1f;
+            }
 
-        _file.read(
-            reinterpret_cast<char*>(voxelAverages.data()),
-            static_cast<size_t>(numBrickVals)*sizeof(float)
-        );
+            // Sum the squared differences per voxel one leaf brick at a time, so that
+            // every leaf is read sequentially
+            std::vector<float> voxelSums(numBrickVals, 0.f);
+            for (unsigned int leaf : coveredBricks) {
+                const float* samples = brickValues(leaf);
+                for (unsigned int voxel = 0; voxel < numBrickVals; ++voxel) {
+                    voxelSums[voxel] += pow(samples[voxel] - voxelAverages[voxel], 2.f);
+                }
+            }
 
-        // Build a list of the BST leaf bricks (within the same octree level) that
-        // this brick covers
-        std::list<unsigned int> coveredBricks = coveredBSTLeafBricks(brick);
-
-        // If the brick is at the lowest BST level, automatically set the error
-        // to -0.1 (enables using -1 as a marker for "no error accepted");
-        // Somewhat ad hoc to get around the fact that the error could be
-        // 0.0 higher up in the tree
-        if (coveredBricks.size() == 1) {
-            errors[brick] = -0.1f;
-        } else {
             // Calculate standard deviation per voxel, average over brick
             float avgStdDev = 0.f;
-            for (unsigned int voxel = 0; voxel<numBrickVals; ++voxel) {
-                float stdDev = 0.f;
-                for (auto leaf = coveredBricks.begin();
-                    leaf != coveredBricks.end(); ++leaf)
-                {
-                    // Sample the leaves at the corresponding voxel position
-                    _file.seekg(dataPosition() +
-                        static_cast<long long>(
-                            (*leaf * numBrickVals + voxel) * sizeof(float)
-                        )
-                    );
-
-                    float sample;
-                    _file.read(reinterpret_cast<char*>(&sample), sizeof(float));
-
-                    stdDev += pow(sample - voxelAverages[voxel], 2.f);
-                }
+            for (unsigned int voxel = 0; voxel < numBrickVals; ++voxel) {
+                float stdDev = voxelSums[voxel];
                 stdDev /= static_cast<float>(coveredBricks.size());
                 stdDev = sqrt(stdDev);
 
                 avgStdDev += stdDev;
-            } // for voxel
-
+            }
             avgStdDev /= static_cast<float>(numBrickVals);
-            meanArray[brick] = avgStdDev;
-            errors[brick] = avgStdDev;
+            return avgStdDev;
         }
-    } // for all bricks
-
-    std::sort(meanArray.begin(), meanArray.end());
-    //float medErr = meanArray[meanArray.size()/2];
+    );
+    if (!success) {
+        return false;
+    }
 
     // Adjust errors using user-provided exponents
     float minNorm = 1e20f;
@@ -501,6 +506,146 @@ bool TSP::calculateTemporalError() {
     return true;
 }
 
+bool TSP::calculateErrors(NodeData errorType, std::vector<float>& errors,
+                          const std::function<float(unsigned int)>& errorFunction)
+{
+    const unsigned int firstBrick = readErrorProgress(errorType, errors);
+    if (firstBrick > 0) {
+        LINFO(fmt::format(
+            "Resuming error calculation at brick {} of {}", firstBrick, _numTotalNodes
+        ));
+    }
+
+    TaskGroup tasks(global::taskScheduler);
+    for (unsigned int passBegin = firstBrick; passBegin < _numTotalNodes;
+         passBegin += BricksPerErrorPass)
+    {
+        const unsigned int passEnd = std::min(
+            passBegin + BricksPerErrorPass,
+            _numTotalNodes
+        );
+        for (unsigned int begin = passBegin; begin < passEnd; begin += BricksPerErrorTask)
+        {
+            const unsigned int end = std::min(begin + BricksPerErrorTask, passEnd);
+            tasks.run([&errors, &errorFunction, begin, end]() {
+                for (unsigned int brick = begin; brick < end; ++brick) {
+                    errors[brick] = errorFunction(brick);
+                }
+            });
+        }
+        tasks.wait();
+
+        writeErrorProgress(errorType, errors, passBegin, passEnd);
+        LDEBUG(fmt::format(
+            "Calculated errors for {} of {} bricks", passEnd, _numTotalNodes
+        ));
+    }
+    return true;
+}
+
+std::string TSP::errorProgressFilename() const {
+    ghoul::filesystem::File f = _filename;
+    return FileSys.cacheManager()->cachedFilename(
+        f.baseName(),
+        "errors",
+        ghoul::filesystem::CacheManager::Persistent::Yes
+    );
+}
+
+unsigned int TSP::readErrorProgress(NodeData errorType, std::vector<float>& errors) const
+{
+    if (!FileSys.cacheManager()) {
+        return 0;
+    }
+
+    std::ifstream file(errorProgressFilename(), std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    ErrorProgressHeader progress;
+    file.read(reinterpret_cast<char*>(&progress), sizeof(ErrorProgressHeader));
+    const ErrorProgressHeader current = errorProgressHeader(
+        _filename,
+        _header,
+        _numTotalNodes
+    );
+    if (!file || !isSameDataFile(progress, current)) {
+        return 0;
+    }
+
+    const bool isSpatial = (errorType == SPATIAL_ERR);
+    const unsigned int nBricks = std::min(
+        isSpatial ? progress.nSpatialBricks : progress.nTemporalBricks,
+        _numTotalNodes
+    );
+    const size_t offset = isSpatial ? 0 : _numTotalNodes;
+    file.seekg(sizeof(ErrorProgressHeader) + offset * sizeof(float));
+    file.read(reinterpret_cast<char*>(errors.data()), nBricks * sizeof(float));
+    if (!file) {
+        return 0;
+    }
+    return nBricks;
+}
+
+void TSP::writeErrorProgress(NodeData errorType, const std::vector<float>& errors,
+                             unsigned int firstBrick, unsigned int lastBrick) const
+{
+    if (!FileSys.cacheManager()) {
+        return;
+    }
+
+    const std::string filename = errorProgressFilename();
+    std::fstream file(filename, std::ios::in | std::ios::out | std::ios::binary);
+    const ErrorProgressHeader current = errorProgressHeader(
+        _filename,
+        _header,
+        _numTotalNodes
+    );
+    ErrorProgressHeader progress = {};
+    if (file.is_open()) {
+        file.read(reinterpret_cast<char*>(&progress), sizeof(ErrorProgressHeader));
+    }
+    if (!file.is_open() || !file || !isSameDataFile(progress, current)) {
+        // Start a new progress file
+        file.close();
+        file.open(
+            filename,
+            std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc
+        );
+        progress = current;
+        file.write(
+            reinterpret_cast<const char*>(&progress),
+            sizeof(ErrorProgressHeader)
+        );
+        std::vector<float> empty(2 * static_cast<size_t>(_numTotalNodes), 0.f);
+        file.write(
+            reinterpret_cast<const char*>(empty.data()),
+            empty.size() * sizeof(float)
+        );
+    }
+
+    const bool isSpatial = (errorType == SPATIAL_ERR);
+    const size_t offset = isSpatial ? 0 : _numTotalNodes;
+    file.seekp(sizeof(ErrorProgressHeader) + (offset + firstBrick) * sizeof(float));
+    file.write(
+        reinterpret_cast<const char*>(errors.data() + firstBrick),
+        (lastBrick - firstBrick) * sizeof(float)
+    );
+    if (isSpatial) {
+        progress.nSpatialBricks = lastBrick;
+    }
+    else {
+        progress.nTemporalBricks = lastBrick;
+    }
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&progress), sizeof(ErrorProgressHeader));
+
+    if (!file) {
+        LWARNING(fmt::format("Failed to store the error progress in {}", filename));
+    }
+}
+
 bool TSP::readCache() {
     if (!FileSys.cacheManager())
         return false;
@@ -518,6 +663,15 @@ bool TSP::readCache() {
         return false;
     }
 
+    // A cache that was not written completely is ignored
+    size_t dataSize = static_cast<size_t>(_numTotalNodes * NUM_DATA) * sizeof(int);
+    file.seekg(0, std::ios::end);
+    const std::streamoff cacheSize = file.tellg();
+    if (cacheSize != static_cast<std::streamoff>(6 * sizeof(float) + dataSize)) {
+        LWARNING(fmt::format("Ignoring incomplete cache {}", cacheFilename));
+        return false;
+    }
+    file.seekg(0, std::ios::beg);
 
     file.read(reinterpret_cast<char*>(&_minSpatialError), sizeof(float));
     file.read(reinterpret_cast<char*>(&_maxSpatialError), sizeof(float));
@@ -525,7 +679,6 @@ bool TSP::readCache() {
     file.read(reinterpret_cast<char*>(&_minTemporalError), sizeof(float));
     file.read(reinterpret_cast<char*>(&_maxTemporalError), sizeof(float));
     file.read(reinterpret_cast<char*>(&_medianTemporalError), sizeof(float));
-    size_t dataSize = static_cast<size_t>(_numTotalNodes * NUM_DATA) * sizeof(int);
     file.read(reinterpret_cast<char*>(_data.data()), dataSize);
     file.close();
 
@@ -569,6 +722,9 @@ bool TSP::writeCache() {
 
     file.close();
 
+    // The final errors are stored, so the intermediate results are no longer needed
+    std::remove(errorProgressFilename().c_str());
+
     return true;
 }
 
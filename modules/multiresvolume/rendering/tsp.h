@@ -27,6 +27,7 @@
 
 #include <ghoul/opengl/ghoul_gl.h>
 #include <fstream>
+#include <functional>
 #include <list>
 #include <string>
 #include <vector>
@@ -70,6 +71,7 @@ public:
 
     const Header& header() const;
     static long long dataPosition();
+    const std::string& filename() const;
     std::ifstream& file();
     unsigned int numTotalNodes() const;
     unsigned int numValuesPerNode() const;
@@ -108,6 +110,18 @@ private:
     // Return a list of eight children brick incices given a brick index
     std::list<unsigned int> childBricks(unsigned int brickIndex);
 
+    // Calculates the error of every brick with the errorFunction on the task scheduler.
+    // The bricks are processed in passes of a bounded number of bricks and the errors
+    // are stored after every pass, so that an interrupted calculation can be resumed
+    bool calculateErrors(NodeData errorType, std::vector<float>& errors,
+        const std::function<float(unsigned int)>& errorFunction);
+
+    std::string errorProgressFilename() const;
+    // Returns the number of bricks whose errors could be restored from a previous run
+    unsigned int readErrorProgress(NodeData errorType, std::vector<float>& errors) const;
+    void writeErrorProgress(NodeData errorType, const std::vector<float>& errors,
+        unsigned int firstBrick, unsigned int lastBrick) const;
+
     std::string _filename;
     std::ifstream _file;
     std::streampos _dataOffset;
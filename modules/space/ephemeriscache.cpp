@@ -0,0 +1,262 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/space/ephemeriscache.h>
+
+#include <openspace/engine/globals.h>
+#include <ghoul/glm.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+    // The number of Chebyshev coefficients for each component of a segment
+    constexpr const int Degree = 12;
+
+    // The points in [-1, 1] at which a segment's fit is compared against the function.
+    // They lie between the Chebyshev nodes, where the fit is not exact by construction
+    constexpr const std::array<double, 5> CheckPoints = { -0.97, -0.45, 0.0, 0.45, 0.97 };
+
+    // The number of times a cell is split in half before it is given up
+    constexpr const int MaxSplitDepth = 6;
+
+    // The number of cells on either side of a requested time that are fitted
+    constexpr const long long PrefetchCells = 4;
+
+    // The number of cells that are kept before the ones furthest from the current time
+    // are dropped
+    constexpr const size_t MaxCells = 1024;
+} // namespace
+
+namespace openspace {
+
+EphemerisCache::EphemerisCache(int nComponents, double tolerance, double cellLength)
+    : _nComponents(nComponents)
+    , _tolerance(tolerance)
+    , _cellLength(cellLength)
+    , _fitter(std::make_unique<TaskGroup>(global::taskScheduler))
+{
+    ghoul_assert(nComponents > 0, "Cache needs at least one component");
+    ghoul_assert(cellLength > 0.0, "Cell length must be positive");
+}
+
+EphemerisCache::~EphemerisCache() {
+    // Stop the running fit early, the TaskGroup waits for it when it is destroyed
+    _token.cancel();
+}
+
+void EphemerisCache::setFunction(Function function) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _token.cancel();
+    _token = CancellationToken();
+    _function = std::move(function);
+    _cells.clear();
+    _pendingCells.clear();
+}
+
+bool EphemerisCache::evaluate(double time, double* values, double* errorBound) {
+    const long long cellIndex = static_cast<long long>(std::floor(time / _cellLength));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_function) {
+        return false;
+    }
+
+    const auto it = _cells.find(cellIndex);
+    if (cellIndex != _lastCell || it == _cells.end()) {
+        requestCells(cellIndex);
+        _lastCell = cellIndex;
+    }
+    if (it == _cells.end() || it->second.empty()) {
+        return false;
+    }
+
+    // The last segment also covers its end, which belongs to the next cell in theory but
+    // might end up here due to rounding
+    const Cell& cell = it->second;
+    auto segment = std::find_if(
+        cell.begin(),
+        cell.end(),
+        [time](const Segment& s) { return time < s.end; }
+    );
+    if (segment == cell.end()) {
+        segment = cell.end() - 1;
+    }
+
+    evaluateSegment(*segment, time, values);
+    if (errorBound) {
+        *errorBound = segment->error;
+    }
+    return true;
+}
+
+void EphemerisCache::waitForPendingFits() {
+    // The fits lock the _mutex to store their results, so it must not be held here
+    _fitter->wait();
+}
+
+void EphemerisCache::requestCells(long long cellIndex) {
+    if (_cells.size() > MaxCells) {
+        for (auto it = _cells.begin(); it != _cells.end();) {
+            if (std::abs(it->first - cellIndex) > static_cast<long long>(MaxCells / 2)) {
+                it = _cells.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    // Collect the missing cells ordered by their distance to the requested one
+    std::vector<long long> missing;
+    for (long long i = 0; i <= 2 * PrefetchCells; ++i) {
+        const long long c = cellIndex + ((i % 2 == 0) ? -i / 2 : (i + 1) / 2);
+        if (_cells.find(c) == _cells.end() && _pendingCells.insert(c).second) {
+            missing.push_back(c);
+        }
+    }
+    if (missing.empty()) {
+        return;
+    }
+
+    _fitter->run(
+        [this, function = _function, token = _token, missing]() {
+            for (long long c : missing) {
+                if (token.isCancelled()) {
+                    return;
+                }
+
+                Cell cell;
+                try {
+                    cell = fitCell(function, c);
+                }
+                catch (const ghoul::RuntimeError&) {
+                    // The function is not defined here, so the cell stays empty and the
+                    // caller keeps using the function directly
+                    cell.clear();
+                }
+
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (token.isCancelled()) {
+                    // The function was replaced in the meantime
+                    return;
+                }
+                _pendingCells.erase(c);
+                _cells[c] = std::move(cell);
+            }
+        },
+        TaskScheduler::Priority::Low,
+        _token
+    );
+}
+
+EphemerisCache::Cell EphemerisCache::fitCell(const Function& function,
+                                             long long cellIndex) const
+{
+    const double start = cellIndex * _cellLength;
+    Cell cell;
+    if (!fitRange(function, start, start + _cellLength, 0, cell)) {
+        cell.clear();
+    }
+    return cell;
+}
+
+bool EphemerisCache::fitRange(const Function& function, double start, double end,
+                              int depth, Cell& cell) const
+{
+    const double mid = (start + end) / 2.0;
+    const double halfLength = (end - start) / 2.0;
+
+    // Sample the function at the Chebyshev nodes of the range
+    std::vector<double> samples(Degree * _nComponents);
+    for (int k = 0; k < Degree; ++k) {
+        const double x = std::cos(glm::pi<double>() * (k + 0.5) / Degree);
+        function(mid + halfLength * x, &samples[k * _nComponents]);
+    }
+
+    Segment segment = { start, end, 0.0, std::vector<double>(Degree * _nComponents) };
+    for (int c = 0; c < _nComponents; ++c) {
+        for (int j = 0; j < Degree; ++j) {
+            double sum = 0.0;
+            for (int k = 0; k < Degree; ++k) {
+                sum += samples[k * _nComponents + c] *
+                       std::cos(glm::pi<double>() * j * (k + 0.5) / Degree);
+            }
+            segment.coefficients[c * Degree + j] = (j == 0 ? 1.0 : 2.0) * sum / Degree;
+        }
+    }
+
+    // Measure the error of the fit between the nodes
+    std::vector<double> expected(_nComponents);
+    std::vector<double> actual(_nComponents);
+    for (double x : CheckPoints) {
+        const double t = mid + halfLength * x;
+        function(t, expected.data());
+        evaluateSegment(segment, t, actual.data());
+
+        double sumSquared = 0.0;
+        for (int c = 0; c < _nComponents; ++c) {
+            sumSquared += (expected[c] - actual[c]) * (expected[c] - actual[c]);
+        }
+        segment.error = std::max(segment.error, std::sqrt(sumSquared));
+    }
+
+    // Written to also reject a NaN error
+    if (segment.error <= _tolerance) {
+        cell.push_back(std::move(segment));
+        return true;
+    }
+    if (depth >= MaxSplitDepth) {
+        return false;
+    }
+    return fitRange(function, start, mid, depth + 1, cell) &&
+           fitRange(function, mid, end, depth + 1, cell);
+}
+
+void EphemerisCache::evaluateSegment(const Segment& segment, double time,
+                                     double* values) const
+{
+    const double x = std::clamp(
+        (2.0 * time - segment.start - segment.end) / (segment.end - segment.start),
+        -1.0,
+        1.0
+    );
+
+    // Clenshaw's recurrence for the Chebyshev series of each component
+    for (int c = 0; c < _nComponents; ++c) {
+        const double* coefficients = &segment.coefficients[c * Degree];
+        double b1 = 0.0;
+        double b2 = 0.0;
+        for (int j = Degree - 1; j >= 1; --j) {
+            const double b = 2.0 * x * b1 - b2 + coefficients[j];
+            b2 = b1;
+            b1 = b;
+        }
+        values[c] = coefficients[0] + x * b1 - b2;
+    }
+}
+
+} // namespace openspace
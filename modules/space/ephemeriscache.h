@@ -0,0 +1,144 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_SPACE___EPHEMERISCACHE___H__
+#define __OPENSPACE_MODULE_SPACE___EPHEMERISCACHE___H__
+
+#include <openspace/util/taskscheduler.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openspace {
+
+/**
+ * The EphemerisCache approximates a smooth, vector-valued function of time, such as a
+ * position or a rotation matrix retrieved from SPICE, with piecewise Chebyshev
+ * polynomials so that it can be evaluated without calling the function itself. Time is
+ * split into cells of a fixed length and the cells around each requested time are fitted
+ * on a background thread. A cell's fit is checked against additional samples of the
+ * function and it is split into smaller segments until the difference is below the
+ * tolerance; cells that cannot be fitted, for example because the function throws, are
+ * not cached at all. <code>evaluate</code> returns <code>false</code> for times that are
+ * not covered yet, in which case the caller is expected to call the function directly.
+ *
+ * All methods are thread-safe.
+ */
+class EphemerisCache {
+public:
+    /**
+     * The function that is approximated. It has to write the <code>nComponents</code>
+     * values at the time passed as the first argument into the second argument and
+     * may throw a ghoul::RuntimeError if it cannot be evaluated. It is called from a
+     * background thread and must therefore not access any state that might change after
+     * it was passed to the cache.
+     */
+    using Function = std::function<void(double, double*)>;
+
+    /**
+     * Creates an empty cache for a function with \p nComponents values.
+     *
+     * \param nComponents The number of values that the cached function returns
+     * \param tolerance The maximum difference, as the Euclidean norm over all components,
+     *        between the cached and the real value at the points where it is checked
+     * \param cellLength The length of the time cells in seconds
+     */
+    EphemerisCache(int nComponents, double tolerance, double cellLength = 86400.0);
+    ~EphemerisCache();
+
+    /**
+     * Replaces the cached function with \p function and drops all previously cached
+     * values, including those that are currently being computed.
+     */
+    void setFunction(Function function);
+
+    /**
+     * Evaluates the cached approximation at the \p time and writes the values into
+     * \p values. If the \p time is not covered yet, the cells around it are scheduled to
+     * be fitted. The cells around the last covered time are fitted ahead of time, so that
+     * a steadily advancing time stays covered.
+     *
+     * \param time The time, in seconds past the J2000 epoch, at which to evaluate
+     * \param values The destination for the <code>nComponents</code> values
+     * \param errorBound If this is not <code>nullptr</code>, it receives the largest
+     *        difference that was measured for the segment that contains the \p time
+     * \returns <code>true</code> if the \p time is covered and the \p values were written
+     */
+    bool evaluate(double time, double* values, double* errorBound = nullptr);
+
+    /**
+     * Blocks until all cells that have been scheduled so far are fitted or were dropped
+     * because the function was replaced. Must not be called from the cached function.
+     */
+    void waitForPendingFits();
+
+private:
+    struct Segment {
+        double start;
+        double end;
+        double error;
+        // The Chebyshev coefficients, Degree for each of the components
+        std::vector<double> coefficients;
+    };
+
+    /// The segments covering one cell, ordered by time. Empty if the cell could not be
+    /// fitted
+    using Cell = std::vector<Segment>;
+
+    /// Schedules the cells within the prefetch range of \p cell that are neither fitted
+    /// nor being fitted. Has to be called with the _mutex locked
+    void requestCells(long long cell);
+
+    /// Fits the segments of the cell with the index \p cell
+    Cell fitCell(const Function& function, long long cell) const;
+
+    /// Recursively fits the segments for the range [\p start, \p end), splitting it until
+    /// every segment is within the tolerance. Returns <code>false</code> if that fails
+    bool fitRange(const Function& function, double start, double end, int depth,
+        Cell& cell) const;
+
+    void evaluateSegment(const Segment& segment, double time, double* values) const;
+
+    const int _nComponents;
+    const double _tolerance;
+    const double _cellLength;
+
+    std::mutex _mutex;
+    Function _function;
+    std::unordered_map<long long, Cell> _cells;
+    std::unordered_set<long long> _pendingCells;
+    // Cancelled whenever the function changes so that running fits are discarded
+    CancellationToken _token;
+    long long _lastCell = 0;
+
+    std::unique_ptr<TaskGroup> _fitter;
+};
+
+} // namespace openspace
+
+#endif // __OPENSPACE_MODULE_SPACE___EPHEMERISCACHE___H__
@@ -28,6 +28,8 @@
 #include <openspace/documentation/verifier.h>
 #include <openspace/util/updatestructures.h>
 #include <openspace/util/distanceconstants.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/renderengine.h>
@@ -39,11 +41,17 @@
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/opengl/texture.h>
 #include <ghoul/opengl/textureunit.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <sstream>
 #include <type_traits>
 
 namespace {
@@ -61,7 +69,180 @@ namespace {
         "filterOutOfRange"
     };
 
-    constexpr int8_t CurrentCacheVersion = 3;
+    constexpr int8_t CurrentCacheVersion = 4;
+
+    // The columns in the cache file start at a multiple of this many bytes so that they
+    // can be used directly from the memory mapped file
+    constexpr const size_t CacheColumnAlignment = 16;
+
+    // Speck files smaller than this are not split up between multiple threads
+    constexpr const size_t MinBytesPerParseThread = 1024 * 1024;
+
+    // Values of the stars that were parsed from one part of a Speck file
+    struct SpeckChunk {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        std::vector<float> values;
+        float minLuminance = std::numeric_limits<float>::max();
+        float maxLuminance = std::numeric_limits<float>::min();
+        size_t firstStar = 0;
+    };
+
+    // Numbers with more characters than this are rejected as malformed
+    constexpr const size_t MaxNumberLength = 64;
+
+    // Parses the number in [first, last) into \p value independently of the locale.
+    // Returns false if the characters don't form a number
+    bool parseNumber(const char* first, const char* last, float& value) {
+        // The powers of ten that are exactly representable as a double
+        constexpr const std::array<double, 23> Powers = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+            1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+        // A uint64_t can hold any number with this many decimal digits
+        constexpr const int MaxSignificantDigits = 19;
+
+        const char* p = first;
+        const bool isNegative = (p != last && *p == '-');
+        if (p != last && (*p == '-' || *p == '+')) {
+            ++p;
+        }
+
+        auto equalsWord = [p, last](const char* word) {
+            const size_t length = std::strlen(word);
+            if (static_cast<size_t>(last - p) != length) {
+                return false;
+            }
+            for (size_t i = 0; i < length; ++i) {
+                const char c = (p[i] >= 'A' && p[i] <= 'Z') ? p[i] - 'A' + 'a' : p[i];
+                if (c != word[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        if (equalsWord("nan")) {
+            value = std::numeric_limits<float>::quiet_NaN();
+            return true;
+        }
+        if (equalsWord("inf") || equalsWord("infinity")) {
+            value = isNegative ?
+                -std::numeric_limits<float>::infinity() :
+                std::numeric_limits<float>::infinity();
+            return true;
+        }
+
+        // Digits beyond the ones that fit into the mantissa only change the exponent
+        uint64_t mantissa = 0;
+        int nSignificantDigits = 0;
+        int exponent = 0;
+        bool hasDigits = false;
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        auto addDigit = [&](char c, bool isFraction) {
+            hasDigits = true;
+            if (nSignificantDigits < MaxSignificantDigits) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(c - '0');
+                nSignificantDigits += (mantissa > 0) ? 1 : 0;
+                exponent -= isFraction ? 1 : 0;
+            }
+            else {
+                exponent += isFraction ? 0 : 1;
+            }
+        };
+        for (; p != last && isDigit(*p); ++p) {
+            addDigit(*p, false);
+        }
+        if (p != last && *p == '.') {
+            for (++p; p != last && isDigit(*p); ++p) {
+                addDigit(*p, true);
+            }
+        }
+        if (!hasDigits) {
+            return false;
+        }
+
+        if (p != last && (*p == 'e' || *p == 'E')) {
+            ++p;
+            const bool isNegativeExponent = (p != last && *p == '-');
+            if (p != last && (*p == '-' || *p == '+')) {
+                ++p;
+            }
+            if (p == last) {
+                return false;
+            }
+            int e = 0;
+            for (; p != last && isDigit(*p); ++p) {
+                // Larger exponents over- or underflow anyway
+                e = std::min(e * 10 + (*p - '0'), 100000);
+            }
+            exponent += isNegativeExponent ? -e : e;
+        }
+        if (p != last) {
+            return false;
+        }
+
+        double v = static_cast<double>(mantissa);
+        if (exponent > 0 && exponent < static_cast<int>(Powers.size())) {
+            v *= Powers[exponent];
+        }
+        else if (exponent < 0 && -exponent < static_cast<int>(Powers.size())) {
+            v /= Powers[-exponent];
+        }
+        else if (exponent != 0 && mantissa != 0) {
+            v *= std::pow(10.0, exponent);
+        }
+        value = static_cast<float>(isNegative ? -v : v);
+        return true;
+    }
+
+    // Parses the next number in [first, last) into \p value and returns the position
+    // directly after it, or nullptr if there is no number
+    const char* parseFloat(const char* first, const char* last, float& value) {
+        auto isSpace = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+        first = std::find_if_not(first, last, isSpace);
+        const char* end = std::find_if(first, last, isSpace);
+
+        if (first == end || static_cast<size_t>(end - first) > MaxNumberLength) {
+            return nullptr;
+        }
+        if (!parseNumber(first, end, value)) {
+            return nullptr;
+        }
+        return end;
+    }
+
+    // Parses all lines in the chunk. Stars whose values are all 0 are skipped, but they
+    // are still considered for the luminosity range
+    void parseSpeckChunk(SpeckChunk& chunk, int nValuesPerStar, size_t lumArrayPos) {
+        std::vector<float> values(nValuesPerStar);
+        const char* line = chunk.begin;
+        while (line < chunk.end) {
+            const char* lineEnd = std::find(line, chunk.end, '\n');
+
+            std::fill(values.begin(), values.end(), 0.f);
+            const char* p = line;
+            for (float& v : values) {
+                p = parseFloat(p, lineEnd, v);
+                if (!p) {
+                    break;
+                }
+            }
+
+            chunk.minLuminance = std::min(chunk.minLuminance, values[lumArrayPos]);
+            chunk.maxLuminance = std::max(chunk.maxLuminance, values[lumArrayPos]);
+
+            const bool nullArray = std::all_of(
+                values.begin(),
+                values.end(),
+                [](float v) { return v == 0.f; }
+            );
+            if (!nullArray) {
+                chunk.values.insert(chunk.values.end(), values.begin(), values.end());
+            }
+
+            line = (lineEnd == chunk.end) ? chunk.end : lineEnd + 1;
+        }
+    }
 
     constexpr const int RenderOptionPointSpreadFunction = 0;
     constexpr const int RenderOptionTexture = 1;
@@ -929,7 +1110,7 @@ void RenderableStars::renderPSFToTexture() {
 }
 
 void RenderableStars::render(const RenderData& data, RendererTasks&) {
-    if (_fullData.empty()) {
+    if (_nStars == 0) {
         return;
     }
 
@@ -1042,8 +1223,7 @@ void RenderableStars::render(const RenderData& data, RendererTasks&) {
 
 
     glBindVertexArray(_vao);
-    const GLsizei nStars = static_cast<GLsizei>(_fullData.size() / _nValuesPerStar);
-    glDrawArrays(GL_POINTS, 0, nStars);
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(_nStars));
 
     glBindVertexArray(0);
     _program->deactivate();
@@ -1064,7 +1244,7 @@ void RenderableStars::update(const UpdateData&) {
         _dataIsDirty = true;
     }
 
-    if (_fullData.empty()) {
+    if (_nStars == 0) {
         return;
     }
 
@@ -1097,8 +1277,7 @@ void RenderableStars::update(const UpdateData&) {
             "in_bvLumAbsMagAppMag"
         );
 
-        const size_t nStars = _fullData.size() / _nValuesPerStar;
-        const size_t nValues = _slicedData.size() / nStars;
+        const size_t nValues = _slicedData.size() / _nStars;
 
         GLsizei stride = static_cast<GLsizei>(sizeof(GLfloat) * nValues);
 
@@ -1327,6 +1506,10 @@ void RenderableStars::loadShapeTexture() {
 }
 */
 
+const float* RenderableStars::column(size_t index) const {
+    return _fullData + index * _nStars;
+}
+
 void RenderableStars::loadData() {
     std::string _file = _speckFile;
     if (!FileSys.fileExists(absPath(_file))) {
@@ -1339,8 +1522,11 @@ void RenderableStars::loadData() {
     );
 
     _nValuesPerStar = 0;
+    _nStars = 0;
     _slicedData.clear();
-    _fullData.clear();
+    _fullData = nullptr;
+    _columnData.clear();
+    _cachedData = nullptr;
     _dataNames.clear();
 
     bool hasCachedFile = FileSys.fileExists(cachedFile);
@@ -1354,6 +1540,9 @@ void RenderableStars::loadData() {
             return;
         }
         else {
+            _nValuesPerStar = 0;
+            _nStars = 0;
+            _dataNames.clear();
             FileSys.cacheManager()->removeCacheFile(_file);
             // Intentional fall-through to the 'else' computation to generate the cache
             // file for the next run
@@ -1366,27 +1555,34 @@ void RenderableStars::loadData() {
 
     readSpeckFile();
 
-    LINFO("Saving cache");
-    saveCachedFile(cachedFile);
+    if (_nStars > 0) {
+        LINFO("Saving cache");
+        saveCachedFile(cachedFile);
+    }
 }
 
 void RenderableStars::readSpeckFile() {
     std::string _file = _speckFile;
-    std::ifstream file(_file);
-    if (!file.good()) {
+    MemoryMappedFile file(absPath(_file));
+    if (!file.isValid()) {
         LERROR(fmt::format("Failed to open Speck file '{}'", _file));
         return;
     }
+    const char* fileBegin = file.at<char>(0);
+    const char* fileEnd = fileBegin + file.size();
 
     // The beginning of the speck file has a header that either contains comments
     // (signaled by a preceding '#') or information about the structure of the file
     // (signaled by the keywords 'datavar', 'texturevar', and 'texture')
-    std::string line;
-    while (true) {
-        std::streampos position = file.tellg();
-        std::getline(file, line, '\n');
-
-        if (line[0] == '#' || line.empty()) {
+    const char* dataBegin = fileEnd;
+    const char* lineBegin = fileBegin;
+    while (lineBegin < fileEnd) {
+        const char* lineEnd = std::find(lineBegin, fileEnd, '\n');
+        const std::string line(lineBegin, lineEnd);
+        const char* position = lineBegin;
+        lineBegin = (lineEnd == fileEnd) ? fileEnd : lineEnd + 1;
+
+        if (line.empty() || line[0] == '#') {
             continue;
         }
 
@@ -1394,10 +1590,11 @@ void RenderableStars::readSpeckFile() {
             line.substr(0, 10) != "texturevar" &&
             line.substr(0, 7) != "texture")
         {
-            // we read a line that doesn't belong to the header, so we have to jump back
-            // before the beginning of the current line
+            // we read a line that doesn't belong to the header, so the data starts at
+            // the beginning of the current line
+            dataBegin = position;
             if (_enableTestGrid) {
-                file.seekg(position - std::streamoff(8));
+                dataBegin = std::max(position - 8, fileBegin);
             }
             break;
         }
@@ -1444,89 +1641,148 @@ void RenderableStars::readSpeckFile() {
     _nValuesPerStar += 3; // X Y Z are not counted in the Speck file indices
     _otherDataOption.addOptions(_dataNames);
 
-    float minLumValue = std::numeric_limits<float>::max();
-    float maxLumValue = std::numeric_limits<float>::min();
-
-    do {
-        std::vector<float> values(_nValuesPerStar);
-        std::stringstream str(line);
-
-        for (int i = 0; i < _nValuesPerStar; ++i) {
-            str >> values[i];
+    // Split the data into chunks of whole lines that are parsed concurrently
+    const size_t nBytes = static_cast<size_t>(fileEnd - dataBegin);
+    const size_t nChunks = std::clamp<size_t>(
+        nBytes / MinBytesPerParseThread,
+        1,
+        std::max<size_t>(global::taskScheduler.numThreads(), 1)
+    );
+    std::vector<SpeckChunk> chunks(nChunks);
+    for (size_t i = 0; i < nChunks; ++i) {
+        chunks[i].begin = (i == 0) ? dataBegin : chunks[i - 1].end;
+        chunks[i].end = fileEnd;
+        if (i + 1 < nChunks) {
+            const char* split = std::max(
+                dataBegin + nBytes * (i + 1) / nChunks,
+                chunks[i].begin
+            );
+            split = std::find(split, fileEnd, '\n');
+            chunks[i].end = (split == fileEnd) ? fileEnd : split + 1;
         }
-        
-        bool nullArray = true;
-        for (float v : values) {
-            if (v != 0.0) {
-                nullArray = false;
-                break;
+    }
+
+    // The calling thread parses chunks as well, so one task fewer than there are chunks
+    // is enough. This also guarantees progress if all workers are busy
+    auto forEachChunk = [&chunks](const auto& function) {
+        std::atomic<size_t> nextChunk = 0;
+        auto worker = [&chunks, &function, &nextChunk]() {
+            for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+                function(chunks[i]);
             }
+        };
+
+        TaskGroup tasks(global::taskScheduler);
+        for (size_t i = 1; i < chunks.size(); ++i) {
+            tasks.run(worker);
         }
-        minLumValue = values[_lumArrayPos] < minLumValue ?
-            values[_lumArrayPos] : minLumValue;
-        maxLumValue = values[_lumArrayPos] > maxLumValue ?
-            values[_lumArrayPos] : maxLumValue;
-        if (!nullArray) {
-            _fullData.insert(_fullData.end(), values.begin(), values.end());
-        }
+        worker();
+        tasks.wait();
+    };
+
+    const int nValuesPerStar = _nValuesPerStar;
+    const size_t lumArrayPos = _lumArrayPos;
+    forEachChunk([nValuesPerStar, lumArrayPos](SpeckChunk& chunk) {
+        parseSpeckChunk(chunk, nValuesPerStar, lumArrayPos);
+    });
 
-        std::getline(file, line, '\n');
+    float minLumValue = std::numeric_limits<float>::max();
+    float maxLumValue = std::numeric_limits<float>::min();
+    for (SpeckChunk& chunk : chunks) {
+        chunk.firstStar = _nStars;
+        _nStars += chunk.values.size() / _nValuesPerStar;
+        minLumValue = std::min(minLumValue, chunk.minLuminance);
+        maxLumValue = std::max(maxLumValue, chunk.maxLuminance);
+    }
 
-    } while (!file.eof());
+    // Transpose the parsed stars into columns
+    _columnData.resize(_nStars * _nValuesPerStar);
+    const size_t nStars = _nStars;
+    float* columnData = _columnData.data();
+    forEachChunk([nStars, nValuesPerStar, columnData](SpeckChunk& chunk) {
+        const size_t nChunkStars = chunk.values.size() / nValuesPerStar;
+        for (int c = 0; c < nValuesPerStar; ++c) {
+            float* dst = columnData + c * nStars + chunk.firstStar;
+            for (size_t i = 0; i < nChunkStars; ++i) {
+                dst[i] = chunk.values[i * nValuesPerStar + c];
+            }
+        }
+        chunk.values = std::vector<float>();
+    });
+    _fullData = _columnData.data();
 
     // Normalize Luminosity:
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        _fullData[i + _lumArrayPos] =
-            (_fullData[i + _lumArrayPos] - minLumValue) / (maxLumValue - minLumValue);
+    float* luminosity = columnData + _lumArrayPos * _nStars;
+    for (size_t i = 0; i < _nStars; ++i) {
+        luminosity[i] = (luminosity[i] - minLumValue) / (maxLumValue - minLumValue);
     }
 }
 
 bool RenderableStars::loadCachedFile(const std::string& file) {
-    std::ifstream fileStream(file, std::ifstream::binary);
-    if (fileStream.good()) {
-        int8_t version = 0;
-        fileStream.read(reinterpret_cast<char*>(&version), sizeof(int8_t));
-        if (version != CurrentCacheVersion) {
-            LINFO("The format of the cached file has changed: deleting old cache");
-            fileStream.close();
-            FileSys.deleteFile(file);
-            return false;
-        }
+    _cachedData = std::make_unique<MemoryMappedFile>(file);
+    if (!_cachedData->isValid()) {
+        _cachedData = nullptr;
+        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
+        return false;
+    }
 
-        int32_t nValues = 0;
-        fileStream.read(reinterpret_cast<char*>(&nValues), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_nValuesPerStar), sizeof(int32_t));
-
-        fileStream.read(reinterpret_cast<char*>(&_lumArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_absMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_appMagArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_bvColorArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_velocityArrayPos), sizeof(int32_t));
-        fileStream.read(reinterpret_cast<char*>(&_speedArrayPos), sizeof(int32_t));
-
-        for (int i = 0; i < _nValuesPerStar - 3; ++i) {
-            uint16_t len;
-            fileStream.read(reinterpret_cast<char*>(&len), sizeof(uint16_t));
-            std::vector<char> buffer(len);
-            fileStream.read(buffer.data(), len);
-            std::string value(buffer.begin(), buffer.end());
-            _dataNames.push_back(value);
+    const std::byte* data = _cachedData->data();
+    const size_t size = _cachedData->size();
+    size_t offset = 0;
+    auto read = [&](void* destination, size_t nBytes) {
+        if (offset + nBytes > size) {
+            return false;
         }
-        _otherDataOption.addOptions(_dataNames);
+        std::memcpy(destination, data + offset, nBytes);
+        offset += nBytes;
+        return true;
+    };
 
-        _fullData.resize(nValues);
-        fileStream.read(reinterpret_cast<char*>(
-            _fullData.data()),
-            nValues * sizeof(_fullData[0])
-        );
+    int8_t version = 0;
+    read(&version, sizeof(int8_t));
+    if (version != CurrentCacheVersion) {
+        LINFO("The format of the cached file has changed: deleting old cache");
+        _cachedData = nullptr;
+        FileSys.deleteFile(file);
+        return false;
+    }
 
-        bool success = fileStream.good();
-        return success;
+    int32_t nStars = 0;
+    bool success = read(&nStars, sizeof(int32_t));
+    success &= read(&_nValuesPerStar, sizeof(int32_t));
+
+    std::array<int32_t, 6> arrayPositions;
+    success &= read(arrayPositions.data(), sizeof(arrayPositions));
+    _lumArrayPos = arrayPositions[0];
+    _absMagArrayPos = arrayPositions[1];
+    _appMagArrayPos = arrayPositions[2];
+    _bvColorArrayPos = arrayPositions[3];
+    _velocityArrayPos = arrayPositions[4];
+    _speedArrayPos = arrayPositions[5];
+
+    for (int i = 0; success && i < _nValuesPerStar - 3; ++i) {
+        uint16_t len = 0;
+        success &= read(&len, sizeof(uint16_t));
+        std::string value(len, '\0');
+        success &= read(value.data(), len);
+        _dataNames.push_back(value);
     }
-    else {
-        LERROR(fmt::format("Error opening file '{}' for loading cache file", file));
+
+    // The columns follow directly after the header and are used in place
+    offset += (CacheColumnAlignment - offset % CacheColumnAlignment) %
+              CacheColumnAlignment;
+    const size_t nValues = static_cast<size_t>(nStars) * _nValuesPerStar;
+    success &= (nStars > 0) && (offset + nValues * sizeof(float) <= size);
+    if (!success) {
+        LERROR(fmt::format("Error reading cache file '{}'", file));
+        _cachedData = nullptr;
         return false;
     }
+
+    _otherDataOption.addOptions(_dataNames);
+    _nStars = static_cast<size_t>(nStars);
+    _fullData = _cachedData->at<float>(offset);
+    return true;
 }
 
 void RenderableStars::saveCachedFile(const std::string& file) const {
@@ -1542,20 +1798,27 @@ void RenderableStars::saveCachedFile(const std::string& file) const {
         sizeof(int8_t)
     );
 
-    int32_t nValues = static_cast<int32_t>(_fullData.size());
-    if (nValues == 0) {
+    int32_t nStars = static_cast<int32_t>(_nStars);
+    if (nStars == 0) {
         throw ghoul::RuntimeError("Error writing cache: No values were loaded");
     }
-    fileStream.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+    fileStream.write(reinterpret_cast<const char*>(&nStars), sizeof(int32_t));
 
     int32_t nValuesPerStar = static_cast<int32_t>(_nValuesPerStar);
     fileStream.write(reinterpret_cast<const char*>(&nValuesPerStar), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_lumArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_absMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_appMagArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_bvColorArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_velocityArrayPos), sizeof(int32_t));
-    fileStream.write(reinterpret_cast<const char*>(&_speedArrayPos), sizeof(int32_t));
+
+    const std::array<int32_t, 6> arrayPositions = {
+        static_cast<int32_t>(_lumArrayPos),
+        static_cast<int32_t>(_absMagArrayPos),
+        static_cast<int32_t>(_appMagArrayPos),
+        static_cast<int32_t>(_bvColorArrayPos),
+        static_cast<int32_t>(_velocityArrayPos),
+        static_cast<int32_t>(_speedArrayPos)
+    };
+    fileStream.write(
+        reinterpret_cast<const char*>(arrayPositions.data()),
+        sizeof(arrayPositions)
+    );
 
     // -3 as we don't want to save the xyz values that are in the beginning of the file
     for (int i = 0; i < _nValuesPerStar - 3; ++i) {
@@ -1564,24 +1827,36 @@ void RenderableStars::saveCachedFile(const std::string& file) const {
         fileStream.write(_dataNames[i].c_str(), len);
     }
 
-    size_t nBytes = nValues * sizeof(_fullData[0]);
-    fileStream.write(reinterpret_cast<const char*>(_fullData.data()), nBytes);
+    // Pad the header so that the columns can be memory mapped when loading the cache
+    const size_t headerSize = static_cast<size_t>(fileStream.tellp());
+    const std::array<char, CacheColumnAlignment> padding = {};
+    fileStream.write(
+        padding.data(),
+        (CacheColumnAlignment - headerSize % CacheColumnAlignment) % CacheColumnAlignment
+    );
+
+    size_t nBytes = _nStars * _nValuesPerStar * sizeof(float);
+    fileStream.write(reinterpret_cast<const char*>(_fullData), nBytes);
 }
 
 void RenderableStars::createDataSlice(ColorOption option) {
     _slicedData.clear();
 
-    _otherDataRange = glm::vec2(
+    const float* positionX = column(0);
+    const float* positionY = column(1);
+    const float* positionZ = column(2);
+    const float* bvColor = column(_bvColorArrayPos);
+    const float* luminance = column(_lumArrayPos);
+    const float* absoluteMagnitude = column(_absMagArrayPos);
+    const float* apparentMagnitude = column(_appMagArrayPos);
+
+    glm::vec2 otherDataRange = glm::vec2(
         std::numeric_limits<float>::max(),
         -std::numeric_limits<float>::max()
     );
 
-    for (size_t i = 0; i < _fullData.size(); i += _nValuesPerStar) {
-        glm::vec3 position = glm::vec3(
-            _fullData[i + 0],
-            _fullData[i + 1],
-            _fullData[i + 2]
-        );
+    for (size_t i = 0; i < _nStars; ++i) {
+        glm::vec3 position = glm::vec3(positionX[i], positionY[i], positionZ[i]);
         position *= openspace::distanceconstants::Parsec;
 
         switch (option) {
@@ -1596,15 +1871,15 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 if (_enableTestGrid) {
                     float sunColor = 0.650f;
-                    layout.value.value = sunColor;// _fullData[i + 3];
+                    layout.value.value = sunColor;
                 }
                 else {
-                    layout.value.value = _fullData[i + _bvColorArrayPos];
+                    layout.value.value = bvColor[i];
                 }
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = luminance[i];
+                layout.value.absoluteMagnitude = absoluteMagnitude[i];
+                layout.value.apparentMagnitude = apparentMagnitude[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1622,14 +1897,14 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = bvColor[i];
+                layout.value.luminance = luminance[i];
+                layout.value.absoluteMagnitude = absoluteMagnitude[i];
+                layout.value.apparentMagnitude = apparentMagnitude[i];
 
-                layout.value.vx = _fullData[i + _velocityArrayPos];
-                layout.value.vy = _fullData[i + _velocityArrayPos + 1];
-                layout.value.vz = _fullData[i + _velocityArrayPos + 2];
+                layout.value.vx = column(_velocityArrayPos)[i];
+                layout.value.vy = column(_velocityArrayPos + 1)[i];
+                layout.value.vz = column(_velocityArrayPos + 2)[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1647,12 +1922,12 @@ void RenderableStars::createDataSlice(ColorOption option) {
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
-                layout.value.value = _fullData[i + _bvColorArrayPos];
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.value = bvColor[i];
+                layout.value.luminance = luminance[i];
+                layout.value.absoluteMagnitude = absoluteMagnitude[i];
+                layout.value.apparentMagnitude = apparentMagnitude[i];
 
-                layout.value.speed = _fullData[i + _speedArrayPos];
+                layout.value.speed = column(_speedArrayPos)[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1665,14 +1940,14 @@ void RenderableStars::createDataSlice(ColorOption option) {
             {
                 union {
                     OtherDataLayout value;
-                    std::array<float, sizeof(OtherDataLayout)> data;
+                    std::array<float, sizeof(OtherDataLayout) / sizeof(float)> data;
                 } layout = {};
 
                 layout.value.position = { { position[0], position[1], position[2] } };
 
                 int index = _otherDataOption.value();
                 // plus 3 because of the position
-                layout.value.value = _fullData[i + index + 3];
+                layout.value.value = column(index + 3)[i];
 
                 if (_staticFilterValue.has_value() &&
                     layout.value.value == _staticFilterValue)
@@ -1680,16 +1955,12 @@ void RenderableStars::createDataSlice(ColorOption option) {
                     layout.value.value = _staticFilterReplacementValue;
                 }
 
-                glm::vec2 range = _otherDataRange.value();
-                range.x = std::min(range.x, layout.value.value);
-                range.y = std::max(range.y, layout.value.value);
-                _otherDataRange = range;
-                _otherDataRange.setMinValue(glm::vec2(range.x));
-                _otherDataRange.setMaxValue(glm::vec2(range.y));
+                otherDataRange.x = std::min(otherDataRange.x, layout.value.value);
+                otherDataRange.y = std::max(otherDataRange.y, layout.value.value);
 
-                layout.value.luminance = _fullData[i + _lumArrayPos];
-                layout.value.absoluteMagnitude = _fullData[i + _absMagArrayPos];
-                layout.value.apparentMagnitude = _fullData[i + _appMagArrayPos];
+                layout.value.luminance = luminance[i];
+                layout.value.absoluteMagnitude = absoluteMagnitude[i];
+                layout.value.apparentMagnitude = apparentMagnitude[i];
 
                 _slicedData.insert(
                     _slicedData.end(),
@@ -1701,6 +1972,12 @@ void RenderableStars::createDataSlice(ColorOption option) {
             }
         }
     }
+
+    _otherDataRange = otherDataRange;
+    if (option == ColorOption::OtherData) {
+        _otherDataRange.setMinValue(glm::vec2(otherDataRange.x));
+        _otherDataRange.setMaxValue(glm::vec2(otherDataRange.y));
+    }
 }
 
 } // namespace openspace
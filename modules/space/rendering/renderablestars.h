@@ -47,6 +47,8 @@ namespace openspace {
 
 namespace documentation { struct Documentation; }
 
+class MemoryMappedFile;
+
 class RenderableStars : public Renderable {
 public:
     explicit RenderableStars(const ghoul::Dictionary& dictionary);
@@ -79,6 +81,9 @@ private:
 
     void createDataSlice(ColorOption option);
 
+    /// Returns the values of the column with the provided \p index for all stars
+    const float* column(size_t index) const;
+
     void loadData();
     void readSpeckFile();
     bool loadCachedFile(const std::string& file);
@@ -146,7 +151,14 @@ private:
     bool _enableTestGrid = false;
 
     std::vector<float> _slicedData;
-    std::vector<float> _fullData;
+
+    // The star data is stored column by column with _nStars values each. It either
+    // points into _columnData after the Speck file was read or directly into the memory
+    // mapped cache file
+    const float* _fullData = nullptr;
+    std::vector<float> _columnData;
+    std::unique_ptr<MemoryMappedFile> _cachedData;
+    size_t _nStars = 0;
 
     int _nValuesPerStar = 0;
     std::string _queuedOtherData;
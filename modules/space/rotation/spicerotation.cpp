@@ -24,14 +24,17 @@
 
 #include <modules/space/rotation/spicerotation.h>
 
+#include <modules/space/ephemeriscache.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/util/spicemanager.h>
 #include <openspace/util/time.h>
 #include <openspace/util/updatestructures.h>
+#include <algorithm>
 
 namespace {
     constexpr const char* KeyKernels = "Kernels";
+    constexpr const char* KeyCacheTolerance = "CacheTolerance";
 
     constexpr openspace::properties::Property::PropertyInfo SourceInfo = {
         "SourceFrame",
@@ -52,6 +55,19 @@ namespace {
         "Time Frame",
         "The time frame in which the spice kernels are valid."
     };
+
+    constexpr openspace::properties::Property::PropertyInfo UseCacheInfo = {
+        "UseCache",
+        "Use Ephemeris Cache",
+        "If this value is enabled, the rotation matrix is approximated by polynomials "
+        "that are fitted to the SPICE kernels in the background, which is much faster "
+        "than querying SPICE for every rotation. Times that are not cached yet are "
+        "retrieved from SPICE directly. The default value is false."
+    };
+
+    // The default difference between a cached and a SPICE matrix, measured as the
+    // Frobenius norm of their difference, which is roughly the angle in radians
+    constexpr const double DefaultCacheTolerance = 1e-9;
 } // namespace
 
 namespace openspace {
@@ -93,6 +109,20 @@ documentation::Documentation SpiceRotation::Documentation() {
                 Optional::Yes,
                 TimeFrameInfo.description
             },
+            {
+                UseCacheInfo.identifier,
+                new BoolVerifier,
+                Optional::Yes,
+                UseCacheInfo.description
+            },
+            {
+                KeyCacheTolerance,
+                new DoubleGreaterVerifier(0.0),
+                Optional::Yes,
+                "The largest difference between a cached rotation matrix and the one "
+                "retrieved from SPICE, measured as the norm of their difference. The "
+                "default value is 1e-9."
+            }
         }
     };
 }
@@ -100,6 +130,7 @@ documentation::Documentation SpiceRotation::Documentation() {
 SpiceRotation::SpiceRotation(const ghoul::Dictionary& dictionary)
     : _sourceFrame(SourceInfo)
     , _destinationFrame(DestinationInfo)
+    , _useCache(UseCacheInfo, false)
 {
     documentation::testSpecificationAndThrow(
         Documentation(),
@@ -135,22 +166,74 @@ SpiceRotation::SpiceRotation(const ghoul::Dictionary& dictionary)
         addPropertySubOwner(_timeFrame.get());
     }
 
+    if (dictionary.hasKey(UseCacheInfo.identifier)) {
+        _useCache = dictionary.value<bool>(UseCacheInfo.identifier);
+    }
+    const double tolerance = dictionary.hasKey(KeyCacheTolerance) ?
+        dictionary.value<double>(KeyCacheTolerance) :
+        DefaultCacheTolerance;
+    _cache = std::make_unique<EphemerisCache>(9, tolerance);
+    resetCache();
+
     addProperty(_sourceFrame);
     addProperty(_destinationFrame);
+    addProperty(_useCache);
+
+    _sourceFrame.onChange([this]() {
+        resetCache();
+        requireUpdate();
+    });
+    _destinationFrame.onChange([this]() {
+        resetCache();
+        requireUpdate();
+    });
+    _useCache.onChange([this]() { resetCache(); });
+}
 
-    _sourceFrame.onChange([this]() { requireUpdate(); });
-    _destinationFrame.onChange([this]() { requireUpdate(); });
+SpiceRotation::~SpiceRotation() {} // NOLINT
+
+void SpiceRotation::resetCache() {
+    if (!_useCache) {
+        _cache->setFunction(nullptr);
+        return;
+    }
+
+    // The cache samples the matrix on a background thread, so it gets its own copy of
+    // the properties
+    _cache->setFunction(
+        [source = _sourceFrame.value(), destination = _destinationFrame.value()]
+        (double time, double* values) {
+            const glm::dmat3 matrix = SpiceManager::ref().positionTransformMatrix(
+                source,
+                destination,
+                time
+            );
+            std::copy_n(glm::value_ptr(matrix), 9, values);
+        }
+    );
 }
 
 glm::dmat3 SpiceRotation::matrix(const UpdateData& data) const {
     if (_timeFrame && !_timeFrame->isActive(data.time)) {
         return glm::dmat3(1.0);
     }
+
+    const double time = data.time.j2000Seconds();
+
+    glm::dmat3 matrix;
+    if (_useCache && _cache->evaluate(time, glm::value_ptr(matrix))) {
+        return matrix;
+    }
+
     return SpiceManager::ref().positionTransformMatrix(
         _sourceFrame,
         _destinationFrame,
-        data.time.j2000Seconds()
+        time
     );
 }
 
+bool SpiceRotation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
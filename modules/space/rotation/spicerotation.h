@@ -27,26 +27,35 @@
 
 #include <openspace/scene/rotation.h>
 
+#include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/stringproperty.h>
 #include <openspace/scene/timeframe.h>
 
 namespace openspace {
 
 namespace documentation { struct Documentation; }
+class EphemerisCache;
 
 class SpiceRotation : public Rotation {
 public:
     SpiceRotation(const ghoul::Dictionary& dictionary);
+    ~SpiceRotation();
 
     const glm::dmat3& matrix() const;
     glm::dmat3 matrix(const UpdateData& data) const override;
+    bool isThreadSafe() const override;
 
     static documentation::Documentation Documentation();
 
 private:
+    /// Passes the current frames to the cache, or clears it if it is not used
+    void resetCache();
+
     properties::StringProperty _sourceFrame;
     properties::StringProperty _destinationFrame;
+    properties::BoolProperty _useCache;
     std::unique_ptr<TimeFrame> _timeFrame;
+    std::unique_ptr<EphemerisCache> _cache;
 };
 
 } // namespace openspace
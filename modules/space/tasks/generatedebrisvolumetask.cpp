@@ -26,6 +26,7 @@
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/rawvolumemetadata.h>
 #include <modules/volume/rawvolumewriter.h>
+#include <modules/volume/volumeutils.h>
 #include <openspace/util/spicemanager.h>
 
 #include <openspace/documentation/verifier.h>
@@ -66,6 +67,8 @@ namespace {
      constexpr const char* KeyLowerDomainBound = "LowerDomainBound";
      constexpr const char* KeyUpperDomainBound = "UpperDomainBound";    
 
+    constexpr const int HistogramBins = 100;
+
 }
 
 namespace openspace{
@@ -719,6 +722,13 @@ void GenerateDebrisVolumeTask::perform(const Task::ProgressCallback& progressCal
     
         volume::RawVolumeWriter<float> writer(rawOutputName);
         writer.write(rawVolumeQueue.front());
+        std::vector<float> histogram = normalizedHistogram(
+            rawVolumeQueue.front().data(),
+            rawVolumeQueue.front().nCells(),
+            minVal,
+            maxVal,
+            HistogramBins
+        );
         rawVolumeQueue.pop();
         
         RawVolumeMetadata metadata;
@@ -734,6 +744,8 @@ void GenerateDebrisVolumeTask::perform(const Task::ProgressCallback& progressCal
         metadata.hasValueRange = true;
         metadata.minValue = minVal;
         metadata.maxValue = maxVal;
+        metadata.hasHistogram = true;
+        metadata.histogram = std::move(histogram);
 
         /*LINFO(fmt::format("min2: {} ", minVal));
         LINFO(fmt::format("max2: {} ", maxVal));*/
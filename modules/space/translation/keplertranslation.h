@@ -70,6 +70,9 @@ public:
     */
     glm::dvec3 position(const UpdateData& data) const override;
 
+    /// The position only depends on the orbital elements of this translation
+    bool isThreadSafe() const override;
+
     /**
      * Method returning the openspace::Documentation that describes the ghoul::Dictinoary
      * that can be passed to the constructor.
@@ -24,6 +24,7 @@
 
 #include <modules/space/translation/spicetranslation.h>
 
+#include <modules/space/ephemeriscache.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/util/spicemanager.h>
@@ -35,6 +36,7 @@
 
 namespace {
     constexpr const char* KeyKernels = "Kernels";
+    constexpr const char* KeyCacheTolerance = "CacheTolerance";
 
     constexpr const char* DefaultReferenceFrame = "GALACTIC";
 
@@ -60,6 +62,18 @@ namespace {
         "This is the SPICE NAIF name for the reference frame in which the position "
         "should be retrieved. The default value is GALACTIC."
     };
+
+    constexpr openspace::properties::Property::PropertyInfo UseCacheInfo = {
+        "UseCache",
+        "Use Ephemeris Cache",
+        "If this value is enabled, the position is approximated by polynomials that are "
+        "fitted to the SPICE ephemeris in the background, which is much faster than "
+        "querying SPICE for every position. Times that are not cached yet are retrieved "
+        "from SPICE directly. The default value is false."
+    };
+
+    // The default distance in meters that a cached position may differ from SPICE
+    constexpr const double DefaultCacheTolerance = 1.0;
 } // namespace
 
 namespace openspace {
@@ -105,6 +119,19 @@ documentation::Documentation SpiceTranslation::Documentation() {
                 "A single kernel or list of kernels that this SpiceTranslation depends "
                 "on. All provided kernels will be loaded before any other operation is "
                 "performed."
+            },
+            {
+                UseCacheInfo.identifier,
+                new BoolVerifier,
+                Optional::Yes,
+                UseCacheInfo.description
+            },
+            {
+                KeyCacheTolerance,
+                new DoubleGreaterVerifier(0.0),
+                Optional::Yes,
+                "The largest distance in meters that a cached position may differ from "
+                "the position retrieved from SPICE. The default value is 1 meter."
             }
         }
     };
@@ -114,6 +141,7 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
     : _target(TargetInfo)
     , _observer(ObserverInfo)
     , _frame(FrameInfo, DefaultReferenceFrame)
+    , _useCache(UseCacheInfo, false)
 {
     documentation::testSpecificationAndThrow(
         Documentation(),
@@ -156,7 +184,17 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
         }
     }
 
+    if (dictionary.hasKey(UseCacheInfo.identifier)) {
+        _useCache = dictionary.value<bool>(UseCacheInfo.identifier);
+    }
+    const double tolerance = dictionary.hasKey(KeyCacheTolerance) ?
+        dictionary.value<double>(KeyCacheTolerance) :
+        DefaultCacheTolerance;
+    _cache = std::make_unique<EphemerisCache>(3, tolerance);
+    resetCache();
+
     auto update = [this](){
+        resetCache();
         requireUpdate();
         notifyObservers();
     };
@@ -169,18 +207,61 @@ SpiceTranslation::SpiceTranslation(const ghoul::Dictionary& dictionary)
 
     _frame.onChange(update);
     addProperty(_frame);
+
+    _useCache.onChange([this]() { resetCache(); });
+    addProperty(_useCache);
+}
+
+SpiceTranslation::~SpiceTranslation() {} // NOLINT
+
+void SpiceTranslation::resetCache() {
+    if (!_useCache) {
+        _cache->setFunction(nullptr);
+        return;
+    }
+
+    // The cache samples the position on a background thread, so it gets its own copy of
+    // the properties
+    _cache->setFunction(
+        [target = _target.value(), observer = _observer.value(), frame = _frame.value()]
+        (double time, double* values) {
+            double lightTime = 0.0;
+            const glm::dvec3 position = SpiceManager::ref().targetPosition(
+                target,
+                observer,
+                frame,
+                {},
+                time,
+                lightTime
+            ) * glm::pow(10.0, 3.0);
+            values[0] = position.x;
+            values[1] = position.y;
+            values[2] = position.z;
+        }
+    );
 }
 
 glm::dvec3 SpiceTranslation::position(const UpdateData& data) const {
+    const double time = data.time.j2000Seconds();
+
+    glm::dvec3 position;
+    if (_useCache && _cache->evaluate(time, glm::value_ptr(position))) {
+        return position;
+    }
+
     double lightTime = 0.0;
     return SpiceManager::ref().targetPosition(
         _target,
         _observer,
         _frame,
         {},
-        data.time.j2000Seconds(),
+        time,
         lightTime
     ) * glm::pow(10.0, 3.0);
 }
 
+bool SpiceTranslation::isThreadSafe() const {
+    return true;
+}
+
 } // namespace openspace
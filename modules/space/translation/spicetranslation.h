@@ -27,24 +27,36 @@
 
 #include <openspace/scene/translation.h>
 
+#include <openspace/properties/scalar/boolproperty.h>
 #include <openspace/properties/stringproperty.h>
+#include <memory>
 
 namespace openspace {
 
+class EphemerisCache;
+
 class SpiceTranslation : public Translation {
 public:
     SpiceTranslation(const ghoul::Dictionary& dictionary);
+    ~SpiceTranslation();
 
     glm::dvec3 position(const UpdateData& data) const override;
+    bool isThreadSafe() const override;
 
     static documentation::Documentation Documentation();
 
 private:
+    /// Passes the current target, observer, and frame to the cache, or clears it if it
+    /// is not used
+    void resetCache();
+
     properties::StringProperty _target;
     properties::StringProperty _observer;
     properties::StringProperty _frame;
+    properties::BoolProperty _useCache;
 
     glm::dvec3 _position;
+    std::unique_ptr<EphemerisCache> _cache;
 };
 
 } // namespace openspace
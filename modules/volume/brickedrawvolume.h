@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_VOLUME___BRICKEDRAWVOLUME___H__
+#define __OPENSPACE_MODULE_VOLUME___BRICKEDRAWVOLUME___H__
+
+#include <modules/volume/brickedvolumeformat.h>
+#include <modules/volume/linearlrucache.h>
+#include <openspace/util/memorymappedfile.h>
+#include <ghoul/glm.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace openspace::volume {
+
+template <typename T> class RawVolume;
+
+/**
+ * A read-only volume that is stored in the bricked and compressed format described in
+ * brickedvolumeformat.h. The file is memory-mapped and bricks are decompressed on
+ * demand, so only the parts of the volume that are accessed are read. The most recently
+ * used bricks are kept decompressed, which makes sampling with a VolumeSampler
+ * efficient as long as consecutive samples are close to each other. Bricks can also be
+ * read individually, for example to upload a volume to a texture brick by brick.
+ *
+ * The cache of decompressed bricks is not synchronized, so an instance must not be
+ * sampled from multiple threads at the same time.
+ */
+template <typename Type>
+class BrickedRawVolume {
+public:
+    using VoxelType = Type;
+
+    /**
+     * Maps the bricked volume at \p path and keeps up to \p nCachedBricks decompressed
+     * bricks in memory.
+     *
+     * \throw ghoul::RuntimeError If the file could not be mapped, is not a bricked
+     *        volume, or stores voxels of a different size than \c VoxelType
+     */
+    BrickedRawVolume(const std::string& path, size_t nCachedBricks = 64);
+
+    glm::uvec3 dimensions() const;
+    size_t nCells() const;
+    VoxelType get(const glm::uvec3& coordinates) const;
+    VoxelType get(size_t index) const;
+
+    unsigned int brickSize() const;
+    size_t nBricks() const;
+    glm::uvec3 brickOrigin(size_t brickIndex) const;
+    glm::uvec3 brickDimensions(size_t brickIndex) const;
+
+    /**
+     * Decompresses the brick \p brickIndex into \p result, which has to hold the number
+     * of voxels given by brickDimensions. The voxels are ordered with x changing fastest.
+     *
+     * \throw ghoul::RuntimeError If the compressed data of the brick is corrupt
+     */
+    void readBrick(size_t brickIndex, VoxelType* result) const;
+
+    /// Decompresses all bricks into a new RawVolume
+    std::unique_ptr<RawVolume<VoxelType>> read() const;
+
+private:
+    const std::vector<VoxelType>& brick(size_t brickIndex) const;
+
+    MemoryMappedFile _file;
+    glm::uvec3 _dimensions;
+    unsigned int _brickSize;
+    glm::uvec3 _gridSize;
+    const uint64_t* _brickTable = nullptr;
+
+    mutable LinearLruCache<std::shared_ptr<std::vector<VoxelType>>> _cache;
+};
+
+} // namespace openspace::volume
+
+#include "brickedrawvolume.inl"
+
+#endif // __OPENSPACE_MODULE_VOLUME___BRICKEDRAWVOLUME___H__
@@ -0,0 +1,187 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/volume/rawvolume.h>
+#include <modules/volume/volumeutils.h>
+#include <ghoul/misc/exception.h>
+#include <cstring>
+
+namespace openspace::volume {
+
+template <typename VoxelType>
+BrickedRawVolume<VoxelType>::BrickedRawVolume(const std::string& path,
+                                              size_t nCachedBricks)
+    : _file(path)
+    , _cache(1, 0)
+{
+    if (!_file.isValid() || _file.size() < sizeof(BrickedVolumeHeader)) {
+        throw ghoul::RuntimeError("Could not map volume file '" + path + "'");
+    }
+
+    const BrickedVolumeHeader& header = *_file.at<BrickedVolumeHeader>(0);
+    if (std::memcmp(header.magic, BrickedVolumeMagic, sizeof(header.magic)) != 0 ||
+        header.version != BrickedVolumeVersion || header.brickSize == 0)
+    {
+        throw ghoul::RuntimeError("'" + path + "' is not a bricked volume file");
+    }
+    if (header.voxelSize != sizeof(VoxelType)) {
+        throw ghoul::RuntimeError("Voxel size in '" + path + "' does not match");
+    }
+
+    _dimensions = glm::uvec3(
+        header.dimensions[0],
+        header.dimensions[1],
+        header.dimensions[2]
+    );
+    _brickSize = header.brickSize;
+    _gridSize = brickGridSize(_dimensions, _brickSize);
+
+    const size_t tableSize = nBricks() * 2 * sizeof(uint64_t);
+    if (_file.size() < sizeof(BrickedVolumeHeader) + tableSize) {
+        throw ghoul::RuntimeError("Brick table in '" + path + "' is truncated");
+    }
+    _brickTable = _file.at<uint64_t>(sizeof(BrickedVolumeHeader));
+    _cache = LinearLruCache<std::shared_ptr<std::vector<VoxelType>>>(
+        std::max<size_t>(nCachedBricks, 1),
+        nBricks()
+    );
+}
+
+template <typename VoxelType>
+glm::uvec3 BrickedRawVolume<VoxelType>::dimensions() const {
+    return _dimensions;
+}
+
+template <typename VoxelType>
+size_t BrickedRawVolume<VoxelType>::nCells() const {
+    return static_cast<size_t>(_dimensions.x) *
+           static_cast<size_t>(_dimensions.y) *
+           static_cast<size_t>(_dimensions.z);
+}
+
+template <typename VoxelType>
+VoxelType BrickedRawVolume<VoxelType>::get(const glm::uvec3& coordinates) const {
+    const glm::uvec3 brickCoords = coordinates / glm::uvec3(_brickSize);
+    const size_t brickIndex = volume::coordsToIndex(brickCoords, _gridSize);
+    const glm::uvec3 origin = brickCoords * glm::uvec3(_brickSize);
+
+    const std::vector<VoxelType>& voxels = brick(brickIndex);
+    return voxels[volume::coordsToIndex(
+        coordinates - origin,
+        brickDimensions(brickIndex)
+    )];
+}
+
+template <typename VoxelType>
+VoxelType BrickedRawVolume<VoxelType>::get(size_t index) const {
+    return get(volume::indexToCoords(index, _dimensions));
+}
+
+template <typename VoxelType>
+unsigned int BrickedRawVolume<VoxelType>::brickSize() const {
+    return _brickSize;
+}
+
+template <typename VoxelType>
+size_t BrickedRawVolume<VoxelType>::nBricks() const {
+    return static_cast<size_t>(_gridSize.x) *
+           static_cast<size_t>(_gridSize.y) *
+           static_cast<size_t>(_gridSize.z);
+}
+
+template <typename VoxelType>
+glm::uvec3 BrickedRawVolume<VoxelType>::brickOrigin(size_t brickIndex) const {
+    return volume::brickOrigin(brickIndex, _gridSize, _brickSize);
+}
+
+template <typename VoxelType>
+glm::uvec3 BrickedRawVolume<VoxelType>::brickDimensions(size_t brickIndex) const {
+    return volume::brickDimensions(brickOrigin(brickIndex), _dimensions, _brickSize);
+}
+
+template <typename VoxelType>
+void BrickedRawVolume<VoxelType>::readBrick(size_t brickIndex, VoxelType* result) const
+{
+    const uint64_t offset = _brickTable[2 * brickIndex];
+    const uint64_t size = _brickTable[2 * brickIndex + 1];
+    const glm::uvec3 dims = brickDimensions(brickIndex);
+    const size_t nVoxels = static_cast<size_t>(dims.x) * dims.y * dims.z;
+
+    const bool isValid = offset <= _file.size() && size <= _file.size() - offset &&
+        decompressBrick(
+            _file.data() + offset,
+            static_cast<size_t>(size),
+            reinterpret_cast<std::byte*>(result),
+            nVoxels,
+            sizeof(VoxelType)
+        );
+    if (!isValid) {
+        throw ghoul::RuntimeError(
+            "Brick " + std::to_string(brickIndex) + " in '" + _file.path() +
+            "' is corrupt"
+        );
+    }
+}
+
+template <typename VoxelType>
+std::unique_ptr<RawVolume<VoxelType>> BrickedRawVolume<VoxelType>::read() const {
+    std::unique_ptr<RawVolume<VoxelType>> volume =
+        std::make_unique<RawVolume<VoxelType>>(_dimensions);
+
+    std::vector<VoxelType> voxels(static_cast<size_t>(_brickSize) * _brickSize *
+                                  _brickSize);
+    for (size_t b = 0; b < nBricks(); ++b) {
+        const glm::uvec3 origin = brickOrigin(b);
+        const glm::uvec3 dims = brickDimensions(b);
+        readBrick(b, voxels.data());
+
+        // Copy the brick one row at a time into the volume
+        for (unsigned int z = 0; z < dims.z; ++z) {
+            for (unsigned int y = 0; y < dims.y; ++y) {
+                const VoxelType* row = voxels.data() + (z * dims.y + y) * dims.x;
+                const size_t index = volume->coordsToIndex(origin + glm::uvec3(0, y, z));
+                std::copy(row, row + dims.x, volume->data() + index);
+            }
+        }
+    }
+    return volume;
+}
+
+template <typename VoxelType>
+const std::vector<VoxelType>& BrickedRawVolume<VoxelType>::brick(size_t brickIndex) const
+{
+    if (_cache.has(brickIndex)) {
+        return *_cache.use(brickIndex);
+    }
+
+    const glm::uvec3 dims = brickDimensions(brickIndex);
+    auto voxels = std::make_shared<std::vector<VoxelType>>(
+        static_cast<size_t>(dims.x) * dims.y * dims.z
+    );
+    readBrick(brickIndex, voxels->data());
+    _cache.set(brickIndex, voxels);
+    return *voxels;
+}
+
+} // namespace openspace::volume
@@ -0,0 +1,180 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <modules/volume/brickedvolumeformat.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // A control byte below this value is followed by (control + 1) literal bytes, any
+    // other control byte is followed by a single byte that is repeated
+    // (control - RunFlag + MinRunLength) times
+    constexpr const uint8_t RunFlag = 0x80;
+    constexpr const size_t MinRunLength = 3;
+    constexpr const size_t MaxRunLength = 127 + MinRunLength;
+    constexpr const size_t MaxLiteralLength = 128;
+
+    void encodeRuns(const std::vector<uint8_t>& in, std::vector<std::byte>& out) {
+        const size_t n = in.size();
+        size_t i = 0;
+        while (i < n) {
+            size_t run = 1;
+            while (i + run < n && run < MaxRunLength && in[i + run] == in[i]) {
+                run++;
+            }
+
+            if (run >= MinRunLength) {
+                out.push_back(std::byte(RunFlag + (run - MinRunLength)));
+                out.push_back(std::byte(in[i]));
+                i += run;
+                continue;
+            }
+
+            // Collect literals until the next run that is worth encoding
+            const size_t start = i;
+            while (i < n && i - start < MaxLiteralLength) {
+                if (i + 2 < n && in[i] == in[i + 1] && in[i] == in[i + 2]) {
+                    break;
+                }
+                i++;
+            }
+            out.push_back(std::byte(i - start - 1));
+            for (size_t j = start; j < i; ++j) {
+                out.push_back(std::byte(in[j]));
+            }
+        }
+    }
+
+    bool decodeRuns(const std::byte* in, size_t size, std::vector<uint8_t>& out) {
+        size_t i = 0;
+        size_t o = 0;
+        while (i < size) {
+            const uint8_t control = static_cast<uint8_t>(in[i++]);
+            if (control < RunFlag) {
+                const size_t length = control + 1;
+                if (i + length > size || o + length > out.size()) {
+                    return false;
+                }
+                std::memcpy(out.data() + o, in + i, length);
+                i += length;
+                o += length;
+            }
+            else {
+                const size_t length = control - RunFlag + MinRunLength;
+                if (i >= size || o + length > out.size()) {
+                    return false;
+                }
+                std::fill_n(out.begin() + o, length, static_cast<uint8_t>(in[i++]));
+                o += length;
+            }
+        }
+        return o == out.size();
+    }
+} // namespace
+
+namespace openspace::volume {
+
+bool isBrickedVolume(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(BrickedVolumeMagic)] = {};
+    file.read(magic, sizeof(magic));
+    return file.good() && std::memcmp(magic, BrickedVolumeMagic, sizeof(magic)) == 0;
+}
+
+glm::uvec3 brickGridSize(const glm::uvec3& dimensions, unsigned int brickSize) {
+    return (dimensions + glm::uvec3(brickSize - 1)) / glm::uvec3(brickSize);
+}
+
+glm::uvec3 brickOrigin(size_t brickIndex, const glm::uvec3& gridSize,
+                       unsigned int brickSize)
+{
+    const size_t x = brickIndex % gridSize.x;
+    const size_t y = (brickIndex / gridSize.x) % gridSize.y;
+    const size_t z = brickIndex / gridSize.x / gridSize.y;
+    return glm::uvec3(x, y, z) * glm::uvec3(brickSize);
+}
+
+glm::uvec3 brickDimensions(const glm::uvec3& origin, const glm::uvec3& dimensions,
+                           unsigned int brickSize)
+{
+    return glm::min(glm::uvec3(brickSize), dimensions - origin);
+}
+
+std::vector<std::byte> compressBrick(const std::byte* data, size_t nVoxels,
+                                     size_t voxelSize)
+{
+    const size_t size = nVoxels * voxelSize;
+
+    // Split the voxels into byte planes and delta encode each plane
+    std::vector<uint8_t> planes(size);
+    for (size_t p = 0; p < voxelSize; ++p) {
+        uint8_t previous = 0;
+        for (size_t i = 0; i < nVoxels; ++i) {
+            const uint8_t value = static_cast<uint8_t>(data[i * voxelSize + p]);
+            planes[p * nVoxels + i] = static_cast<uint8_t>(value - previous);
+            previous = value;
+        }
+    }
+
+    std::vector<std::byte> result;
+    result.reserve(size);
+    encodeRuns(planes, result);
+
+    if (result.size() >= size) {
+        // Incompressible data is stored as is, which is detected by its size
+        result.assign(data, data + size);
+    }
+    return result;
+}
+
+bool decompressBrick(const std::byte* data, size_t size, std::byte* result,
+                     size_t nVoxels, size_t voxelSize)
+{
+    const size_t rawSize = nVoxels * voxelSize;
+    if (size == rawSize) {
+        std::memcpy(result, data, rawSize);
+        return true;
+    }
+    if (size > rawSize) {
+        return false;
+    }
+
+    std::vector<uint8_t> planes(rawSize);
+    if (!decodeRuns(data, size, planes)) {
+        return false;
+    }
+
+    for (size_t p = 0; p < voxelSize; ++p) {
+        uint8_t value = 0;
+        for (size_t i = 0; i < nVoxels; ++i) {
+            value = static_cast<uint8_t>(value + planes[p * nVoxels + i]);
+            result[i * voxelSize + p] = std::byte(value);
+        }
+    }
+    return true;
+}
+
+} // namespace openspace::volume
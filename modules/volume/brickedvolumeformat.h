@@ -0,0 +1,92 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#ifndef __OPENSPACE_MODULE_VOLUME___BRICKEDVOLUMEFORMAT___H__
+#define __OPENSPACE_MODULE_VOLUME___BRICKEDVOLUMEFORMAT___H__
+
+#include <ghoul/glm.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace openspace::volume {
+
+/**
+ * The bricked raw volume format splits a volume into cubic bricks that are compressed
+ * independently of each other, so that a part of the volume can be read without reading
+ * or decompressing the whole file. A file starts with a BrickedVolumeHeader, followed by
+ * a table with two <code>uint64_t</code> per brick (the byte offset of the brick in the
+ * file and its compressed size) and the compressed bricks. The bricks are ordered with
+ * the x coordinate changing fastest and bricks at the upper boundaries are smaller if
+ * the dimensions are not a multiple of the brick size. The voxels within a brick are
+ * ordered in the same way as in a raw volume of the brick's dimensions.
+ */
+struct BrickedVolumeHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t voxelSize;
+    uint32_t dimensions[3];
+    uint32_t brickSize;
+};
+
+constexpr const char BrickedVolumeMagic[8] = "OSBRICK";
+constexpr const uint32_t BrickedVolumeVersion = 1;
+
+/// Returns <code>true</code> if the file at \p path starts with a bricked volume header
+bool isBrickedVolume(const std::string& path);
+
+/// Returns the number of bricks along each axis for a volume of \p dimensions
+glm::uvec3 brickGridSize(const glm::uvec3& dimensions, unsigned int brickSize);
+
+/// Returns the coordinates of the first voxel of the brick with index \p brickIndex
+glm::uvec3 brickOrigin(size_t brickIndex, const glm::uvec3& gridSize,
+    unsigned int brickSize);
+
+/// Returns the number of voxels along each axis of the brick starting at \p origin
+glm::uvec3 brickDimensions(const glm::uvec3& origin, const glm::uvec3& dimensions,
+    unsigned int brickSize);
+
+/**
+ * Losslessly compresses \p nVoxels voxels of \p voxelSize bytes each. The bytes of the
+ * voxels are first split into one plane per byte position and each plane is delta
+ * encoded, which turns the slowly varying exponent and high mantissa bytes of smooth
+ * fields into long runs of zeros that are then run length encoded. If the compressed
+ * data would not be smaller than the input, the input is returned unchanged.
+ */
+std::vector<std::byte> compressBrick(const std::byte* data, size_t nVoxels,
+    size_t voxelSize);
+
+/**
+ * Decompresses \p size bytes from \p data, which were created by compressBrick, into
+ * the \p nVoxels voxels of \p voxelSize bytes each in \p result.
+ *
+ * \returns <code>false</code> if the compressed data is corrupt
+ */
+bool decompressBrick(const std::byte* data, size_t size, std::byte* result,
+    size_t nVoxels, size_t voxelSize);
+
+} // namespace openspace::volume
+
+#endif // __OPENSPACE_MODULE_VOLUME___BRICKEDVOLUMEFORMAT___H__
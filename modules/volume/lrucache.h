@@ -47,6 +47,8 @@ public:
     ValueType& get(const KeyType& key);
     void evict();
     size_t capacity() const;
+    size_t size() const;
+    const KeyType& leastRecentlyUsed() const;
 
 private:
     void insert(const KeyType& key, const ValueType& value);
@@ -59,4 +61,6 @@ private:
 
 } // namespace openspace::volume
 
+#include "lrucache.inl"
+
 #endif // __OPENSPACE_MODULE_VOLUME___LRUCACHE___H__
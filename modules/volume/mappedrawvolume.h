@@ -22,34 +22,52 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#ifndef __OPENSPACE_CORE___PERFORMANCEMEASUREMENT___H__
-#define __OPENSPACE_CORE___PERFORMANCEMEASUREMENT___H__
+#ifndef __OPENSPACE_MODULE_VOLUME___MAPPEDRAWVOLUME___H__
+#define __OPENSPACE_MODULE_VOLUME___MAPPEDRAWVOLUME___H__
 
-#include <chrono>
+#include <openspace/util/memorymappedfile.h>
+#include <ghoul/glm.h>
 #include <string>
 
-namespace openspace::performance {
+namespace openspace::volume {
 
-class PerformanceManager;
-
-class PerformanceMeasurement {
+/**
+ * A read-only raw volume whose voxels are accessed directly in a memory-mapped file
+ * instead of being copied into memory. Only the pages that are sampled are loaded by
+ * the operating system, which makes it possible to sample volumes that are larger than
+ * the available memory, for example with a VolumeSampler.
+ */
+template <typename Type>
+class MappedRawVolume {
 public:
-    PerformanceMeasurement(std::string identifier);
-    ~PerformanceMeasurement();
+    using VoxelType = Type;
+
+    /**
+     * Maps the raw volume at \p path with the provided \p dimensions.
+     *
+     * \throw ghoul::RuntimeError If the file could not be mapped or is too small for the
+     *        \p dimensions
+     */
+    MappedRawVolume(const std::string& path, const glm::uvec3& dimensions);
+
+    glm::uvec3 dimensions() const;
+    size_t nCells() const;
+    VoxelType get(const glm::uvec3& coordinates) const;
+    VoxelType get(size_t index) const;
+    const VoxelType* data() const;
+    size_t coordsToIndex(const glm::uvec3& cartesian) const;
+    glm::uvec3 indexToCoords(size_t linear) const;
+
+    /// Hints that the slices with z coordinates in [\p first, \p last] are read soon
+    void prefetchSlices(unsigned int first, unsigned int last) const;
 
 private:
-    std::string _identifier;
-    std::chrono::high_resolution_clock::time_point _startTime;
+    glm::uvec3 _dimensions;
+    MemoryMappedFile _file;
 };
 
-#define __MERGE_PerfMeasure(a,b)  a##b
-#define __LABEL_PerfMeasure(a) __MERGE_PerfMeasure(unique_name_, a)
-
-/// Declare a new variable for measuring the performance of the current block
-#define PerfMeasure(name)                                                                \
-    auto __LABEL_PerfMeasure(__LINE__) =                                                 \
-        openspace::performance::PerformanceMeasurement((name))
+} // namespace openspace::volume
 
-} // namespace openspace::performance
+#include "mappedrawvolume.inl"
 
-#endif // __OPENSPACE_CORE___PERFORMANCEMEASUREMENT___H__
+#endif // __OPENSPACE_MODULE_VOLUME___MAPPEDRAWVOLUME___H__
@@ -41,6 +41,7 @@ namespace {
     constexpr const char* KeyValueUnit = "ValueUnit";
 
     constexpr const char* KeyGridType = "GridType";
+    constexpr const char* KeyHistogram = "Histogram";
 } // namespace
 
 namespace openspace::volume {
@@ -87,6 +88,17 @@ RawVolumeMetadata RawVolumeMetadata::createFromDictionary(
         metadata.time = Time::convertTime(timeString);
     }
 
+    metadata.hasHistogram = dictionary.hasValue<ghoul::Dictionary>(KeyHistogram);
+    if (metadata.hasHistogram) {
+        ghoul::Dictionary bins = dictionary.value<ghoul::Dictionary>(KeyHistogram);
+        metadata.histogram.resize(bins.size());
+        for (size_t i = 0; i < bins.size(); ++i) {
+            metadata.histogram[i] = static_cast<float>(
+                bins.value<double>(std::to_string(i + 1))
+            );
+        }
+    }
+
     return metadata;
 }
 
@@ -119,6 +131,14 @@ ghoul::Dictionary RawVolumeMetadata::dictionary() {
         }
         dict.setValue<std::string>(KeyTime, timeString);
     }
+
+    if (hasHistogram) {
+        ghoul::Dictionary bins;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            bins.setValue<double>(std::to_string(i + 1), histogram[i]);
+        }
+        dict.setValue<ghoul::Dictionary>(KeyHistogram, bins);
+    }
     return dict;
 }
 
@@ -175,6 +195,16 @@ documentation::Documentation RawVolumeMetadata::Documentation() {
                 new DoubleVerifier,
                 Optional::Yes,
                 "Specifies the maximum value stored in the volume"
+            },
+            {
+                KeyHistogram,
+                new TableVerifier({
+                    { "*", new DoubleVerifier, Optional::No, "The value of a bin" }
+                }),
+                Optional::Yes,
+                "Specifies the bins of a histogram of the values in the volume, after "
+                "they have been normalized to the range between the minimum and maximum "
+                "value"
             }
         }
     };
@@ -29,6 +29,7 @@
 #include <modules/volume/volumegridtype.h>
 
 #include <ghoul/misc/dictionary.h>
+#include <vector>
 
 namespace openspace::volume {
 
@@ -55,6 +56,11 @@ struct RawVolumeMetadata {
     glm::vec3 upperDomainBound;
     bool hasDomainUnit;
     std::string domainUnit;
+
+    // The bins of a histogram of the values, normalized to the value range. Storing it
+    // in the metadata makes it possible to show the histogram without reading the volume
+    bool hasHistogram = false;
+    std::vector<float> histogram;
 };
 
 } // namespace openspace::volume
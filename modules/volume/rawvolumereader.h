@@ -46,6 +46,11 @@ public:
     void setDimensions(const glm::uvec3& dimensions);
     //VoxelType get(const glm::ivec3& coordinates) const; // TODO: Implement this
     //VoxelType get(const size_t index) const; // TODO: Implement this
+
+    /**
+     * Reads the whole volume into memory. Both plain raw volumes and volumes that were
+     * written in the bricked format by RawVolumeWriter::writeBricked are supported.
+     */
     std::unique_ptr<RawVolume<VoxelType>> read();
 
 private:
@@ -22,6 +22,8 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <modules/volume/brickedrawvolume.h>
+#include <ghoul/misc/exception.h>
 #include <fstream>
 
 namespace openspace::volume {
@@ -81,6 +83,15 @@ glm::uvec3 RawVolumeReader<VoxelType>::indexToCoords(size_t linear) const {
 template <typename VoxelType>
 std::unique_ptr<RawVolume<VoxelType>> RawVolumeReader<VoxelType>::read() {
     glm::uvec3 dims = dimensions();
+
+    if (isBrickedVolume(_path)) {
+        BrickedRawVolume<VoxelType> bricked(_path);
+        if (bricked.dimensions() != dims) {
+            throw ghoul::RuntimeError("Volume dimensions do not match");
+        }
+        return bricked.read();
+    }
+
     std::unique_ptr<RawVolume<VoxelType>> volume = std::make_unique<RawVolume<VoxelType>>(
         dims
     );
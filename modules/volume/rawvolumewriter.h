@@ -44,6 +44,17 @@ public:
                const std::function<void(float)>& onProgress = [](float) {});
     void write(const RawVolume<VoxelType>& volume);
 
+    /**
+     * Writes the volume in the bricked and compressed format that is described in
+     * brickedvolumeformat.h, using cubic bricks with \p brickSize voxels along each
+     * side. The voxels are computed one brick at a time by calling \p fn, so the whole
+     * volume never has to be kept in memory.
+     */
+    void writeBricked(const std::function<VoxelType(const glm::uvec3&)>& fn,
+        unsigned int brickSize,
+        const std::function<void(float)>& onProgress = [](float) {});
+    void writeBricked(const RawVolume<VoxelType>& volume, unsigned int brickSize);
+
     size_t coordsToIndex(const glm::uvec3& coords) const;
     glm::ivec3 indexToCoords(size_t linear) const;
 
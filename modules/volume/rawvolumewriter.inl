@@ -22,6 +22,7 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
+#include <modules/volume/brickedvolumeformat.h>
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/volumeutils.h>
 #include <ghoul/misc/exception.h>
@@ -106,4 +107,83 @@ void RawVolumeWriter<VoxelType>::write(const RawVolume<VoxelType>& volume) {
     file.close();
 }
 
+template <typename VoxelType>
+void RawVolumeWriter<VoxelType>::writeBricked(
+                                    const std::function<VoxelType(const glm::uvec3&)>& fn,
+                                                                  unsigned int brickSize,
+                                           const std::function<void(float t)>& onProgress)
+{
+    const glm::uvec3 dims = dimensions();
+    const glm::uvec3 gridSize = brickGridSize(dims, brickSize);
+    const size_t nBricks = static_cast<size_t>(gridSize.x) *
+                           static_cast<size_t>(gridSize.y) *
+                           static_cast<size_t>(gridSize.z);
+
+    std::ofstream file(_path, std::ios::binary);
+    if (!file.good()) {
+        throw ghoul::RuntimeError("Could not create file '" + _path + "'");
+    }
+
+    BrickedVolumeHeader header;
+    std::copy(
+        std::begin(BrickedVolumeMagic),
+        std::end(BrickedVolumeMagic),
+        std::begin(header.magic)
+    );
+    header.version = BrickedVolumeVersion;
+    header.voxelSize = sizeof(VoxelType);
+    header.dimensions[0] = dims.x;
+    header.dimensions[1] = dims.y;
+    header.dimensions[2] = dims.z;
+    header.brickSize = brickSize;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(BrickedVolumeHeader));
+
+    // The brick table is written after the bricks, when the offsets are known
+    std::vector<uint64_t> brickTable(2 * nBricks, 0);
+    const size_t tableSize = brickTable.size() * sizeof(uint64_t);
+    file.write(reinterpret_cast<const char*>(brickTable.data()), tableSize);
+    uint64_t offset = sizeof(BrickedVolumeHeader) + tableSize;
+
+    std::vector<VoxelType> voxels(static_cast<size_t>(brickSize) * brickSize * brickSize);
+    for (size_t b = 0; b < nBricks; ++b) {
+        const glm::uvec3 origin = brickOrigin(b, gridSize, brickSize);
+        const glm::uvec3 brickDims = brickDimensions(origin, dims, brickSize);
+        const size_t nVoxels = static_cast<size_t>(brickDims.x) * brickDims.y *
+                               brickDims.z;
+        for (size_t i = 0; i < nVoxels; ++i) {
+            voxels[i] = fn(origin + volume::indexToCoords(i, brickDims));
+        }
+
+        const std::vector<std::byte> compressed = compressBrick(
+            reinterpret_cast<const std::byte*>(voxels.data()),
+            nVoxels,
+            sizeof(VoxelType)
+        );
+        file.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+
+        brickTable[2 * b] = offset;
+        brickTable[2 * b + 1] = compressed.size();
+        offset += compressed.size();
+        onProgress(static_cast<float>(b + 1) / nBricks);
+    }
+
+    file.seekp(sizeof(BrickedVolumeHeader));
+    file.write(reinterpret_cast<const char*>(brickTable.data()), tableSize);
+
+    if (!file.good()) {
+        throw ghoul::RuntimeError("Error writing volume file '" + _path + "'");
+    }
+}
+
+template <typename VoxelType>
+void RawVolumeWriter<VoxelType>::writeBricked(const RawVolume<VoxelType>& volume,
+                                              unsigned int brickSize)
+{
+    setDimensions(volume.dimensions());
+    writeBricked(
+        [&volume](const glm::uvec3& coords) { return volume.get(coords); },
+        brickSize
+    );
+}
+
 } // namespace openspace::volume
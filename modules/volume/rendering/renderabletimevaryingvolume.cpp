@@ -30,12 +30,15 @@
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/rawvolumereader.h>
 #include <modules/volume/volumegridtype.h>
+#include <modules/volume/volumeutils.h>
 #include <openspace/documentation/documentation.h>
 #include <openspace/documentation/verifier.h>
 #include <openspace/engine/globals.h>
 #include <openspace/rendering/raycastermanager.h>
 #include <openspace/rendering/renderengine.h>
+#include <openspace/rendering/renderqueue.h>
 #include <openspace/util/histogram.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/time.h>
 #include <openspace/util/timemanager.h>
 #include <openspace/util/updatestructures.h>
@@ -43,6 +46,8 @@
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
 #include <ghoul/opengl/texture.h>
+#include <iterator>
+#include <limits>
 
 namespace {
     constexpr const char* _loggerCat = "RenderableTimeVaryingVolume";
@@ -58,9 +63,13 @@ namespace {
     const char* KeyClipPlanes = "ClipPlanes";
     const char* KeySecondsBefore = "SecondsBefore";
     const char* KeySecondsAfter = "SecondsAfter";
+    const char* KeyMemoryBudget = "MemoryBudget";
+    const char* KeyPrefetchSteps = "PrefetchSteps";
 
     const float SecondsInOneDay = 60 * 60 * 24;
     constexpr const float VolumeMaxOpacity = 500;
+    constexpr const int HistogramBins = 100;
+    constexpr const size_t BytesPerMegabyte = 1024 * 1024;
 
     static const openspace::properties::Property::PropertyInfo StepSizeInfo = {
         "stepSize",
@@ -127,6 +136,29 @@ namespace {
         "Radius upper bound",
         "" // @TODO Missing documentation
     };
+
+    constexpr openspace::properties::Property::PropertyInfo MemoryBudgetInfo = {
+        "memoryBudget",
+        "Memory budget (MB)",
+        "The maximum amount of GPU memory in megabytes that is used by the loaded "
+        "timesteps. The least recently used timesteps are unloaded when the budget is "
+        "exceeded, but the current timestep is always kept."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo PrefetchStepsInfo = {
+        "prefetchSteps",
+        "Prefetch steps",
+        "The number of timesteps after the current timestep that are loaded in advance. "
+        "If time is running backwards, the timesteps before the current one are loaded "
+        "instead. Only the timesteps that fit in the memory budget together with the "
+        "current timestep are prefetched."
+    };
+
+    // The number of bytes used by the texture of a timestep with the \p dimensions
+    size_t textureBytes(const glm::uvec3& dimensions) {
+        return static_cast<size_t>(dimensions.x) * dimensions.y * dimensions.z *
+               sizeof(float);
+    }
 } // namespace
 
 namespace openspace::volume {
@@ -162,6 +194,18 @@ namespace openspace::volume {
                 Optional::No,
                 "Specifies the number of seconds to show the the last timestep after its "
                 "actual time"
+            },
+            {
+                KeyMemoryBudget,
+                new IntVerifier,
+                Optional::Yes,
+                MemoryBudgetInfo.description
+            },
+            {
+                KeyPrefetchSteps,
+                new IntVerifier,
+                Optional::Yes,
+                PrefetchStepsInfo.description
             }
         }
     };
@@ -181,6 +225,9 @@ RenderableTimeVaryingVolume::RenderableTimeVaryingVolume(
     , _triggerTimeJump(TriggerTimeJumpInfo)
     , _jumpToTimestep(JumpToTimestepInfo, 0, 0, 256)
     , _currentTimestep(CurrentTimeStepInfo, 0, 0, 256)
+    , _memoryBudget(MemoryBudgetInfo, 2048, 64, 65536)
+    , _nPrefetchSteps(PrefetchStepsInfo, 2, 0, 16)
+    , _textureCache(std::numeric_limits<size_t>::max())
 {
     documentation::testSpecificationAndThrow(
         Documentation(),
@@ -210,6 +257,13 @@ RenderableTimeVaryingVolume::RenderableTimeVaryingVolume(
     }
     _secondsAfter = dictionary.value<float>(KeySecondsAfter);
 
+    if (dictionary.hasKeyAndValue<double>(KeyMemoryBudget)) {
+        _memoryBudget = static_cast<int>(dictionary.value<double>(KeyMemoryBudget));
+    }
+    if (dictionary.hasKeyAndValue<double>(KeyPrefetchSteps)) {
+        _nPrefetchSteps = static_cast<int>(dictionary.value<double>(KeyPrefetchSteps));
+    }
+
     ghoul::Dictionary clipPlanesDictionary;
     dictionary.getValue(KeyClipPlanes, clipPlanesDictionary);
     _clipPlanes = std::make_shared<volume::VolumeClipPlanes>(clipPlanesDictionary);
@@ -249,44 +303,8 @@ void RenderableTimeVaryingVolume::initializeGL() {
         }
     }
 
-    // TODO: defer loading of data to later (separate thread or at least not when loading)
-    for (std::pair<const double, Timestep>& p : _volumeTimesteps) {
-        Timestep& t = p.second;
-        std::string path = FileSys.pathByAppendingComponent(
-            _sourceDirectory, t.baseName
-        ) + ".rawvolume";
-        RawVolumeReader<float> reader(path, t.metadata.dimensions);
-        t.rawVolume = reader.read();
-
-        float min = t.metadata.minValue;
-        float diff = t.metadata.maxValue - t.metadata.minValue;
-        float* data = t.rawVolume->data();
-        for (size_t i = 0; i < t.rawVolume->nCells(); ++i) {
-            data[i] = glm::clamp((data[i] - min) / diff, 0.f, 1.f);
-        }
-
-        t.histogram = std::make_shared<Histogram>(0.f, 1.f, 100);
-        for (size_t i = 0; i < t.rawVolume->nCells(); ++i) {
-            t.histogram->add(data[i]);
-        }
-
-        // TODO: handle normalization properly for different timesteps + transfer function
-
-        t.texture = std::make_shared<ghoul::opengl::Texture>(
-            t.metadata.dimensions,
-            ghoul::opengl::Texture::Format::Red,
-            GL_RED,
-            GL_FLOAT,
-            ghoul::opengl::Texture::FilterMode::Linear,
-            ghoul::opengl::Texture::WrappingMode::Clamp
-        );
-
-        t.texture->setPixelData(
-            reinterpret_cast<void*>(data),
-            ghoul::opengl::Texture::TakeOwnership::No
-        );
-        t.texture->uploadTexture();
-    }
+    // The volumes are loaded on demand in the update method
+    _loader = std::make_unique<TaskGroup>(global::taskScheduler);
 
     _clipPlanes->initialize();
 
@@ -328,6 +346,10 @@ void RenderableTimeVaryingVolume::initializeGL() {
     addProperty(_rNormalization);
     addProperty(_rUpperBound);
     addProperty(_gridType);
+    addProperty(_memoryBudget);
+    addProperty(_nPrefetchSteps);
+
+    _memoryBudget.onChange([this]() { evictTimesteps(0); });
 
     _raycaster->setGridType(static_cast<VolumeGridType>(_gridType.value()));
     _gridType.onChange([this] {
@@ -355,8 +377,9 @@ void RenderableTimeVaryingVolume::loadTimestepMetadata(const std::string& path)
     Timestep t;
     t.metadata = metadata;
     t.baseName = ghoul::filesystem::File(path).baseName();
-    t.inRam = false;
-    t.onGpu = false;
+    if (metadata.hasHistogram && !metadata.histogram.empty()) {
+        t.histogram = histogramFromBins(metadata.histogram);
+    }
 
     _volumeTimesteps[t.metadata.time] = std::move(t);
 }
@@ -430,12 +453,194 @@ void RenderableTimeVaryingVolume::jumpToTimestep(int target) {
     }
 }
 
+void RenderableTimeVaryingVolume::requestTimestep(int index, bool isCurrent) {
+    if (index < 0 || index >= static_cast<int>(_volumeTimesteps.size())) {
+        return;
+    }
+    Timestep* t = timestepFromIndex(index);
+    if (t->state != LoadState::Unloaded) {
+        return;
+    }
+    t->state = LoadState::Loading;
+
+    const std::string path = FileSys.pathByAppendingComponent(
+        _sourceDirectory, t->baseName
+    ) + ".rawvolume";
+    const glm::uvec3 dimensions = t->metadata.dimensions;
+    const float min = t->metadata.minValue;
+    const float diff = t->metadata.maxValue - t->metadata.minValue;
+    const bool needsHistogram = !t->histogram;
+
+    _loader->run(
+        [this, index, path, dimensions, min, diff, needsHistogram]() {
+            LoadedTimestep loaded;
+            loaded.index = index;
+
+            // Every exception has to be caught, as the timestep would otherwise never
+            // leave the Loading state. Without a volume, it is marked as Failed instead
+            try {
+                RawVolumeReader<float> reader(path, dimensions);
+                loaded.rawVolume = reader.read();
+
+                if (loaded.rawVolume) {
+                    // TODO: handle normalization properly for different timesteps +
+                    // transfer function
+                    float* data = loaded.rawVolume->data();
+                    const size_t nCells = loaded.rawVolume->nCells();
+                    for (size_t i = 0; i < nCells; ++i) {
+                        data[i] = glm::clamp((data[i] - min) / diff, 0.f, 1.f);
+                    }
+
+                    if (needsHistogram) {
+                        loaded.histogram = normalizedHistogram(
+                            data,
+                            nCells,
+                            0.f,
+                            1.f,
+                            HistogramBins
+                        );
+                    }
+                }
+            }
+            catch (const ghoul::RuntimeError& e) {
+                LERROR(fmt::format("Could not load timestep '{}': {}", path, e.message));
+                loaded.rawVolume = nullptr;
+            }
+            catch (const std::exception& e) {
+                LERROR(fmt::format("Could not load timestep '{}': {}", path, e.what()));
+                loaded.rawVolume = nullptr;
+            }
+            catch (...) {
+                LERROR(fmt::format("Could not load timestep '{}'", path));
+                loaded.rawVolume = nullptr;
+            }
+
+            std::lock_guard<std::mutex> lock(_loadedTimestepsMutex);
+            _loadedTimesteps.push_back(std::move(loaded));
+        },
+        isCurrent ? TaskScheduler::Priority::High : TaskScheduler::Priority::Normal
+    );
+}
+
+void RenderableTimeVaryingVolume::uploadLoadedTimesteps() {
+    std::vector<LoadedTimestep> loadedTimesteps;
+    {
+        std::lock_guard<std::mutex> lock(_loadedTimestepsMutex);
+        std::swap(loadedTimesteps, _loadedTimesteps);
+    }
+
+    RenderQueue& queue = global::renderEngine.renderQueue();
+    for (size_t i = 0; i < loadedTimesteps.size(); ++i) {
+        LoadedTimestep& loaded = loadedTimesteps[i];
+        Timestep* t = timestepFromIndex(loaded.index);
+        if (!loaded.rawVolume) {
+            t->state = LoadState::Failed;
+            continue;
+        }
+
+        // If the upload budget of this frame is exhausted, the remaining timesteps are
+        // put back and uploaded in one of the next frames
+        if (!queue.requestUpload()) {
+            std::lock_guard<std::mutex> lock(_loadedTimestepsMutex);
+            _loadedTimesteps.insert(
+                _loadedTimesteps.begin(),
+                std::make_move_iterator(loadedTimesteps.begin() + i),
+                std::make_move_iterator(loadedTimesteps.end())
+            );
+            return;
+        }
+        if (!loaded.histogram.empty()) {
+            t->histogram = histogramFromBins(loaded.histogram);
+        }
+
+        const size_t nBytes = textureBytes(t->metadata.dimensions);
+        evictTimesteps(nBytes);
+
+        t->texture = std::make_shared<ghoul::opengl::Texture>(
+            t->metadata.dimensions,
+            ghoul::opengl::Texture::Format::Red,
+            GL_RED,
+            GL_FLOAT,
+            ghoul::opengl::Texture::FilterMode::Linear,
+            ghoul::opengl::Texture::WrappingMode::Clamp
+        );
+        t->texture->setPixelData(
+            reinterpret_cast<void*>(loaded.rawVolume->data()),
+            ghoul::opengl::Texture::TakeOwnership::No
+        );
+        t->texture->uploadTexture();
+        // Only the GPU copy is kept, the raw volume is freed at the end of the loop
+        t->texture->setPixelData(nullptr, ghoul::opengl::Texture::TakeOwnership::No);
+
+        t->state = LoadState::Loaded;
+        _textureCache.set(loaded.index, nBytes);
+        _textureCacheBytes += nBytes;
+        queue.registerUpload(nBytes);
+    }
+}
+
+void RenderableTimeVaryingVolume::evictTimesteps(size_t nBytes) {
+    const size_t budget = static_cast<size_t>(_memoryBudget) * BytesPerMegabyte;
+    const int current = _currentTimestep;
+
+    while (_textureCache.size() > 0 && _textureCacheBytes + nBytes > budget) {
+        const int index = _textureCache.leastRecentlyUsed();
+        if (index == current) {
+            break;
+        }
+
+        Timestep* t = timestepFromIndex(index);
+        t->texture = nullptr;
+        t->state = LoadState::Unloaded;
+        _textureCacheBytes -= _textureCache.get(index);
+        _textureCache.evict();
+    }
+}
+
 void RenderableTimeVaryingVolume::update(const UpdateData&) {
     _transferFunction->update();
 
     if (_raycaster) {
+        // The current timestep has to be known before the uploads so that it is not
+        // evicted to make room for them
         Timestep* t = currentTimestep();
-        _currentTimestep = timestepIndex(t);
+        const int index = timestepIndex(t);
+        _currentTimestep = index;
+
+        uploadLoadedTimesteps();
+
+        if (t) {
+            requestTimestep(index, true);
+            if (t->state == LoadState::Loaded) {
+                _textureCache.use(index);
+            }
+
+            // Avoid piling up prefetches when time moves faster than the steps load
+            if (_loader->numUnfinishedTasks() <= static_cast<size_t>(_nPrefetchSteps)) {
+                const double deltaTime = global::timeManager.deltaTime();
+                const int direction = deltaTime < 0.0 ? -1 : 1;
+
+                // Only prefetch the timesteps that fit in the memory budget together
+                // with the current one. Otherwise each prefetched timestep would evict
+                // one that is needed earlier, which then has to be loaded again
+                std::vector<size_t> stepSizes = { textureBytes(t->metadata.dimensions) };
+                for (int i = 1; i <= _nPrefetchSteps; ++i) {
+                    const int next = index + i * direction;
+                    if (next < 0 || next >= static_cast<int>(_volumeTimesteps.size())) {
+                        break;
+                    }
+                    stepSizes.push_back(
+                        textureBytes(timestepFromIndex(next)->metadata.dimensions)
+                    );
+                }
+                const size_t budget =
+                    static_cast<size_t>(_memoryBudget) * BytesPerMegabyte;
+                const size_t nSteps = nItemsWithinBudget(stepSizes, budget);
+                for (size_t i = 1; i < nSteps; ++i) {
+                    requestTimestep(index + static_cast<int>(i) * direction, false);
+                }
+            }
+        }
 
         // Set scale and translation matrices:
         // The original data cube is a unit cube centered in 0
@@ -483,6 +688,18 @@ bool RenderableTimeVaryingVolume::isReady() const {
 }
 
 void RenderableTimeVaryingVolume::deinitializeGL() {
+    // Destroying the loader waits for the timesteps that are currently being read
+    _loader = nullptr;
+    _loadedTimesteps.clear();
+    for (std::pair<const double, Timestep>& p : _volumeTimesteps) {
+        p.second.texture = nullptr;
+        p.second.state = LoadState::Unloaded;
+    }
+    while (_textureCache.size() > 0) {
+        _textureCache.evict();
+    }
+    _textureCacheBytes = 0;
+
     if (_raycaster) {
         global::raycasterManager.detachRaycaster(*_raycaster.get());
         _raycaster = nullptr;
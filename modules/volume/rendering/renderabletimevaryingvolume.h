@@ -31,7 +31,8 @@
 #include <openspace/properties/stringproperty.h>
 #include <openspace/properties/triggerproperty.h>
 // #include <modules/volume/rawvolume.h>
- #include <modules/volume/rawvolumemetadata.h>
+#include <modules/volume/lrucache.h>
+#include <modules/volume/rawvolumemetadata.h>
 // #include <modules/volume/rendering/basicvolumeraycaster.h>
 // #include <modules/volume/rendering/volumeclipplanes.h>
 
@@ -41,10 +42,14 @@
 // #include <openspace/util/boxgeometry.h>
 // #include <openspace/util/histogram.h>
 // #include <openspace/rendering/transferfunction.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace openspace {
     class Histogram;
     struct RenderData;
+    class TaskGroup;
     class TransferFunction;
 } // namespace openspace
 
@@ -68,16 +73,29 @@ public:
     static documentation::Documentation Documentation();
 
 private:
+    enum class LoadState {
+        Unloaded = 0,
+        Loading,
+        Loaded,
+        Failed
+    };
+
     struct Timestep {
         std::string baseName;
-        bool inRam;
-        bool onGpu;
+        LoadState state = LoadState::Unloaded;
         RawVolumeMetadata metadata;
-        std::shared_ptr<RawVolume<float>> rawVolume;
         std::shared_ptr<ghoul::opengl::Texture> texture;
         std::shared_ptr<Histogram> histogram;
     };
 
+    // A timestep that has been read and normalized by the loader and that is waiting to
+    // be uploaded to the GPU on the main thread
+    struct LoadedTimestep {
+        int index;
+        std::unique_ptr<RawVolume<float>> rawVolume;
+        std::vector<float> histogram;
+    };
+
     Timestep* currentTimestep();
     int timestepIndex(const Timestep* t) const;
     Timestep* timestepFromIndex(int index);
@@ -85,6 +103,22 @@ private:
 
     void loadTimestepMetadata(const std::string& path);
 
+    /**
+     * Starts loading the timestep with the provided \p index on a background thread if
+     * it is not already loaded or being loaded. The current timestep is loaded before all
+     * prefetched timesteps.
+     */
+    void requestTimestep(int index, bool isCurrent);
+
+    /// Uploads the timesteps that have finished loading since the last frame
+    void uploadLoadedTimesteps();
+
+    /**
+     * Evicts the least recently used timesteps from the GPU until \p nBytes more bytes
+     * fit within the memory budget. The current timestep is never evicted.
+     */
+    void evictTimesteps(size_t nBytes);
+
     properties::OptionProperty _gridType;
     std::shared_ptr<VolumeClipPlanes> _clipPlanes;
 
@@ -99,11 +133,24 @@ private:
     properties::TriggerProperty _triggerTimeJump;
     properties::IntProperty _jumpToTimestep;
     properties::IntProperty _currentTimestep;
+    properties::IntProperty _memoryBudget;
+    properties::IntProperty _nPrefetchSteps;
 
     std::map<double, Timestep> _volumeTimesteps;
+
+    // Tracks which timesteps are on the GPU and the number of bytes each of them uses
+    LruCache<int, size_t, std::unordered_map> _textureCache;
+    size_t _textureCacheBytes = 0;
+
+    std::mutex _loadedTimestepsMutex;
+    std::vector<LoadedTimestep> _loadedTimesteps;
+
     std::unique_ptr<BasicVolumeRaycaster> _raycaster;
 
     std::shared_ptr<openspace::TransferFunction> _transferFunction;
+
+    // Declared last so that it is destroyed, and its tasks have finished, first
+    std::unique_ptr<TaskGroup> _loader;
 };
 
 } // namespace openspace::volume
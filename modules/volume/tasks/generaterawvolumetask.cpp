@@ -27,6 +27,7 @@
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/rawvolumemetadata.h>
 #include <modules/volume/rawvolumewriter.h>
+#include <modules/volume/volumeutils.h>
 
 #include <openspace/documentation/verifier.h>
 #include <openspace/util/time.h>
@@ -51,6 +52,9 @@ namespace {
     constexpr const char* KeyValueFunction = "ValueFunction";
     constexpr const char* KeyLowerDomainBound = "LowerDomainBound";
     constexpr const char* KeyUpperDomainBound = "UpperDomainBound";
+    constexpr const char* KeyBrickSize = "BrickSize";
+
+    constexpr const int HistogramBins = 100;
 } // namespace
 
 namespace openspace {
@@ -71,6 +75,10 @@ GenerateRawVolumeTask::GenerateRawVolumeTask(const ghoul::Dictionary& dictionary
     _valueFunctionLua = dictionary.value<std::string>(KeyValueFunction);
     _lowerDomainBound = dictionary.value<glm::vec3>(KeyLowerDomainBound);
     _upperDomainBound = dictionary.value<glm::vec3>(KeyUpperDomainBound);
+
+    if (dictionary.hasKeyAndValue<double>(KeyBrickSize)) {
+        _brickSize = static_cast<unsigned int>(dictionary.value<double>(KeyBrickSize));
+    }
 }
 
 std::string GenerateRawVolumeTask::description() {
@@ -152,7 +160,12 @@ void GenerateRawVolumeTask::perform(const Task::ProgressCallback& progressCallba
     }
 
     volume::RawVolumeWriter<float> writer(_rawVolumeOutputPath);
-    writer.write(rawVolume);
+    if (_brickSize > 0) {
+        writer.writeBricked(rawVolume, _brickSize);
+    }
+    else {
+        writer.write(rawVolume);
+    }
 
     progressCallback(0.9f);
 
@@ -170,6 +183,14 @@ void GenerateRawVolumeTask::perform(const Task::ProgressCallback& progressCallba
     metadata.hasValueRange = true;
     metadata.minValue = minVal;
     metadata.maxValue = maxVal;
+    metadata.hasHistogram = true;
+    metadata.histogram = normalizedHistogram(
+        rawVolume.data(),
+        rawVolume.nCells(),
+        minVal,
+        maxVal,
+        HistogramBins
+    );
 
     ghoul::Dictionary outputDictionary = metadata.dictionary();
     ghoul::DictionaryLuaFormatter formatter;
@@ -230,6 +251,15 @@ documentation::Documentation GenerateRawVolumeTask::documentation() {
                 new DoubleVector3Verifier,
                 Optional::No,
                 "A vector representing the upper bound of the domain"
+            },
+            {
+                KeyBrickSize,
+                new IntGreaterVerifier(0),
+                Optional::Yes,
+                "If this value is specified, the volume is written in bricks with this "
+                "many voxels along each side that are compressed individually. This "
+                "makes it possible to read parts of volumes that are larger than the "
+                "available memory"
             }
         }
     };
@@ -49,6 +49,7 @@ private:
     glm::uvec3 _dimensions;
     glm::vec3 _lowerDomainBound;
     glm::vec3 _upperDomainBound;
+    unsigned int _brickSize = 0;
 
     std::string _valueFunctionLua;
 };
@@ -24,6 +24,8 @@
 
 #include <modules/volume/volumeutils.h>
 
+#include <openspace/util/histogram.h>
+
 namespace openspace::volume {
 
 size_t coordsToIndex(const glm::uvec3& coords, const glm::uvec3& dims) {
@@ -43,4 +45,43 @@ glm::uvec3 indexToCoords(size_t index, const glm::uvec3& dims) {
     return glm::uvec3(x, y, z);
 }
 
+std::vector<float> normalizedHistogram(const float* data, size_t nValues, float minValue,
+                                       float maxValue, int nBins)
+{
+    std::vector<float> bins(nBins, 0.f);
+    const float diff = maxValue - minValue;
+    for (size_t i = 0; i < nValues; ++i) {
+        const float normalized = diff > 0.f ? (data[i] - minValue) / diff : 0.f;
+        const int bin = static_cast<int>(normalized * nBins);
+        bins[glm::clamp(bin, 0, nBins - 1)] += 1.f;
+    }
+    return bins;
+}
+
+std::shared_ptr<Histogram> histogramFromBins(const std::vector<float>& bins) {
+    const int nBins = static_cast<int>(bins.size());
+    auto histogram = std::make_shared<Histogram>(0.f, 1.f, nBins);
+    bool hasValues = false;
+    for (int i = 0; i < nBins; ++i) {
+        if (bins[i] > 0.f) {
+            // Adding the values to the center of each bin also counts them, which is
+            // needed to normalize the histogram
+            histogram->add((i + 0.5f) / nBins, bins[i]);
+            hasValues = true;
+        }
+    }
+    return hasValues ? histogram : nullptr;
+}
+
+size_t nItemsWithinBudget(const std::vector<size_t>& sizes, size_t budget) {
+    size_t total = 0;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (sizes[i] > budget - total) {
+            return i;
+        }
+        total += sizes[i];
+    }
+    return sizes.size();
+}
+
 } // namespace openspace::volume
@@ -26,12 +26,43 @@
 #define __OPENSPACE_MODULE_VOLUME___VOLUMEUTILS___H__
 
 #include <ghoul/glm.h>
+#include <memory>
+#include <vector>
+
+namespace openspace { class Histogram; }
 
 namespace openspace::volume {
 
 size_t coordsToIndex(const glm::uvec3& coords, const glm::uvec3& dimensions);
 glm::uvec3 indexToCoords(size_t index, const glm::uvec3& dimensions);
 
+/**
+ * Computes a histogram with \p nBins bins of the \p nValues values in \p data after they
+ * have been normalized from the range [\p minValue, \p maxValue] to [0, 1]. Values
+ * outside of the range are counted in the first or last bin.
+ */
+std::vector<float> normalizedHistogram(const float* data, size_t nValues, float minValue,
+    float maxValue, int nBins);
+
+/**
+ * Creates a histogram over the range [0, 1] from the values counted in each of the
+ * \p bins, as returned by normalizedHistogram.
+ *
+ * \param bins The number of values in each bin
+ * \returns The histogram, or \c nullptr if there are no bins or no values were counted
+ */
+std::shared_ptr<Histogram> histogramFromBins(const std::vector<float>& bins);
+
+/**
+ * Returns the number of consecutive items, starting with the first, whose sizes in
+ * \p sizes sum up to at most \p budget.
+ *
+ * \param sizes The sizes of the items in the order in which they are added
+ * \param budget The maximum total size of the items
+ * \returns The number of items that fit within the \p budget
+ */
+size_t nItemsWithinBudget(const std::vector<size_t>& sizes, size_t budget);
+
 } // namespace openspace::volume
 
 #endif // __OPENSPACE_MODULE_VOLUME___VOLUMEUTILS___H__
@@ -35,6 +35,7 @@
 #include <openspace/mission/mission.h>
 #include <openspace/mission/missionmanager.h>
 #include <openspace/network/parallelpeer.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/dashboard.h>
 #include <openspace/rendering/renderable.h>
 #include <openspace/rendering/renderengine.h>
@@ -90,6 +91,7 @@ void registerCoreClasses(scripting::ScriptEngine& engine) {
     engine.addLibrary(interaction::SessionRecording::luaLibrary());
     engine.addLibrary(interaction::ShortcutManager::luaLibrary());
     engine.addLibrary(scripting::ScriptScheduler::luaLibrary());
+    engine.addLibrary(performance::profiler::luaLibrary());
     engine.addLibrary(scripting::generalSystemCapabilities());
     engine.addLibrary(scripting::openglSystemCapabilities());
 }
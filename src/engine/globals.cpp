@@ -50,12 +50,14 @@
 #include <openspace/rendering/screenspacerenderable.h>
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/scripting/scriptscheduler.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/versionchecker.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/glm.h>
 #include <ghoul/font/fontmanager.h>
 #include <ghoul/misc/sharedmemory.h>
 #include <ghoul/opengl/texture.h>
+#include <algorithm>
 
 namespace openspace::global {
 
@@ -126,6 +128,12 @@ SyncEngine& gSyncEngine() {
     return g;
 }
 
+TaskScheduler& gTaskScheduler() {
+    // Leave one core for the render thread
+    static TaskScheduler g(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    return g;
+}
+
 TimeManager& gTimeManager() {
     static TimeManager g;
     return g;
@@ -42,8 +42,7 @@
 #include <openspace/interaction/navigationhandler.h>
 #include <openspace/interaction/orbitalnavigator.h>
 #include <openspace/network/parallelpeer.h>
-#include <openspace/performance/performancemeasurement.h>
-#include <openspace/performance/performancemanager.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/dashboard.h>
 #include <openspace/rendering/dashboarditem.h>
 #include <openspace/rendering/helper.h>
@@ -182,6 +181,7 @@ void OpenSpaceEngine::registerPathTokens() {
 void OpenSpaceEngine::initialize() {
     LTRACE("OpenSpaceEngine::initialize(begin)");
 
+    performance::profiler::setThreadName("Main");
     global::initialize();
 
     const std::string versionCheckUrl = global::configuration.versionCheckUrl;
@@ -976,12 +976,11 @@ void OpenSpaceEngine::preSynchronization() {
 
     //std::this_thread::sleep_for(std::chrono::milliseconds(10));
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "OpenSpaceEngine::preSynchronization"
-        );
-    }
+    ProfileZone("OpenSpaceEngine::preSynchronization");
+
+    // The scene is updated both here and in postSynchronizationPreDraw on the master, so
+    // the frame of the render queue has to start before either of them
+    global::renderEngine.renderQueue().beginFrame();
 
     FileSys.triggerFilesystemEvents();
 
@@ -1043,12 +1042,7 @@ void OpenSpaceEngine::preSynchronization() {
 void OpenSpaceEngine::postSynchronizationPreDraw() {
     LTRACE("OpenSpaceEngine::postSynchronizationPreDraw(begin)");
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "OpenSpaceEngine::postSynchronizationPreDraw"
-        );
-    }
+    ProfileZone("OpenSpaceEngine::postSynchronizationPreDraw");
 
     bool master = global::windowDelegate.isMaster();
     global::syncEngine.postSynchronization(SyncEngine::IsMaster(master));
@@ -1116,12 +1110,7 @@ void OpenSpaceEngine::render(const glm::mat4& sceneMatrix, const glm::mat4& view
 {
     LTRACE("OpenSpaceEngine::render(begin)");
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "OpenSpaceEngine::render"
-        );
-    }
+    ProfileZone("OpenSpaceEngine::render");
 
     const bool isGuiWindow =
         global::windowDelegate.hasGuiWindow() ?
@@ -1144,12 +1133,7 @@ void OpenSpaceEngine::render(const glm::mat4& sceneMatrix, const glm::mat4& view
 void OpenSpaceEngine::drawOverlays() {
     LTRACE("OpenSpaceEngine::drawOverlays(begin)");
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "OpenSpaceEngine::drawOverlays"
-        );
-    }
+    ProfileZone("OpenSpaceEngine::drawOverlays");
 
     const bool isGuiWindow =
         global::windowDelegate.hasGuiWindow() ?
@@ -1171,12 +1155,7 @@ void OpenSpaceEngine::drawOverlays() {
 void OpenSpaceEngine::postDraw() {
     LTRACE("OpenSpaceEngine::postDraw(begin)");
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "OpenSpaceEngine::postDraw"
-        );
-    }
+    ProfileZone("OpenSpaceEngine::postDraw");
 
     global::renderEngine.postDraw();
 
@@ -1184,6 +1163,8 @@ void OpenSpaceEngine::postDraw() {
         func();
     }
 
+    performance::profiler::collectGpuZones();
+
     if (_isFirstRenderingFirstFrame) {
         global::windowDelegate.setSynchronization(true);
         _isFirstRenderingFirstFrame = false;
@@ -36,10 +36,14 @@
 #include <openspace/scripting/scriptengine.h>
 #include <openspace/scripting/scriptscheduler.h>
 #include <openspace/util/camera.h>
+#include <openspace/util/memorymappedfile.h>
+#include <openspace/util/taskscheduler.h>
 #include <openspace/util/timemanager.h>
 #include <ghoul/filesystem/file.h>
 #include <ghoul/filesystem/filesystem.h>
 #include <ghoul/logging/logmanager.h>
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 
 namespace {
@@ -49,42 +53,59 @@ namespace {
     const std::string FileHeaderTitle = "OpenSpace_record/playback";
     constexpr const size_t FileHeaderVersionLength = 5;
     constexpr const char FileHeaderVersion[FileHeaderVersionLength] = {
-        '0', '0', '.', '8', '5'
+        '0', '1', '.', '0', '0'
     };
     constexpr const char DataFormatAsciiTag = 'A';
     constexpr const char DataFormatBinaryTag = 'B';
 
-
-    template <typename T>
-    T readFromPlayback(std::ifstream& stream) {
-        T res;
-        stream.read(reinterpret_cast<char*>(&res), sizeof(T));
-        return res;
-    }
-
-    template <>
-    bool readFromPlayback(std::ifstream& stream) {
-        unsigned char b;
-        stream.read(reinterpret_cast<char*>(&b), sizeof(unsigned char));
-        if (b == 0) {
-            return false;
+    // Binary recordings end with the keyframe index, followed by the number of index
+    // entries, the offset of the index from the start of the file, and this tag
+    constexpr const size_t IndexTagLength = 8;
+    constexpr const char IndexTag[IndexTagLength] = {
+        'O', 'S', 'R', 'I', 'N', 'D', 'E', 'X'
+    };
+    constexpr const size_t IndexTrailerSize = 2 * sizeof(uint64_t) + IndexTagLength;
+
+    // The number of keyframes that are decoded ahead of the current playback position
+    // before the next block is requested from the task scheduler
+    constexpr const size_t KeyframesAheadOfPlayback = 512;
+
+    // Reads values from a block of a memory mapped recording. Reading past the end of
+    // the block sets the error flag instead of accessing memory outside of the block
+    struct BlockReader {
+        const std::byte* data;
+        size_t size;
+        size_t offset = 0;
+        bool hasError = false;
+
+        template <typename T>
+        T read() {
+            T res = T();
+            if (sizeof(T) > size - offset) {
+                hasError = true;
+                offset = size;
+                return res;
+            }
+            std::memcpy(&res, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return res;
         }
-        else {
-            return true;
+
+        std::string readString(size_t length) {
+            if (length > size - offset) {
+                hasError = true;
+                offset = size;
+                return std::string();
+            }
+            const char* begin = reinterpret_cast<const char*>(data + offset);
+            offset += length;
+            return std::string(begin, begin + length);
         }
-    }
 
-    template <>
-    std::string readFromPlayback(std::ifstream& stream) {
-        size_t strLen;
-        // Read string length from file
-        stream.read(reinterpret_cast<char*>(&strLen), sizeof(strLen));
-        // Read back full string
-        std::vector<char> temp(strLen + 1);
-        stream.read(temp.data(), strLen);
-        temp[strLen] = '\0';
-        return temp.data();
-    }
+        bool isAtEnd() const {
+            return offset >= size;
+        }
+    };
 
     std::string readHeaderElement(std::ifstream& stream, size_t readLen_chars) {
         std::vector<char> readTemp(readLen_chars);
@@ -107,6 +128,8 @@ SessionRecording::~SessionRecording() {} // NOLINT
 void SessionRecording::deinitialize() {
     stopRecording();
     stopPlayback();
+    // Make sure no keyframe block is being decoded once the task scheduler shuts down
+    _playbackReader = nullptr;
 }
 
 void SessionRecording::setRecordDataFormat(RecordedDataMode dataMode) {
@@ -167,6 +190,7 @@ bool SessionRecording::startRecording(const std::string& filename) {
         _recordFile << DataFormatAsciiTag;
     }
     _recordFile << '\n';
+    _recordingIndex.clear();
 
     LINFO("Session recording started");
     _timestampRecordStarted = global::windowDelegate.applicationTime();
@@ -176,6 +200,9 @@ bool SessionRecording::startRecording(const std::string& filename) {
 void SessionRecording::stopRecording() {
     if (_state == SessionState::Recording) {
         _state = SessionState::Idle;
+        if (_recordingDataMode == RecordedDataMode::Binary) {
+            saveRecordingIndex();
+        }
         LINFO("Session recording stopped");
     }
     // Close the recording file
@@ -235,16 +262,6 @@ bool SessionRecording::startPlayback(const std::string& filename,
     }
     std::string throwawayNewlineChar = readHeaderElement(_playbackFile, 1);
 
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        //Close & re-open the file, starting from the beginning, and do dummy read
-        // past the header, version, and data type
-        _playbackFile.close();
-        _playbackFile.open(_playbackFilename, std::ifstream::in | std::ios::binary);
-        size_t headerSize = FileHeaderTitle.length() + FileHeaderVersionLength +
-                            sizeof(DataFormatBinaryTag) + sizeof('\n');
-        _playbackFile.read(reinterpret_cast<char*>(&_keyframeBuffer), headerSize);
-    }
-
     if (!_playbackFile.is_open() || !_playbackFile.good()) {
         LERROR(fmt::format(
             "Unable to open file {} for keyframe playback", absFilename.c_str()
@@ -253,6 +270,24 @@ bool SessionRecording::startPlayback(const std::string& filename,
         cleanUpPlayback();
         return false;
     }
+
+    if (_recordingDataMode == RecordedDataMode::Binary) {
+        // Binary recordings are mapped into memory and decoded in blocks instead of
+        // being read through the stream
+        _playbackFile.close();
+        _playbackData = std::make_unique<MemoryMappedFile>(_playbackFilename);
+        if (!_playbackData->isValid()) {
+            LERROR(fmt::format(
+                "Unable to map file {} for keyframe playback", absFilename
+            ));
+            cleanUpPlayback();
+            return false;
+        }
+        const size_t headerSize = FileHeaderTitle.length() + FileHeaderVersionLength +
+                                  sizeof(DataFormatBinaryTag) + sizeof('\n');
+        loadRecordingIndex(headerSize);
+        _playbackReader = std::make_unique<TaskGroup>(global::taskScheduler);
+    }
     //Set time reference mode
     double now = global::windowDelegate.applicationTime();
     _timestampPlaybackStarted_application = now;
@@ -271,7 +306,10 @@ bool SessionRecording::startPlayback(const std::string& filename,
     global::scriptScheduler.setTimeReferenceMode(timeMode);
 
     _setSimulationTimeWithNextCameraKeyframe = forceSimTimeAtStart;
-    if (!playbackAddEntriesToTimeline()) {
+    const bool success = (_recordingDataMode == RecordedDataMode::Binary) ?
+        loadKeyframesUntilCameraKeyframe() :
+        playbackAddEntriesToTimeline();
+    if (!success) {
         cleanUpPlayback();
         return false;
     }
@@ -351,7 +389,72 @@ void SessionRecording::stopPlayback() {
     }
 }
 
+bool SessionRecording::seekPlayback(double recordedTime) {
+    if (_state != SessionState::Playback) {
+        LERROR("Unable to seek while not in session playback mode");
+        return false;
+    }
+    if (!_playbackData) {
+        LERROR("Seeking is only supported for binary recordings");
+        return false;
+    }
+    if (_playbackTimeReferenceMode != KeyframeTimeRef::Relative_recordedStart) {
+        LERROR("Seeking is only supported for playback relative to the recording start");
+        return false;
+    }
+
+    // A block that is still being decoded belongs to the previous playback position
+    _playbackReader->wait();
+    _decodedBlock = std::nullopt;
+    _isReadingBlock = false;
+
+    _nextPlaybackBlock = indexBlockForTime(_playbackIndex, recordedTime);
+
+    const double now = global::windowDelegate.applicationTime();
+    _timestampPlaybackStarted_application = now - recordedTime;
+    _saveRenderingCurrentRecordedTime = recordedTime;
+    global::navigationHandler.keyframeNavigator().setTimeReferenceMode(
+        _playbackTimeReferenceMode,
+        _timestampPlaybackStarted_application
+    );
+
+    clearTimeline();
+    _setSimulationTimeWithNextCameraKeyframe = false;
+    if (!loadKeyframesUntilCameraKeyframe()) {
+        stopPlayback();
+        return false;
+    }
+
+    _playbackActive_camera = true;
+    _playbackActive_script = true;
+    if (UsingTimeKeyframes) {
+        _playbackActive_time = true;
+    }
+    findFirstCameraKeyframeInTimeline();
+
+    // Skip the non-camera keyframes of the block that precede the requested time
+    while (_idxTimeline_nonCamera < _timeline.size() &&
+           _timeline[_idxTimeline_nonCamera].timestamp < recordedTime)
+    {
+        _idxTimeline_nonCamera++;
+    }
+    if (_idxTimeline_nonCamera >= _timeline.size() && hasLoadedAllKeyframes()) {
+        if (_playbackActive_time) {
+            signalPlaybackFinishedForComponent(RecordedType::Time);
+        }
+        if (_playbackActive_script) {
+            signalPlaybackFinishedForComponent(RecordedType::Script);
+        }
+    }
+
+    LINFO(fmt::format("Playback moved to recorded time {:.3f}", recordedTime));
+    return true;
+}
+
 void SessionRecording::cleanUpPlayback() {
+    // The destructor waits for the block that is currently being decoded
+    _playbackReader = nullptr;
+
     global::navigationHandler.stopPlayback();
 
     Camera* camera = global::navigationHandler.camera();
@@ -367,8 +470,19 @@ void SessionRecording::cleanUpPlayback() {
     global::scriptScheduler.stopPlayback();
 
     _playbackFile.close();
+    _playbackData = nullptr;
+    _playbackIndex.clear();
+    _nextPlaybackBlock = 0;
+    _isReadingBlock = false;
+    _decodedBlock = std::nullopt;
+
+    clearTimeline();
+    _saveRenderingDuringPlayback = false;
+
+    _cleanupNeeded = false;
+}
 
-    // Clear all timelines and keyframes
+void SessionRecording::clearTimeline() {
     _timeline.clear();
     _keyframesCamera.clear();
     _keyframesTime.clear();
@@ -378,10 +492,8 @@ void SessionRecording::cleanUpPlayback() {
     _idxScript = 0;
     _idxTimeline_cameraPtrNext = 0;
     _idxTimeline_cameraPtrPrev = 0;
+    _idxTimeline_cameraFirstInTimeline = 0;
     _hasHitEndOfCameraKeyframes = false;
-    _saveRenderingDuringPlayback = false;
-
-    _cleanupNeeded = false;
 }
 
 void SessionRecording::writeToFileBuffer(double src) {
@@ -457,13 +569,19 @@ void SessionRecording::saveCameraKeyframe() {
 
     if (_recordingDataMode == RecordedDataMode::Binary) {
         // Writing to a binary session recording file
+        const double timeSim = global::timeManager.time().j2000Seconds();
+        addEntryToRecordingIndex(
+            kf._timestamp,
+            kf._timestamp - _timestampRecordStarted,
+            timeSim
+        );
         _bufferIndex = 0;
         _keyframeBuffer[_bufferIndex++] = 'c';
 
         // Writing to internal buffer, and then to file, for performance reasons
         writeToFileBuffer(kf._timestamp);
         writeToFileBuffer(kf._timestamp - _timestampRecordStarted);
-        writeToFileBuffer(global::timeManager.time().j2000Seconds());
+        writeToFileBuffer(timeSim);
         std::vector<char> kfBuffer;
         kf.serialize(kfBuffer);
         writeToFileBuffer(kfBuffer);
@@ -512,6 +630,11 @@ void SessionRecording::saveTimeKeyframe() {
     datamessagestructures::TimeKeyframe kf = _externInteract.generateTimeKeyframe();
 
     if (_recordingDataMode == RecordedDataMode::Binary) {
+        addEntryToRecordingIndex(
+            kf._timestamp,
+            kf._timestamp - _timestampRecordStarted,
+            kf._time
+        );
         _bufferIndex = 0;
         _keyframeBuffer[_bufferIndex++] = 't';
         writeToFileBuffer(kf._timestamp);
@@ -557,11 +680,17 @@ void SessionRecording::saveScriptKeyframe(std::string scriptToSave) {
         = _externInteract.generateScriptMessage(scriptToSave);
 
     if (_recordingDataMode == RecordedDataMode::Binary) {
+        const double timeSim = global::timeManager.time().j2000Seconds();
+        addEntryToRecordingIndex(
+            sm._timestamp,
+            sm._timestamp - _timestampRecordStarted,
+            timeSim
+        );
         _bufferIndex = 0;
         _keyframeBuffer[_bufferIndex++] = 's';
         writeToFileBuffer(sm._timestamp);
         writeToFileBuffer(sm._timestamp - _timestampRecordStarted);
-        writeToFileBuffer(global::timeManager.time().j2000Seconds());
+        writeToFileBuffer(timeSim);
         //Write header to file
         saveKeyframeToFileBinary(_keyframeBuffer, _bufferIndex);
 
@@ -594,6 +723,7 @@ void SessionRecording::preSynchronization() {
         }
     }
     else if (_state == SessionState::Playback) {
+        streamKeyframeBlocks();
         moveAheadInTime();
     }
     else if (_cleanupNeeded) {
@@ -630,81 +760,372 @@ SessionRecording::SessionState SessionRecording::state() const {
 bool SessionRecording::playbackAddEntriesToTimeline() {
     bool parsingErrorsFound = false;
 
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        unsigned char frameType;
-        bool fileReadOk = true;
-
-        while (fileReadOk) {
-            frameType = readFromPlayback<unsigned char>(_playbackFile);
-            // Check if have reached EOF
-            if (!_playbackFile) {
-                LINFO(fmt::format(
-                    "Finished parsing {} entries from playback file {}",
-                    _playbackLineNum - 1, _playbackFilename
-                ));
-                fileReadOk = false;
-                break;
-            }
-            if (frameType == 'c') {
-                playbackCamera();
-            }
-            else if (frameType == 't') {
-                playbackTimeChange();
+    while (std::getline(_playbackFile, _playbackLineParsing)) {
+        _playbackLineNum++;
+
+        std::istringstream iss(_playbackLineParsing);
+        std::string entryType;
+        if (!(iss >> entryType)) {
+            LERROR(fmt::format(
+                "Error reading entry type @ line {} of playback file {}",
+                _playbackLineNum, _playbackFilename
+            ));
+            break;
+        }
+
+        if (entryType == "camera") {
+            playbackCamera();
+        }
+        else if (entryType == "time") {
+            playbackTimeChange();
+        }
+        else if (entryType == "script") {
+            playbackScript();
+        }
+        else {
+            LERROR(fmt::format(
+                "Unknown frame type {} @ line {} of playback file {}",
+                entryType, _playbackLineNum, _playbackFilename
+            ));
+            parsingErrorsFound = true;
+            break;
+        }
+    }
+    LINFO(fmt::format(
+        "Finished parsing {} entries from playback file {}",
+        _playbackLineNum, _playbackFilename
+    ));
+
+    return !parsingErrorsFound;
+}
+
+void SessionRecording::loadRecordingIndex(size_t headerSize) {
+    _playbackIndex = readRecordingIndex(
+        _playbackData->data(),
+        _playbackData->size(),
+        headerSize
+    );
+    LINFO(fmt::format(
+        "Found {} keyframe blocks in playback file {}",
+        _playbackIndex.size(), _playbackFilename
+    ));
+}
+
+std::vector<SessionRecording::RecordingIndexEntry> SessionRecording::readRecordingIndex(
+                                                                    const std::byte* data,
+                                                                    size_t size,
+                                                                    size_t headerSize)
+{
+    if (size >= headerSize + IndexTrailerSize &&
+        std::memcmp(data + size - IndexTagLength, IndexTag, IndexTagLength) == 0)
+    {
+        uint64_t nBlocks;
+        uint64_t indexOffset;
+        const std::byte* trailer = data + size - IndexTrailerSize;
+        std::memcpy(&nBlocks, trailer, sizeof(uint64_t));
+        std::memcpy(&indexOffset, trailer + sizeof(uint64_t), sizeof(uint64_t));
+
+        // The number of blocks is bounded first, as the size of the index could
+        // otherwise overflow for a corrupt trailer and pass the comparison below
+        const uint64_t maxBlocks =
+            (size - IndexTrailerSize) / sizeof(RecordingIndexEntry);
+        const bool isIndexValid = nBlocks <= maxBlocks &&
+            indexOffset >= headerSize &&
+            indexOffset <= size - IndexTrailerSize &&
+            size - IndexTrailerSize - indexOffset ==
+                nBlocks * sizeof(RecordingIndexEntry);
+        if (isIndexValid) {
+            std::vector<RecordingIndexEntry> index(nBlocks);
+            std::memcpy(
+                index.data(),
+                data + indexOffset,
+                nBlocks * sizeof(RecordingIndexEntry)
+            );
+            const bool areBlocksValid = std::all_of(
+                index.begin(),
+                index.end(),
+                [headerSize, indexOffset](const RecordingIndexEntry& e) {
+                    return e.offset >= headerSize && e.offset <= indexOffset &&
+                           e.size <= indexOffset - e.offset;
+                }
+            );
+            if (areBlocksValid) {
+                return index;
             }
-            else if (frameType == 's') {
-                playbackScript();
+        }
+        LWARNING("Ignoring the corrupt keyframe index of playback file");
+    }
+
+    // Recordings from earlier versions and recordings that were not stopped properly
+    // do not have an index, so all of their keyframes are decoded as a single block
+    RecordingIndexEntry entry;
+    entry.offset = headerSize;
+    entry.size = size - std::min(size, headerSize);
+    entry.nEntries = 0;
+    entry.timeOs = 0.0;
+    entry.timeRec = 0.0;
+    entry.timeSim = 0.0;
+    return { entry };
+}
+
+size_t SessionRecording::indexBlockForTime(const std::vector<RecordingIndexEntry>& index,
+                                           double recordedTime)
+{
+    // Continue from the last block that starts before the requested time
+    const auto it = std::upper_bound(
+        index.begin(),
+        index.end(),
+        recordedTime,
+        [](double time, const RecordingIndexEntry& e) { return time < e.timeRec; }
+    );
+    return (it == index.begin()) ?
+        0 :
+        static_cast<size_t>(std::distance(index.begin(), it) - 1);
+}
+
+SessionRecording::KeyframeBlock SessionRecording::decodeKeyframeBlock(
+                                                                    const std::byte* data,
+                                                                    size_t size,
+                                                                    size_t fileOffset)
+{
+    KeyframeBlock block;
+    BlockReader reader = { data, size };
+
+    while (!reader.isAtEnd()) {
+        const size_t entryOffset = fileOffset + reader.offset;
+        const unsigned char frameType = reader.read<unsigned char>();
+
+        KeyframeBlock::Entry entry;
+        entry.timeOs = reader.read<double>();
+        entry.timeRec = reader.read<double>();
+        entry.timeSim = reader.read<double>();
+
+        if (frameType == 'c') {
+            interaction::KeyframeNavigator::CameraPose pose;
+            pose.position = reader.read<glm::dvec3>();
+            pose.rotation = glm::quat(reader.read<glm::dquat>());
+            pose.followFocusNodeRotation = (reader.read<unsigned char>() == 1);
+            const int nodeNameLength = reader.read<int>();
+            if (nodeNameLength < 0) {
+                reader.hasError = true;
             }
             else {
-                LERROR(fmt::format(
-                    "Unknown frame type {} @ index {} of playback file {}",
-                    frameType, _playbackLineNum - 1, _playbackFilename
-                ));
-                parsingErrorsFound = true;
-                break;
+                pose.focusNode = reader.readString(static_cast<size_t>(nodeNameLength));
             }
+            pose.scale = reader.read<float>();
+            // The recorded application time is stored again as the keyframe timestamp
+            entry.timeOs = reader.read<double>();
+
+            entry.type = RecordedType::Camera;
+            entry.idxIntoKeyframeTypeArray =
+                static_cast<unsigned int>(block.keyframesCamera.size());
+            block.keyframesCamera.push_back(std::move(pose));
+        }
+        else if (frameType == 't') {
+            datamessagestructures::TimeKeyframe keyframe;
+            keyframe._dt = reader.read<double>();
+            keyframe._paused = (reader.read<unsigned char>() != 0);
+            keyframe._requiresTimeJump = (reader.read<unsigned char>() != 0);
+
+            entry.type = RecordedType::Time;
+            entry.idxIntoKeyframeTypeArray =
+                static_cast<unsigned int>(block.keyframesTime.size());
+            block.keyframesTime.push_back(std::move(keyframe));
+        }
+        else if (frameType == 's') {
+            const size_t scriptLength = reader.read<size_t>();
+            std::string script = reader.readString(scriptLength);
+
+            entry.type = RecordedType::Script;
+            entry.idxIntoKeyframeTypeArray =
+                static_cast<unsigned int>(block.keyframesScript.size());
+            block.keyframesScript.push_back(std::move(script));
+        }
+        else {
+            LERROR(fmt::format(
+                "Unknown frame type {} at byte {} of playback file",
+                frameType, entryOffset
+            ));
+            block.hasErrors = true;
+            break;
+        }
 
-            _playbackLineNum++;
+        if (reader.hasError) {
+            // Recordings that were not stopped properly can end with a partial keyframe
+            LERROR(fmt::format(
+                "Error reading keyframe at byte {} of playback file", entryOffset
+            ));
+            break;
         }
+        block.entries.push_back(entry);
     }
-    else {
-        while (std::getline(_playbackFile, _playbackLineParsing)) {
-            _playbackLineNum++;
-
-            std::istringstream iss(_playbackLineParsing);
-            std::string entryType;
-            if (!(iss >> entryType)) {
-                LERROR(fmt::format(
-                    "Error reading entry type @ line {} of playback file {}",
-                    _playbackLineNum, _playbackFilename
-                ));
+    return block;
+}
+
+bool SessionRecording::loadKeyframesUntilCameraKeyframe() {
+    // The camera needs at least one keyframe before the playback can start, so the
+    // first blocks are decoded on the calling thread
+    while (_keyframesCamera.empty() && _nextPlaybackBlock < _playbackIndex.size()) {
+        const RecordingIndexEntry& entry = _playbackIndex[_nextPlaybackBlock];
+        KeyframeBlock block = decodeKeyframeBlock(
+            _playbackData->data() + entry.offset,
+            static_cast<size_t>(entry.size),
+            static_cast<size_t>(entry.offset)
+        );
+        _nextPlaybackBlock++;
+        if (block.hasErrors) {
+            return false;
+        }
+        addKeyframeBlock(std::move(block));
+    }
+    return true;
+}
+
+void SessionRecording::addKeyframeBlock(KeyframeBlock block) {
+    for (const KeyframeBlock::Entry& e : block.entries) {
+        const unsigned int idx = e.idxIntoKeyframeTypeArray;
+        switch (e.type) {
+            case RecordedType::Camera:
+                addPlaybackKeyframe(
+                    e.timeOs,
+                    e.timeRec,
+                    e.timeSim,
+                    std::move(block.keyframesCamera[idx])
+                );
                 break;
-            }
+            case RecordedType::Time:
+                addPlaybackKeyframe(
+                    e.timeOs,
+                    e.timeRec,
+                    e.timeSim,
+                    std::move(block.keyframesTime[idx])
+                );
+                break;
+            case RecordedType::Script:
+                addPlaybackKeyframe(
+                    e.timeOs,
+                    e.timeRec,
+                    e.timeSim,
+                    std::move(block.keyframesScript[idx])
+                );
+                break;
+            default:
+                break;
+        }
+    }
+}
 
-            if (entryType == "camera") {
-                playbackCamera();
-            }
-            else if (entryType == "time") {
-                playbackTimeChange();
-            }
-            else if (entryType == "script") {
-                playbackScript();
-            }
-            else {
-                LERROR(fmt::format(
-                    "Unknown frame type {} @ line {} of playback file {}",
-                    entryType, _playbackLineNum, _playbackFilename
-                ));
-                parsingErrorsFound = true;
+void SessionRecording::streamKeyframeBlocks() {
+    if (!_playbackData) {
+        return;
+    }
+
+    std::optional<KeyframeBlock> block;
+    {
+        std::lock_guard<std::mutex> lock(_decodedBlockMutex);
+        if (_decodedBlock.has_value()) {
+            block = std::move(_decodedBlock);
+            _decodedBlock = std::nullopt;
+            _isReadingBlock = false;
+        }
+    }
+    if (block.has_value()) {
+        if (block->hasErrors) {
+            // The keyframes up to the corrupt entry are still played back
+            _nextPlaybackBlock = _playbackIndex.size();
+        }
+        addKeyframeBlock(std::move(*block));
+    }
+
+    discardPlayedKeyframes();
+
+    const size_t nKeyframesAhead = _timeline.size() - _idxTimeline_cameraPtrNext;
+    const bool needsMoreKeyframes = nKeyframesAhead < KeyframesAheadOfPlayback;
+    if (!_isReadingBlock && needsMoreKeyframes &&
+        _nextPlaybackBlock < _playbackIndex.size())
+    {
+        const RecordingIndexEntry& entry = _playbackIndex[_nextPlaybackBlock];
+        const std::byte* data = _playbackData->data() + entry.offset;
+        const size_t size = static_cast<size_t>(entry.size);
+        const size_t offset = static_cast<size_t>(entry.offset);
+        _nextPlaybackBlock++;
+        _isReadingBlock = true;
+
+        _playbackReader->run([this, data, size, offset]() {
+            KeyframeBlock b = decodeKeyframeBlock(data, size, offset);
+            std::lock_guard<std::mutex> lock(_decodedBlockMutex);
+            _decodedBlock = std::move(b);
+        });
+    }
+}
+
+void SessionRecording::discardPlayedKeyframes() {
+    // Keyframes that lie before the camera interpolation interval and before the next
+    // non-camera keyframe are never accessed again. They are removed in batches to keep
+    // the memory usage bounded for long recordings
+    unsigned int nPlayed = _idxTimeline_cameraPtrPrev;
+    if (_playbackActive_time || _playbackActive_script) {
+        nPlayed = std::min(nPlayed, _idxTimeline_nonCamera);
+    }
+    if (nPlayed < KeyframesPerIndexBlock) {
+        return;
+    }
+
+    unsigned int nCamera = 0;
+    unsigned int nTime = 0;
+    unsigned int nScript = 0;
+    for (unsigned int i = 0; i < nPlayed; ++i) {
+        switch (_timeline[i].keyframeType) {
+            case RecordedType::Camera:
+                nCamera++;
+                break;
+            case RecordedType::Time:
+                nTime++;
+                break;
+            case RecordedType::Script:
+                nScript++;
+                break;
+            default:
                 break;
-            }
         }
-        LINFO(fmt::format(
-            "Finished parsing {} entries from playback file {}",
-            _playbackLineNum, _playbackFilename
-        ));
     }
 
-    return !parsingErrorsFound;
+    // Keyframes of each type are appended in timeline order, so the played entries of
+    // the timeline refer to the first keyframes of each type
+    _timeline.erase(_timeline.begin(), _timeline.begin() + nPlayed);
+    _keyframesCamera.erase(_keyframesCamera.begin(), _keyframesCamera.begin() + nCamera);
+    _keyframesTime.erase(_keyframesTime.begin(), _keyframesTime.begin() + nTime);
+    _keyframesScript.erase(_keyframesScript.begin(), _keyframesScript.begin() + nScript);
+    for (timelineEntry& e : _timeline) {
+        switch (e.keyframeType) {
+            case RecordedType::Camera:
+                e.idxIntoKeyframeTypeArray -= nCamera;
+                break;
+            case RecordedType::Time:
+                e.idxIntoKeyframeTypeArray -= nTime;
+                break;
+            case RecordedType::Script:
+                e.idxIntoKeyframeTypeArray -= nScript;
+                break;
+            default:
+                break;
+        }
+    }
+
+    _idxTimeline_nonCamera -= std::min(_idxTimeline_nonCamera, nPlayed);
+    _idxTimeline_cameraPtrPrev -= nPlayed;
+    _idxTimeline_cameraPtrNext -= std::min(_idxTimeline_cameraPtrNext, nPlayed);
+    _idxTimeline_cameraFirstInTimeline -= std::min(
+        _idxTimeline_cameraFirstInTimeline,
+        nPlayed
+    );
+}
+
+bool SessionRecording::hasLoadedAllKeyframes() const {
+    if (!_playbackData) {
+        return true;
+    }
+    return _nextPlaybackBlock >= _playbackIndex.size() && !_isReadingBlock;
 }
 
 double SessionRecording::appropriateTimestamp(double timeOs, double timeRec,
@@ -785,77 +1206,30 @@ void SessionRecording::playbackCamera() {
     double timeSim;
     std::string rotationFollowing;
     interaction::KeyframeNavigator::CameraPose pbFrame;
-    datamessagestructures::CameraKeyframe kf;
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        try {
-            kf.read(&_playbackFile);
-        }
-        catch (std::bad_alloc&) {
-            LERROR(fmt::format(
-                "Allocation error with camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-        catch (std::length_error&) {
-            LERROR(fmt::format(
-                "length_error with camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-
-        timeOs = kf._timestamp;
-
-        pbFrame.focusNode = kf._focusNode;
-        pbFrame.position = kf._position;
-        pbFrame.rotation = kf._rotation;
-        pbFrame.scale = kf._scale;
-        pbFrame.followFocusNodeRotation = kf._followNodeRotation;
 
-        if (!_playbackFile) {
-            LINFO(fmt::format(
-                "Error reading camera playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-    }
-    else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> pbFrame.position.x
-            >> pbFrame.position.y
-            >> pbFrame.position.z
-            >> pbFrame.rotation.x
-            >> pbFrame.rotation.y
-            >> pbFrame.rotation.z
-            >> pbFrame.rotation.w
-            >> pbFrame.scale
-            >> rotationFollowing
-            >> pbFrame.focusNode;
-        if (iss.fail() || !iss.eof()) {
-            LERROR(fmt::format(
-                "Error parsing camera line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        pbFrame.followFocusNodeRotation = (rotationFollowing == "F");
-    }
-    if (_setSimulationTimeWithNextCameraKeyframe) {
-        global::timeManager.setTimeNextFrame(Time(timeSim));
-        _setSimulationTimeWithNextCameraKeyframe = false;
-        _saveRenderingCurrentRecordedTime = timeRec;
+    std::istringstream iss(_playbackLineParsing);
+    std::string entryType;
+    iss >> entryType;
+    iss >> timeOs >> timeRec >> timeSim;
+    iss >> pbFrame.position.x
+        >> pbFrame.position.y
+        >> pbFrame.position.z
+        >> pbFrame.rotation.x
+        >> pbFrame.rotation.y
+        >> pbFrame.rotation.z
+        >> pbFrame.rotation.w
+        >> pbFrame.scale
+        >> rotationFollowing
+        >> pbFrame.focusNode;
+    if (iss.fail() || !iss.eof()) {
+        LERROR(fmt::format(
+            "Error parsing camera line {} of playback file", _playbackLineNum
+        ));
+        return;
     }
-    double timeRef = appropriateTimestamp(timeOs, timeRec, timeSim);
+    pbFrame.followFocusNodeRotation = (rotationFollowing == "F");
 
-    //global::navigationHandler.keyframeNavigator().addKeyframe(timeRef, pbFrame);
-    addKeyframe(timeRef, pbFrame);
+    addPlaybackKeyframe(timeOs, timeRec, timeSim, std::move(pbFrame));
 }
 
 void SessionRecording::playbackTimeChange() {
@@ -863,45 +1237,25 @@ void SessionRecording::playbackTimeChange() {
     double timeRec;
     double timeSim;
     datamessagestructures::TimeKeyframe pbFrame;
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        pbFrame._dt = readFromPlayback<double>(_playbackFile);
-        pbFrame._paused = readFromPlayback<bool>(_playbackFile);
-        pbFrame._requiresTimeJump = readFromPlayback<bool>(_playbackFile);
-
-        if (!_playbackFile) {
-            LERROR(fmt::format(
-                "Error reading time playback from keyframe entry {}", _playbackLineNum - 1
-            ));
-            return;
-        }
-    } else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        //double timeRef;
-        std::string paused, jump;
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> pbFrame._dt
-            >> paused
-            >> jump;
-        if (iss.fail() || !iss.eof()) {
-            LERROR(fmt::format(
-                "Error parsing time line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        pbFrame._paused = (paused == "P");
-        pbFrame._requiresTimeJump = (jump == "J");
+
+    std::istringstream iss(_playbackLineParsing);
+    std::string entryType;
+    std::string paused, jump;
+    iss >> entryType;
+    iss >> timeOs >> timeRec >> timeSim;
+    iss >> pbFrame._dt
+        >> paused
+        >> jump;
+    if (iss.fail() || !iss.eof()) {
+        LERROR(fmt::format(
+            "Error parsing time line {} of playback file", _playbackLineNum
+        ));
+        return;
     }
-    pbFrame._timestamp = equivalentApplicationTime(timeOs, timeRec, timeSim);
+    pbFrame._paused = (paused == "P");
+    pbFrame._requiresTimeJump = (jump == "J");
 
-    pbFrame._time = pbFrame._timestamp + _timestampApplicationStarted_simulation;
-    //global::timeManager.addKeyframe(timeRef, pbFrame._timestamp);
-    //_externInteract.timeInteraction(pbFrame);
-    addKeyframe(pbFrame._timestamp, pbFrame);
+    addPlaybackKeyframe(timeOs, timeRec, timeSim, std::move(pbFrame));
 }
 
 void SessionRecording::playbackScript() {
@@ -911,80 +1265,66 @@ void SessionRecording::playbackScript() {
     unsigned int numScriptLines;
     datamessagestructures::ScriptMessage pbFrame;
 
-    if (_recordingDataMode == RecordedDataMode::Binary) {
-        timeOs = readFromPlayback<double>(_playbackFile);
-        timeRec = readFromPlayback<double>(_playbackFile);
-        timeSim = readFromPlayback<double>(_playbackFile);
-        try {
-            pbFrame._script = readFromPlayback<std::string>(_playbackFile);
-        }
-        catch (std::bad_alloc&) {
-            LERROR(fmt::format(
-                "Allocation error with script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-        catch (std::length_error&) {
-            LERROR(fmt::format(
-                "length_error with script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
+    std::istringstream iss(_playbackLineParsing);
+    std::string entryType;
+    std::string tmpReadbackScript;
 
-        if (!_playbackFile) {
-            LERROR(fmt::format(
-                "Error reading script playback from keyframe entry {}",
-                _playbackLineNum - 1
-            ));
-            return;
-        }
-    } else {
-        std::istringstream iss(_playbackLineParsing);
-        std::string entryType;
-        std::string tmpReadbackScript;
-
-        iss >> entryType;
-        iss >> timeOs >> timeRec >> timeSim;
-        iss >> numScriptLines;
-        std::getline(iss, tmpReadbackScript); //iss >> tmpReadbackScript;
-        pbFrame._script.append(tmpReadbackScript);
-        if (iss.fail()) {
-            LERROR(fmt::format(
-                "Error parsing script line {} of playback file", _playbackLineNum
-            ));
-            return;
-        } else if (!iss.eof()) {
-            LERROR(fmt::format(
-                "Did not find an EOL at line {} of playback file", _playbackLineNum
-            ));
-            return;
-        }
-        if (numScriptLines > 1) {
-            //Now loop to read any subsequent lines if is a multi-line script
-            for (unsigned int i = 1; i < numScriptLines; ++i) {
-                pbFrame._script.append("\n");
-                std::getline(_playbackFile, tmpReadbackScript);
-                pbFrame._script.append(tmpReadbackScript);
-            }
+    iss >> entryType;
+    iss >> timeOs >> timeRec >> timeSim;
+    iss >> numScriptLines;
+    std::getline(iss, tmpReadbackScript); //iss >> tmpReadbackScript;
+    pbFrame._script.append(tmpReadbackScript);
+    if (iss.fail()) {
+        LERROR(fmt::format(
+            "Error parsing script line {} of playback file", _playbackLineNum
+        ));
+        return;
+    } else if (!iss.eof()) {
+        LERROR(fmt::format(
+            "Did not find an EOL at line {} of playback file", _playbackLineNum
+        ));
+        return;
+    }
+    if (numScriptLines > 1) {
+        //Now loop to read any subsequent lines if is a multi-line script
+        for (unsigned int i = 1; i < numScriptLines; ++i) {
+            pbFrame._script.append("\n");
+            std::getline(_playbackFile, tmpReadbackScript);
+            pbFrame._script.append(tmpReadbackScript);
         }
     }
+
+    addPlaybackKeyframe(timeOs, timeRec, timeSim, std::move(pbFrame._script));
+}
+
+void SessionRecording::addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+                                     interaction::KeyframeNavigator::CameraPose keyframe)
+{
+    if (_setSimulationTimeWithNextCameraKeyframe) {
+        global::timeManager.setTimeNextFrame(Time(timeSim));
+        _setSimulationTimeWithNextCameraKeyframe = false;
+        _saveRenderingCurrentRecordedTime = timeRec;
+    }
+    double timeRef = appropriateTimestamp(timeOs, timeRec, timeSim);
+
+    addKeyframe(timeRef, std::move(keyframe));
+}
+
+void SessionRecording::addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+                                           datamessagestructures::TimeKeyframe keyframe)
+{
+    keyframe._timestamp = equivalentApplicationTime(timeOs, timeRec, timeSim);
+    keyframe._time = keyframe._timestamp + _timestampApplicationStarted_simulation;
+
+    addKeyframe(keyframe._timestamp, std::move(keyframe));
+}
+
+void SessionRecording::addPlaybackKeyframe(double timeOs, double timeRec, double timeSim,
+                                           std::string scriptToQueue)
+{
     double timeRef = appropriateTimestamp(timeOs, timeRec, timeSim);
-    //timeRef = getEquivalentSimulationTime(timeOs, timeRec, timeSim);
-
-    //Call script scheduler with this new script entry
-    //std::string timeDescription = SpiceManager::ref().dateFromEphemerisTime(
-    //  timeRef,
-    //  "YYYY MON DD HR:MN:SC.###"
-    //);
-    //ghoul::Dictionary scriptDict(ghoul::Dictionary{
-    //  { KeyTime, timeDescription },
-    //  { KeyForwardScript, pbFrame._script}
-    //}
-    //                            );
-    //global::scriptScheduler.loadScripts({ { "1", scriptDict } });
-    addKeyframe(timeRef, pbFrame._script);
+
+    addKeyframe(timeRef, std::move(scriptToQueue));
 }
 
 void SessionRecording::addKeyframe(double timestamp,
@@ -1045,6 +1385,10 @@ void SessionRecording::lookForNonCameraKeyframesThatHaveComeDue(double currTime)
         }
 
         if (++_idxTimeline_nonCamera >= _timeline.size()) {
+            if (!hasLoadedAllKeyframes()) {
+                // Wait past the end of the timeline until the next block is decoded
+                break;
+            }
             _idxTimeline_nonCamera--;
             if (_playbackActive_time) {
                 signalPlaybackFinishedForComponent(RecordedType::Time);
@@ -1079,7 +1423,9 @@ void SessionRecording::updateCameraWithOrWithoutNewKeyframes(double currTime) {
 
 bool SessionRecording::isTimeToHandleNextNonCameraKeyframe(double currTime) {
     bool isNonCameraPlaybackActive = (_playbackActive_time || _playbackActive_script);
-    return (currTime > getNextTimestamp()) && isNonCameraPlaybackActive;
+    bool isNextKeyframeLoaded = (_idxTimeline_nonCamera < _timeline.size());
+    return (currTime > getNextTimestamp()) && isNonCameraPlaybackActive &&
+           isNextKeyframeLoaded;
 }
 
 bool SessionRecording::findNextFutureCameraIndex(double currTime) {
@@ -1095,7 +1441,9 @@ bool SessionRecording::findNextFutureCameraIndex(double currTime) {
                 _timeline[seekAheadIndex].idxIntoKeyframeTypeArray;
             double seekAheadKeyframeTimestamp = _timeline[seekAheadIndex].timestamp;
 
-            if (indexIntoCameraKeyframes >= (_keyframesCamera.size() - 1)) {
+            if (indexIntoCameraKeyframes >= (_keyframesCamera.size() - 1) &&
+                hasLoadedAllKeyframes())
+            {
                 _hasHitEndOfCameraKeyframes = true;
             }
 
@@ -1241,7 +1589,12 @@ bool SessionRecording::processScriptKeyframe() {
         std::string nextScript = nextKeyframeObj(
             _idxScript,
             _keyframesScript,
-            ([this]() { signalPlaybackFinishedForComponent(RecordedType::Script); })
+            [this]() {
+                // More scripts might follow in blocks that have not been decoded yet
+                if (hasLoadedAllKeyframes()) {
+                    signalPlaybackFinishedForComponent(RecordedType::Script);
+                }
+            }
         );
         global::scriptEngine.queueScript(
             nextScript,
@@ -1312,6 +1665,48 @@ void SessionRecording::saveKeyframeToFileBinary(unsigned char* buffer, size_t si
     _recordFile.write(reinterpret_cast<char*>(buffer), size);
 }
 
+void SessionRecording::addEntryToRecordingIndex(double timeOs, double timeRec,
+                                                double timeSim)
+{
+    const bool isBlockFull = !_recordingIndex.empty() &&
+        _recordingIndex.back().nEntries >= KeyframesPerIndexBlock;
+    if (_recordingIndex.empty() || isBlockFull) {
+        RecordingIndexEntry entry;
+        entry.offset = static_cast<uint64_t>(_recordFile.tellp());
+        entry.size = 0;
+        entry.nEntries = 0;
+        entry.timeOs = timeOs;
+        entry.timeRec = timeRec;
+        entry.timeSim = timeSim;
+        _recordingIndex.push_back(entry);
+    }
+    _recordingIndex.back().nEntries++;
+}
+
+void SessionRecording::saveRecordingIndex() {
+    writeRecordingIndex(_recordFile, _recordingIndex);
+    _recordingIndex.clear();
+}
+
+void SessionRecording::writeRecordingIndex(std::ostream& stream,
+                                           std::vector<RecordingIndexEntry>& index)
+{
+    const uint64_t indexOffset = static_cast<uint64_t>(stream.tellp());
+    for (size_t i = 0; i < index.size(); ++i) {
+        const uint64_t end = (i + 1 < index.size()) ? index[i + 1].offset : indexOffset;
+        index[i].size = end - index[i].offset;
+    }
+
+    const uint64_t nBlocks = index.size();
+    stream.write(
+        reinterpret_cast<const char*>(index.data()),
+        index.size() * sizeof(RecordingIndexEntry)
+    );
+    stream.write(reinterpret_cast<const char*>(&nBlocks), sizeof(uint64_t));
+    stream.write(reinterpret_cast<const char*>(&indexOffset), sizeof(uint64_t));
+    stream.write(IndexTag, IndexTagLength);
+}
+
 void SessionRecording::saveKeyframeToFile(std::string entry) {
     _recordFile << std::move(entry) << std::endl;
 }
@@ -1429,6 +1824,15 @@ scripting::LuaLibrary SessionRecording::luaLibrary() {
                 "void",
                 "Stops a playback session before playback of all keyframes is complete"
             },
+            {
+                "seekPlayback",
+                &luascriptfunctions::seekPlayback,
+                {},
+                "number",
+                "Moves the current playback to the provided number of seconds since the "
+                "start of the recording. This is only supported for binary recordings "
+                "that are played back relative to the recording start."
+            },
             {
                 "enableTakeScreenShotDuringPlayback",
                 &luascriptfunctions::enableTakeScreenShotDuringPlayback,
@@ -34,12 +34,6 @@ PerformanceLayout::PerformanceLayout() {
         0,
         MaxValues * sizeof(SceneGraphPerformanceLayout)
     );
-
-    std::memset(
-        functionEntries,
-        0,
-        MaxValues * sizeof(FunctionPerformanceLayout)
-    );
 }
 
 } // namespace openspace::performance
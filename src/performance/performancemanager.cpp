@@ -200,8 +200,6 @@ void PerformanceManager::resetPerformanceMeasurements() {
     _performanceMemory->acquireLock();
     new (_performanceMemory->memory()) PerformanceLayout;
     _performanceMemory->releaseLock();
-
-    individualPerformanceLocations.clear();
 }
 
 void PerformanceManager::outputLogs() {
@@ -209,24 +207,6 @@ void PerformanceManager::outputLogs() {
     PerformanceLayout* layout = performanceData();
     const size_t writeStart = (PerformanceLayout::NumberValues - 1) - _currentTick;
 
-    // Log function performance
-    for (int16_t n = 0; n < layout->nFunctionEntries; n++) {
-        const PerformanceLayout::FunctionPerformanceLayout& function =
-            layout->functionEntries[n];
-        std::string filename = formatLogName(function.name);
-        std::ofstream out = std::ofstream(
-            absPath(std::move(filename)),
-            std::ofstream::out | std::ofstream::app
-        );
-
-        // Comma separate data
-        for (size_t i = writeStart; i < PerformanceLayout::NumberValues; i++) {
-            const std::vector<float>& data = { function.time[i] };
-            writeData(out, data);
-        }
-        out.close();
-    }
-
     // Log scene object performance
     for (int16_t n = 0; n < layout->nScaleGraphEntries; n++) {
         const PerformanceLayout::SceneGraphPerformanceLayout node =
@@ -339,45 +319,6 @@ void PerformanceManager::tick() {
     _currentTick = (_currentTick + 1) % PerformanceLayout::NumberValues;
 }
 
-void PerformanceManager::storeIndividualPerformanceMeasurement(
-                                                            const std::string& identifier,
-                                                                   long long microseconds)
-{
-    if (!_performanceMemory) {
-        // If someone called the PerfMeasure macro without checking whether we are
-        // currently set-up for recording, we don't want to crash, so we just discard
-        return;
-    }
-
-    PerformanceLayout* layout = performanceData();
-    _performanceMemory->acquireLock();
-
-    auto it = individualPerformanceLocations.find(identifier);
-    PerformanceLayout::FunctionPerformanceLayout* p = nullptr;
-    if (it == individualPerformanceLocations.end()) {
-        p = &(layout->functionEntries[layout->nFunctionEntries]);
-        individualPerformanceLocations[identifier] = layout->nFunctionEntries;
-        ++(layout->nFunctionEntries);
-    }
-    else {
-        p = &(layout->functionEntries[it->second]);
-    }
-#ifdef _MSC_VER
-    strcpy_s(p->name, identifier.length() + 1, identifier.c_str());
-#else
-    strcpy(p->name, identifier.c_str());
-#endif
-
-    std::rotate(
-        std::begin(p->time),
-        std::next(std::begin(p->time)),
-        std::end(p->time)
-    );
-    p->time[PerformanceLayout::NumberValues - 1] = static_cast<float>(microseconds);
-
-    _performanceMemory->releaseLock();
-}
-
 void PerformanceManager::storeScenePerformanceMeasurements(
                                            const std::vector<SceneGraphNode*>& sceneNodes)
 {
@@ -0,0 +1,333 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/performance/profiler.h>
+
+#include <openspace/documentation/documentationgenerator.h>
+#include <openspace/scripting/lualibrary.h>
+#include <ghoul/fmt.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/lua/ghoul_lua.h>
+#include <ghoul/lua/lua_helper.h>
+#include <ghoul/misc/assert.h>
+#include <ghoul/opengl/ghoul_gl.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "profiler_lua.inl"
+
+namespace {
+    constexpr const char* _loggerCat = "Profiler";
+
+    using openspace::performance::profiler::RingBufferSize;
+
+    struct Zone {
+        const char* name;
+        uint64_t begin;
+        uint64_t end;
+    };
+
+    // The values are atomics so that the zones can be copied while their thread is
+    // writing new ones. Relaxed atomic accesses compile to plain loads and stores
+    struct Slot {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> begin;
+        std::atomic<uint64_t> end;
+    };
+
+    // Each buffer is only written to by a single thread. Readers detect zones that were
+    // overwritten while they were being copied by rereading the number of written zones
+    struct ThreadBuffer {
+        std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(RingBufferSize);
+        // The total number of zones that have been written to this buffer
+        std::atomic<uint64_t> nWritten = 0;
+        // The zones with a lower index than this have been removed by clear()
+        std::atomic<uint64_t> nCleared = 0;
+        size_t id = 0;
+        std::string name;
+    };
+
+    const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+    // Guards the list of buffers and their names, but not the zones themselves
+    std::mutex BuffersMutex;
+    // Buffers are never removed, so that zones of threads that have ended are retained
+    std::vector<std::unique_ptr<ThreadBuffer>> Buffers;
+
+    thread_local ThreadBuffer* CurrentBuffer = nullptr;
+    thread_local std::string CurrentThreadName;
+
+    ThreadBuffer* createBuffer(std::string name) {
+        std::lock_guard lock(BuffersMutex);
+        auto buffer = std::make_unique<ThreadBuffer>();
+        buffer->id = Buffers.size();
+        buffer->name = name.empty() ? fmt::format("Thread {}", buffer->id) : name;
+        Buffers.push_back(std::move(buffer));
+        return Buffers.back().get();
+    }
+
+    void write(ThreadBuffer& buffer, const Zone& zone) {
+        const uint64_t i = buffer.nWritten.load(std::memory_order_relaxed);
+        // Orders the previous update of nWritten before the slot is overwritten, which
+        // pairs with the acquire fence in saveChromeTrace
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = buffer.slots[i % RingBufferSize];
+        slot.name.store(zone.name, std::memory_order_relaxed);
+        slot.begin.store(zone.begin, std::memory_order_relaxed);
+        slot.end.store(zone.end, std::memory_order_relaxed);
+        buffer.nWritten.store(i + 1, std::memory_order_release);
+    }
+
+    // GPU zones are only used from the thread that owns the OpenGL context
+    struct GpuZone {
+        const char* name;
+        GLuint beginQuery;
+        GLuint endQuery;
+    };
+
+    // The zones that have been started but not ended, stored as name and begin query
+    std::vector<std::pair<const char*, GLuint>> OpenGpuZones;
+    std::deque<GpuZone> PendingGpuZones;
+    std::vector<GLuint> FreeQueries;
+    ThreadBuffer* GpuBuffer = nullptr;
+
+    GLuint timestampQuery() {
+        GLuint query = 0;
+        if (FreeQueries.empty()) {
+            glGenQueries(1, &query);
+        }
+        else {
+            query = FreeQueries.back();
+            FreeQueries.pop_back();
+        }
+        glQueryCounter(query, GL_TIMESTAMP);
+        return query;
+    }
+} // namespace
+
+namespace openspace::performance::profiler {
+
+namespace detail {
+    std::atomic<bool> IsEnabled = false;
+} // namespace detail
+
+void setEnabled(bool enabled) {
+    detail::IsEnabled = enabled;
+}
+
+uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - Epoch
+    ).count();
+}
+
+void recordZone(const char* name, uint64_t begin, uint64_t end) {
+    if (!CurrentBuffer) {
+        CurrentBuffer = createBuffer(CurrentThreadName);
+    }
+    write(*CurrentBuffer, { name, begin, end });
+}
+
+void setThreadName(std::string name) {
+    if (CurrentBuffer) {
+        std::lock_guard lock(BuffersMutex);
+        CurrentBuffer->name = name;
+    }
+    CurrentThreadName = std::move(name);
+}
+
+void beginGpuZone(const char* name) {
+    OpenGpuZones.emplace_back(name, timestampQuery());
+}
+
+void endGpuZone() {
+    ghoul_assert(!OpenGpuZones.empty(), "No GPU zone was started");
+
+    const std::pair<const char*, GLuint> zone = OpenGpuZones.back();
+    OpenGpuZones.pop_back();
+    PendingGpuZones.push_back({ zone.first, zone.second, timestampQuery() });
+}
+
+void collectGpuZones() {
+    if (PendingGpuZones.empty()) {
+        return;
+    }
+    if (!GpuBuffer) {
+        GpuBuffer = createBuffer("GPU");
+    }
+
+    // Map the GPU timestamps onto the CPU clock. The current GPU time is the time at
+    // which all previously issued commands have been submitted, which is close enough
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+    const int64_t offset = static_cast<int64_t>(now()) - gpuNow;
+
+    // The end queries finish in the order in which the zones were ended, so we can stop
+    // at the first query that is not available yet
+    while (!PendingGpuZones.empty()) {
+        const GpuZone& zone = PendingGpuZones.front();
+        GLint isAvailable = 0;
+        glGetQueryObjectiv(zone.endQuery, GL_QUERY_RESULT_AVAILABLE, &isAvailable);
+        if (!isAvailable) {
+            break;
+        }
+
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+        glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+        write(
+            *GpuBuffer,
+            {
+                zone.name,
+                static_cast<uint64_t>(static_cast<int64_t>(begin) + offset),
+                static_cast<uint64_t>(static_cast<int64_t>(end) + offset)
+            }
+        );
+
+        FreeQueries.push_back(zone.beginQuery);
+        FreeQueries.push_back(zone.endQuery);
+        PendingGpuZones.pop_front();
+    }
+}
+
+void clear() {
+    std::lock_guard lock(BuffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : Buffers) {
+        buffer->nCleared = buffer->nWritten.load();
+    }
+}
+
+bool saveChromeTrace(const std::string& path) {
+    std::ofstream file(path);
+    if (!file.good()) {
+        LERROR(fmt::format("Could not open file '{}' for writing", path));
+        return false;
+    }
+
+    file << "{\"traceEvents\":[";
+    bool isFirst = true;
+    std::vector<Zone> zones;
+
+    std::lock_guard lock(BuffersMutex);
+    for (const std::unique_ptr<ThreadBuffer>& buffer : Buffers) {
+        if (!isFirst) {
+            file << ',';
+        }
+        isFirst = false;
+        file << fmt::format(
+            "\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},"
+            "\"args\":{{\"name\":\"{}\"}}}}",
+            buffer->id, escapedJson(buffer->name)
+        );
+
+        const uint64_t last = buffer->nWritten.load(std::memory_order_acquire);
+        const uint64_t oldest = last > RingBufferSize ? last - RingBufferSize : 0;
+        const uint64_t first = std::max(oldest, buffer->nCleared.load());
+        zones.clear();
+        for (uint64_t i = first; i < last; ++i) {
+            const Slot& slot = buffer->slots[i % RingBufferSize];
+            zones.push_back({
+                slot.name.load(std::memory_order_relaxed),
+                slot.begin.load(std::memory_order_relaxed),
+                slot.end.load(std::memory_order_relaxed)
+            });
+        }
+
+        // The owning thread continues writing while the zones are copied, so the oldest
+        // copied zones might have been overwritten in the meantime and are discarded.
+        // The zone with index i is overwritten once nWritten reaches i + RingBufferSize
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t written = buffer->nWritten.load(std::memory_order_relaxed);
+        const uint64_t valid =
+            written >= RingBufferSize ? written - RingBufferSize + 1 : 0;
+        const size_t nInvalid = static_cast<size_t>(
+            std::min<uint64_t>(valid > first ? valid - first : 0, zones.size())
+        );
+
+        for (size_t i = nInvalid; i < zones.size(); ++i) {
+            const Zone& z = zones[i];
+            // The trace event format expects timestamps in microseconds
+            file << fmt::format(
+                ",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},"
+                "\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                escapedJson(z.name), buffer->id, z.begin / 1000.0,
+                (z.end - z.begin) / 1000.0
+            );
+        }
+    }
+    file << "\n]}\n";
+
+    LINFO(fmt::format("Saved profiler trace to '{}'", path));
+    return true;
+}
+
+scripting::LuaLibrary luaLibrary() {
+    return {
+        "profiling",
+        {
+            {
+                "setEnabled",
+                &luascriptfunctions::setEnabled,
+                {},
+                "bool",
+                "Enables or disables the recording of profiler zones. Zones that were "
+                "recorded before are kept when the profiler is disabled."
+            },
+            {
+                "isEnabled",
+                &luascriptfunctions::isEnabled,
+                {},
+                "",
+                "Returns whether the profiler is currently recording zones"
+            },
+            {
+                "clear",
+                &luascriptfunctions::clear,
+                {},
+                "",
+                "Removes all profiler zones that have been recorded so far"
+            },
+            {
+                "saveTrace",
+                &luascriptfunctions::saveTrace,
+                {},
+                "string",
+                "Saves the recorded profiler zones to the provided file in the Chrome "
+                "trace event format, which can be opened in chrome://tracing or "
+                "Perfetto. The path can contain path tokens, which are automatically "
+                "resolved."
+            }
+        }
+    };
+}
+
+} // namespace openspace::performance::profiler
@@ -22,81 +22,73 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
 
-#include <openspace/util/threadpool.h>
+namespace openspace::performance::profiler::luascriptfunctions {
 
-namespace openspace {
+/**
+ * \ingroup LuaScripts
+ * setEnabled(bool):
+ * Enables or disables the recording of profiler zones
+ */
+int setEnabled(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 1, "lua::setEnabled");
 
-Worker::Worker(ThreadPool& p) : pool(p) {}
+    const bool enabled = ghoul::lua::value<bool>(L, 1, ghoul::lua::PopValue::Yes);
+    profiler::setEnabled(enabled);
 
-void Worker::operator()() {
-    std::function<void()> task;
-    while (true) {
-        // acquire lock
-        {
-            std::unique_lock<std::mutex> lock(pool.queue_mutex);
-
-            // look for a work item
-            while (!pool.stop && pool.tasks.empty()) {
-                // if there are none wait for notification
-                pool.condition.wait(lock);
-            }
-
-            if (pool.stop) { // exit if the pool is stopped
-                return;
-            }
-
-            // get the task from the queue
-            task = pool.tasks.front();
-            pool.tasks.pop_front();
-
-        } // release lock
-
-        // execute the task
-        task();
-    }
+    ghoul_assert(lua_gettop(L) == 0, "Incorrect number of items left on stack");
+    return 0;
 }
 
-ThreadPool::ThreadPool(size_t numThreads) : stop(false) {
-    for (size_t i = 0; i < numThreads; ++i) {
-        workers.emplace_back(std::thread(Worker(*this)));
-    }
-}
-
-ThreadPool::ThreadPool(const ThreadPool& toCopy) : ThreadPool(toCopy.workers.size()) {}
+/**
+ * \ingroup LuaScripts
+ * isEnabled():
+ * Returns whether the profiler is recording zones
+ */
+int isEnabled(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 0, "lua::isEnabled");
 
-// the destructor joins all threads
-ThreadPool::~ThreadPool() {
-    // stop all threads
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        stop = true;
-    }
-    condition.notify_all();
+    ghoul::lua::push(L, profiler::isEnabled());
 
-    // join them
-    for (std::thread& w : workers) {
-        w.join();
-    }
+    ghoul_assert(lua_gettop(L) == 1, "Incorrect number of items left on stack");
+    return 1;
 }
 
-// add new work item to the pool
-void ThreadPool::enqueue(std::function<void()> f) {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
+/**
+ * \ingroup LuaScripts
+ * clear():
+ * Removes all recorded profiler zones
+ */
+int clear(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 0, "lua::clear");
 
-        // add the task
-        tasks.push_back(std::move(f));
-    } // release lock
+    profiler::clear();
 
-    // wake up one thread
-    condition.notify_one();
+    ghoul_assert(lua_gettop(L) == 0, "Incorrect number of items left on stack");
+    return 0;
 }
 
-void ThreadPool::clearTasks() {
-    { // acquire lock
-        std::unique_lock<std::mutex> lock(queue_mutex);
-        tasks.clear();
-    } // release lock
+/**
+ * \ingroup LuaScripts
+ * saveTrace(string):
+ * Saves the recorded profiler zones in the Chrome trace event format
+ */
+int saveTrace(lua_State* L) {
+    ghoul::lua::checkArgumentsAndThrow(L, 1, "lua::saveTrace");
+
+    const std::string path = ghoul::lua::value<std::string>(
+        L,
+        1,
+        ghoul::lua::PopValue::Yes
+    );
+    if (!profiler::saveChromeTrace(absPath(path))) {
+        return ghoul::lua::luaError(
+            L,
+            fmt::format("Could not save profiler trace to '{}'", path)
+        );
+    }
+
+    ghoul_assert(lua_gettop(L) == 0, "Incorrect number of items left on stack");
+    return 0;
 }
 
-} // namespace openspace
+} // namespace openspace::performance::profiler::luascriptfunctions
@@ -31,10 +31,33 @@
 #include <ghoul/misc/assert.h>
 #include <ghoul/misc/invariants.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <numeric>
+#include <shared_mutex>
 
 namespace {
     constexpr const char* _loggerCat = "PropertyOwner";
+
+    constexpr const uint64_t FnvPrime = 1099511628211ULL;
+
+    // Incremented whenever the structure of any tree of PropertyOwners changes
+    std::atomic<uint64_t> structureGenerationCounter = 0;
+
+    // Guards the URI indices of all PropertyOwners. Lookups only read the index once it
+    // has been built, so they share the lock with each other
+    std::shared_mutex uriIndexMutex;
+
+    // Removes the \p suffix from the end of \p str if it is present
+    bool consumeSuffix(std::string_view& str, std::string_view suffix) {
+        if (str.size() < suffix.size() ||
+            str.compare(str.size() - suffix.size(), suffix.size(), suffix) != 0)
+        {
+            return false;
+        }
+        str.remove_suffix(suffix.size());
+        return true;
+    }
 } // namespace
 
 namespace openspace::properties {
@@ -64,6 +87,27 @@ PropertyOwner::PropertyOwner(PropertyOwnerInfo info)
 }
 
 PropertyOwner::~PropertyOwner() {
+    if (_owner) {
+        // Neither the index of the root nor our owner may refer to us after this
+        {
+            const PropertyOwner* root = uriIndexRoot().first;
+            std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+            if (root->_hasUriIndex) {
+                root->removeFromUriIndex(*this);
+            }
+        }
+
+        std::vector<PropertyOwner*>& siblings = _owner->_subOwners;
+        siblings.erase(
+            std::remove(siblings.begin(), siblings.end(), this),
+            siblings.end()
+        );
+        ++structureGenerationCounter;
+    }
+
+    for (PropertyOwner* owner : _subOwners) {
+        owner->_owner = nullptr;
+    }
     _properties.clear();
     _subOwners.clear();
 }
@@ -83,24 +127,54 @@ std::vector<Property*> PropertyOwner::propertiesRecursive() const {
     return props;
 }
 
-Property* PropertyOwner::property(const std::string& uri) const {
+Property* PropertyOwner::property(std::string_view uri) const {
+    const auto [root, prefix] = uriIndexRoot();
+    {
+        std::shared_lock<std::shared_mutex> lock(uriIndexMutex);
+        if (!root->_hasUriIndex) {
+            // Building the index requires exclusive access
+            lock.unlock();
+            {
+                std::lock_guard<std::shared_mutex> buildLock(uriIndexMutex);
+                if (!root->_hasUriIndex) {
+                    root->addToUriIndex(*root, UriHash());
+                    root->_hasUriIndex = true;
+                }
+            }
+            lock.lock();
+        }
+
+        const auto [begin, end] = root->_uriIndex.equal_range(prefix.append(uri).value);
+        for (auto it = begin; it != end; ++it) {
+            if (isUriOf(*it->second, uri)) {
+                return it->second;
+            }
+        }
+    }
+
+    // The index only knows about Property's that were added through this class, so we
+    // fall back to searching the tree to make sure that no Property is missed
+    return findProperty(uri);
+}
+
+Property* PropertyOwner::findProperty(std::string_view uri) const {
     auto it = std::find_if(
         _properties.begin(),
         _properties.end(),
         [&uri](Property* prop) { return prop->identifier() == uri; }
     );
 
-    if (it == _properties.end() || (*it)->identifier() != uri) {
+    if (it == _properties.end()) {
         // if we do not own the searched property, it must consist of a concatenated
         // name and we can delegate it to a subowner
         const size_t ownerSeparator = uri.find(URISeparator);
-        if (ownerSeparator == std::string::npos) {
+        if (ownerSeparator == std::string_view::npos) {
             // if we do not own the property and there is no separator, it does not exist
             return nullptr;
         }
         else {
-            const std::string ownerName = uri.substr(0, ownerSeparator);
-            const std::string propertyName = uri.substr(ownerSeparator + 1);
+            const std::string_view ownerName = uri.substr(0, ownerSeparator);
+            const std::string_view propertyName = uri.substr(ownerSeparator + 1);
 
             PropertyOwner* owner = propertySubOwner(ownerName);
             if (!owner) {
@@ -108,7 +182,7 @@ Property* PropertyOwner::property(const std::string& uri) const {
             }
             else {
                 // Recurse into the subOwner
-                return owner->property(propertyName);
+                return owner->findProperty(propertyName);
             }
         }
     }
@@ -117,6 +191,93 @@ Property* PropertyOwner::property(const std::string& uri) const {
     }
 }
 
+PropertyOwner::UriHash PropertyOwner::UriHash::append(std::string_view identifier) const
+{
+    UriHash res = *this;
+    if (!res.isEmpty) {
+        res.value = (res.value ^ static_cast<uint8_t>(URISeparator)) * FnvPrime;
+    }
+    for (char c : identifier) {
+        res.value = (res.value ^ static_cast<uint8_t>(c)) * FnvPrime;
+    }
+    res.isEmpty = false;
+    return res;
+}
+
+std::pair<const PropertyOwner*, PropertyOwner::UriHash>
+PropertyOwner::uriIndexRoot() const
+{
+    if (!_owner) {
+        return { this, UriHash() };
+    }
+    const auto [root, prefix] = _owner->uriIndexRoot();
+    return { root, prefix.append(_identifier) };
+}
+
+void PropertyOwner::addToUriIndex(Property* prop, UriHash prefix) const {
+    const uint64_t key = prefix.append(prop->identifier()).value;
+    if (_uriIndexKeys.emplace(prop, key).second) {
+        _uriIndex.emplace(key, prop);
+    }
+}
+
+void PropertyOwner::addToUriIndex(const PropertyOwner& owner, UriHash prefix) const {
+    for (Property* p : owner._properties) {
+        addToUriIndex(p, prefix);
+    }
+    for (const PropertyOwner* o : owner._subOwners) {
+        addToUriIndex(*o, prefix.append(o->identifier()));
+    }
+}
+
+void PropertyOwner::removeFromUriIndex(const Property* prop) const {
+    const auto key = _uriIndexKeys.find(prop);
+    if (key == _uriIndexKeys.end()) {
+        return;
+    }
+
+    const auto [begin, end] = _uriIndex.equal_range(key->second);
+    const auto it = std::find_if(
+        begin,
+        end,
+        [prop](const std::pair<const uint64_t, Property*>& e) { return e.second == prop; }
+    );
+    if (it != end) {
+        _uriIndex.erase(it);
+    }
+    _uriIndexKeys.erase(key);
+}
+
+void PropertyOwner::removeFromUriIndex(const PropertyOwner& owner) const {
+    for (const Property* p : owner._properties) {
+        removeFromUriIndex(p);
+    }
+    for (const PropertyOwner* o : owner._subOwners) {
+        removeFromUriIndex(*o);
+    }
+}
+
+bool PropertyOwner::isUriOf(const Property& prop, std::string_view uri) const {
+    // Match the identifiers from the Property upwards until we reach this owner without
+    // assembling the fully qualified identifier
+    if (!consumeSuffix(uri, prop.identifier())) {
+        return false;
+    }
+
+    const PropertyOwner* owner = prop.owner();
+    while (owner != this) {
+        if (!owner || uri.empty() || uri.back() != URISeparator) {
+            return false;
+        }
+        uri.remove_suffix(1);
+        if (!consumeSuffix(uri, owner->identifier())) {
+            return false;
+        }
+        owner = owner->_owner;
+    }
+    return uri.empty();
+}
+
 bool PropertyOwner::hasProperty(const std::string& uri) const {
     return property(uri) != nullptr;
 }
@@ -135,14 +296,14 @@ const std::vector<PropertyOwner*>& PropertyOwner::propertySubOwners() const {
     return _subOwners;
 }
 
-PropertyOwner* PropertyOwner::propertySubOwner(const std::string& identifier) const {
+PropertyOwner* PropertyOwner::propertySubOwner(std::string_view identifier) const {
     std::vector<PropertyOwner*>::const_iterator it = std::find_if(
         _subOwners.begin(),
         _subOwners.end(),
         [&identifier](PropertyOwner* owner) { return owner->identifier() == identifier; }
     );
 
-    if (it == _subOwners.end() || (*it)->identifier() != identifier) {
+    if (it == _subOwners.end()) {
         return nullptr;
     }
     else {
@@ -203,6 +364,13 @@ void PropertyOwner::addProperty(Property* prop) {
         else {
             _properties.push_back(prop);
             prop->setPropertyOwner(this);
+            ++structureGenerationCounter;
+
+            const auto [root, prefix] = uriIndexRoot();
+            std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+            if (root->_hasUriIndex) {
+                root->addToUriIndex(prop, prefix);
+            }
         }
     }
 }
@@ -247,6 +415,18 @@ void PropertyOwner::addPropertySubOwner(openspace::properties::PropertyOwner* ow
         else {
             _subOwners.push_back(owner);
             owner->setPropertyOwner(this);
+            ++structureGenerationCounter;
+
+            // The new sub-owner is no longer the top of a tree, so its own index is
+            // replaced by the entries in the index of our root
+            const auto [root, prefix] = uriIndexRoot();
+            std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+            owner->_uriIndex.clear();
+            owner->_uriIndexKeys.clear();
+            owner->_hasUriIndex = false;
+            if (root->_hasUriIndex) {
+                root->addToUriIndex(*owner, prefix.append(owner->identifier()));
+            }
         }
     }
 }
@@ -267,8 +447,17 @@ void PropertyOwner::removeProperty(Property* prop) {
 
     // If we found the property identifier, we can delete it
     if (it != _properties.end() && (*it)->identifier() == prop->identifier()) {
+        {
+            const PropertyOwner* root = uriIndexRoot().first;
+            std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+            if (root->_hasUriIndex) {
+                root->removeFromUriIndex(*it);
+            }
+        }
+
         (*it)->setPropertyOwner(nullptr);
         _properties.erase(it);
+        ++structureGenerationCounter;
     } else {
         LERROR(fmt::format(
             "Property with identifier '{}' not found for removal", prop->identifier()
@@ -294,7 +483,17 @@ void PropertyOwner::removePropertySubOwner(openspace::properties::PropertyOwner*
 
     // If we found the propertyowner, we can delete it
     if (it != _subOwners.end() && (*it)->identifier() == owner->identifier()) {
+        {
+            const PropertyOwner* root = uriIndexRoot().first;
+            std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+            if (root->_hasUriIndex) {
+                root->removeFromUriIndex(**it);
+            }
+        }
+
+        (*it)->setPropertyOwner(nullptr);
         _subOwners.erase(it);
+        ++structureGenerationCounter;
     } else {
         LERROR(fmt::format(
             "PropertyOwner with name '{}' not found for removal", owner->identifier()
@@ -317,6 +516,15 @@ void PropertyOwner::setIdentifier(std::string identifier) {
     );
 
     _identifier = std::move(identifier);
+    ++structureGenerationCounter;
+
+    // The identifier is part of the URIs of all Property's below us, so the index of the
+    // tree has to be rebuilt on the next lookup
+    const PropertyOwner* root = uriIndexRoot().first;
+    std::lock_guard<std::shared_mutex> lock(uriIndexMutex);
+    root->_uriIndex.clear();
+    root->_uriIndexKeys.clear();
+    root->_hasUriIndex = false;
 }
 
 const std::string& PropertyOwner::identifier() const {
@@ -351,6 +559,10 @@ void PropertyOwner::removeTag(const std::string& tag) {
     _tags.erase(std::remove(_tags.begin(), _tags.end(), tag), _tags.end());
 }
 
+uint64_t PropertyOwner::structureGeneration() {
+    return structureGenerationCounter;
+}
+
 std::string PropertyOwner::generateJson() const {
     std::function<std::string(properties::PropertyOwner*)> createJson =
         [&createJson](properties::PropertyOwner* owner) -> std::string
@@ -0,0 +1,226 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/properties/uripattern.h>
+
+#include <openspace/properties/property.h>
+#include <openspace/properties/propertyowner.h>
+
+namespace {
+    // The number of positions that fit into a UriPattern::State, including the position
+    // after the last token at which the pattern is accepted
+    constexpr const size_t MaxTokens = 63;
+
+    enum class TokenType {
+        Character,
+        AnyCharacter,
+        AnySequence
+    };
+
+    struct Token {
+        TokenType type;
+        char character;
+    };
+
+    bool isLiteral(char c) {
+        // All characters that do not have a special meaning in an ECMAScript regular
+        // expression outside of a bracket expression
+        constexpr const std::string_view Special = "^$\\.*+?()[]{}|";
+        return Special.find(c) == std::string_view::npos;
+    }
+
+    // Splits the regex into tokens if it only consists of literal characters, '.', '.*',
+    // and '(.*)', which is what the wildcard expansion in the scripting API produces.
+    // Returns an empty vector if the regex uses anything else
+    std::vector<Token> tokenize(std::string_view regex) {
+        constexpr const std::string_view GroupedSequence = "(.*)";
+
+        std::vector<Token> tokens;
+        size_t i = 0;
+        while (i < regex.size()) {
+            if (regex.compare(i, GroupedSequence.size(), GroupedSequence) == 0) {
+                tokens.push_back({ TokenType::AnySequence, '\0' });
+                i += GroupedSequence.size();
+            }
+            else if (regex[i] == '.' && i + 1 < regex.size() && regex[i + 1] == '*') {
+                tokens.push_back({ TokenType::AnySequence, '\0' });
+                i += 2;
+            }
+            else if (regex[i] == '.') {
+                tokens.push_back({ TokenType::AnyCharacter, '\0' });
+                ++i;
+            }
+            else if (isLiteral(regex[i])) {
+                tokens.push_back({ TokenType::Character, regex[i] });
+                ++i;
+            }
+            else {
+                return {};
+            }
+
+            if (tokens.size() > MaxTokens) {
+                return {};
+            }
+        }
+        return tokens;
+    }
+} // namespace
+
+namespace openspace::properties {
+
+UriPattern::UriPattern(const std::string& regex) {
+    const std::vector<Token> tokens = tokenize(regex);
+    if (tokens.empty() && !regex.empty()) {
+        _regex = std::make_unique<std::regex>(regex);
+        return;
+    }
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const State position = State(1) << i;
+        switch (tokens[i].type) {
+            case TokenType::Character:
+                _characterMasks[static_cast<uint8_t>(tokens[i].character)] |= position;
+                break;
+            case TokenType::AnyCharacter:
+                _anyCharacterMask |= position;
+                break;
+            case TokenType::AnySequence:
+                _anySequenceMask |= position;
+                break;
+        }
+    }
+    _acceptMask = State(1) << tokens.size();
+}
+
+bool UriPattern::isHierarchical() const {
+    return _regex == nullptr;
+}
+
+UriPattern::State UriPattern::closure(State state) const {
+    // A sequence can be empty, so every active sequence also activates the next position
+    State next = state | ((state & _anySequenceMask) << 1);
+    while (next != state) {
+        state = next;
+        next = state | ((state & _anySequenceMask) << 1);
+    }
+    return state;
+}
+
+UriPattern::State UriPattern::advance(State state, char c) const {
+    const State mask = _characterMasks[static_cast<uint8_t>(c)] | _anyCharacterMask;
+    return closure(((state & mask) << 1) | (state & _anySequenceMask));
+}
+
+UriPattern::State UriPattern::advance(State state, std::string_view str) const {
+    for (char c : str) {
+        if (state == 0) {
+            return 0;
+        }
+        state = advance(state, c);
+    }
+    return state;
+}
+
+std::vector<Property*> UriPattern::matchingProperties(const PropertyOwner& owner) const {
+    std::vector<Property*> result;
+    if (_regex) {
+        std::string prefix = owner.identifier();
+        collectRegex(owner, prefix, result);
+    }
+    else {
+        const State start = closure(1);
+        if (owner.identifier().empty()) {
+            collect(owner, start, true, result);
+        }
+        else {
+            const State state = advance(start, owner.identifier());
+            if (state != 0) {
+                collect(owner, state, false, result);
+            }
+        }
+    }
+    return result;
+}
+
+void UriPattern::collect(const PropertyOwner& owner, State state, bool isEmpty,
+                         std::vector<Property*>& result) const
+{
+    // Owners with an empty identifier are skipped in the fully qualified identifier, so
+    // the separator is only added after the first owner that has one
+    const State base = isEmpty ? state : advance(state, PropertyOwner::URISeparator);
+    if (base != 0) {
+        for (Property* p : owner.properties()) {
+            if (advance(base, p->identifier()) & _acceptMask) {
+                result.push_back(p);
+            }
+        }
+    }
+
+    for (const PropertyOwner* o : owner.propertySubOwners()) {
+        if (o->identifier().empty()) {
+            collect(*o, state, isEmpty, result);
+        }
+        else if (base != 0) {
+            // If no position is active after the identifier, no URI in the sub-owner's
+            // tree can match and we don't have to descend
+            const State s = advance(base, o->identifier());
+            if (s != 0) {
+                collect(*o, s, false, result);
+            }
+        }
+    }
+}
+
+void UriPattern::collectRegex(const PropertyOwner& owner, std::string& prefix,
+                              std::vector<Property*>& result) const
+{
+    const size_t prefixSize = prefix.size();
+    if (!prefix.empty()) {
+        prefix += PropertyOwner::URISeparator;
+    }
+    const size_t baseSize = prefix.size();
+
+    for (Property* p : owner.properties()) {
+        prefix += p->identifier();
+        if (std::regex_match(prefix, *_regex)) {
+            result.push_back(p);
+        }
+        prefix.resize(baseSize);
+    }
+
+    for (const PropertyOwner* o : owner.propertySubOwners()) {
+        if (o->identifier().empty()) {
+            prefix.resize(prefixSize);
+            collectRegex(*o, prefix, result);
+        }
+        else {
+            prefix.resize(baseSize);
+            prefix += o->identifier();
+            collectRegex(*o, prefix, result);
+        }
+    }
+    prefix.resize(prefixSize);
+}
+
+} // namespace openspace::properties
@@ -26,8 +26,24 @@
 
 #include <openspace/engine/globals.h>
 #include <openspace/engine/virtualpropertymanager.h>
+#include <openspace/properties/uripattern.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/scene/scene.h>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // The number of patterns that are cached before the cache is emptied
+    constexpr const size_t MaxCachedPatterns = 256;
+
+    struct PatternCacheEntry {
+        std::unique_ptr<openspace::properties::UriPattern> pattern;
+        // The PropertyOwner::structureGeneration for which the result was computed
+        uint64_t generation = 0;
+        bool hasResult = false;
+        std::vector<openspace::properties::Property*> result;
+    };
+} // namespace
 
 namespace openspace {
 
@@ -71,4 +87,37 @@ std::vector<properties::Property*> allProperties() {
     return properties;
 }
 
+std::vector<properties::Property*> matchingProperties(const std::string& regex) {
+    static std::mutex cacheMutex;
+    static std::unordered_map<std::string, PatternCacheEntry> cache;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = cache.find(regex);
+    if (it == cache.end()) {
+        if (cache.size() >= MaxCachedPatterns) {
+            cache.clear();
+        }
+
+        PatternCacheEntry entry;
+        // Might throw, in which case nothing is added to the cache
+        entry.pattern = std::make_unique<properties::UriPattern>(regex);
+        it = cache.emplace(regex, std::move(entry)).first;
+    }
+
+    PatternCacheEntry& entry = it->second;
+    const uint64_t generation = properties::PropertyOwner::structureGeneration();
+    if (!entry.hasResult || entry.generation != generation) {
+        entry.result = entry.pattern->matchingProperties(global::rootPropertyOwner);
+
+        // The virtual property manager is not part of the rootProperty owner, see above
+        std::vector<properties::Property*> p =
+            entry.pattern->matchingProperties(global::virtualPropertyManager);
+        entry.result.insert(entry.result.end(), p.begin(), p.end());
+
+        entry.generation = generation;
+        entry.hasResult = true;
+    }
+    return entry.result;
+}
+
 }  // namespace
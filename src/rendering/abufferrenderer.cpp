@@ -29,7 +29,7 @@
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/performance/performancemanager.h>
-#include <openspace/performance/performancemeasurement.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/raycastermanager.h>
 #include <openspace/rendering/renderengine.h>
 #include <openspace/rendering/renderable.h>
@@ -162,7 +162,7 @@ void ABufferRenderer::raycastersChanged(VolumeRaycaster&, IsAttached) {
 }
 
 void ABufferRenderer::update() {
-    PerfMeasure("ABufferRenderer::update");
+    ProfileZone("ABufferRenderer::update");
 
     // Make sure that the fragment buffer has the correct resoliution
     // according to the output render buffer size
@@ -546,7 +546,7 @@ void ABufferRenderer::updateMSAASamplingPattern() {
 void ABufferRenderer::render(Scene* scene, Camera* camera, float blackoutFactor) {
     const bool doPerformanceMeasurements = global::performanceManager.isEnabled();
 
-    PerfMeasure("ABufferRenderer::render");
+    ProfileZone("ABufferRenderer::render");
 
     if (!scene || !camera) {
         return;
@@ -826,7 +826,7 @@ void ABufferRenderer::clear() {
 }
 
 void ABufferRenderer::updateResolution() {
-    PerfMeasure("ABufferRenderer::updateResolution");
+    ProfileZone("ABufferRenderer::updateResolution");
 
     int totalPixels = _resolution.x * _resolution.y;
     glBindTexture(GL_TEXTURE_2D, _anchorPointerTexture);
@@ -936,7 +936,7 @@ void ABufferRenderer::updateResolveDictionary() {
 }
 
 void ABufferRenderer::updateRaycastData() {
-    PerfMeasure("ABufferRenderer::updateRaycastData");
+    ProfileZone("ABufferRenderer::updateRaycastData");
 
     _raycastData.clear();
     _boundsPrograms.clear();
@@ -1015,7 +1015,7 @@ void ABufferRenderer::updateRaycastData() {
 }
 
 void ABufferRenderer::updateRendererData() {
-    PerfMeasure("ABufferRenderer::updateRendererData");
+    ProfileZone("ABufferRenderer::updateRendererData");
 
     ghoul::Dictionary dict;
     dict.setValue("fragmentRendererPath", std::string(RenderFragmentShaderPath));
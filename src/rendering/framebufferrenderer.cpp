@@ -27,7 +27,7 @@
 #include <openspace/engine/globals.h>
 #include <openspace/engine/windowdelegate.h>
 #include <openspace/performance/performancemanager.h>
-#include <openspace/performance/performancemeasurement.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/deferredcaster.h>
 #include <openspace/rendering/deferredcastermanager.h>
 #include <openspace/rendering/raycastermanager.h>
@@ -417,14 +417,9 @@ void FramebufferRenderer::deferredcastersChanged(Deferredcaster&,
 }
 
 void FramebufferRenderer::applyTMO(float blackoutFactor) {
-    const bool doPerformanceMeasurements = global::performanceManager.isEnabled();
-    std::unique_ptr<performance::PerformanceMeasurement> perfInternal;
-    
-    if (doPerformanceMeasurements) {
-        perfInternal = std::make_unique<performance::PerformanceMeasurement>(
-            "FramebufferRenderer::render::TMO"
-            );
-    }
+    ProfileZone("FramebufferRenderer::render::TMO");
+    ProfileGpuZone("FramebufferRenderer::render::TMO");
+
     _hdrFilteringProgram->activate();
 
     ghoul::opengl::TextureUnit hdrFeedingTextureUnit;
@@ -461,14 +456,8 @@ void FramebufferRenderer::applyTMO(float blackoutFactor) {
 }
 
 void FramebufferRenderer::applyFXAA() {
-    const bool doPerformanceMeasurements = global::performanceManager.isEnabled();
-    std::unique_ptr<performance::PerformanceMeasurement> perfInternal;
-
-    if (doPerformanceMeasurements) {
-        perfInternal = std::make_unique<performance::PerformanceMeasurement>(
-            "FramebufferRenderer::render::FXAA"
-            );
-    }
+    ProfileZone("FramebufferRenderer::render::FXAA");
+    ProfileGpuZone("FramebufferRenderer::render::FXAA");
 
     _fxaaProgram->activate();
 
@@ -535,14 +524,8 @@ void FramebufferRenderer::updateDownscaleTextures() {
 }
 
 void FramebufferRenderer::writeDownscaledVolume() {
-    const bool doPerformanceMeasurements = global::performanceManager.isEnabled();
-    std::unique_ptr<performance::PerformanceMeasurement> perfInternal;
-
-    if (doPerformanceMeasurements) {
-        perfInternal = std::make_unique<performance::PerformanceMeasurement>(
-            "FramebufferRenderer::render::writeDownscaledVolume"
-            );
-    }
+    ProfileZone("FramebufferRenderer::render::writeDownscaledVolume");
+    ProfileGpuZone("FramebufferRenderer::render::writeDownscaledVolume");
 
     // Saving current OpenGL state
     GLboolean blendEnabled = glIsEnabledi(GL_BLEND, 0);
@@ -1063,12 +1046,7 @@ void FramebufferRenderer::render(Scene* scene, Camera* camera, float blackoutFac
     // Measurements cache variable
     const bool doPerformanceMeasurements = global::performanceManager.isEnabled();
 
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (doPerformanceMeasurements) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "FramebufferRenderer::render"
-        );
-    }
+    ProfileZone("FramebufferRenderer::render");
 
     if (!scene || !camera) {
         return;
@@ -1090,21 +1068,22 @@ void FramebufferRenderer::render(Scene* scene, Camera* camera, float blackoutFac
     };
     RendererTasks tasks;
 
-    data.renderBinMask = static_cast<int>(Renderable::RenderBin::Background);
-    scene->render(data, tasks);
-    data.renderBinMask = static_cast<int>(Renderable::RenderBin::Opaque);
-    scene->render(data, tasks);
-    data.renderBinMask = static_cast<int>(Renderable::RenderBin::Transparent);
-    scene->render(data, tasks);
+    {
+        ProfileZone("FramebufferRenderer::render::scene");
+        ProfileGpuZone("FramebufferRenderer::render::scene");
+
+        data.renderBinMask = static_cast<int>(Renderable::RenderBin::Background);
+        scene->render(data, tasks);
+        data.renderBinMask = static_cast<int>(Renderable::RenderBin::Opaque);
+        scene->render(data, tasks);
+        data.renderBinMask = static_cast<int>(Renderable::RenderBin::Transparent);
+        scene->render(data, tasks);
+    }
 
     // Run Volume Tasks
     {
-        std::unique_ptr<performance::PerformanceMeasurement> perfInternal;
-        if (doPerformanceMeasurements) {
-            perfInternal = std::make_unique<performance::PerformanceMeasurement>(
-                "FramebufferRenderer::render::raycasterTasks"
-            );
-        }
+        ProfileZone("FramebufferRenderer::render::raycasterTasks");
+        ProfileGpuZone("FramebufferRenderer::render::raycasterTasks");
         performRaycasterTasks(tasks.raycasterTasks);
     }
 
@@ -1115,12 +1094,8 @@ void FramebufferRenderer::render(Scene* scene, Camera* camera, float blackoutFac
         glBindFramebuffer(GL_FRAMEBUFFER, _pingPongBuffers.framebuffer);
         glDrawBuffers(1, &ColorAttachment01Array[_pingPongIndex]);
 
-        std::unique_ptr<performance::PerformanceMeasurement> perfInternal;
-        if (doPerformanceMeasurements) {
-            perfInternal = std::make_unique<performance::PerformanceMeasurement>(
-                "FramebufferRenderer::render::deferredTasks"
-            );
-        }
+        ProfileZone("FramebufferRenderer::render::deferredTasks");
+        ProfileGpuZone("FramebufferRenderer::render::deferredTasks");
         performDeferredTasks(tasks.deferredcasterTasks);
     }
     
@@ -30,6 +30,7 @@
 #include <openspace/util/factorymanager.h>
 #include <openspace/util/updatestructures.h>
 #include <ghoul/opengl/programobject.h>
+#include <typeinfo>
 
 namespace {
     constexpr const char* KeyType = "Type";
@@ -202,6 +203,10 @@ bool Renderable::matchesRenderBinMask(int binMask) {
     return binMask & static_cast<int>(renderBin());
 }
 
+uint64_t Renderable::renderSortKey() const {
+    return static_cast<uint64_t>(typeid(*this).hash_code());
+}
+
 bool Renderable::isVisible() const {
     return _enabled;
 }
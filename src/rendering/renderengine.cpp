@@ -33,7 +33,7 @@
 #include <openspace/interaction/orbitalnavigator.h>
 #include <openspace/mission/missionmanager.h>
 #include <openspace/performance/performancemanager.h>
-#include <openspace/performance/performancemeasurement.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/rendering/abufferrenderer.h>
 #include <openspace/rendering/dashboard.h>
 #include <openspace/rendering/deferredcastermanager.h>
@@ -237,6 +237,24 @@ namespace {
         "rendering window"
     };
 
+    constexpr openspace::properties::Property::PropertyInfo SortRenderQueueInfo = {
+        "SortRenderQueue",
+        "Sort Render Queue",
+        "If this value is enabled, the renderables in the opaque render bin are drawn "
+        "sorted by their shader program and state, rather than in the order of the "
+        "scene graph, to reduce the number of state changes. The background, "
+        "transparent, and overlay render bins are always drawn in scene graph order."
+    };
+
+    constexpr openspace::properties::Property::PropertyInfo TextureUploadBudgetInfo = {
+        "TextureUploadBudget",
+        "Texture Upload Budget (in MB)",
+        "The number of megabytes that streaming components, such as the globe tile "
+        "providers, are allowed to upload to the GPU in a single frame. Further uploads "
+        "are postponed to the following frames, which prevents large upload spikes from "
+        "causing stuttering. The first upload in every frame is always performed."
+    };
+
     constexpr openspace::properties::Property::PropertyInfo FXAAInfo = {
         "FXAA",
         "Enable FXAA",
@@ -260,6 +278,8 @@ RenderEngine::RenderEngine()
     , _saveFrameInformation(SaveFrameInfo, false)
 #endif // OPENSPACE_WITH_INSTRUMENTATION
     , _disableMasterRendering(DisableMasterInfo, false)
+    , _sortRenderQueue(SortRenderQueueInfo, true)
+    , _textureUploadBudget(TextureUploadBudgetInfo, 64, 1, 1024)
     , _globalBlackOutFactor(GlobalBlackoutFactorInfo, 1.f, 0.f, 1.f)
     , _enableFXAA(FXAAInfo, true)
     , _disableHDRPipeline(DisableHDRPipelineInfo, false)
@@ -382,6 +402,15 @@ RenderEngine::RenderEngine()
     addProperty(_screenSpaceRotation);
     addProperty(_masterRotation);
     addProperty(_disableMasterRendering);
+
+    addProperty(_sortRenderQueue);
+    _textureUploadBudget.onChange([this]() {
+        constexpr const uint64_t OneMegabyte = 1024 * 1024;
+        _renderQueue.setUploadBudget(
+            static_cast<uint64_t>(_textureUploadBudget) * OneMegabyte
+        );
+    });
+    addProperty(_textureUploadBudget);
 }
 
 RenderEngine::~RenderEngine() {} // NOLINT
@@ -610,6 +639,14 @@ uint64_t RenderEngine::frameNumber() const {
     return _frameNumber;
 }
 
+RenderQueue& RenderEngine::renderQueue() {
+    return _renderQueue;
+}
+
+bool RenderEngine::sortRenderQueue() const {
+    return _sortRenderQueue;
+}
+
 void RenderEngine::render(const glm::mat4& sceneMatrix, const glm::mat4& viewMatrix,
                           const glm::mat4& projectionMatrix)
 {
@@ -659,9 +696,16 @@ void RenderEngine::render(const glm::mat4& sceneMatrix, const glm::mat4& viewMat
         std::string dt = std::to_string(global::windowDelegate.deltaTime());
         std::string avgDt = std::to_string(global::windowDelegate.averageDeltaTime());
 
+        const RenderQueue::Statistics& stats = _renderQueue.statistics();
+        std::string queue = fmt::format(
+            "Draws: {}\nState changes: {}\nUploaded: {} KB ({} deferred)",
+            stats.nDraws, stats.nStateChanges, stats.nUploadedBytes / 1024,
+            stats.nDeferredUploads
+        );
+
         std::string res = "Frame: " + fn + ' ' + fr + '\n' +
                           "Swap group frame: " + sgFn + '\n' +
-                          "Dt: " + dt + '\n' + "Avg Dt: " + avgDt;
+                          "Dt: " + dt + '\n' + "Avg Dt: " + avgDt + '\n' + queue;
         RenderFont(*_fontFrameInfo, penPosition, res);
     }
 
@@ -816,12 +860,7 @@ void RenderEngine::renderShutdownInformation(float timer, float fullTime) {
 }
 
 void RenderEngine::renderDashboard() {
-    std::unique_ptr<performance::PerformanceMeasurement> perf;
-    if (global::performanceManager.isEnabled()) {
-        perf = std::make_unique<performance::PerformanceMeasurement>(
-            "Main Dashboard::render"
-        );
-    }
+    ProfileZone("Main Dashboard::render");
 
     glm::vec2 dashboardStart = global::dashboard.getStartPositionOffset();
     glm::vec2 penPosition = glm::vec2(
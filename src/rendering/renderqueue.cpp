@@ -0,0 +1,104 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/rendering/renderqueue.h>
+
+#include <openspace/engine/globalscallbacks.h>
+#include <openspace/scene/scenegraphnode.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+
+namespace {
+    constexpr const char* _loggerCat = "RenderQueue";
+} // namespace
+
+namespace openspace {
+
+void RenderQueue::beginFrame() {
+    _statistics = Statistics();
+}
+
+void RenderQueue::submit(SceneGraphNode* node, uint64_t sortKey) {
+    _packets.push_back({ node, sortKey });
+}
+
+void RenderQueue::flush(const RenderData& data, RendererTasks& tasks, SortPackets sort)
+{
+    if (sort) {
+        // A stable sort retains the topological order between packets with the same key
+        std::stable_sort(
+            _packets.begin(),
+            _packets.end(),
+            [](const Packet& lhs, const Packet& rhs) { return lhs.sortKey < rhs.sortKey; }
+        );
+    }
+
+    for (size_t i = 0; i < _packets.size(); ++i) {
+        const Packet& p = _packets[i];
+        if (i > 0 && _packets[i - 1].sortKey != p.sortKey) {
+            _statistics.nStateChanges++;
+        }
+
+        try {
+            LTRACE("RenderQueue::flush(begin '" + p.node->identifier() + "')");
+            p.node->render(data, tasks);
+            LTRACE("RenderQueue::flush(end '" + p.node->identifier() + "')");
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.what());
+        }
+        _statistics.nDraws++;
+
+        if (global::callback::webBrowserPerformanceHotfix) {
+            (*global::callback::webBrowserPerformanceHotfix)();
+        }
+    }
+    _packets.clear();
+}
+
+void RenderQueue::setUploadBudget(uint64_t nBytes) {
+    _uploadBudget = nBytes;
+}
+
+bool RenderQueue::requestUpload() {
+    // The first check only makes a difference for a budget of 0, which would otherwise
+    // prevent all uploads
+    if (_statistics.nUploadedBytes == 0 || _statistics.nUploadedBytes < _uploadBudget) {
+        return true;
+    }
+    else {
+        _statistics.nDeferredUploads++;
+        return false;
+    }
+}
+
+void RenderQueue::registerUpload(uint64_t nBytes) {
+    _statistics.nUploadedBytes += nBytes;
+}
+
+const RenderQueue::Statistics& RenderQueue::statistics() const {
+    return _statistics;
+}
+
+} // namespace openspace
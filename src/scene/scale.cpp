@@ -79,6 +79,10 @@ bool Scale::initialize() {
     return true;
 }
 
+bool Scale::isThreadSafe() const {
+    return false;
+}
+
 double Scale::scaleValue() const {
     return _cachedScale;
 }
@@ -25,18 +25,28 @@
 #include <openspace/scene/scene.h>
 
 #include <openspace/engine/globals.h>
-#include <openspace/engine/globalscallbacks.h>
 #include <openspace/engine/windowdelegate.h>
+#include <openspace/performance/profiler.h>
 #include <openspace/query/query.h>
+#include <openspace/rendering/renderable.h>
 #include <openspace/rendering/renderengine.h>
+#include <openspace/rendering/renderqueue.h>
 #include <openspace/scene/scenegraphnode.h>
 #include <openspace/scene/scenelicensewriter.h>
 #include <openspace/scene/sceneinitializer.h>
 #include <openspace/scripting/lualibrary.h>
 #include <openspace/util/camera.h>
+#include <openspace/util/taskscheduler.h>
+#include <openspace/util/updatestructures.h>
 #include <ghoul/opengl/programobject.h>
 #include <ghoul/logging/logmanager.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <stack>
 
@@ -46,6 +56,18 @@ namespace {
     constexpr const char* _loggerCat = "Scene";
     constexpr const char* KeyIdentifier = "Identifier";
     constexpr const char* KeyParent = "Parent";
+
+    constexpr openspace::properties::Property::PropertyInfo ParallelUpdateInfo = {
+        "ParallelUpdate",
+        "Parallel Update",
+        "If this value is enabled, the translations, rotations, and scales of "
+        "independent scene graph nodes are updated concurrently on worker threads. Every "
+        "node is still updated after its parent and dependencies and renderables are "
+        "always updated in order on the main thread, so the result is the same as for "
+        "the serial update. Disabling it updates all nodes one after another on the "
+        "main thread, which can be used for debugging or to rule out differences between "
+        "the nodes of a cluster."
+    };
 } // namespace
 
 namespace openspace {
@@ -57,9 +79,12 @@ Scene::InvalidSceneError::InvalidSceneError(std::string msg, std::string comp)
 Scene::Scene(std::unique_ptr<SceneInitializer> initializer)
     : properties::PropertyOwner({"Scene", "Scene"})
     , _initializer(std::move(initializer))
+    , _parallelUpdate(ParallelUpdateInfo, true)
 {
     _rootDummy.setIdentifier(SceneGraphNode::RootNodeIdentifier);
     _rootDummy.setScene(this);
+
+    addProperty(_parallelUpdate);
 }
 
 Scene::~Scene() {
@@ -121,6 +146,7 @@ void Scene::markNodeRegistryDirty() {
 
 void Scene::updateNodeRegistry() {
     sortTopologically();
+    buildUpdateGraph();
     _dirtyNodeRegistry = false;
 }
 
@@ -201,6 +227,36 @@ void Scene::sortTopologically() {
     _topologicallySortedNodes = nodes;
 }
 
+void Scene::buildUpdateGraph() {
+    const size_t nNodes = _topologicallySortedNodes.size();
+
+    std::unordered_map<const SceneGraphNode*, size_t> indices;
+    for (size_t i = 0; i < nNodes; ++i) {
+        indices[_topologicallySortedNodes[i]] = i;
+    }
+
+    _updateGraph.successors.assign(nNodes, {});
+    _updateGraph.nPredecessors.assign(nNodes, 0);
+    _updateGraph.nRemaining = std::make_unique<std::atomic<int>[]>(nNodes);
+
+    auto addEdge = [this, &indices](size_t from, const SceneGraphNode* to) {
+        // Nodes that are part of a circular dependency are not updated at all
+        const auto it = indices.find(to);
+        if (it != indices.end()) {
+            _updateGraph.successors[from].push_back(it->second);
+            _updateGraph.nPredecessors[it->second]++;
+        }
+    };
+    for (size_t i = 0; i < nNodes; ++i) {
+        for (const SceneGraphNode* child : _topologicallySortedNodes[i]->children()) {
+            addEdge(i, child);
+        }
+        for (const SceneGraphNode* n : _topologicallySortedNodes[i]->dependentNodes()) {
+            addEdge(i, n);
+        }
+    }
+}
+
 void Scene::initializeNode(SceneGraphNode* node) {
     _initializer->initializeNode(node);
 }
@@ -279,6 +335,8 @@ void Scene::initializeGL() {
 */
 
 void Scene::update(const UpdateData& data) {
+    ProfileZone("Scene::update");
+
     std::vector<SceneGraphNode*> initializedNodes = _initializer->takeInitializedNodes();
 
     for (SceneGraphNode* node : initializedNodes) {
@@ -291,10 +349,15 @@ void Scene::update(const UpdateData& data) {
     if (_dirtyNodeRegistry) {
         updateNodeRegistry();
     }
+
+    updateTransforms(data);
+
+    // Renderables may use OpenGL, so they are updated on this thread
+    ProfileZone("Scene::update::renderables");
     for (SceneGraphNode* node : _topologicallySortedNodes) {
         try {
             LTRACE("Scene::update(begin '" + node->identifier() + "')");
-            node->update(data);
+            node->updateRenderable(data);
             LTRACE("Scene::update(end '" + node->identifier() + "')");
         }
         catch (const ghoul::RuntimeError& e) {
@@ -303,29 +366,208 @@ void Scene::update(const UpdateData& data) {
     }
 }
 
-void Scene::render(const RenderData& data, RendererTasks& tasks) {
-    for (SceneGraphNode* node : _topologicallySortedNodes) {
+void Scene::updateTransforms(const UpdateData& data) {
+    ProfileZone("Scene::updateTransforms");
+
+    // Exceptions must not escape, as the successors of a node are only released after it
+    // has been updated
+    auto updateNode = [](SceneGraphNode* node, const UpdateData& updateData) {
+        ProfileZone("SceneGraphNode::updateTransform");
         try {
-            LTRACE("Scene::render(begin '" + node->identifier() + "')");
-            node->render(data, tasks);
-            LTRACE("Scene::render(end '" + node->identifier() + "')");
+            node->updateTransform(updateData);
         }
         catch (const ghoul::RuntimeError& e) {
             LERRORC(e.component, e.what());
         }
-        if (global::callback::webBrowserPerformanceHotfix) {
-            (*global::callback::webBrowserPerformanceHotfix)();
+        catch (const std::exception& e) {
+            LERROR(e.what());
+        }
+        catch (...) {
+            LERROR(fmt::format(
+                "Unknown error while updating the transform of '{}'", node->identifier()
+            ));
+        }
+    };
+
+    const size_t nNodes = _topologicallySortedNodes.size();
+    if (!_parallelUpdate || global::taskScheduler.numThreads() == 0 || nNodes < 2) {
+        for (SceneGraphNode* node : _topologicallySortedNodes) {
+            updateNode(node, data);
+        }
+        return;
+    }
+
+    // Transformations that are not thread-safe may read any other node, for example the
+    // node a FixedRotation is attached to, which is not an edge in the update graph. They
+    // are therefore updated on the main thread while no other node is being updated,
+    // after all nodes before them in the topological order and before all nodes after
+    // them, just as in a serial update. This splits the thread-safe nodes into phases,
+    // the nodes of which are updated in parallel
+    std::vector<bool> isThreadSafe(nNodes);
+    std::vector<size_t> phase(nNodes);
+    std::vector<size_t> mainThreadNodes;
+    for (size_t i = 0; i < nNodes; ++i) {
+        isThreadSafe[i] = _topologicallySortedNodes[i]->isTransformThreadSafe();
+        phase[i] = mainThreadNodes.size();
+        if (!isThreadSafe[i]) {
+            mainThreadNodes.push_back(i);
+        }
+        _updateGraph.nRemaining[i] = _updateGraph.nPredecessors[i];
+    }
+
+    TaskGroup tasks(global::taskScheduler);
+    std::atomic<size_t> nUpdated = 0;
+    // The phase whose thread-safe nodes are currently being updated
+    std::atomic<size_t> currentPhase = 0;
+    // The value of nUpdated that the main thread is waiting for
+    std::atomic<size_t> barrier = nNodes;
+
+    // Thread-safe nodes that are ready to be updated. Each of them is picked up either by
+    // a task on the scheduler or by the main thread, whichever gets to it first, so that
+    // the main thread keeps working instead of sleeping while the workers are busy
+    std::mutex readyMutex;
+    std::condition_variable readyChanged;
+    std::deque<size_t> readyNodes;
+
+    auto popReadyNode = [&]() -> std::optional<size_t> {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        if (readyNodes.empty()) {
+            return std::nullopt;
+        }
+        const size_t index = readyNodes.front();
+        readyNodes.pop_front();
+        return index;
+    };
+
+    std::function<void(size_t)> process;
+    auto pushReadyNode = [&](size_t index) {
+        {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            readyNodes.push_back(index);
+        }
+        readyChanged.notify_all();
+        tasks.run(
+            [&]() {
+                if (std::optional<size_t> i = popReadyNode(); i.has_value()) {
+                    process(*i);
+                }
+            },
+            TaskScheduler::Priority::High
+        );
+    };
+
+    // Updates the node and then releases its successors. Successors of the current phase
+    // that become ready are handed out through the ready queue, except for one that is
+    // continued with directly. Successors of later phases are started with their phase
+    process = [&](size_t index) {
+        while (true) {
+            updateNode(_topologicallySortedNodes[index], data);
+
+            bool hasNext = false;
+            size_t next = 0;
+            for (size_t s : _updateGraph.successors[index]) {
+                if (_updateGraph.nRemaining[s].fetch_sub(1) != 1) {
+                    continue;
+                }
+                if (!isThreadSafe[s] || phase[s] != currentPhase) {
+                    continue;
+                }
+
+                if (!hasNext) {
+                    hasNext = true;
+                    next = s;
+                }
+                else {
+                    pushReadyNode(s);
+                }
+            }
+
+            if (++nUpdated == barrier) {
+                std::lock_guard<std::mutex> lock(readyMutex);
+                readyChanged.notify_all();
+            }
+
+            if (!hasNext) {
+                return;
+            }
+            index = next;
         }
+    };
 
-        // @TODO(abock 2019-08-19) This glGetError call is a hack to prevent the GPU
-        // thread and the CPU thread from diverging too much, particularly the uploading
-        // of a lot of textures for the globebrowsing planets can cause a hard stuttering
-        // effect. Asking for a glGetError after every rendering call will force the
-        // threads to implicitly synchronize and thus prevent the stuttering.  The better
-        // solution would be to reduce the number of uploads per frame, use a staggered
-        // buffer, or something else like that preventing a large spike in uploads
-        glGetError();
+    // Starts the thread-safe nodes of the phase whose predecessors are all updated. The
+    // nodes are collected before the phase becomes current, as the nodes that are
+    // started release the others as soon as it is
+    auto startPhase = [&](size_t p, size_t begin, size_t end) {
+        std::vector<size_t> ready;
+        for (size_t i = begin; i < end; ++i) {
+            if (isThreadSafe[i] && _updateGraph.nRemaining[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+        currentPhase = p;
+        for (size_t i : ready) {
+            pushReadyNode(i);
+        }
+    };
+
+    // Runs ready thread-safe nodes on the main thread until the predicate is fulfilled
+    auto helpUntil = [&](auto isDone) {
+        while (true) {
+            std::optional<size_t> index;
+            {
+                std::unique_lock<std::mutex> lock(readyMutex);
+                readyChanged.wait(
+                    lock,
+                    [&]() { return isDone() || !readyNodes.empty(); }
+                );
+                if (isDone()) {
+                    return;
+                }
+                index = readyNodes.front();
+                readyNodes.pop_front();
+            }
+            process(*index);
+        }
+    };
+
+    size_t phaseBegin = 0;
+    for (size_t p = 0; p < mainThreadNodes.size(); ++p) {
+        const size_t node = mainThreadNodes[p];
+        startPhase(p, phaseBegin, node);
+
+        // All nodes before this one have been updated when nUpdated reaches its index
+        barrier = node;
+        helpUntil([&nUpdated, node]() { return nUpdated == node; });
+        process(node);
+        phaseBegin = node + 1;
     }
+    startPhase(mainThreadNodes.size(), phaseBegin, nNodes);
+    barrier = nNodes;
+    helpUntil([&nUpdated, nNodes]() { return nUpdated == nNodes; });
+
+    // The remaining tasks find the ready queue empty and return immediately
+    tasks.wait();
+}
+
+void Scene::render(const RenderData& data, RendererTasks& tasks) {
+    ProfileZone("Scene::render");
+
+    RenderQueue& queue = global::renderEngine.renderQueue();
+    for (SceneGraphNode* node : _topologicallySortedNodes) {
+        if (node->shouldRender(data)) {
+            queue.submit(node, node->renderable()->renderSortKey());
+        }
+    }
+
+    // Only the opaque bin can be sorted as its result does not depend on the drawing
+    // order. The background bin contains blended renderables, such as spheres, image
+    // planes and trails, so it is drawn in scene graph order like the transparent and
+    // overlay bins
+    constexpr const int SortableBins = static_cast<int>(Renderable::RenderBin::Opaque);
+    const bool sort = global::renderEngine.sortRenderQueue() &&
+                      (data.renderBinMask & ~SortableBins) == 0;
+
+    queue.flush(data, tasks, RenderQueue::SortPackets(sort));
 }
 
 void Scene::clear() {
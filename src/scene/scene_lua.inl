@@ -59,7 +59,6 @@ properties::PropertyOwner* findPropertyOwnerWithMatchingGroupTag(T* prop,
 }
 
 void applyRegularExpression(lua_State* L, const std::string& regex,
-                            const std::vector<properties::Property*>& properties,
                             double interpolationDuration,
                             const std::string& groupName,
                             ghoul::EasingFunction easingFunction)
@@ -74,52 +73,46 @@ void applyRegularExpression(lua_State* L, const std::string& regex,
     // Stores whether we found at least one matching property. If this is false at the end
     // of the loop, the property name regex was probably misspelled.
     bool foundMatching = false;
-    std::regex r(regex);
-    for (properties::Property* prop : properties) {
-        // Check the regular expression for all properties
-        const std::string& id = prop->fullyQualifiedIdentifier();
-
-        if (std::regex_match(id, r)) {
-            // If the fully qualified id matches the regular expression, we queue the
-            // value change if the types agree
-            if (isGroupMode) {
-                properties::PropertyOwner* matchingTaggedOwner =
-                    findPropertyOwnerWithMatchingGroupTag(
-                        prop,
-                        groupName
-                    );
-                if (!matchingTaggedOwner) {
-                    continue;
-                }
+    for (properties::Property* prop : matchingProperties(regex)) {
+        // The fully qualified id of all of these properties matches the regular
+        // expression, so we queue the value change if the types agree
+        if (isGroupMode) {
+            properties::PropertyOwner* matchingTaggedOwner =
+                findPropertyOwnerWithMatchingGroupTag(
+                    prop,
+                    groupName
+                );
+            if (!matchingTaggedOwner) {
+                continue;
             }
+        }
 
-            if (type != prop->typeLua()) {
-                LERRORC(
-                    "property_setValue",
-                    fmt::format(
-                        "{}: Property '{}' does not accept input of type '{}'. "
-                        "Requested type: '{}'",
-                        errorLocation(L),
-                        prop->fullyQualifiedIdentifier(),
-                        luaTypeToString(type),
-                        luaTypeToString(prop->typeLua())
-                    )
+        if (type != prop->typeLua()) {
+            LERRORC(
+                "property_setValue",
+                fmt::format(
+                    "{}: Property '{}' does not accept input of type '{}'. "
+                    "Requested type: '{}'",
+                    errorLocation(L),
+                    prop->fullyQualifiedIdentifier(),
+                    luaTypeToString(type),
+                    luaTypeToString(prop->typeLua())
+                )
+            );
+        } else {
+            foundMatching = true;
+
+            if (interpolationDuration == 0.0) {
+                global::renderEngine.scene()->removePropertyInterpolation(prop);
+                prop->setLuaValue(L);
+            }
+            else {
+                prop->setLuaInterpolationTarget(L);
+                global::renderEngine.scene()->addPropertyInterpolation(
+                    prop,
+                    static_cast<float>(interpolationDuration),
+                    easingFunction
                 );
-            } else {
-                foundMatching = true;
-
-                if (interpolationDuration == 0.0) {
-                    global::renderEngine.scene()->removePropertyInterpolation(prop);
-                    prop->setLuaValue(L);
-                }
-                else {
-                    prop->setLuaInterpolationTarget(L);
-                    global::renderEngine.scene()->addPropertyInterpolation(
-                        prop,
-                        static_cast<float>(interpolationDuration),
-                        easingFunction
-                    );
-                }
             }
         }
     }
@@ -291,7 +284,6 @@ int property_setValue(lua_State* L) {
             applyRegularExpression(
                 L,
                 uriOrRegex,
-                allProperties(),
                 interpolationDuration,
                 groupName,
                 easingMethod
@@ -312,7 +304,6 @@ int property_setValue(lua_State* L) {
             applyRegularExpression(
                 L,
                 uriOrRegex,
-                allProperties(),
                 interpolationDuration,
                 "",
                 easingMethod
@@ -431,16 +422,9 @@ int property_getProperty(lua_State* L) {
 
 
 
-    std::regex r(regex);
-    std::vector<properties::Property*> props = allProperties();
     std::vector<std::string> res;
-    for (properties::Property* prop : props) {
-        // Check the regular expression for all properties
-        const std::string& id = prop->fullyQualifiedIdentifier();
-
-        if (std::regex_match(id, r)) {
-            res.push_back(id);
-        }
+    for (properties::Property* prop : matchingProperties(regex)) {
+        res.push_back(prop->fullyQualifiedIdentifier());
     }
 
     lua_newtable(L);
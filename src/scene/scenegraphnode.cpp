@@ -381,108 +381,115 @@ void SceneGraphNode::traversePostOrder(const std::function<void(SceneGraphNode*)
 }
 
 void SceneGraphNode::update(const UpdateData& data) {
+    updateTransform(data);
+    updateRenderable(data);
+}
+
+void SceneGraphNode::updateTransform(const UpdateData& data) {
+    _hasUpdatedTransform = false;
+
     State s = _state;
-    if (s != State::Initialized && _state != State::GLInitialized) {
+    if (s != State::Initialized && s != State::GLInitialized) {
         return;
     }
     if (!isTimeFrameActive(data.time)) {
         return;
     }
 
+    // The transformations don't issue any OpenGL calls and might run on a worker
+    // thread, so they are timed without synchronizing with the GPU
+    using Clock = std::chrono::high_resolution_clock;
     if (_transform.translation) {
+        const Clock::time_point start = Clock::now();
+        _transform.translation->update(data);
         if (data.doPerformanceMeasurement) {
-            glFinish();
-            const auto start = std::chrono::high_resolution_clock::now();
-
-            _transform.translation->update(data);
-
-            glFinish();
-            const auto end = std::chrono::high_resolution_clock::now();
-            _performanceRecord.updateTimeTranslation = (end - start).count();
-        }
-        else {
-            _transform.translation->update(data);
+            _performanceRecord.updateTimeTranslation = (Clock::now() - start).count();
         }
     }
 
     if (_transform.rotation) {
+        const Clock::time_point start = Clock::now();
+        _transform.rotation->update(data);
         if (data.doPerformanceMeasurement) {
-            glFinish();
-            const auto start = std::chrono::high_resolution_clock::now();
-
-            _transform.rotation->update(data);
-
-            glFinish();
-            const auto end = std::chrono::high_resolution_clock::now();
-            _performanceRecord.updateTimeRotation = (end - start).count();
-        }
-        else {
-            _transform.rotation->update(data);
+            _performanceRecord.updateTimeRotation = (Clock::now() - start).count();
         }
     }
 
     if (_transform.scale) {
+        const Clock::time_point start = Clock::now();
+        _transform.scale->update(data);
         if (data.doPerformanceMeasurement) {
-            glFinish();
-            const auto start = std::chrono::high_resolution_clock::now();
-
-            _transform.scale->update(data);
-
-            glFinish();
-            const auto end = std::chrono::high_resolution_clock::now();
-            _performanceRecord.updateTimeScaling = (end - start).count();
-        }
-        else {
-            _transform.scale->update(data);
+            _performanceRecord.updateTimeScaling = (Clock::now() - start).count();
         }
     }
-    UpdateData newUpdateData = data;
 
     // Assumes _worldRotationCached and _worldScaleCached have been calculated for parent
     _worldPositionCached = calculateWorldPosition();
     _worldRotationCached = calculateWorldRotation();
     _worldScaleCached = calculateWorldScale();
 
-    newUpdateData.modelTransform.translation = _worldPositionCached;
-    newUpdateData.modelTransform.rotation = _worldRotationCached;
-    newUpdateData.modelTransform.scale = _worldScaleCached;
-
-    glm::dmat4 translation = glm::translate(
-        glm::dmat4(1.0),
-        newUpdateData.modelTransform.translation
-    );
-    glm::dmat4 rotation = glm::dmat4(newUpdateData.modelTransform.rotation);
+    glm::dmat4 translation = glm::translate(glm::dmat4(1.0), _worldPositionCached);
+    glm::dmat4 rotation = glm::dmat4(_worldRotationCached);
     glm::dmat4 scaling = glm::scale(
         glm::dmat4(1.0),
-        glm::dvec3(
-            newUpdateData.modelTransform.scale,
-            newUpdateData.modelTransform.scale,
-            newUpdateData.modelTransform.scale
-        )
+        glm::dvec3(_worldScaleCached, _worldScaleCached, _worldScaleCached)
     );
 
     _modelTransformCached = translation * rotation * scaling;
     _inverseModelTransformCached = glm::inverse(_modelTransformCached);
 
-    if (_renderable && _renderable->isReady()) {
-        if (data.doPerformanceMeasurement) {
-            glFinish();
-            auto start = std::chrono::high_resolution_clock::now();
+    _hasUpdatedTransform = true;
+}
 
-            _renderable->update(newUpdateData);
+void SceneGraphNode::updateRenderable(const UpdateData& data) {
+    if (!_hasUpdatedTransform || !_renderable || !_renderable->isReady()) {
+        return;
+    }
 
-            glFinish();
-            auto end = std::chrono::high_resolution_clock::now();
-            _performanceRecord.updateTimeRenderable = (end - start).count();
-        }
-        else {
-            _renderable->update(newUpdateData);
-        }
+    UpdateData newUpdateData = data;
+    newUpdateData.modelTransform.translation = _worldPositionCached;
+    newUpdateData.modelTransform.rotation = _worldRotationCached;
+    newUpdateData.modelTransform.scale = _worldScaleCached;
+
+    if (data.doPerformanceMeasurement) {
+        glFinish();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        _renderable->update(newUpdateData);
+
+        glFinish();
+        auto end = std::chrono::high_resolution_clock::now();
+        _performanceRecord.updateTimeRenderable = (end - start).count();
+    }
+    else {
+        _renderable->update(newUpdateData);
     }
 }
 
-void SceneGraphNode::render(const RenderData& data, RendererTasks& tasks) {
+bool SceneGraphNode::isTransformThreadSafe() const {
+    return (!_transform.translation || _transform.translation->isThreadSafe()) &&
+           (!_transform.rotation || _transform.rotation->isThreadSafe()) &&
+           (!_transform.scale || _transform.scale->isThreadSafe());
+}
+
+bool SceneGraphNode::shouldRender(const RenderData& data) const {
     if (_state != State::GLInitialized) {
+        return false;
+    }
+
+    if (!isTimeFrameActive(data.time)) {
+        return false;
+    }
+
+    return _renderable &&
+           _renderable->isVisible() &&
+           _renderable->isReady() &&
+           _renderable->isEnabled() &&
+           _renderable->matchesRenderBinMask(data.renderBinMask);
+}
+
+void SceneGraphNode::render(const RenderData& data, RendererTasks& tasks) {
+    if (!shouldRender(data)) {
         return;
     }
 
@@ -494,20 +501,6 @@ void SceneGraphNode::render(const RenderData& data, RendererTasks& tasks) {
         { _worldPositionCached, _worldRotationCached, _worldScaleCached }
     };
 
-    if (!isTimeFrameActive(data.time)) {
-        return;
-    }
-
-    bool visible = _renderable &&
-                   _renderable->isVisible() &&
-                   _renderable->isReady() &&
-                   _renderable->isEnabled() &&
-                   _renderable->matchesRenderBinMask(data.renderBinMask);
-
-    if (!visible) {
-        return;
-    }
-
     if (data.doPerformanceMeasurement) {
         glFinish();
         auto start = std::chrono::high_resolution_clock::now();
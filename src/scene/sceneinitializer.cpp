@@ -28,7 +28,28 @@
 #include <openspace/engine/openspaceengine.h>
 #include <openspace/rendering/loadingscreen.h>
 #include <openspace/scene/scenegraphnode.h>
+#include <ghoul/fmt.h>
 #include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+
+namespace {
+    constexpr const char* _loggerCat = "SceneInitializer";
+
+    // Calls the function when it goes out of scope, including during stack unwinding
+    template <typename Func>
+    class OnScopeExit {
+    public:
+        explicit OnScopeExit(Func func) : _func(std::move(func)) {}
+        ~OnScopeExit() { _func(); }
+
+        OnScopeExit(const OnScopeExit&) = delete;
+        OnScopeExit& operator=(const OnScopeExit&) = delete;
+
+    private:
+        Func _func;
+    };
+} // namespace
 
 namespace openspace {
 
@@ -47,11 +68,74 @@ bool SingleThreadedSceneInitializer::isInitializing() const {
 }
 
 MultiThreadedSceneInitializer::MultiThreadedSceneInitializer(unsigned int nThreads)
-    : _threadPool(nThreads)
+    : _nThreads(std::max(nThreads, 1u))
+    , _tasks(global::taskScheduler)
 {}
 
 void MultiThreadedSceneInitializer::initializeNode(SceneGraphNode* node) {
-    auto initFunction = [this, node]() {
+    LoadingScreen::ProgressInfo progressInfo;
+    progressInfo.progress = 0.f;
+
+    LoadingScreen* loadingScreen = global::openSpaceEngine.loadingScreen();
+    if (loadingScreen) {
+        loadingScreen->setItemNumber(loadingScreen->itemNumber() + 1);
+        loadingScreen->updateItem(
+            node->identifier(),
+            node->guiName(),
+            LoadingScreen::ItemStatus::Started,
+            progressInfo
+        );
+    }
+
+    std::lock_guard<std::mutex> g(_mutex);
+    _initializingNodes.insert(node);
+    _queuedNodes.push_back(node);
+    if (_nRunningInitializers < _nThreads) {
+        _nRunningInitializers++;
+        _tasks.run([this]() { initializeQueuedNodes(); });
+    }
+}
+
+void MultiThreadedSceneInitializer::initializeQueuedNodes() {
+    // If an exception escapes, this initializer stops. As no new initializer is started
+    // for the queued nodes while this one counts as running, another one takes over
+    bool isDone = false;
+    OnScopeExit release([this, &isDone]() {
+        if (isDone) {
+            return;
+        }
+        std::lock_guard<std::mutex> g(_mutex);
+        if (_queuedNodes.empty()) {
+            _nRunningInitializers--;
+        }
+        else {
+            _tasks.run([this]() { initializeQueuedNodes(); });
+        }
+    });
+
+    while (true) {
+        SceneGraphNode* node = nullptr;
+        {
+            std::lock_guard<std::mutex> g(_mutex);
+            if (_queuedNodes.empty()) {
+                _nRunningInitializers--;
+                isDone = true;
+                return;
+            }
+            node = _queuedNodes.front();
+            _queuedNodes.pop_front();
+        }
+
+        // The node stops counting as initializing however its initialization ends
+        bool success = false;
+        OnScopeExit finishNode([this, node, &success]() {
+            std::lock_guard<std::mutex> g(_mutex);
+            if (success) {
+                _initializedNodes.push_back(node);
+            }
+            _initializingNodes.erase(node);
+        });
+
         LoadingScreen* loadingScreen = global::openSpaceEngine.loadingScreen();
 
         LoadingScreen::ProgressInfo progressInfo;
@@ -65,10 +149,21 @@ void MultiThreadedSceneInitializer::initializeNode(SceneGraphNode* node) {
             );
         }
 
-        node->initialize();
-        std::lock_guard<std::mutex> g(_mutex);
-        _initializedNodes.push_back(node);
-        _initializingNodes.erase(node);
+        try {
+            node->initialize();
+            success = true;
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+        }
+        catch (const std::exception& e) {
+            LERROR(e.what());
+        }
+        catch (...) {
+            LERROR(fmt::format(
+                "Unknown error while initializing '{}'", node->identifier()
+            ));
+        }
 
         if (loadingScreen) {
             loadingScreen->updateItem(
@@ -78,25 +173,7 @@ void MultiThreadedSceneInitializer::initializeNode(SceneGraphNode* node) {
                 progressInfo
             );
         }
-    };
-
-    LoadingScreen::ProgressInfo progressInfo;
-    progressInfo.progress = 0.f;
-
-    LoadingScreen* loadingScreen = global::openSpaceEngine.loadingScreen();
-    if (loadingScreen) {
-        loadingScreen->setItemNumber(loadingScreen->itemNumber() + 1);
-        loadingScreen->updateItem(
-            node->identifier(),
-            node->guiName(),
-            LoadingScreen::ItemStatus::Started,
-            progressInfo
-        );
     }
-
-    std::lock_guard<std::mutex> g(_mutex);
-    _initializingNodes.insert(node);
-    _threadPool.enqueue(initFunction);
 }
 
 std::vector<SceneGraphNode*> MultiThreadedSceneInitializer::takeInitializedNodes() {
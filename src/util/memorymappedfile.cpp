@@ -0,0 +1,241 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <openspace/util/memorymappedfile.h>
+
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <algorithm>
+
+#ifdef WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // WIN32
+
+namespace {
+    constexpr const char* _loggerCat = "MemoryMappedFile";
+} // namespace
+
+namespace openspace {
+
+MemoryMappedFile::MemoryMappedFile(const std::string& path) : _path(path) {
+#ifdef WIN32
+    HANDLE file = CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        LERROR(fmt::format("Could not create file mapping for '{}'", path));
+        CloseHandle(file);
+        return;
+    }
+
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        LERROR(fmt::format("Could not map view of file '{}'", path));
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return;
+    }
+
+    _fileHandle = file;
+    _mappingHandle = mapping;
+    _data = reinterpret_cast<const std::byte*>(data);
+    _size = static_cast<size_t>(size.QuadPart);
+#else // WIN32
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == -1 || info.st_size == 0) {
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(
+        nullptr,
+        static_cast<size_t>(info.st_size),
+        PROT_READ,
+        MAP_PRIVATE,
+        fd,
+        0
+    );
+    // The mapping keeps its own reference to the file, so the descriptor can be closed
+    close(fd);
+    if (data == MAP_FAILED) {
+        LERROR(fmt::format("Could not map file '{}'", path));
+        return;
+    }
+
+    _data = reinterpret_cast<const std::byte*>(data);
+    _size = static_cast<size_t>(info.st_size);
+#endif // WIN32
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    unmap();
+}
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+    : _path(std::move(other._path))
+    , _data(other._data)
+    , _size(other._size)
+#ifdef WIN32
+    , _fileHandle(other._fileHandle)
+    , _mappingHandle(other._mappingHandle)
+#endif // WIN32
+{
+    other._data = nullptr;
+    other._size = 0;
+#ifdef WIN32
+    other._fileHandle = nullptr;
+    other._mappingHandle = nullptr;
+#endif // WIN32
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        _path = std::move(other._path);
+        _data = other._data;
+        _size = other._size;
+        other._data = nullptr;
+        other._size = 0;
+#ifdef WIN32
+        _fileHandle = other._fileHandle;
+        _mappingHandle = other._mappingHandle;
+        other._fileHandle = nullptr;
+        other._mappingHandle = nullptr;
+#endif // WIN32
+    }
+    return *this;
+}
+
+bool MemoryMappedFile::isValid() const {
+    return _data != nullptr;
+}
+
+const std::string& MemoryMappedFile::path() const {
+    return _path;
+}
+
+const std::byte* MemoryMappedFile::data() const {
+    return _data;
+}
+
+size_t MemoryMappedFile::size() const {
+    return _size;
+}
+
+void MemoryMappedFile::prefetch(size_t offset, size_t length) const {
+    if (!_data || offset >= _size) {
+        return;
+    }
+    length = std::min(length, _size - offset);
+
+#ifdef WIN32
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<std::byte*>(_data + offset);
+    range.NumberOfBytes = length;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else // WIN32
+    // madvise requires a page aligned address
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t alignedOffset = offset - (offset % pageSize);
+    madvise(
+        const_cast<std::byte*>(_data + alignedOffset),
+        length + (offset - alignedOffset),
+        MADV_WILLNEED
+    );
+#endif // WIN32
+}
+
+void MemoryMappedFile::populate() const {
+    if (!_data) {
+        return;
+    }
+
+    prefetch(0, _size);
+
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const size_t pageSize = static_cast<size_t>(info.dwPageSize);
+#else // WIN32
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif // WIN32
+
+    // The volatile read prevents the compiler from optimizing the loop away
+    unsigned char sum = 0;
+    for (size_t offset = 0; offset < _size; offset += pageSize) {
+        sum += static_cast<unsigned char>(
+            *reinterpret_cast<const volatile unsigned char*>(_data + offset)
+        );
+    }
+    (void)sum;
+}
+
+void MemoryMappedFile::unmap() {
+    if (!_data) {
+        return;
+    }
+
+#ifdef WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(_mappingHandle);
+    CloseHandle(_fileHandle);
+    _fileHandle = nullptr;
+    _mappingHandle = nullptr;
+#else // WIN32
+    munmap(const_cast<std::byte*>(_data), _size);
+#endif // WIN32
+
+    _data = nullptr;
+    _size = 0;
+}
+
+} // namespace openspace
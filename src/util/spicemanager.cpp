@@ -207,6 +207,8 @@ SpiceManager& SpiceManager::ref() {
 }
 
 SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!filePath.empty(), "Empty file path");
     ghoul_assert(
         FileSys.fileExists(filePath),
@@ -270,6 +272,8 @@ SpiceManager::KernelHandle SpiceManager::loadKernel(std::string filePath) {
 }
 
 void SpiceManager::unloadKernel(KernelHandle kernelId) {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(kernelId <= _lastAssignedKernel, "Invalid unassigned kernel");
     ghoul_assert(kernelId != KernelHandle(0), "Invalid zero handle");
 
@@ -296,6 +300,8 @@ void SpiceManager::unloadKernel(KernelHandle kernelId) {
 }
 
 void SpiceManager::unloadKernel(std::string filePath) {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!filePath.empty(), "Empty filename");
 
     std::string path = absPath(std::move(filePath));
@@ -332,6 +338,8 @@ void SpiceManager::unloadKernel(std::string filePath) {
 }
 
 bool SpiceManager::hasSpkCoverage(const std::string& target, double et) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Empty target");
 
     const int id = naifId(target);
@@ -348,6 +356,8 @@ bool SpiceManager::hasSpkCoverage(const std::string& target, double et) const {
 }
 
 bool SpiceManager::hasCkCoverage(const std::string& frame, double et) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!frame.empty(), "Empty target");
 
     const int id = frameId(frame);
@@ -364,10 +374,13 @@ bool SpiceManager::hasCkCoverage(const std::string& frame, double et) const {
 }
 
 bool SpiceManager::hasValue(int naifId, const std::string& item) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
     return bodfnd_c(naifId, item.c_str());
 }
 
 bool SpiceManager::hasValue(const std::string& body, const std::string& item) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!body.empty(), "Empty body");
     ghoul_assert(!item.empty(), "Empty item");
 
@@ -376,6 +389,8 @@ bool SpiceManager::hasValue(const std::string& body, const std::string& item) co
 }
 
 int SpiceManager::naifId(const std::string& body) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!body.empty(), "Empty body");
 
     SpiceBoolean success;
@@ -388,6 +403,8 @@ int SpiceManager::naifId(const std::string& body) const {
 }
 
 bool SpiceManager::hasNaifId(const std::string& body) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!body.empty(), "Empty body");
 
     SpiceBoolean success;
@@ -398,6 +415,8 @@ bool SpiceManager::hasNaifId(const std::string& body) const {
 }
 
 int SpiceManager::frameId(const std::string& frame) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!frame.empty(), "Empty frame");
 
     SpiceInt id;
@@ -409,6 +428,8 @@ int SpiceManager::frameId(const std::string& frame) const {
 }
 
 bool SpiceManager::hasFrameId(const std::string& frame) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!frame.empty(), "Empty frame");
 
     SpiceInt id;
@@ -432,36 +453,44 @@ void getValueInternal(const std::string& body, const std::string& value, int siz
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             double& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
     getValueInternal(body, value, 1, &v);
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec2& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
     getValueInternal(body, value, 2, glm::value_ptr(v));
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec3& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
     getValueInternal(body, value, 3, glm::value_ptr(v));
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             glm::dvec4& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
     getValueInternal(body, value, 4, glm::value_ptr(v));
 }
 
 void SpiceManager::getValue(const std::string& body, const std::string& value,
                             std::vector<double>& v) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!v.empty(), "Array for values has to be preallocaed");
 
     getValueInternal(body, value, static_cast<int>(v.size()), v.data());
 }
 
 double SpiceManager::spacecraftClockToET(const std::string& craft, double craftTicks) {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!craft.empty(), "Empty craft");
 
     int craftId = naifId(craft);
@@ -474,6 +503,8 @@ double SpiceManager::spacecraftClockToET(const std::string& craft, double craftT
 }
 
 double SpiceManager::ephemerisTimeFromDate(const std::string& timeString) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!timeString.empty(), "Empty timeString");
 
     double et;
@@ -485,6 +516,8 @@ double SpiceManager::ephemerisTimeFromDate(const std::string& timeString) const
 std::string SpiceManager::dateFromEphemerisTime(double ephemerisTime,
                                                     const std::string& formatString) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!formatString.empty(), "Format is empty");
 
     constexpr const int BufferSize = 256;
@@ -505,6 +538,8 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
                                         AberrationCorrection aberrationCorrection,
                                         double ephemerisTime, double& lightTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Target is not empty");
     ghoul_assert(!observer.empty(), "Observer is not empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame is not empty");
@@ -571,6 +606,8 @@ glm::dvec3 SpiceManager::targetPosition(const std::string& target,
                                         AberrationCorrection aberrationCorrection,
                                         double ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     double unused = 0.0;
     return targetPosition(
         target,
@@ -586,6 +623,8 @@ glm::dmat3 SpiceManager::frameTransformationMatrix(const std::string& from,
                                                    const std::string& to,
                                                    double ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!from.empty(), "From must not be empty");
     ghoul_assert(!to.empty(), "To must not be empty");
 
@@ -618,6 +657,8 @@ SpiceManager::SurfaceInterceptResult SpiceManager::surfaceIntercept(
                                                                      double ephemerisTime,
                                                   const glm::dvec3& directionVector) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Target must not be empty");
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(target != observer, "Target and observer must be different");
@@ -662,6 +703,8 @@ bool SpiceManager::isTargetInFieldOfView(const std::string& target,
                                          AberrationCorrection aberrationCorrection,
                                          double& ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Target must not be empty");
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(target != observer, "Target and observer must be different");
@@ -693,6 +736,8 @@ SpiceManager::TargetStateResult SpiceManager::targetState(const std::string& tar
                                                 AberrationCorrection aberrationCorrection,
                                                                double ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Target must not be empty");
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(!referenceFrame.empty(), "Reference frame must not be empty");
@@ -728,6 +773,8 @@ SpiceManager::TransformMatrix SpiceManager::stateTransformMatrix(
                                                       const std::string& destinationFrame,
                                                                double ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "toFrame must not be empty");
 
@@ -750,6 +797,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
                                                  const std::string& destinationFrame,
                                                  double ephemerisTime) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
@@ -780,6 +829,8 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
                                                  double ephemerisTimeFrom,
                                                  double ephemerisTimeTo) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!sourceFrame.empty(), "sourceFrame must not be empty");
     ghoul_assert(!destinationFrame.empty(), "destinationFrame must not be empty");
 
@@ -803,11 +854,15 @@ glm::dmat3 SpiceManager::positionTransformMatrix(const std::string& sourceFrame,
 SpiceManager::FieldOfViewResult
 SpiceManager::fieldOfView(const std::string& instrument) const
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!instrument.empty(), "Instrument must not be empty");
     return fieldOfView(naifId(instrument));
 }
 
 SpiceManager::FieldOfViewResult SpiceManager::fieldOfView(int instrument) const {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     constexpr int MaxBoundsSize = 64;
     constexpr int BufferSize = 128;
 
@@ -863,6 +918,8 @@ SpiceManager::TerminatorEllipseResult SpiceManager::terminatorEllipse(
                                                                      double ephemerisTime,
                                                              int numberOfTerminatorPoints)
 {
+    std::lock_guard<std::recursive_mutex> lock(_spiceMutex);
+
     ghoul_assert(!target.empty(), "Target must not be empty");
     ghoul_assert(!observer.empty(), "Observer must not be empty");
     ghoul_assert(!frame.empty(), "Frame must not be empty");
@@ -0,0 +1,313 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include <openspace/util/taskscheduler.h>
+
+#include <openspace/performance/profiler.h>
+#include <ghoul/fmt.h>
+#include <ghoul/logging/logmanager.h>
+#include <ghoul/misc/exception.h>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace {
+    constexpr const char* _loggerCat = "TaskScheduler";
+
+    // The scheduler and index of the worker that is running on the current thread
+    thread_local const openspace::TaskScheduler* CurrentScheduler = nullptr;
+    thread_local size_t CurrentWorker = 0;
+} // namespace
+
+namespace openspace {
+
+CancellationToken::CancellationToken()
+    : _isCancelled(std::make_shared<std::atomic<bool>>(false))
+{}
+
+void CancellationToken::cancel() {
+    *_isCancelled = true;
+}
+
+bool CancellationToken::isCancelled() const {
+    return *_isCancelled;
+}
+
+TaskScheduler::TaskScheduler(size_t nThreads)
+    : _nThreads(std::max<size_t>(nThreads, 1))
+{
+    _queues.reserve(_nThreads);
+    for (size_t i = 0; i < _nThreads; ++i) {
+        _queues.push_back(std::make_unique<WorkerQueue>());
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stop = true;
+    }
+    _wakeUp.notify_all();
+
+    for (std::thread& worker : _workers) {
+        worker.join();
+    }
+
+    // Drop all tasks that were never started
+    for (std::unique_ptr<WorkerQueue>& queue : _queues) {
+        for (std::deque<Task>& tasks : queue->tasks) {
+            for (Task& task : tasks) {
+                finishTask(task);
+            }
+            tasks.clear();
+        }
+    }
+}
+
+void TaskScheduler::enqueue(std::function<void()> task, Priority priority) {
+    submit({ std::move(task), nullptr, nullptr }, priority);
+}
+
+void TaskScheduler::enqueue(std::function<void()> task, Priority priority,
+                            const CancellationToken& token)
+{
+    submit({ std::move(task), token._isCancelled, nullptr }, priority);
+}
+
+size_t TaskScheduler::numThreads() const {
+    return _nThreads;
+}
+
+size_t TaskScheduler::numQueuedTasks() const {
+    return _nQueuedTasks;
+}
+
+void TaskScheduler::startWorkers() {
+    _workers.reserve(_nThreads);
+    for (size_t i = 0; i < _nThreads; ++i) {
+        _workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+void TaskScheduler::submit(Task task, Priority priority) {
+    if (_stop) {
+        finishTask(task);
+        return;
+    }
+    std::call_once(_startWorkers, [this]() { startWorkers(); });
+
+    // Tasks that are enqueued from a worker stay with that worker, all other tasks are
+    // distributed evenly
+    size_t queueIndex = currentWorker();
+    if (queueIndex == _nThreads) {
+        queueIndex = _nextQueue++ % _nThreads;
+    }
+
+    WorkerQueue& queue = *_queues[queueIndex];
+    const size_t p = static_cast<size_t>(priority);
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks[p].push_back(std::move(task));
+        queue.nTasks[p]++;
+    }
+    _nQueuedTasks++;
+
+    // A worker that is about to sleep has either registered itself already, in which
+    // case taking the lock makes sure that it is waiting before being notified, or it
+    // will see the new task before going to sleep
+    if (_nSleepingWorkers > 0) {
+        { std::lock_guard lock(_sleepMutex); }
+        _wakeUp.notify_one();
+    }
+}
+
+void TaskScheduler::removeTasks(const std::shared_ptr<GroupState>& group) {
+    for (std::unique_ptr<WorkerQueue>& queue : _queues) {
+        std::vector<Task> removedTasks;
+        {
+            std::lock_guard lock(queue->mutex);
+            for (size_t p = 0; p < queue->tasks.size(); ++p) {
+                std::deque<Task>& tasks = queue->tasks[p];
+                auto it = std::stable_partition(
+                    tasks.begin(),
+                    tasks.end(),
+                    [&group](const Task& task) { return task.group != group; }
+                );
+                queue->nTasks[p] -= std::distance(it, tasks.end());
+                std::move(it, tasks.end(), std::back_inserter(removedTasks));
+                tasks.erase(it, tasks.end());
+            }
+        }
+        _nQueuedTasks -= removedTasks.size();
+        for (Task& task : removedTasks) {
+            finishTask(task);
+        }
+    }
+}
+
+void TaskScheduler::finishTask(Task& task) {
+    // Destroy the function first so that nothing it has captured outlives the group
+    task.function = nullptr;
+    if (task.group && --task.group->nUnfinished == 0) {
+        std::lock_guard lock(task.group->mutex);
+        task.group->finished.notify_all();
+    }
+    task.group = nullptr;
+}
+
+bool TaskScheduler::runQueuedTask(size_t preferredQueue) {
+    // Higher priorities are checked in all queues before lower priorities are considered
+    for (size_t p = 3; p-- > 0;) {
+        for (size_t i = 0; i < _nThreads; ++i) {
+            WorkerQueue& queue = *_queues[(preferredQueue + i) % _nThreads];
+            if (queue.nTasks[p] == 0) {
+                continue;
+            }
+
+            Task task;
+            {
+                std::lock_guard lock(queue.mutex);
+                std::deque<Task>& tasks = queue.tasks[p];
+                if (tasks.empty()) {
+                    continue;
+                }
+                queue.nTasks[p]--;
+
+                // The worker takes its newest task while other workers steal the oldest
+                if (i == 0) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                }
+                else {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+            }
+            _nQueuedTasks--;
+
+            runTask(task);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskScheduler::runTask(Task& task) {
+    const bool isCancelled = (task.isCancelled && *task.isCancelled) ||
+                             (task.group && task.group->isCancelled);
+    if (!isCancelled) {
+        try {
+            ProfileZone("TaskScheduler::runTask");
+            task.function();
+        }
+        catch (const ghoul::RuntimeError& e) {
+            LERRORC(e.component, e.message);
+        }
+        catch (const std::exception& e) {
+            LERROR(e.what());
+        }
+        catch (...) {
+            // The task has to be finished regardless, or waiting for its group would
+            // never return
+            LERROR("Unknown error while running a task");
+        }
+    }
+    finishTask(task);
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+    CurrentScheduler = this;
+    CurrentWorker = index;
+    performance::profiler::setThreadName(fmt::format("Worker {}", index));
+
+    while (!_stop) {
+        if (runQueuedTask(index)) {
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _nSleepingWorkers++;
+        _wakeUp.wait(lock, [this]() { return _stop || _nQueuedTasks > 0; });
+        _nSleepingWorkers--;
+    }
+}
+
+size_t TaskScheduler::currentWorker() const {
+    return (CurrentScheduler == this) ? CurrentWorker : _nThreads;
+}
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler)
+    : _scheduler(scheduler)
+    , _state(std::make_shared<TaskScheduler::GroupState>())
+{}
+
+TaskGroup::~TaskGroup() {
+    cancel();
+    wait();
+}
+
+void TaskGroup::run(std::function<void()> task, TaskScheduler::Priority priority) {
+    _state->nUnfinished++;
+    _scheduler.submit({ std::move(task), nullptr, _state }, priority);
+}
+
+void TaskGroup::run(std::function<void()> task, TaskScheduler::Priority priority,
+                    const CancellationToken& token)
+{
+    _state->nUnfinished++;
+    _scheduler.submit({ std::move(task), token._isCancelled, _state }, priority);
+}
+
+void TaskGroup::wait() {
+    const size_t worker = _scheduler.currentWorker();
+    const bool isWorker = worker < _scheduler.numThreads();
+
+    while (_state->nUnfinished > 0) {
+        // A worker can't block as the tasks it is waiting for might be queued behind it
+        if (isWorker && _scheduler.runQueuedTask(worker)) {
+            continue;
+        }
+
+        std::unique_lock lock(_state->mutex);
+        auto isFinished = [this]() { return _state->nUnfinished == 0; };
+        if (isWorker) {
+            _state->finished.wait_for(lock, std::chrono::milliseconds(1), isFinished);
+        }
+        else {
+            _state->finished.wait(lock, isFinished);
+        }
+    }
+}
+
+void TaskGroup::cancel() {
+    _state->isCancelled = true;
+    _scheduler.removeTasks(_state);
+}
+
+size_t TaskGroup::numUnfinishedTasks() const {
+    return _state->nUnfinished;
+}
+
+} // namespace openspace
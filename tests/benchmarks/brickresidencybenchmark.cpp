@@ -0,0 +1,209 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+// Compares the BrickResidency table against the std::map and std::set based residency
+// tracking that the AtlasManager previously used. Both implementations replay the same
+// brick request trace and the wall clock time is printed. A trace can be recorded from
+// a running multiresolution volume by writing the brick indices that are passed to
+// AtlasManager::updateAtlas into a text file, one frame per line. If no trace file is
+// provided, a synthetic trace of a slowly moving camera is used instead.
+
+#include <modules/multiresvolume/rendering/brickresidency.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    using Trace = std::vector<std::vector<int>>;
+
+    struct Result {
+        double milliseconds = 0.0;
+        size_t nStreamedBricks = 0;
+    };
+
+    Trace loadTrace(const std::string& path) {
+        Trace trace;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::stringstream s(line);
+            std::vector<int> frame;
+            int brick;
+            while (s >> brick) {
+                frame.push_back(brick);
+            }
+            if (!frame.empty()) {
+                trace.push_back(std::move(frame));
+            }
+        }
+        return trace;
+    }
+
+    // Every frame requests a fixed number of bricks from a window that moves a little
+    // bit each frame, so most of the bricks stay the same between consecutive frames
+    Trace syntheticTrace(int nBricks, int nBricksPerFrame, int nFrames) {
+        std::mt19937 generator(1337);
+        Trace trace(nFrames);
+        for (int i = 0; i < nFrames; ++i) {
+            const int windowStart = (i * nBricksPerFrame / 64) % (nBricks / 2);
+            std::uniform_int_distribution<int> dist(
+                windowStart,
+                windowStart + nBricksPerFrame * 2
+            );
+            trace[i].resize(nBricksPerFrame);
+            for (int& brick : trace[i]) {
+                brick = dist(generator);
+            }
+        }
+        return trace;
+    }
+
+    template <typename Function>
+    double measure(Function function) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    // The residency tracking as it was implemented in AtlasManager::updateAtlas
+    Result mapAndSet(const Trace& trace, unsigned int nAtlasSlots) {
+        std::map<unsigned int, unsigned int> brickMap;
+        std::vector<unsigned int> freeAtlasCoords(nAtlasSlots);
+        for (unsigned int i = 0; i < nAtlasSlots; ++i) {
+            freeAtlasCoords[i] = i;
+        }
+        std::set<unsigned int> requiredBricks;
+        std::set<unsigned int> prevRequiredBricks;
+        std::vector<unsigned int> atlasMap;
+
+        Result result;
+        result.milliseconds = measure([&]() {
+            for (const std::vector<int>& brickIndices : trace) {
+                requiredBricks.clear();
+                for (int brick : brickIndices) {
+                    requiredBricks.insert(brick);
+                }
+
+                for (unsigned int brick : prevRequiredBricks) {
+                    if (!requiredBricks.count(brick)) {
+                        freeAtlasCoords.push_back(brickMap[brick] & 0x0FFFFFFF);
+                        brickMap.erase(brick);
+                    }
+                }
+
+                for (unsigned int brick : requiredBricks) {
+                    if (!brickMap.count(brick)) {
+                        brickMap.emplace(brick, freeAtlasCoords.back());
+                        freeAtlasCoords.pop_back();
+                        result.nStreamedBricks++;
+                    }
+                }
+
+                atlasMap.resize(brickIndices.size());
+                for (size_t i = 0; i < brickIndices.size(); ++i) {
+                    atlasMap[i] = brickMap[brickIndices[i]];
+                }
+
+                std::swap(prevRequiredBricks, requiredBricks);
+            }
+        });
+        return result;
+    }
+
+    Result brickResidency(const Trace& trace, unsigned int nBricks,
+                          unsigned int nAtlasSlots)
+    {
+        openspace::BrickResidency residency;
+        residency.initialize(nBricks, nAtlasSlots);
+        std::vector<unsigned int> atlasMap;
+
+        Result result;
+        result.milliseconds = measure([&]() {
+            for (const std::vector<int>& brickIndices : trace) {
+                for (unsigned int brick : residency.update(brickIndices)) {
+                    residency.insert(brick, 0);
+                    result.nStreamedBricks++;
+                }
+
+                atlasMap.resize(brickIndices.size());
+                for (size_t i = 0; i < brickIndices.size(); ++i) {
+                    atlasMap[i] = residency.atlasData(brickIndices[i]);
+                }
+            }
+        });
+        return result;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    Trace trace;
+    if (argc > 1) {
+        trace = loadTrace(argv[1]);
+        if (trace.empty()) {
+            std::cerr << "Could not read brick trace from " << argv[1] << std::endl;
+            return 1;
+        }
+    }
+    else {
+        trace = syntheticTrace(1 << 21, 1 << 15, 200);
+    }
+
+    int maxBrick = 0;
+    size_t maxFrameSize = 0;
+    for (const std::vector<int>& frame : trace) {
+        maxBrick = std::max(maxBrick, *std::max_element(frame.begin(), frame.end()));
+        maxFrameSize = std::max(maxFrameSize, frame.size());
+    }
+    const unsigned int nBricks = static_cast<unsigned int>(maxBrick) + 1;
+    const unsigned int nAtlasSlots = static_cast<unsigned int>(maxFrameSize);
+
+    std::cout << "Frames: " << trace.size() << "  Bricks: " << nBricks
+              << "  Atlas slots: " << nAtlasSlots << std::endl;
+    std::cout << std::left << std::setw(16) << "Implementation" << std::right
+              << std::setw(14) << "Time [ms]" << std::setw(14) << "Streamed"
+              << std::endl;
+
+    const Result map = mapAndSet(trace, nAtlasSlots);
+    const Result residency = brickResidency(trace, nBricks, nAtlasSlots);
+
+    std::cout << std::left << std::setw(16) << "Map and set" << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14) << map.milliseconds
+              << std::setw(14) << map.nStreamedBricks << std::endl;
+    std::cout << std::left << std::setw(16) << "BrickResidency" << std::right
+              << std::fixed << std::setprecision(1) << std::setw(14)
+              << residency.milliseconds << std::setw(14) << residency.nStreamedBricks
+              << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+// Measures the throughput of the fieldline tracing in KameleonWrapper. Seed points are
+// placed on rings around the Earth in the equatorial plane of a BATSRUS model and the
+// magnetic field lines through them are traced on all threads of the global task
+// scheduler. The number of lines per second and the average number of points per line
+// are printed. The model file is not part of the repository; any BATSRUS CDF file with
+// the bx, by, and bz variables, for example from the CCMC, can be used.
+
+#include <openspace/engine/globals.h>
+#include <openspace/util/taskscheduler.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef OPENSPACE_MODULE_KAMELEON_ENABLED
+
+#include <modules/kameleon/include/kameleonwrapper.h>
+
+namespace {
+    constexpr const float Pi = 3.14159265358979f;
+
+    struct Result {
+        double seconds = 0.0;
+        size_t nPoints = 0;
+    };
+
+    std::vector<glm::vec3> seedPoints(int nRings, int nSeedsPerRing) {
+        std::vector<glm::vec3> seeds;
+        seeds.reserve(nRings * nSeedsPerRing);
+        for (int ring = 0; ring < nRings; ++ring) {
+            // Rings between 2 and 10 Earth radii cover both closed and open field lines
+            const float radius = 2.f + 8.f * ring / std::max(nRings - 1, 1);
+            for (int i = 0; i < nSeedsPerRing; ++i) {
+                const float angle = 2.f * Pi * i / nSeedsPerRing;
+                seeds.emplace_back(
+                    radius * std::cos(angle),
+                    radius * std::sin(angle),
+                    0.f
+                );
+            }
+        }
+        return seeds;
+    }
+
+    Result trace(const openspace::KameleonWrapper& kw,
+                 const std::vector<glm::vec3>& seeds, float stepSize)
+    {
+        auto start = std::chrono::steady_clock::now();
+        openspace::KameleonWrapper::Fieldlines lines = kw.classifiedFieldLines(
+            "bx",
+            "by",
+            "bz",
+            seeds,
+            stepSize
+        );
+        auto end = std::chrono::steady_clock::now();
+
+        Result result;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        for (const std::vector<openspace::LinePoint>& line : lines) {
+            result.nPoints += line.size();
+        }
+        return result;
+    }
+
+    void print(size_t nThreads, const Result& result, size_t nLines) {
+        std::cout << std::left << std::setw(16) << nThreads << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << nLines / result.seconds
+                  << std::setw(14)
+                  << static_cast<double>(result.nPoints) / std::max<size_t>(nLines, 1)
+                  << std::endl;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <BATSRUS CDF file> [number of seeds per ring] [step size]"
+                  << std::endl;
+        return 1;
+    }
+
+    const int nSeedsPerRing = argc > 2 ? std::stoi(argv[2]) : 64;
+    const float stepSize = argc > 3 ? std::stof(argv[3]) : 0.5f;
+    constexpr const int NRings = 8;
+
+    openspace::KameleonWrapper kw(argv[1]);
+    if (kw.model() != openspace::KameleonWrapper::Model::BATSRUS) {
+        std::cerr << argv[1] << " is not a BATSRUS model" << std::endl;
+        return 1;
+    }
+
+    const std::vector<glm::vec3> seeds = seedPoints(NRings, nSeedsPerRing);
+
+    // Warm-up to load the variables and to fill the file system caches
+    trace(kw, std::vector<glm::vec3>(seeds.begin(), seeds.begin() + 1), stepSize);
+
+    std::cout << "Seeds: " << seeds.size() << "  Step size: " << stepSize << std::endl;
+    std::cout << std::left << std::setw(16) << "Threads" << std::right
+              << std::setw(14) << "Lines/s" << std::setw(14) << "Points/line"
+              << std::endl;
+
+    // The tracing uses as many threads as the task scheduler has, including the calling
+    // thread, but never more than there are seed points
+    const size_t nThreads = std::min(
+        openspace::global::taskScheduler.numThreads(),
+        seeds.size()
+    );
+    const Result result = trace(kw, seeds, stepSize);
+    print(nThreads, result, seeds.size());
+
+    return 0;
+}
+
+#else // OPENSPACE_MODULE_KAMELEON_ENABLED
+
+int main() {
+    std::cerr << "The fieldline benchmark requires the Kameleon module" << std::endl;
+    return 1;
+}
+
+#endif // OPENSPACE_MODULE_KAMELEON_ENABLED
@@ -0,0 +1,187 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+// Compares PropertyOwner::property, which is served from the hashed URI index, against
+// the recursive search through the sub-owners that was used previously. A synthetic tree
+// with the shape of the default profile is built: every scene graph node owns a
+// transformation and a renderable, and some renderables own layers. Every URI in the
+// tree is then looked up repeatedly and the wall clock time is printed.
+
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalar/boolproperty.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    using namespace openspace::properties;
+
+    struct Tree {
+        std::unique_ptr<PropertyOwner> root;
+        std::vector<std::unique_ptr<PropertyOwner>> owners;
+        std::vector<std::unique_ptr<BoolProperty>> properties;
+        std::vector<std::string> uris;
+    };
+
+    PropertyOwner* addOwner(Tree& tree, PropertyOwner& parent, std::string identifier) {
+        tree.owners.push_back(
+            std::make_unique<PropertyOwner>(PropertyOwner::PropertyOwnerInfo{
+                std::move(identifier)
+            })
+        );
+        parent.addPropertySubOwner(tree.owners.back().get());
+        return tree.owners.back().get();
+    }
+
+    void addProperties(Tree& tree, PropertyOwner& owner, const std::string& prefix,
+                       int nProperties)
+    {
+        for (int i = 0; i < nProperties; ++i) {
+            const std::string identifier = "Property" + std::to_string(i);
+            tree.properties.push_back(std::make_unique<BoolProperty>(
+                Property::PropertyInfo{ identifier.c_str(), "", "" }
+            ));
+            owner.addProperty(tree.properties.back().get());
+            tree.uris.push_back(prefix + identifier);
+        }
+    }
+
+    Tree createTree(int nNodes) {
+        Tree tree;
+        tree.root = std::make_unique<PropertyOwner>(
+            PropertyOwner::PropertyOwnerInfo{ "" }
+        );
+
+        PropertyOwner* scene = addOwner(tree, *tree.root, "Scene");
+        for (int i = 0; i < nNodes; ++i) {
+            const std::string id = "Node" + std::to_string(i);
+            PropertyOwner* node = addOwner(tree, *scene, id);
+            addProperties(tree, *node, "Scene." + id + ".", 4);
+
+            PropertyOwner* transform = addOwner(tree, *node, "Transform");
+            addProperties(tree, *transform, "Scene." + id + ".Transform.", 2);
+
+            PropertyOwner* renderable = addOwner(tree, *node, "Renderable");
+            addProperties(tree, *renderable, "Scene." + id + ".Renderable.", 8);
+
+            if (i % 20 == 0) {
+                // Globes own a number of layer groups with layers
+                for (int j = 0; j < 5; ++j) {
+                    const std::string l = "Layer" + std::to_string(j);
+                    PropertyOwner* layer = addOwner(tree, *renderable, l);
+                    addProperties(
+                        tree,
+                        *layer,
+                        "Scene." + id + ".Renderable." + l + ".",
+                        10
+                    );
+                }
+            }
+        }
+        return tree;
+    }
+
+    // The recursive lookup that PropertyOwner::property used before the URI index
+    Property* recursiveProperty(const PropertyOwner& owner, const std::string& uri) {
+        for (Property* p : owner.properties()) {
+            if (p->identifier() == uri) {
+                return p;
+            }
+        }
+
+        const size_t ownerSeparator = uri.find(PropertyOwner::URISeparator);
+        if (ownerSeparator == std::string::npos) {
+            return nullptr;
+        }
+        const std::string ownerName = uri.substr(0, ownerSeparator);
+        const std::string propertyName = uri.substr(ownerSeparator + 1);
+        for (PropertyOwner* o : owner.propertySubOwners()) {
+            if (o->identifier() == ownerName) {
+                return recursiveProperty(*o, propertyName);
+            }
+        }
+        return nullptr;
+    }
+
+    template <typename Function>
+    double measure(Function function) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    int nNodes = 2000;
+    if (argc > 1) {
+        nNodes = std::max(std::atoi(argv[1]), 1);
+    }
+    constexpr const int NumRepetitions = 10;
+
+    Tree tree = createTree(nNodes);
+    std::cout << "Nodes: " << nNodes << "  Properties: " << tree.uris.size()
+              << std::endl;
+
+    // Build the index before the measurement and make sure both lookups agree
+    for (const std::string& uri : tree.uris) {
+        if (tree.root->property(uri) != recursiveProperty(*tree.root, uri)) {
+            std::cerr << "Mismatch for URI '" << uri << "'" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    size_t nFound = 0;
+    const double recursive = measure([&]() {
+        for (int i = 0; i < NumRepetitions; ++i) {
+            for (const std::string& uri : tree.uris) {
+                nFound += recursiveProperty(*tree.root, uri) != nullptr;
+            }
+        }
+    });
+    const double indexed = measure([&]() {
+        for (int i = 0; i < NumRepetitions; ++i) {
+            for (const std::string& uri : tree.uris) {
+                nFound += tree.root->property(std::string_view(uri)) != nullptr;
+            }
+        }
+    });
+
+    std::cout << std::left << std::setw(16) << "Lookup" << std::right
+              << std::setw(14) << "Time [ms]" << std::endl;
+    std::cout << std::left << std::setw(16) << "Recursive" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(14) << recursive << std::endl;
+    std::cout << std::left << std::setw(16) << "Indexed" << std::right << std::fixed
+              << std::setprecision(1) << std::setw(14) << indexed << std::endl;
+    std::cout << "Found: " << nFound << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,218 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+// Compares the TaskScheduler against a thread pool with a single shared queue, which is
+// how the previous ThreadPool and LRUThreadPool classes were implemented. Every scenario
+// is run with both implementations and the wall clock time is printed.
+
+#include <openspace/util/taskscheduler.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    // A single deque that is guarded by one mutex and condition variable
+    class SharedQueuePool {
+    public:
+        explicit SharedQueuePool(size_t nThreads) {
+            for (size_t i = 0; i < nThreads; ++i) {
+                _workers.emplace_back([this]() {
+                    while (true) {
+                        std::function<void()> task;
+                        {
+                            std::unique_lock lock(_mutex);
+                            _condition.wait(lock, [this]() {
+                                return _stop || !_tasks.empty();
+                            });
+                            if (_stop) {
+                                return;
+                            }
+                            task = std::move(_tasks.front());
+                            _tasks.pop_front();
+                        }
+                        task();
+                    }
+                });
+            }
+        }
+
+        ~SharedQueuePool() {
+            {
+                std::lock_guard lock(_mutex);
+                _stop = true;
+            }
+            _condition.notify_all();
+            for (std::thread& worker : _workers) {
+                worker.join();
+            }
+        }
+
+        void enqueue(std::function<void()> task) {
+            {
+                std::lock_guard lock(_mutex);
+                _tasks.push_back(std::move(task));
+            }
+            _condition.notify_one();
+        }
+
+    private:
+        std::vector<std::thread> _workers;
+        std::deque<std::function<void()>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _stop = false;
+    };
+
+    void waitFor(const std::atomic<size_t>& counter, size_t value) {
+        while (counter < value) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Simulates a small amount of work, such as decoding a part of a tile
+    void spin(size_t iterations) {
+        volatile size_t sum = 0;
+        for (size_t i = 0; i < iterations; ++i) {
+            sum = sum + i;
+        }
+    }
+
+    // Many tiny tasks that are all enqueued from the main thread
+    template <typename Enqueue>
+    void smallTasks(Enqueue enqueue) {
+        constexpr const size_t NumTasks = 200000;
+        std::atomic<size_t> nFinished = 0;
+        for (size_t i = 0; i < NumTasks; ++i) {
+            enqueue([&nFinished]() {
+                spin(100);
+                nFinished++;
+            });
+        }
+        waitFor(nFinished, NumTasks);
+    }
+
+    // Tasks that enqueue more tasks, like a recursive traversal of a tree
+    template <typename Enqueue>
+    void nestedTasks(Enqueue enqueue) {
+        constexpr const size_t Depth = 12;
+        constexpr const size_t NumTasks = (size_t(1) << (Depth + 1)) - 1;
+        std::atomic<size_t> nFinished = 0;
+        std::function<void(size_t)> node = [&](size_t level) {
+            spin(1000);
+            if (level < Depth) {
+                enqueue([&node, level]() { node(level + 1); });
+                enqueue([&node, level]() { node(level + 1); });
+            }
+            nFinished++;
+        };
+        enqueue([&node]() { node(0); });
+        waitFor(nFinished, NumTasks);
+    }
+
+    // A mix of tasks that block, like file reads, and tasks that compute
+    template <typename Enqueue>
+    void mixedTasks(Enqueue enqueue) {
+        constexpr const size_t NumTasks = 2000;
+        std::atomic<size_t> nFinished = 0;
+        for (size_t i = 0; i < NumTasks; ++i) {
+            if (i % 10 == 0) {
+                enqueue([&nFinished]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    nFinished++;
+                });
+            }
+            else {
+                enqueue([&nFinished]() {
+                    spin(20000);
+                    nFinished++;
+                });
+            }
+        }
+        waitFor(nFinished, NumTasks);
+    }
+
+    template <typename Function>
+    double measure(Function function) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    template <typename Scenario>
+    void runScenario(const std::string& name, size_t nThreads, Scenario scenario) {
+        double sharedQueue = 0.0;
+        {
+            SharedQueuePool pool(nThreads);
+            sharedQueue = measure([&]() {
+                scenario([&pool](std::function<void()> f) {
+                    pool.enqueue(std::move(f));
+                });
+            });
+        }
+
+        double scheduler = 0.0;
+        {
+            openspace::TaskScheduler taskScheduler(nThreads);
+            scheduler = measure([&]() {
+                scenario([&taskScheduler](std::function<void()> f) {
+                    taskScheduler.enqueue(std::move(f));
+                });
+            });
+        }
+
+        std::cout << std::left << std::setw(16) << name << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(14) << sharedQueue
+                  << std::setw(14) << scheduler << std::endl;
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t nThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    if (argc > 1) {
+        nThreads = std::max(std::atoi(argv[1]), 1);
+    }
+
+    std::cout << "Threads: " << nThreads << std::endl;
+    std::cout << std::left << std::setw(16) << "Scenario" << std::right
+              << std::setw(14) << "Shared [ms]" << std::setw(14) << "Stealing [ms]"
+              << std::endl;
+
+    runScenario("Small tasks", nThreads, [](auto enqueue) { smallTasks(enqueue); });
+    runScenario("Nested tasks", nThreads, [](auto enqueue) { nestedTasks(enqueue); });
+    runScenario("Mixed tasks", nThreads, [](auto enqueue) { mixedTasks(enqueue); });
+
+    return 0;
+}
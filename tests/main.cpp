@@ -66,15 +66,28 @@
 #include <test_documentation.inl>
 #include <test_luaconversions.inl>
 #include <test_optionproperty.inl>
+#include <test_propertyowner.inl>
 #include <test_scriptscheduler.inl>
+#include <test_sessionrecording.inl>
 #include <test_spicemanager.inl>
+#include <test_taskscheduler.inl>
 #include <test_timeline.inl>
+#include <test_uripattern.inl>
+
+#ifdef OPENSPACE_MODULE_FIELDLINESSEQUENCE_ENABLED
+#include <test_fieldlinesstate.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_GAIA_ENABLED
+#include <test_constructoctreetask.inl>
+#endif
 
 #ifdef OPENSPACE_MODULE_GLOBEBROWSING_ENABLED
 #include <test_angle.inl>
 #include <test_concurrentjobmanager.inl>
 #include <test_concurrentqueue.inl>
 #include <test_lrucache.inl>
+#include <test_priorityqueue.inl>
 #include <test_gdalwms.inl>
 #endif
 
@@ -82,8 +95,21 @@
 #include <test_screenspaceimage.inl>
 #endif
 
+#ifdef OPENSPACE_MODULE_KAMELEON_ENABLED
+#include <test_kameleonwrapper.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_MULTIRESVOLUME_ENABLED
+#include <test_brickresidency.inl>
+#endif
+
+#ifdef OPENSPACE_MODULE_SPACE_ENABLED
+#include <test_ephemeriscache.inl>
+#endif
+
 #ifdef OPENSPACE_MODULE_VOLUME_ENABLED
 #include <test_rawvolumeio.inl>
+#include <test_volumeutils.inl>
 #endif
 
 // Regression tests
@@ -21,33 +21,49 @@
  * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
  ****************************************************************************************/
+#include <modules/multiresvolume/rendering/brickresidency.h>
 
-#include <openspace/performance/performancemeasurement.h>
+class BrickResidencyTest : public testing::Test {};
 
-#include <openspace/engine/globals.h>
-#include <openspace/performance/performancemanager.h>
-#include <ghoul/opengl/ghoul_gl.h>
+TEST_F(BrickResidencyTest, MissingBricks) {
+    openspace::BrickResidency residency;
+    residency.initialize(16, 4);
 
-namespace openspace::performance {
-
-PerformanceMeasurement::PerformanceMeasurement(std::string identifier)
-    : _identifier(std::move(identifier))
-{
-    glFinish();
-    _startTime = std::chrono::high_resolution_clock::now();
+    const std::vector<unsigned int>& missing = residency.update({ 7, 3, 3, 5, 7 });
+    ASSERT_EQ(missing.size(), 3) << "Duplicate bricks should be reported once";
+    EXPECT_EQ(missing[0], 3);
+    EXPECT_EQ(missing[1], 5);
+    EXPECT_EQ(missing[2], 7);
+    EXPECT_EQ(residency.numRequiredBricks(), 3);
 }
 
-PerformanceMeasurement::~PerformanceMeasurement() {
-    glFinish();
-    auto endTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
-        endTime - _startTime
-    ).count();
-
-    global::performanceManager.storeIndividualPerformanceMeasurement(
-        std::move(_identifier),
-        duration
-    );
+TEST_F(BrickResidencyTest, InsertAndEvict) {
+    openspace::BrickResidency residency;
+    residency.initialize(16, 2);
+
+    residency.update({ 1, 2 });
+    const unsigned int data = residency.insert(1, 3);
+    residency.insert(2, 0);
+    EXPECT_TRUE(residency.isResident(1));
+    EXPECT_EQ(data >> 28, 3) << "The level should be stored in the upper bits";
+    EXPECT_EQ(residency.atlasData(1), data);
+
+    // Brick 1 is not required anymore, so its slot can be reused by brick 4
+    const std::vector<unsigned int>& missing = residency.update({ 2, 4 });
+    EXPECT_FALSE(residency.isResident(1));
+    EXPECT_EQ(residency.atlasData(1), openspace::BrickResidency::NotResident);
+    ASSERT_EQ(missing.size(), 1);
+    EXPECT_EQ(missing[0], 4);
+    EXPECT_EQ(residency.insert(4, 0) & 0x0FFFFFFF, data & 0x0FFFFFFF);
+    EXPECT_EQ(residency.numResidentBricks(), 2);
 }
 
-} // namespace openspace::performance
+TEST_F(BrickResidencyTest, OutOfRangeBricks) {
+    openspace::BrickResidency residency;
+    residency.initialize(4, 4);
+
+    const std::vector<unsigned int>& missing = residency.update({ -1, 2, 4 });
+    ASSERT_EQ(missing.size(), 1);
+    EXPECT_EQ(missing[0], 2);
+    EXPECT_EQ(residency.atlasData(4), openspace::BrickResidency::NotResident);
+}
@@ -0,0 +1,173 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/gaia/rendering/octreemanager.h>
+#include <modules/gaia/tasks/constructoctreetask.h>
+#include <ghoul/filesystem/directory.h>
+#include <ghoul/filesystem/file.h>
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/misc/dictionary.h>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+namespace {
+    constexpr const int32_t NValuesPerStar = 8;
+    constexpr const int NStars = 20000;
+    constexpr const double MaxDist = 10.0;
+    constexpr const double MaxStarsPerNode = 64.0;
+
+    // Random stars within a few kiloparsecs that only consist of their render values
+    std::vector<float> createStars() {
+        std::mt19937 random(1337);
+        std::uniform_real_distribution<float> position(-4.f, 4.f);
+        std::uniform_real_distribution<float> magnitude(2.f, 20.f);
+        std::uniform_real_distribution<float> color(-1.f, 4.f);
+        std::uniform_real_distribution<float> velocity(-100.f, 100.f);
+
+        std::vector<float> stars;
+        stars.reserve(NStars * NValuesPerStar);
+        for (int i = 0; i < NStars; ++i) {
+            stars.push_back(position(random));
+            stars.push_back(position(random));
+            stars.push_back(position(random));
+            stars.push_back(magnitude(random));
+            stars.push_back(color(random));
+            stars.push_back(velocity(random));
+            stars.push_back(velocity(random));
+            stars.push_back(velocity(random));
+        }
+        return stars;
+    }
+
+    std::vector<char> readFile(const std::string& path) {
+        std::ifstream file(path, std::ifstream::binary);
+        return std::vector<char>(
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        );
+    }
+
+    void constructOctree(const std::string& inPath, const std::string& outPath,
+                         bool singleFileInput, bool parallelBuild)
+    {
+        ghoul::Dictionary dictionary {
+            { "Type", std::string("ConstructOctreeTask") },
+            { "InFileOrFolderPath", inPath },
+            { "OutFileOrFolderPath", outPath },
+            { "MaxDist", MaxDist },
+            { "MaxStarsPerNode", MaxStarsPerNode },
+            { "SingleFileInput", singleFileInput },
+            { "ParallelBuild", parallelBuild },
+            { "NumThreads", 4.0 }
+        };
+        openspace::ConstructOctreeTask task(dictionary);
+        task.perform([](float) {});
+    }
+} // namespace
+
+class ConstructOctreeTaskTest : public testing::Test {};
+
+TEST_F(ConstructOctreeTaskTest, ParallelSingleFile) {
+    const std::vector<float> stars = createStars();
+
+    const std::string inPath = absPath("${TESTDIR}/gaiastars.bin");
+    {
+        std::ofstream file(inPath, std::ofstream::binary);
+        const int32_t nValues = static_cast<int32_t>(stars.size());
+        file.write(reinterpret_cast<const char*>(&nValues), sizeof(int32_t));
+        file.write(reinterpret_cast<const char*>(&NValuesPerStar), sizeof(int32_t));
+        file.write(
+            reinterpret_cast<const char*>(stars.data()),
+            stars.size() * sizeof(float)
+        );
+    }
+
+    const std::string serialPath = absPath("${TESTDIR}/gaiaoctree_serial.bin");
+    const std::string parallelPath = absPath("${TESTDIR}/gaiaoctree_parallel.bin");
+    constructOctree(inPath, serialPath, true, false);
+    constructOctree(inPath, parallelPath, true, true);
+
+    const std::vector<char> serial = readFile(serialPath);
+    const std::vector<char> parallel = readFile(parallelPath);
+    ASSERT_FALSE(serial.empty());
+    EXPECT_TRUE(serial == parallel);
+}
+
+TEST_F(ConstructOctreeTaskTest, ParallelFolder) {
+    using ghoul::filesystem::FileSystem;
+
+    const std::vector<float> stars = createStars();
+
+    // Distribute the stars into one file per branch like ReadFitsTask does
+    openspace::OctreeManager octree;
+    octree.initOctree(0, static_cast<int>(MaxDist), static_cast<int>(MaxStarsPerNode));
+    std::array<std::vector<float>, 8> branches;
+    for (size_t i = 0; i < stars.size(); i += NValuesPerStar) {
+        const size_t branch = octree.branchIndex(stars[i], stars[i + 1], stars[i + 2]);
+        branches[branch].insert(
+            branches[branch].end(),
+            stars.begin() + i,
+            stars.begin() + i + NValuesPerStar
+        );
+    }
+
+    const std::string inFolder = absPath("${TESTDIR}/gaiastars/");
+    const std::string serialFolder = absPath("${TESTDIR}/gaiaoctree_serial/");
+    const std::string parallelFolder = absPath("${TESTDIR}/gaiaoctree_parallel/");
+    for (const std::string& folder : { inFolder, serialFolder, parallelFolder }) {
+        FileSys.createDirectory(folder, FileSystem::Recursive::Yes);
+    }
+
+    for (size_t branch = 0; branch < 8; ++branch) {
+        const std::string path = inFolder + "octant_" + std::to_string(branch) + ".bin";
+        std::ofstream file(path, std::ofstream::binary);
+        file.write(reinterpret_cast<const char*>(&NValuesPerStar), sizeof(int32_t));
+        file.write(
+            reinterpret_cast<const char*>(branches[branch].data()),
+            branches[branch].size() * sizeof(float)
+        );
+    }
+
+    constructOctree(inFolder, serialFolder, false, false);
+    constructOctree(inFolder, parallelFolder, false, true);
+
+    // Every node file and the index file have to be identical
+    const std::vector<std::string> serialFiles =
+        ghoul::filesystem::Directory(serialFolder).readFiles();
+    const std::vector<std::string> parallelFiles =
+        ghoul::filesystem::Directory(parallelFolder).readFiles();
+    ASSERT_GT(serialFiles.size(), 8);
+    EXPECT_EQ(serialFiles.size(), parallelFiles.size());
+    for (const std::string& path : serialFiles) {
+        const std::string name = ghoul::filesystem::File(path).filename();
+        const std::vector<char> serial = readFile(path);
+        const std::vector<char> parallel = readFile(parallelFolder + name);
+        EXPECT_FALSE(serial.empty()) << name;
+        EXPECT_TRUE(serial == parallel) << name;
+    }
+}
@@ -0,0 +1,102 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/space/ephemeriscache.h>
+
+#include <ghoul/misc/exception.h>
+#include <atomic>
+#include <cmath>
+
+class EphemerisCacheTest : public testing::Test {
+protected:
+    // Requests the cells around the time, waits for them to be fitted and evaluates
+    bool waitForCoverage(openspace::EphemerisCache& cache, double time, double* values) {
+        cache.evaluate(time, values);
+        cache.waitForPendingFits();
+        return cache.evaluate(time, values);
+    }
+};
+
+TEST_F(EphemerisCacheTest, Orbit) {
+    using namespace openspace;
+
+    // A circular orbit with a period of ten days and a radius of 4e8 meters
+    auto orbit = [](double time, double* values) {
+        const double angle = 2.0 * 3.141592653589793 * time / (10.0 * 86400.0);
+        values[0] = 4e8 * std::cos(angle);
+        values[1] = 4e8 * std::sin(angle);
+        values[2] = 0.0;
+    };
+
+    EphemerisCache cache(3, 1.0);
+    cache.setFunction(orbit);
+
+    const double start = 3.25 * 86400.0;
+    double values[3];
+    ASSERT_TRUE(waitForCoverage(cache, start, values));
+
+    // The neighbouring cells are fitted together with the first one
+    for (double time = start; time < start + 86400.0; time += 977.0) {
+        double expected[3];
+        orbit(time, expected);
+        double errorBound = -1.0;
+        ASSERT_TRUE(cache.evaluate(time, values, &errorBound));
+        EXPECT_LE(errorBound, 1.0);
+        for (int c = 0; c < 3; ++c) {
+            EXPECT_NEAR(values[c], expected[c], 1.0);
+        }
+    }
+}
+
+TEST_F(EphemerisCacheTest, Uncovered) {
+    using namespace openspace;
+
+    // The function is only defined for positive times
+    std::atomic<int> nUndefinedCalls = 0;
+    auto function = [&nUndefinedCalls](double time, double* values) {
+        if (time < 0.0) {
+            ++nUndefinedCalls;
+            throw ghoul::RuntimeError("Outside of coverage");
+        }
+        values[0] = time;
+    };
+
+    EphemerisCache cache(1, 1e-6);
+    cache.setFunction(function);
+
+    double value;
+    ASSERT_TRUE(waitForCoverage(cache, 0.5 * 86400.0, &value));
+    EXPECT_NEAR(value, 0.5 * 86400.0, 1e-6);
+
+    // The cells before the start were fitted together with the first one, which failed,
+    // so they remain uncovered
+    EXPECT_GT(nUndefinedCalls.load(), 0);
+    EXPECT_FALSE(cache.evaluate(-0.5 * 86400.0, &value));
+
+    // Replacing the function drops the cached values
+    cache.setFunction(nullptr);
+    EXPECT_FALSE(cache.evaluate(0.5 * 86400.0, &value));
+}
@@ -0,0 +1,119 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/fieldlinessequence/util/fieldlinesstate.h>
+
+#include <ghoul/filesystem/filesystem.h>
+#include <ghoul/glm.h>
+#include <algorithm>
+#include <cmath>
+
+class FieldlinesStateTest : public testing::Test {
+protected:
+    openspace::FieldlinesState createState() {
+        using namespace openspace;
+
+        FieldlinesState state;
+        std::vector<glm::vec3> line0 = { { 1.f, 2.f, 3.f }, { 4.f, 5.f, -6.f } };
+        std::vector<glm::vec3> line1 = {
+            { 0.f, 0.f, 0.f }, { -10.f, 10.f, 3.f }, { 7.f, 8.f, 9.f }
+        };
+        state.addLine(line0);
+        state.addLine(line1);
+        state.setExtraQuantityNames({ "rho", "T" });
+        for (int i = 0; i < 5; ++i) {
+            state.appendToExtra(0, static_cast<float>(i));
+            state.appendToExtra(1, 1000.f * i);
+        }
+        state.setTriggerTime(42.0);
+        state.setModel(fls::Model::Enlil);
+        return state;
+    }
+
+    // Compares the states with a tolerance that is relative to the range of the values
+    // in each axis of the positions and in each of the extra quantities
+    void compareStates(const openspace::FieldlinesState& expected,
+                       const openspace::FieldlinesState& actual, float relativeTolerance)
+    {
+        ASSERT_EQ(actual.triggerTime(), expected.triggerTime());
+        ASSERT_EQ(actual.model(), expected.model());
+        ASSERT_EQ(actual.lineStart(), expected.lineStart());
+        ASSERT_EQ(actual.lineCount(), expected.lineCount());
+        ASSERT_EQ(actual.extraQuantityNames(), expected.extraQuantityNames());
+
+        const std::vector<glm::vec3>& positions = expected.vertexPositions();
+        ASSERT_EQ(actual.vertexPositions().size(), positions.size());
+        for (int c = 0; c < 3; ++c) {
+            const auto [min, max] = std::minmax_element(
+                positions.begin(),
+                positions.end(),
+                [c](const glm::vec3& a, const glm::vec3& b) { return a[c] < b[c]; }
+            );
+            const float tolerance = relativeTolerance * ((*max)[c] - (*min)[c]);
+            for (size_t i = 0; i < positions.size(); ++i) {
+                EXPECT_NEAR(actual.vertexPositions()[i][c], positions[i][c], tolerance);
+            }
+        }
+
+        ASSERT_EQ(actual.extraQuantities().size(), expected.extraQuantities().size());
+        for (size_t e = 0; e < expected.extraQuantities().size(); ++e) {
+            const std::vector<float>& values = expected.extraQuantities()[e];
+            ASSERT_EQ(actual.extraQuantities()[e].size(), values.size());
+            const auto [min, max] = std::minmax_element(values.begin(), values.end());
+            const float tolerance = relativeTolerance * (*max - *min);
+            for (size_t i = 0; i < values.size(); ++i) {
+                EXPECT_NEAR(actual.extraQuantities()[e][i], values[i], tolerance);
+            }
+        }
+    }
+};
+
+TEST_F(FieldlinesStateTest, OsflsInputOutput) {
+    using namespace openspace;
+
+    const FieldlinesState state = createState();
+    const std::string path = absPath("${TESTDIR}/fieldlinesstate.osfls");
+    ASSERT_TRUE(state.writeStateToOsfls(path));
+
+    FieldlinesState stored;
+    ASSERT_TRUE(stored.loadStateFromOsfls(path));
+    compareStates(state, stored, 0.f);
+}
+
+TEST_F(FieldlinesStateTest, QuantizedOsflsInputOutput) {
+    using namespace openspace;
+
+    const FieldlinesState state = createState();
+    const std::string path = absPath("${TESTDIR}/quantizedfieldlinesstate.osfls");
+    ASSERT_TRUE(state.writeStateToOsfls(path, true, true));
+
+    FieldlinesState stored;
+    ASSERT_TRUE(stored.loadStateFromOsfls(path));
+    // Each axis of the positions and each extra quantity is quantized to 65535 steps of
+    // its own range. The values are within half a step, a full step leaves a margin for
+    // the rounding of the dequantized floats
+    compareStates(state, stored, 1.f / 65535.f);
+}
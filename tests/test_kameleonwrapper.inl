@@ -0,0 +1,148 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/kameleon/include/kameleonwrapper.h>
+#include <cmath>
+
+namespace {
+    // A fixed grid cell size for the analytic fields, in Earth radii
+    constexpr const float CellSize = 0.25f;
+    constexpr const float StepSize = 0.5f;
+
+    // The field of a dipole at the origin whose moment points to -Z, like the Earth's.
+    // Its fieldlines are given by r = L * sin^2(theta), where theta is the colatitude
+    // and L is the distance at which the line crosses the equatorial plane
+    glm::vec3 dipoleField(const glm::vec3& p, glm::vec3* cellSize) {
+        if (cellSize) {
+            *cellSize = glm::vec3(CellSize);
+        }
+        const glm::vec3 m = glm::vec3(0.f, 0.f, -1.f);
+        const float r = glm::length(p);
+        const glm::vec3 n = p / r;
+        return (3.f * glm::dot(m, n) * n - m) / (r * r * r);
+    }
+
+    bool isInsideDomain(const glm::vec3& p) {
+        return glm::all(glm::lessThan(glm::abs(p), glm::vec3(20.f))) &&
+               glm::dot(p, p) >= 1.f;
+    }
+
+    // Returns the radial distance of p to the dipole fieldline with the parameter l
+    float fieldlineDistance(const glm::vec3& p, float l) {
+        const float r = glm::length(p);
+        return std::abs(r - l * (p.x * p.x + p.y * p.y) / (r * r));
+    }
+} // namespace
+
+class KameleonWrapperTest : public testing::Test {};
+
+TEST_F(KameleonWrapperTest, DipoleFieldline) {
+    using Wrapper = openspace::KameleonWrapper;
+
+    for (float l : { 3.f, 5.f, 8.f }) {
+        for (float angle : { 0.f, 1.f, 2.5f, 4.f }) {
+            const glm::vec3 seed = l * glm::vec3(std::cos(angle), std::sin(angle), 0.f);
+
+            const std::vector<glm::vec3> forward = Wrapper::integrateFieldline(
+                dipoleField,
+                isInsideDomain,
+                seed,
+                StepSize,
+                Wrapper::TraceDirection::FORWARD
+            );
+            const std::vector<glm::vec3> back = Wrapper::integrateFieldline(
+                dipoleField,
+                isInsideDomain,
+                seed,
+                StepSize,
+                Wrapper::TraceDirection::BACK
+            );
+            ASSERT_GT(forward.size(), 2);
+            ASSERT_GT(back.size(), 2);
+
+            // All points have to stay on the analytic fieldline. The error of every step
+            // is kept below 1e-3 cells, so a tenth of a cell leaves a wide margin for
+            // the accumulated error
+            constexpr const float MaxDistance = 0.1f * CellSize;
+            float length = 0.f;
+            for (size_t i = 0; i < forward.size(); ++i) {
+                EXPECT_LT(fieldlineDistance(forward[i], l), MaxDistance);
+                if (i + 1 < forward.size()) {
+                    length += glm::distance(forward[i], forward[i + 1]);
+                }
+            }
+            for (const glm::vec3& p : back) {
+                EXPECT_LT(fieldlineDistance(p, l), MaxDistance);
+            }
+
+            // The field points north in the equatorial plane, so the forward line ends in
+            // the northern and the backward line in the southern hemisphere, mirrored at
+            // the equator
+            const glm::vec3& forwardEnd = forward.back();
+            const glm::vec3& backEnd = back.back();
+            EXPECT_GT(forwardEnd.z, 0.f);
+            EXPECT_LT(backEnd.z, 0.f);
+            EXPECT_LT(glm::length(forwardEnd), 1.f);
+            EXPECT_LT(glm::length(backEnd), 1.f);
+            EXPECT_NEAR(forwardEnd.z, -backEnd.z, MaxDistance);
+
+            // Where the field is smooth, the steps grow beyond the initial step size, so
+            // fewer points are needed than with a fixed step size
+            EXPECT_LT(forward.size(), length / (StepSize * CellSize));
+        }
+    }
+}
+
+TEST_F(KameleonWrapperTest, UniformField) {
+    using Wrapper = openspace::KameleonWrapper;
+
+    auto field = [](const glm::vec3&, glm::vec3* cellSize) {
+        if (cellSize) {
+            *cellSize = glm::vec3(CellSize);
+        }
+        return glm::vec3(0.f, 0.f, 2.f);
+    };
+
+    const glm::vec3 seed = glm::vec3(5.f, 0.f, 0.f);
+    const std::vector<glm::vec3> line = Wrapper::integrateFieldline(
+        field,
+        isInsideDomain,
+        seed,
+        StepSize,
+        Wrapper::TraceDirection::BACK
+    );
+
+    // A straight line is integrated without error, so the step size grows to its
+    // maximum of eight times the initial step size and the line leaves the domain
+    ASSERT_GT(line.size(), 2);
+    for (size_t i = 0; i < line.size(); ++i) {
+        EXPECT_FLOAT_EQ(line[i].x, seed.x);
+        EXPECT_FLOAT_EQ(line[i].y, seed.y);
+    }
+    EXPECT_LT(line.back().z, -20.f);
+    const float lastStep = line[line.size() - 2].z - line.back().z;
+    EXPECT_FLOAT_EQ(lastStep, 8.f * StepSize * CellSize);
+}
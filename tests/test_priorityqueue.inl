@@ -0,0 +1,93 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/globebrowsing/src/priorityqueue.h>
+
+#include <string>
+
+class PriorityQueueTest : public testing::Test {};
+
+namespace {
+    struct PriorityQueueHasher {
+        unsigned long long operator()(const int& var) const {
+            return static_cast<unsigned long long>(var);
+        }
+    };
+
+    using Queue = openspace::globebrowsing::PriorityQueue<
+        int, std::string, PriorityQueueHasher
+    >;
+} // namespace
+
+TEST_F(PriorityQueueTest, PopOrder) {
+    Queue queue;
+    queue.push(1, "low", 1.f);
+    queue.push(2, "high", 10.f);
+    queue.push(3, "medium", 5.f);
+    queue.push(4, "medium, but newer", 5.f);
+
+    ASSERT_EQ(queue.size(), 4);
+    EXPECT_EQ(queue.pop().value, "high");
+    EXPECT_EQ(queue.pop().value, "medium, but newer");
+    EXPECT_EQ(queue.pop().value, "medium");
+    EXPECT_EQ(queue.pop().value, "low");
+    EXPECT_TRUE(queue.isEmpty());
+}
+
+TEST_F(PriorityQueueTest, Reprioritize) {
+    Queue queue;
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i, std::to_string(i), static_cast<float>(i));
+    }
+
+    EXPECT_TRUE(queue.setPriority(2, 100.f));
+    EXPECT_TRUE(queue.setPriority(9, -1.f));
+    EXPECT_FALSE(queue.setPriority(42, 1.f)) << "Key 42 was never pushed";
+
+    EXPECT_EQ(queue.pop().key, 2);
+    EXPECT_EQ(queue.pop().key, 8);
+    EXPECT_EQ(queue.lowestPriority(), -1.f);
+    EXPECT_EQ(queue.popLowest().key, 9);
+    EXPECT_EQ(queue.popLowest().key, 0);
+}
+
+TEST_F(PriorityQueueTest, Erase) {
+    Queue queue;
+    for (int i = 0; i < 10; ++i) {
+        queue.push(i, std::to_string(i), static_cast<float>(i));
+    }
+
+    EXPECT_TRUE(queue.erase(9));
+    EXPECT_TRUE(queue.erase(4));
+    EXPECT_FALSE(queue.erase(4)) << "Key 4 was already erased";
+    EXPECT_FALSE(queue.contains(4));
+
+    const int expected[] = { 8, 7, 6, 5, 3, 2, 1, 0 };
+    for (int key : expected) {
+        EXPECT_EQ(queue.pop().key, key);
+    }
+    EXPECT_TRUE(queue.isEmpty());
+}
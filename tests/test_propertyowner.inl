@@ -0,0 +1,144 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/scalar/boolproperty.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PropertyOwnerTest : public testing::Test {};
+
+TEST_F(PropertyOwnerTest, IndexedLookup) {
+    using namespace openspace::properties;
+
+    PropertyOwner root({ "Root" });
+    PropertyOwner a({ "A" });
+    PropertyOwner b({ "B" });
+    BoolProperty p({ "P", "", "" });
+    BoolProperty q({ "Q", "", "" });
+    root.addPropertySubOwner(a);
+    a.addPropertySubOwner(b);
+    b.addProperty(p);
+
+    EXPECT_EQ(root.property("A.B.P"), &p);
+    EXPECT_EQ(a.property("B.P"), &p);
+    EXPECT_EQ(b.property("P"), &p);
+    EXPECT_EQ(root.property("A.B.Q"), nullptr);
+
+    // Changes after the index has been built
+    b.addProperty(q);
+    EXPECT_EQ(root.property("A.B.Q"), &q);
+    b.removeProperty(p);
+    EXPECT_EQ(root.property("A.B.P"), nullptr);
+    b.setIdentifier("C");
+    EXPECT_EQ(root.property("A.C.Q"), &q);
+    EXPECT_EQ(root.property("A.B.Q"), nullptr);
+    a.removePropertySubOwner(b);
+    EXPECT_EQ(root.property("A.C.Q"), nullptr);
+    EXPECT_EQ(b.property("Q"), &q);
+
+    b.removeProperty(q);
+}
+
+TEST_F(PropertyOwnerTest, DestroyedSubOwner) {
+    using namespace openspace::properties;
+
+    PropertyOwner root({ "Root" });
+    PropertyOwner a({ "A" });
+    root.addPropertySubOwner(a);
+
+    {
+        PropertyOwner b({ "B" });
+        BoolProperty p({ "P", "", "" });
+        a.addPropertySubOwner(b);
+        b.addProperty(p);
+        EXPECT_EQ(root.property("A.B.P"), &p);
+
+        // The property is destroyed first, as for properties that are members of a class
+        // derived from PropertyOwner
+    }
+
+    // The destroyed owner is neither in the index nor a sub-owner anymore
+    EXPECT_TRUE(a.propertySubOwners().empty());
+    EXPECT_EQ(root.property("A.B.P"), nullptr);
+
+    // A new owner with the same URI is found instead of the destroyed one
+    PropertyOwner b({ "B" });
+    BoolProperty p({ "P", "", "" });
+    a.addPropertySubOwner(b);
+    b.addProperty(p);
+    EXPECT_EQ(root.property("A.B.P"), &p);
+    b.removeProperty(p);
+}
+
+TEST_F(PropertyOwnerTest, ConcurrentLookups) {
+    using namespace openspace::properties;
+
+    constexpr const int NOwners = 1000;
+    PropertyOwner root({ "Root" });
+    std::vector<std::unique_ptr<PropertyOwner>> owners;
+    std::vector<std::unique_ptr<BoolProperty>> properties;
+    for (int i = 0; i < NOwners; ++i) {
+        owners.push_back(std::make_unique<PropertyOwner>(
+            PropertyOwner::PropertyOwnerInfo{ "Owner" + std::to_string(i) }
+        ));
+        root.addPropertySubOwner(owners.back().get());
+        properties.push_back(std::make_unique<BoolProperty>(
+            Property::PropertyInfo{ "P", "", "" }
+        ));
+        owners.back()->addProperty(properties.back().get());
+    }
+
+    // Renaming drops the index, so it is rebuilt by whichever thread looks up a property
+    // first while the other threads are looking up properties as well
+    root.setIdentifier("Root");
+    std::atomic<bool> start = false;
+    std::atomic<int> nFound = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            while (!start) {
+                std::this_thread::yield();
+            }
+            for (int i = 0; i < NOwners; ++i) {
+                const std::string uri = "Owner" + std::to_string(i) + ".P";
+                if (root.property(uri) == properties[i].get()) {
+                    ++nFound;
+                }
+            }
+        });
+    }
+    start = true;
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(nFound, 4 * NOwners);
+
+    for (int i = 0; i < NOwners; ++i) {
+        owners[i]->removeProperty(properties[i].get());
+    }
+}
@@ -27,6 +27,8 @@
 #include <openspace/util/timeline.h>
 #include <openspace/util/time.h>
 
+#include <modules/volume/brickedrawvolume.h>
+#include <modules/volume/mappedrawvolume.h>
 #include <modules/volume/rawvolume.h>
 #include <modules/volume/rawvolumereader.h>
 #include <modules/volume/rawvolumewriter.h>
@@ -85,3 +87,54 @@ TEST_F(RawVolumeIoTest, BasicInputOutput) {
         ASSERT_EQ(v, value(x));
     });
 }
+
+TEST_F(RawVolumeIoTest, BrickedInputOutput) {
+    using namespace openspace::volume;
+
+    // The dimensions are not a multiple of the brick size to test the partial bricks
+    glm::uvec3 dims{ 5, 7, 9 };
+    auto value = [](glm::uvec3 v) {
+        return v.z < 4 ? 0.f : static_cast<float>(v.x * 100 + v.y * 10 + v.z);
+    };
+
+    RawVolume<float> vol(dims);
+    vol.forEachVoxel([&vol, &value](glm::uvec3 x, float) { vol.set(x, value(x)); });
+
+    std::string volumePath = absPath("${TESTDIR}/brickedvolume.rawvolume");
+
+    RawVolumeWriter<float> writer(volumePath);
+    writer.writeBricked(vol, 4);
+    ASSERT_TRUE(isBrickedVolume(volumePath));
+
+    BrickedRawVolume<float> bricked(volumePath, 2);
+    ASSERT_EQ(bricked.nBricks(), 2 * 2 * 3);
+    vol.forEachVoxel([&bricked](glm::uvec3 x, float v) {
+        ASSERT_EQ(bricked.get(x), v);
+    });
+
+    // The reader decompresses bricked volumes transparently
+    RawVolumeReader<float> reader(volumePath, dims);
+    std::unique_ptr<RawVolume<float>> storedVolume = reader.read();
+    vol.forEachVoxel([&storedVolume](glm::uvec3 x, float v) {
+        ASSERT_EQ(storedVolume->get(x), v);
+    });
+}
+
+TEST_F(RawVolumeIoTest, MappedInput) {
+    using namespace openspace::volume;
+
+    glm::uvec3 dims{ 2, 4, 8 };
+    RawVolume<float> vol(dims);
+    vol.forEachVoxel([&vol](glm::uvec3 x, float) {
+        vol.set(x, static_cast<float>(x.x + x.y * 2 + x.z * 8));
+    });
+
+    std::string volumePath = absPath("${TESTDIR}/mappedvolume.rawvolume");
+    RawVolumeWriter<float> writer(volumePath);
+    writer.write(vol);
+
+    MappedRawVolume<float> mapped(volumePath, dims);
+    vol.forEachVoxel([&mapped](glm::uvec3 x, float v) {
+        ASSERT_EQ(mapped.get(x), v);
+    });
+}
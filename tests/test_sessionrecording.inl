@@ -0,0 +1,390 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/interaction/sessionrecording.h>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+    using SessionRecording = openspace::interaction::SessionRecording;
+    using RecordedType = SessionRecording::RecordedType;
+    using RecordingIndexEntry = SessionRecording::RecordingIndexEntry;
+    using Entry = SessionRecording::KeyframeBlock::Entry;
+
+    constexpr const size_t HeaderSize = 16;
+    constexpr const int NKeyframes = 25;
+    constexpr const uint64_t KeyframesPerBlock = 4;
+
+    template <typename T>
+    void write(std::ostream& stream, T value) {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    double recordedTime(int i) {
+        return 0.5 * i;
+    }
+
+    // Every 7th keyframe changes the time, every 5th runs a script, and all others move
+    // the camera
+    RecordedType keyframeType(int i) {
+        if (i % 7 == 6) {
+            return RecordedType::Time;
+        }
+        else if (i % 5 == 4) {
+            return RecordedType::Script;
+        }
+        else {
+            return RecordedType::Camera;
+        }
+    }
+
+    // Writes the keyframe in the layout of SessionRecording's binary recordings
+    void writeKeyframe(std::ostream& stream, int i) {
+        const double timeOs = 100.0 + recordedTime(i);
+        const double timeRec = recordedTime(i);
+        const double timeSim = 1000.0 + recordedTime(i);
+
+        switch (keyframeType(i)) {
+            case RecordedType::Camera: {
+                const std::string focus = "Node" + std::to_string(i);
+                write(stream, 'c');
+                write(stream, timeOs);
+                write(stream, timeRec);
+                write(stream, timeSim);
+                write(stream, glm::dvec3(i, 2.0 * i, 3.0 * i));
+                write(stream, glm::dquat(1.0, 0.0, 0.0, 0.0));
+                write(stream, static_cast<unsigned char>(1));
+                write(stream, static_cast<int>(focus.size()));
+                stream.write(focus.data(), focus.size());
+                write(stream, 1.f);
+                write(stream, timeOs);
+                break;
+            }
+            case RecordedType::Time:
+                write(stream, 't');
+                write(stream, timeOs);
+                write(stream, timeRec);
+                write(stream, timeSim);
+                write(stream, 60.0);
+                write(stream, static_cast<unsigned char>(0));
+                write(stream, static_cast<unsigned char>(1));
+                break;
+            case RecordedType::Script: {
+                const std::string script =
+                    "openspace.printInfo(" + std::to_string(i) + ")";
+                write(stream, 's');
+                write(stream, timeOs);
+                write(stream, timeRec);
+                write(stream, timeSim);
+                write(stream, script.size());
+                stream.write(script.data(), script.size());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Creates a binary recording and returns the index that was written, if any
+    std::vector<std::byte> createRecording(bool withIndex,
+                                           std::vector<RecordingIndexEntry>* index)
+    {
+        std::stringstream stream;
+        stream << std::string(HeaderSize, 'H');
+
+        std::vector<RecordingIndexEntry> blocks;
+        for (int i = 0; i < NKeyframes; ++i) {
+            if (blocks.empty() || blocks.back().nEntries == KeyframesPerBlock) {
+                RecordingIndexEntry entry;
+                entry.offset = static_cast<uint64_t>(stream.tellp());
+                entry.size = 0;
+                entry.nEntries = 0;
+                entry.timeOs = 100.0 + recordedTime(i);
+                entry.timeRec = recordedTime(i);
+                entry.timeSim = 1000.0 + recordedTime(i);
+                blocks.push_back(entry);
+            }
+            blocks.back().nEntries++;
+            writeKeyframe(stream, i);
+        }
+
+        if (withIndex) {
+            SessionRecording::writeRecordingIndex(stream, blocks);
+            if (index) {
+                *index = blocks;
+            }
+        }
+
+        const std::string content = stream.str();
+        const std::byte* begin = reinterpret_cast<const std::byte*>(content.data());
+        return std::vector<std::byte>(begin, begin + content.size());
+    }
+
+    // Decodes all blocks of the recording and concatenates their entries
+    std::vector<Entry> decodeAll(const std::vector<std::byte>& file,
+                                 const std::vector<RecordingIndexEntry>& index,
+                                 bool& hasErrors)
+    {
+        std::vector<Entry> entries;
+        hasErrors = false;
+        for (const RecordingIndexEntry& e : index) {
+            SessionRecording::KeyframeBlock block = SessionRecording::decodeKeyframeBlock(
+                file.data() + e.offset,
+                static_cast<size_t>(e.size),
+                static_cast<size_t>(e.offset)
+            );
+            hasErrors |= block.hasErrors;
+            entries.insert(entries.end(), block.entries.begin(), block.entries.end());
+        }
+        return entries;
+    }
+} // namespace
+
+class SessionRecordingTest : public testing::Test {};
+
+TEST_F(SessionRecordingTest, WriteAndReadIndex) {
+    std::vector<RecordingIndexEntry> written;
+    const std::vector<std::byte> file = createRecording(true, &written);
+
+    const std::vector<RecordingIndexEntry> index = SessionRecording::readRecordingIndex(
+        file.data(),
+        file.size(),
+        HeaderSize
+    );
+    ASSERT_EQ(index.size(), (NKeyframes + KeyframesPerBlock - 1) / KeyframesPerBlock);
+    ASSERT_EQ(index.size(), written.size());
+
+    uint64_t nEntries = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+        EXPECT_EQ(index[i].offset, written[i].offset);
+        EXPECT_EQ(index[i].size, written[i].size);
+        EXPECT_EQ(index[i].nEntries, written[i].nEntries);
+        EXPECT_EQ(index[i].timeRec, written[i].timeRec);
+        if (i + 1 < index.size()) {
+            // The blocks are contiguous
+            EXPECT_EQ(index[i].offset + index[i].size, index[i + 1].offset);
+        }
+        nEntries += index[i].nEntries;
+
+        SessionRecording::KeyframeBlock block = SessionRecording::decodeKeyframeBlock(
+            file.data() + index[i].offset,
+            static_cast<size_t>(index[i].size),
+            static_cast<size_t>(index[i].offset)
+        );
+        EXPECT_FALSE(block.hasErrors);
+        ASSERT_EQ(block.entries.size(), index[i].nEntries);
+        EXPECT_EQ(block.entries.front().timeRec, index[i].timeRec);
+    }
+    EXPECT_EQ(index.front().offset, HeaderSize);
+    EXPECT_EQ(nEntries, NKeyframes);
+
+    bool hasErrors = false;
+    const std::vector<Entry> entries = decodeAll(file, index, hasErrors);
+    EXPECT_FALSE(hasErrors);
+    ASSERT_EQ(entries.size(), NKeyframes);
+    for (int i = 0; i < NKeyframes; ++i) {
+        EXPECT_EQ(entries[i].type, keyframeType(i));
+        EXPECT_EQ(entries[i].timeRec, recordedTime(i));
+        EXPECT_EQ(entries[i].timeSim, 1000.0 + recordedTime(i));
+    }
+}
+
+TEST_F(SessionRecordingTest, DecodeKeyframes) {
+    std::vector<RecordingIndexEntry> index;
+    const std::vector<std::byte> file = createRecording(true, &index);
+
+    // The second block contains keyframes 4 (script), 5 (camera), 6 (time), 7 (camera)
+    SessionRecording::KeyframeBlock block = SessionRecording::decodeKeyframeBlock(
+        file.data() + index[1].offset,
+        static_cast<size_t>(index[1].size),
+        static_cast<size_t>(index[1].offset)
+    );
+    ASSERT_EQ(block.keyframesCamera.size(), 2);
+    ASSERT_EQ(block.keyframesTime.size(), 1);
+    ASSERT_EQ(block.keyframesScript.size(), 1);
+
+    EXPECT_EQ(block.keyframesCamera[0].focusNode, "Node5");
+    EXPECT_EQ(block.keyframesCamera[0].position, glm::dvec3(5.0, 10.0, 15.0));
+    EXPECT_TRUE(block.keyframesCamera[0].followFocusNodeRotation);
+    EXPECT_EQ(block.keyframesCamera[1].focusNode, "Node7");
+    EXPECT_EQ(block.keyframesTime[0]._dt, 60.0);
+    EXPECT_FALSE(block.keyframesTime[0]._paused);
+    EXPECT_TRUE(block.keyframesTime[0]._requiresTimeJump);
+    EXPECT_EQ(block.keyframesScript[0], "openspace.printInfo(4)");
+
+    ASSERT_EQ(block.entries.size(), 4);
+    EXPECT_EQ(block.entries[0].type, RecordedType::Script);
+    EXPECT_EQ(block.entries[1].idxIntoKeyframeTypeArray, 0);
+    EXPECT_EQ(block.entries[3].idxIntoKeyframeTypeArray, 1);
+}
+
+TEST_F(SessionRecordingTest, RecordingWithoutIndex) {
+    // Recordings that were not stopped properly end after the last keyframe
+    const std::vector<std::byte> file = createRecording(false, nullptr);
+
+    const std::vector<RecordingIndexEntry> index = SessionRecording::readRecordingIndex(
+        file.data(),
+        file.size(),
+        HeaderSize
+    );
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index.front().offset, HeaderSize);
+    EXPECT_EQ(index.front().size, file.size() - HeaderSize);
+
+    bool hasErrors = false;
+    const std::vector<Entry> entries = decodeAll(file, index, hasErrors);
+    EXPECT_FALSE(hasErrors);
+    EXPECT_EQ(entries.size(), NKeyframes);
+
+    // A file that only contains the header
+    const std::vector<RecordingIndexEntry> empty = SessionRecording::readRecordingIndex(
+        file.data(),
+        HeaderSize,
+        HeaderSize
+    );
+    ASSERT_EQ(empty.size(), 1);
+    EXPECT_EQ(empty.front().size, 0);
+}
+
+TEST_F(SessionRecordingTest, TruncatedRecording) {
+    std::vector<RecordingIndexEntry> written;
+    std::vector<std::byte> file = createRecording(true, &written);
+
+    // Without the end of the trailer the index can't be found, so the whole file is
+    // decoded as one block. Decoding stops with an error at the start of the index
+    file.resize(file.size() - 3);
+    std::vector<RecordingIndexEntry> index = SessionRecording::readRecordingIndex(
+        file.data(),
+        file.size(),
+        HeaderSize
+    );
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index.front().offset, HeaderSize);
+
+    bool hasErrors = false;
+    std::vector<Entry> entries = decodeAll(file, index, hasErrors);
+    EXPECT_TRUE(hasErrors);
+    EXPECT_EQ(entries.size(), NKeyframes);
+
+    // A recording that ends in the middle of a keyframe keeps all complete keyframes
+    std::vector<std::byte> partial = createRecording(false, nullptr);
+    partial.resize(partial.size() - 3);
+    index = SessionRecording::readRecordingIndex(
+        partial.data(),
+        partial.size(),
+        HeaderSize
+    );
+    entries = decodeAll(partial, index, hasErrors);
+    EXPECT_FALSE(hasErrors);
+    EXPECT_EQ(entries.size(), NKeyframes - 1);
+}
+
+TEST_F(SessionRecordingTest, CorruptIndex) {
+    std::vector<RecordingIndexEntry> written;
+    std::vector<std::byte> file = createRecording(true, &written);
+
+    // The offset of the index in the trailer points past the end of the file
+    const uint64_t invalidOffset = file.size();
+    std::memcpy(
+        file.data() + file.size() - 8 - sizeof(uint64_t),
+        &invalidOffset,
+        sizeof(uint64_t)
+    );
+    const std::vector<RecordingIndexEntry> index = SessionRecording::readRecordingIndex(
+        file.data(),
+        file.size(),
+        HeaderSize
+    );
+    ASSERT_EQ(index.size(), 1);
+    EXPECT_EQ(index.front().offset, HeaderSize);
+    EXPECT_EQ(index.front().size, file.size() - HeaderSize);
+
+    // The number of blocks in the trailer is so large that the size of the index
+    // overflows to the actual size of the index
+    file = createRecording(true, &written);
+    const uint64_t nOverflowingBlocks = written.size() + (uint64_t(1) << 60);
+    ASSERT_EQ(
+        nOverflowingBlocks * sizeof(RecordingIndexEntry),
+        written.size() * sizeof(RecordingIndexEntry)
+    );
+    std::memcpy(
+        file.data() + file.size() - 8 - 2 * sizeof(uint64_t),
+        &nOverflowingBlocks,
+        sizeof(uint64_t)
+    );
+    const std::vector<RecordingIndexEntry> overflowIndex =
+        SessionRecording::readRecordingIndex(file.data(), file.size(), HeaderSize);
+    ASSERT_EQ(overflowIndex.size(), 1);
+    EXPECT_EQ(overflowIndex.front().offset, HeaderSize);
+}
+
+TEST_F(SessionRecordingTest, SeekToTimestamp) {
+    std::vector<RecordingIndexEntry> written;
+    const std::vector<std::byte> file = createRecording(true, &written);
+    const std::vector<RecordingIndexEntry> index = SessionRecording::readRecordingIndex(
+        file.data(),
+        file.size(),
+        HeaderSize
+    );
+    ASSERT_EQ(index.size(), 7u);
+
+    // Before the first keyframe, the playback starts with the first block
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, -1.0), 0);
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 0.0), 0);
+    // Block i starts with keyframe 4 * i at time 2 * i
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 1.9), 0);
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 2.0), 1);
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 5.5), 2);
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 12.0), 6);
+    // After the last keyframe, the last block is used
+    EXPECT_EQ(SessionRecording::indexBlockForTime(index, 1000.0), 6);
+
+    // The block that is found contains the keyframes around the requested time
+    for (int i = 0; i < NKeyframes; ++i) {
+        const double time = recordedTime(i) + 0.25;
+        const size_t b = SessionRecording::indexBlockForTime(index, time);
+        SessionRecording::KeyframeBlock block = SessionRecording::decodeKeyframeBlock(
+            file.data() + index[b].offset,
+            static_cast<size_t>(index[b].size),
+            static_cast<size_t>(index[b].offset)
+        );
+        ASSERT_FALSE(block.entries.empty());
+        EXPECT_LE(block.entries.front().timeRec, time);
+        if (b + 1 < index.size()) {
+            EXPECT_GT(index[b + 1].timeRec, time);
+        }
+    }
+
+    // A recording without index has a single block that is used for all times
+    const std::vector<std::byte> unindexed = createRecording(false, nullptr);
+    const std::vector<RecordingIndexEntry> single = SessionRecording::readRecordingIndex(
+        unindexed.data(),
+        unindexed.size(),
+        HeaderSize
+    );
+    EXPECT_EQ(SessionRecording::indexBlockForTime(single, 5.0), 0);
+}
@@ -0,0 +1,143 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+
+#include "gtest/gtest.h"
+
+#include <openspace/util/taskscheduler.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class TaskSchedulerTest : public testing::Test {};
+
+TEST_F(TaskSchedulerTest, ExecutesAllTasks) {
+    using namespace openspace;
+
+    TaskScheduler scheduler(4);
+    std::atomic<int> nExecuted = 0;
+    {
+        TaskGroup group(scheduler);
+        for (int i = 0; i < 1000; ++i) {
+            group.run([&nExecuted]() { nExecuted++; });
+        }
+        group.wait();
+    }
+    EXPECT_EQ(nExecuted, 1000);
+}
+
+TEST_F(TaskSchedulerTest, NestedGroups) {
+    using namespace openspace;
+
+    // Waiting on a group from within a task must not block the worker forever, even if
+    // there is only a single worker
+    TaskScheduler scheduler(1);
+    std::atomic<int> nExecuted = 0;
+    {
+        TaskGroup outer(scheduler);
+        for (int i = 0; i < 10; ++i) {
+            outer.run([&scheduler, &nExecuted]() {
+                TaskGroup inner(scheduler);
+                for (int j = 0; j < 10; ++j) {
+                    inner.run([&nExecuted]() { nExecuted++; });
+                }
+                inner.wait();
+            });
+        }
+        outer.wait();
+    }
+    EXPECT_EQ(nExecuted, 100);
+}
+
+TEST_F(TaskSchedulerTest, Cancellation) {
+    using namespace openspace;
+
+    TaskScheduler scheduler(1);
+    std::atomic<bool> isBlocking = true;
+    std::atomic<int> nExecuted = 0;
+
+    TaskGroup group(scheduler);
+    group.run([&isBlocking]() {
+        while (isBlocking) {
+            std::this_thread::yield();
+        }
+    });
+
+    CancellationToken token;
+    for (int i = 0; i < 10; ++i) {
+        group.run(
+            [&nExecuted]() { nExecuted++; },
+            TaskScheduler::Priority::Normal,
+            token
+        );
+    }
+    token.cancel();
+
+    TaskGroup cancelledGroup(scheduler);
+    for (int i = 0; i < 10; ++i) {
+        cancelledGroup.run([&nExecuted]() { nExecuted++; });
+    }
+    cancelledGroup.cancel();
+
+    isBlocking = false;
+    group.wait();
+    cancelledGroup.wait();
+    EXPECT_EQ(nExecuted, 0) << "Cancelled tasks should not be executed";
+}
+
+TEST_F(TaskSchedulerTest, Priorities) {
+    using namespace openspace;
+
+    TaskScheduler scheduler(1);
+    std::atomic<bool> isBlocking = true;
+    std::mutex orderMutex;
+    std::vector<int> order;
+
+    TaskGroup group(scheduler);
+    group.run([&isBlocking]() {
+        while (isBlocking) {
+            std::this_thread::yield();
+        }
+    });
+    // Make sure the worker is busy before the prioritized tasks are enqueued
+    while (scheduler.numQueuedTasks() > 0) {
+        std::this_thread::yield();
+    }
+
+    auto addToOrder = [&orderMutex, &order](int value) {
+        return [&orderMutex, &order, value]() {
+            std::lock_guard lock(orderMutex);
+            order.push_back(value);
+        };
+    };
+    group.run(addToOrder(0), TaskScheduler::Priority::Low);
+    group.run(addToOrder(1), TaskScheduler::Priority::Normal);
+    group.run(addToOrder(2), TaskScheduler::Priority::High);
+
+    isBlocking = false;
+    group.wait();
+    EXPECT_EQ(order, std::vector<int>({ 2, 1, 0 }));
+}
@@ -0,0 +1,275 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include <openspace/engine/globals.h>
+#include <openspace/properties/propertyowner.h>
+#include <openspace/properties/uripattern.h>
+#include <openspace/properties/scalar/boolproperty.h>
+#include <openspace/query/query.h>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+namespace {
+    using openspace::properties::BoolProperty;
+    using openspace::properties::Property;
+    using openspace::properties::PropertyOwner;
+    using openspace::properties::UriPattern;
+
+    // The reference result: all Property's in the tree whose fully qualified identifier
+    // matches the regular expression, in the order of propertiesRecursive
+    std::vector<Property*> regexMatches(const PropertyOwner& owner,
+                                        const std::string& regex)
+    {
+        const std::regex r(regex);
+        std::vector<Property*> result;
+        for (Property* p : owner.propertiesRecursive()) {
+            if (std::regex_match(p->fullyQualifiedIdentifier(), r)) {
+                result.push_back(p);
+            }
+        }
+        return result;
+    }
+} // namespace
+
+class UriPatternTest : public testing::Test {
+protected:
+    UriPatternTest()
+        : _scene({ "Scene" })
+        , _earth({ "Earth" })
+        , _earthRenderable({ "Renderable" })
+        , _mars({ "Mars" })
+        , _marsRenderable({ "Renderable" })
+        , _unnamed({ "Unnamed" })
+        , _layer({ "Layer" })
+        , _long({ std::string(56, 'a') })
+    {
+        // Scene.Enabled
+        // Scene.Earth.Opacity, Scene.Earth.Enabled
+        // Scene.Earth.Renderable.Opacity, Scene.Earth.Renderable.Color
+        // Scene.Mars.Renderable.Opacity
+        // Scene.Fade, Scene.Layer.Opacity (the owner in between has no identifier)
+        // Scene.aaa...aaa.Opacity
+        addProperty(_scene, "Enabled");
+        _scene.addPropertySubOwner(_earth);
+        addProperty(_earth, "Opacity");
+        addProperty(_earth, "Enabled");
+        _earth.addPropertySubOwner(_earthRenderable);
+        addProperty(_earthRenderable, "Opacity");
+        addProperty(_earthRenderable, "Color");
+        _scene.addPropertySubOwner(_mars);
+        _mars.addPropertySubOwner(_marsRenderable);
+        addProperty(_marsRenderable, "Opacity");
+        _scene.addPropertySubOwner(_unnamed);
+        addProperty(_unnamed, "Fade");
+        _unnamed.addPropertySubOwner(_layer);
+        addProperty(_layer, "Opacity");
+        // Sub-owners can't be added without an identifier, but they can be renamed
+        _unnamed.setIdentifier("");
+        _scene.addPropertySubOwner(_long);
+        addProperty(_long, "Opacity");
+    }
+
+    void addProperty(PropertyOwner& owner, const std::string& identifier) {
+        _properties.push_back(std::make_unique<BoolProperty>(
+            Property::PropertyInfo{ identifier.c_str(), "", "" }
+        ));
+        owner.addProperty(_properties.back().get());
+    }
+
+    // Checks that the UriPattern returns the same Property's in the same order as
+    // std::regex_match over the fully qualified identifiers
+    void expectSameAsRegex(const std::string& regex, bool isHierarchical) {
+        const UriPattern pattern(regex);
+        EXPECT_EQ(pattern.isHierarchical(), isHierarchical) << regex;
+        EXPECT_EQ(pattern.matchingProperties(_scene), regexMatches(_scene, regex))
+            << regex;
+    }
+
+    // Owners have to be destroyed after the Property's they own, so they are declared
+    // first
+    PropertyOwner _scene;
+    PropertyOwner _earth;
+    PropertyOwner _earthRenderable;
+    PropertyOwner _mars;
+    PropertyOwner _marsRenderable;
+    PropertyOwner _unnamed;
+    PropertyOwner _layer;
+    PropertyOwner _long;
+    std::vector<std::unique_ptr<BoolProperty>> _properties;
+};
+
+TEST_F(UriPatternTest, Literal) {
+    expectSameAsRegex("Scene.Earth.Renderable.Opacity", true);
+    expectSameAsRegex("Scene.Earth.Renderable", true);
+    expectSameAsRegex("Scene.Pluto.Renderable.Opacity", true);
+    expectSameAsRegex("", true);
+
+    const UriPattern pattern("Scene.Earth.Renderable.Opacity");
+    ASSERT_EQ(pattern.matchingProperties(_scene).size(), 1);
+    EXPECT_EQ(
+        pattern.matchingProperties(_scene).front()->fullyQualifiedIdentifier(),
+        "Scene.Earth.Renderable.Opacity"
+    );
+}
+
+TEST_F(UriPatternTest, ExpandedWildcards) {
+    // The scripting API replaces every * with (.*)
+    expectSameAsRegex("Scene.(.*).Opacity", true);
+    expectSameAsRegex("Scene.(.*).Renderable.Opacity", true);
+    expectSameAsRegex("(.*)Opacity", true);
+    expectSameAsRegex("Scene.(.*)", true);
+    expectSameAsRegex("(.*).Renderable.(.*)", true);
+    expectSameAsRegex("(.*)", true);
+
+    EXPECT_EQ(UriPattern("Scene.(.*).Opacity").matchingProperties(_scene).size(), 5);
+}
+
+TEST_F(UriPatternTest, AnyCharacter) {
+    expectSameAsRegex("Scene.Ma.s.Renderable.Opacity", true);
+    expectSameAsRegex("Scene.Earth.Renderable.Colo.", true);
+    expectSameAsRegex(".cene.Earth.Enabled", true);
+    expectSameAsRegex("Scene.Earth.Enabled.", true);
+    expectSameAsRegex("Scene.*Opacity", true);
+    expectSameAsRegex("Scene.Earth.*", true);
+
+    EXPECT_EQ(
+        UriPattern("Scene.Ma.s.Renderable.Opacity").matchingProperties(_scene).size(),
+        1
+    );
+}
+
+TEST_F(UriPatternTest, RegexFallback) {
+    expectSameAsRegex("Scene\\.Earth\\..*", false);
+    expectSameAsRegex("Scene.(Earth|Mars).Renderable.Opacity", false);
+    expectSameAsRegex("[A-Z].*Opacity", false);
+    expectSameAsRegex("Scene.*(Opacity|Color)", false);
+    expectSameAsRegex("Scene.E+arth.Enabled", false);
+
+    EXPECT_EQ(
+        UriPattern("Scene.(Earth|Mars).Renderable.Opacity").matchingProperties(
+            _scene
+        ).size(),
+        2
+    );
+    EXPECT_THROW(UriPattern("Scene.(Earth"), std::regex_error);
+}
+
+TEST_F(UriPatternTest, EmptyIdentifier) {
+    // The owner without identifier is skipped in the fully qualified identifier
+    expectSameAsRegex("Scene.Fade", true);
+    expectSameAsRegex("Scene.Layer.Opacity", true);
+    expectSameAsRegex("Scene..Fade", true);
+    expectSameAsRegex("Scene.Layer.(.*)", true);
+    expectSameAsRegex("Scene\\.Layer\\.Opacity", false);
+
+    EXPECT_EQ(UriPattern("Scene.Fade").matchingProperties(_scene).size(), 1);
+    EXPECT_EQ(UriPattern("Scene.Layer.Opacity").matchingProperties(_scene).size(), 1);
+
+    // A top-level owner without identifier
+    PropertyOwner root({ "" });
+    root.addPropertySubOwner(_scene);
+    EXPECT_EQ(
+        UriPattern("Scene.Earth.Opacity").matchingProperties(root),
+        regexMatches(root, "Scene.Earth.Opacity")
+    );
+    EXPECT_EQ(UriPattern("Scene.Earth.Opacity").matchingProperties(root).size(), 1);
+    EXPECT_EQ(
+        UriPattern("Scene\\.Earth\\.Opacity").matchingProperties(root),
+        regexMatches(root, "Scene\\.Earth\\.Opacity")
+    );
+    root.removePropertySubOwner(_scene);
+}
+
+TEST_F(UriPatternTest, TokenLimit) {
+    const std::string longIdentifier = "Scene." + std::string(56, 'a');
+
+    // 6 + 56 characters and one sequence are the 63 tokens that fit into the automaton
+    expectSameAsRegex(longIdentifier + ".*", true);
+    // One more token is handled by the regular expression
+    expectSameAsRegex(longIdentifier + "..*", false);
+    expectSameAsRegex(longIdentifier + ".Opacity", false);
+
+    EXPECT_EQ(UriPattern(longIdentifier + ".*").matchingProperties(_scene).size(), 1);
+    EXPECT_EQ(UriPattern(longIdentifier + "..*").matchingProperties(_scene).size(), 1);
+}
+
+TEST_F(UriPatternTest, Order) {
+    // The result follows propertiesRecursive: the properties of an owner come before
+    // the ones of its sub-owners, which are visited in the order they were added
+    const std::vector<Property*> result =
+        UriPattern("(.*)").matchingProperties(_scene);
+    const std::vector<Property*> all = _scene.propertiesRecursive();
+    EXPECT_EQ(result, all);
+    EXPECT_EQ(result.size(), _properties.size());
+
+    const std::vector<Property*> opacities =
+        UriPattern("Scene.(.*)Opacity").matchingProperties(_scene);
+    std::vector<std::string> identifiers;
+    for (Property* p : opacities) {
+        identifiers.push_back(p->fullyQualifiedIdentifier());
+    }
+    const std::vector<std::string> expected = {
+        "Scene.Earth.Opacity",
+        "Scene.Earth.Renderable.Opacity",
+        "Scene.Mars.Renderable.Opacity",
+        "Scene.Layer.Opacity",
+        "Scene." + std::string(56, 'a') + ".Opacity"
+    };
+    EXPECT_EQ(identifiers, expected);
+}
+
+TEST_F(UriPatternTest, QueryCacheInvalidation) {
+    using openspace::global::rootPropertyOwner;
+
+    PropertyOwner owner({ "UriPatternCacheTest" });
+    BoolProperty a({ "A", "", "" });
+    BoolProperty b({ "B", "", "" });
+    owner.addProperty(a);
+    rootPropertyOwner.addPropertySubOwner(owner);
+
+    const std::string regex = "UriPatternCacheTest.(.*)";
+    EXPECT_EQ(openspace::matchingProperties(regex), std::vector<Property*>{ &a });
+    // A second query is answered from the cache
+    EXPECT_EQ(openspace::matchingProperties(regex), std::vector<Property*>{ &a });
+
+    owner.addProperty(b);
+    EXPECT_EQ(openspace::matchingProperties(regex), (std::vector<Property*>{ &a, &b }));
+
+    owner.removeProperty(a);
+    EXPECT_EQ(openspace::matchingProperties(regex), std::vector<Property*>{ &b });
+
+    owner.setIdentifier("UriPatternCacheRenamed");
+    EXPECT_TRUE(openspace::matchingProperties(regex).empty());
+    EXPECT_EQ(
+        openspace::matchingProperties("UriPatternCacheRenamed.(.*)"),
+        std::vector<Property*>{ &b }
+    );
+
+    rootPropertyOwner.removePropertySubOwner(owner);
+    EXPECT_TRUE(openspace::matchingProperties("UriPatternCacheRenamed.(.*)").empty());
+
+    owner.removeProperty(b);
+}
@@ -0,0 +1,124 @@
+/*****************************************************************************************
+ *                                                                                       *
+ * OpenSpace                                                                             *
+ *                                                                                       *
+ * Copyright (c) 2014-2019                                                               *
+ *                                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this  *
+ * software and associated documentation files (the "Software"), to deal in the Software *
+ * without restriction, including without limitation the rights to use, copy, modify,    *
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to the following   *
+ * conditions:                                                                           *
+ *                                                                                       *
+ * The above copyright notice and this permission notice shall be included in all copies *
+ * or substantial portions of the Software.                                              *
+ *                                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,   *
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A         *
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT    *
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF  *
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE  *
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                                         *
+ ****************************************************************************************/
+
+#include "gtest/gtest.h"
+
+#include <modules/volume/lrucache.h>
+#include <modules/volume/volumeutils.h>
+#include <openspace/util/histogram.h>
+#include <cmath>
+#include <unordered_map>
+
+class VolumeUtilsTest : public testing::Test {};
+
+TEST_F(VolumeUtilsTest, NormalizedHistogram) {
+    using namespace openspace::volume;
+
+    const std::vector<float> values = { -1.f, 0.f, 1.f, 2.5f, 4.f, 5.f, 10.f };
+    const std::vector<float> bins = normalizedHistogram(
+        values.data(),
+        values.size(),
+        0.f,
+        4.f,
+        4
+    );
+
+    // Values outside of the range are counted in the first and last bin
+    ASSERT_EQ(bins.size(), 4);
+    EXPECT_EQ(bins[0], 2.f);
+    EXPECT_EQ(bins[1], 1.f);
+    EXPECT_EQ(bins[2], 1.f);
+    EXPECT_EQ(bins[3], 3.f);
+}
+
+TEST_F(VolumeUtilsTest, HistogramFromBins) {
+    using namespace openspace::volume;
+
+    const std::vector<float> bins = { 2.f, 0.f, 6.f, 2.f };
+    std::shared_ptr<openspace::Histogram> histogram = histogramFromBins(bins);
+    ASSERT_NE(histogram, nullptr);
+    ASSERT_EQ(histogram->numBins(), 4);
+    EXPECT_EQ(histogram->minValue(), 0.f);
+    EXPECT_EQ(histogram->maxValue(), 1.f);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(histogram->sample(i), bins[i]);
+    }
+
+    // The equalizer divides by the number of values in the histogram
+    histogram->generateEqualizer();
+    EXPECT_FLOAT_EQ(histogram->equalize(0.1f), 0.2f * 3.f);
+    EXPECT_FLOAT_EQ(histogram->equalize(0.6f), 0.8f * 3.f);
+    EXPECT_FLOAT_EQ(histogram->equalize(0.9f), 3.f);
+
+    const float entropy = histogram->entropy();
+    EXPECT_TRUE(std::isfinite(entropy));
+}
+
+TEST_F(VolumeUtilsTest, EmptyHistogram) {
+    using namespace openspace::volume;
+
+    EXPECT_EQ(histogramFromBins({}), nullptr);
+    EXPECT_EQ(histogramFromBins({ 0.f, 0.f, 0.f }), nullptr);
+}
+
+TEST_F(VolumeUtilsTest, ItemsWithinBudget) {
+    using namespace openspace::volume;
+
+    EXPECT_EQ(nItemsWithinBudget({}, 100), 0);
+    EXPECT_EQ(nItemsWithinBudget({ 40, 40, 40 }, 100), 2);
+    EXPECT_EQ(nItemsWithinBudget({ 40, 60, 40 }, 100), 2);
+    EXPECT_EQ(nItemsWithinBudget({ 40, 40, 20 }, 100), 3);
+    EXPECT_EQ(nItemsWithinBudget({ 120, 40 }, 100), 0);
+    // Items are added in order, so a small item after one that does not fit is skipped
+    EXPECT_EQ(nItemsWithinBudget({ 40, 80, 10 }, 100), 1);
+}
+
+TEST_F(VolumeUtilsTest, LruCacheEvictionOrder) {
+    using namespace openspace::volume;
+
+    // The timesteps of a volume with the number of bytes of their textures
+    LruCache<int, size_t, std::unordered_map> cache(16);
+    EXPECT_EQ(cache.size(), 0);
+
+    cache.set(3, 100);
+    cache.set(4, 200);
+    cache.set(5, 300);
+    ASSERT_EQ(cache.size(), 3);
+    EXPECT_EQ(cache.leastRecentlyUsed(), 3);
+
+    // Using a timestep makes it the most recently used one
+    cache.use(3);
+    EXPECT_EQ(cache.leastRecentlyUsed(), 4);
+
+    EXPECT_EQ(cache.get(4), 200);
+    cache.evict();
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_FALSE(cache.has(4));
+    EXPECT_EQ(cache.leastRecentlyUsed(), 5);
+
+    // Setting an existing timestep updates its size and marks it as used
+    cache.set(5, 50);
+    EXPECT_EQ(cache.get(5), 50);
+    EXPECT_EQ(cache.leastRecentlyUsed(), 3);
+}